@@ -95,6 +95,8 @@
 #define CDB2_TEMP_WRITE_COST 0.2
 #define CDB2_TEMP_FIND_COST 0.1
 #define CDB2_TEMP_MOVE_COST 0.1
+/* A run sorted or merged by a sorter thread */
+#define CDB2_TEMP_SORT_TASK_COST 1.0
 
 /* Access to sqlite_statN & sqlite_master tables is considered free */
 #define CDB2_SQLITE_STAT_COST 0.0
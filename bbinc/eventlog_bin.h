@@ -0,0 +1,95 @@
+/*
+   Copyright 2026 Bloomberg Finance L.P.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+ */
+
+#ifndef __EVENTLOG_BIN_H__
+#define __EVENTLOG_BIN_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Binary event log format (eventlog_binary).
+ *
+ * The file is a gzip stream starting with EVENTLOG_BIN_MAGIC, followed by
+ * events.  Each event is a varint length followed by one encoded value,
+ * always an object.  Values are a tag byte followed by:
+ *
+ *   EVB_NULL, EVB_TRUE, EVB_FALSE  nothing
+ *   EVB_INT                        zigzag varint
+ *   EVB_DOUBLE                     8 byte IEEE double, little endian
+ *   EVB_STRING                     varint length, bytes
+ *   EVB_JSON                       varint length, JSON text
+ *   EVB_OBJECT                     (varint key length, key, value)...,
+ *                                  terminated by a 0 key length
+ *   EVB_ARRAY                      values..., terminated by EVB_ARRAY_END
+ *
+ * Members are stored in the order the JSON event log prints them, so
+ * cdb2_evtojson produces the same lines as the JSON writer.
+ */
+
+#define EVENTLOG_BIN_MAGIC "CDB2EVB\001"
+#define EVENTLOG_BIN_MAGIC_LEN 8
+
+#define EVB_NULL 'n'
+#define EVB_TRUE 't'
+#define EVB_FALSE 'f'
+#define EVB_INT 'i'
+#define EVB_DOUBLE 'd'
+#define EVB_STRING 's'
+#define EVB_JSON 'j'
+#define EVB_OBJECT '{'
+#define EVB_ARRAY '['
+#define EVB_ARRAY_END ']'
+
+/* Longest varint encoding of a 64 bit value. */
+#define EVB_VARINT_MAX 10
+
+static inline size_t evb_put_varint(uint8_t *p, uint64_t v)
+{
+    size_t n = 0;
+    while (v >= 0x80) {
+        p[n++] = (uint8_t)(v | 0x80);
+        v >>= 7;
+    }
+    p[n++] = (uint8_t)v;
+    return n;
+}
+
+/* Returns the number of bytes consumed, 0 if `p' holds no complete varint. */
+static inline size_t evb_get_varint(const uint8_t *p, size_t len, uint64_t *v)
+{
+    uint64_t r = 0;
+    for (size_t n = 0; n < len && n < EVB_VARINT_MAX; ++n) {
+        r |= (uint64_t)(p[n] & 0x7f) << (7 * n);
+        if ((p[n] & 0x80) == 0) {
+            *v = r;
+            return n + 1;
+        }
+    }
+    return 0;
+}
+
+static inline uint64_t evb_zigzag(int64_t v)
+{
+    return ((uint64_t)v << 1) ^ (uint64_t)(v >> 63);
+}
+
+static inline int64_t evb_unzigzag(uint64_t v)
+{
+    return (int64_t)(v >> 1) ^ -(int64_t)(v & 1);
+}
+
+#endif
@@ -0,0 +1,62 @@
+/*
+   Copyright 2026 Bloomberg Finance L.P.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+ */
+
+/*
+ * Protocol of multiplexed newsql connections.
+ *
+ * A multiplexed connection carries many newsql sessions over one tcp
+ * connection.  The client opens it with the appsock line
+ * NEWSQL_MUX_APPSOCK, and the database answers with a NEWSQL_MUX_HELLO
+ * frame.  From then on both sides send frames: a header, in network byte
+ * order, followed by `length' bytes.
+ *
+ *  - NEWSQL_MUX_OPEN (client): start a session with a new id.  The session
+ *    behaves like a newsql connection which has just sent its appsock line,
+ *    and has its own sql state: transactions, SET options and prepared
+ *    statements are not shared with other sessions.
+ *  - NEWSQL_MUX_DATA (both): newsql bytes of a session.
+ *  - NEWSQL_MUX_CLOSE (both): the session is gone.  The database rolls back
+ *    whatever the session had open.
+ *
+ * Session ids are picked by the client and must not be reused while the
+ * session is open.
+ */
+
+#ifndef INCLUDED_NEWSQL_MUX_H
+#define INCLUDED_NEWSQL_MUX_H
+
+#include <stdint.h>
+
+/* Appsock lines are at most CDB2BUF_UNGETC_BUF_MAX bytes */
+#define NEWSQL_MUX_APPSOCK "sqlmux\n"
+
+enum {
+    NEWSQL_MUX_HELLO = 0,
+    NEWSQL_MUX_OPEN = 1,
+    NEWSQL_MUX_DATA = 2,
+    NEWSQL_MUX_CLOSE = 3
+};
+
+struct newsql_mux_hdr {
+    uint32_t type;
+    uint32_t session;
+    uint32_t length;
+};
+
+/* Largest payload of a frame */
+#define NEWSQL_MUX_MAX_FRAME (64 * 1024)
+
+#endif /* INCLUDED_NEWSQL_MUX_H */
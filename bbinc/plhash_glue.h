@@ -6,4 +6,11 @@
 hash_t *hash_init_ptr(void); /* hash of pointers (addresses) */
 hash_t *hash_init_strcase(int keyoff); /* string starts at keyoff (case-insensitive) */
 hash_t *hash_init_strcaseptr(int keyoff); /* like above, case insensitive */
+
+/* Store objects in an open addressing table instead of hash chains: no
+ * allocation per object, and lookups compare a group of 16 one-byte hash
+ * tags at once.  Must be called on a new table, before hash_initsize() and
+ * hash_add().  Returns 0 on success.  Iterators stay valid across
+ * deletions, but hash_find() does not move found objects up front. */
+int hash_set_open_addressing(hash_t *h);
 #endif /*INCLUDED_PLHASH_GLUE_H*/
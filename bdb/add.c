@@ -301,6 +301,9 @@ static int bdb_prim_allocdta_int(bdb_state_type *bdb_state, tran_type *tran,
         return 0;
     }
 
+    if (bdb_zonemap_widen(bdb_state, tran, *genid, dta, dtalen, bdberr))
+        return 0;
+
     return rrn;
 }
 
@@ -416,6 +419,10 @@ static int bdb_prim_adddta_n_genid_int(bdb_state_type *bdb_state,
         return 0;
     }
 
+    if (dtanum == 0 && !odhready &&
+        bdb_zonemap_widen(bdb_state, tran, genid, dtaptr, dtalen, bdberr))
+        return 0;
+
     return 0;
 }
 
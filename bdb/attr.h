@@ -240,6 +240,12 @@ DEF_ATTR(TEMPTABLE_MEM_THRESHOLD, temptable_mem_threshold, QUANTITY, 512,
 DEF_ATTR(TEMPTABLE_CACHESZ, temptable_cachesz, BYTES, 262144,
          "Cache size for temporary tables. Temp tables do not share the "
          "database's main buffer pool.")
+DEF_ATTR(TEMPTABLE_SKIPLIST_MAXSZ, temptable_skiplist_maxsz, BYTES, 16777216,
+         "Spill in-memory skiplist temp tables (osql shadow tables) to disk "
+         "past this many bytes.")
+DEF_ATTR(TEMPTABLE_HASHJOIN_MAXSZ, temptable_hashjoin_maxsz, BYTES, 67108864,
+         "Spill the in-memory build side of a sql hash join to a disk-backed "
+         "index past this many bytes.")
 DEF_ATTR(PARTICIPANTID_BITS, participantid_bits, QUANTITY, 0,
          "Number of bits allocated for the participant stripe ID (remaining "
          "bits are used for the update ID).")
@@ -716,6 +716,31 @@ int bdb_fingerprint_rtstats_get(const unsigned char *fingerprint, size_t fplen,
     return bb_berkdb_fingerprint_rtstats_get(fingerprint, fplen, n_pagein_read, n_pagein_read_io);
 }
 
+int bdb_changed_pages_snapshot(bdb_state_type *bdb_state, int *valid,
+                               char *chain, size_t chainlen)
+{
+    return bb_berkdb_changed_pages_snapshot(bdb_state->dbenv, valid, chain,
+                                            chainlen);
+}
+
+int bdb_changed_pages_ack(bdb_state_type *bdb_state, const char *chain)
+{
+    return bb_berkdb_changed_pages_ack(bdb_state->dbenv, chain);
+}
+
+uint64_t bdb_table_chg_gen(bdb_state_type *bdb_state)
+{
+    uint64_t gen = 0;
+    for (int dtanum = 0; dtanum < bdb_state->numdtafiles; dtanum++) {
+        int nstripes = bdb_get_datafile_num_files(bdb_state, dtanum);
+        for (int strnum = 0; strnum < nstripes; strnum++)
+            gen += bb_berkdb_mpf_chg_gen(bdb_state->dbp_data[dtanum][strnum]);
+    }
+    for (int ixnum = 0; ixnum < bdb_state->numix; ixnum++)
+        gen += bb_berkdb_mpf_chg_gen(bdb_state->dbp_ix[ixnum]);
+    return gen;
+}
+
 /* Call this any time to get process wide stats (which get updated locklessly)
  */
 const struct berkdb_thread_stats *bdb_get_process_stats(void)
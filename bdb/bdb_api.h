@@ -1083,6 +1083,11 @@ int bdb_dump_dta_file_n(bdb_state_type *bdb_state, int dtanum, FILE *out);
 int bdb_fetch_next_genids(bdb_state_type *bdb_state, int ixnum, int ixlen,
                           unsigned char *key, unsigned long long *genids,
                           int numgenids, int *num_genids_gotten, int *bdberr);
+int bdb_fetch_prev_genids(bdb_state_type *bdb_state, int ixnum, int ixlen,
+                          unsigned char *key, unsigned long long *genids,
+                          int numgenids, int *num_genids_gotten, int *bdberr);
+int bdb_prefault_dta(bdb_state_type *bdb_state, unsigned long long genid,
+                     int num, int prev, int *num_gotten);
 
 void bdb_set_io_control(void (*start)(), void (*cmplt)());
 
@@ -1204,6 +1209,10 @@ struct temp_table *bdb_temp_hashtable_create(bdb_state_type *bdb_state,
                                              int *bdberr);
 struct temp_table *bdb_temp_array_create(bdb_state_type *bdb_state,
                                          int *bdberr);
+struct temp_table *bdb_temp_skiplist_create(bdb_state_type *bdb_state,
+                                            int *bdberr);
+struct temp_table *bdb_temp_hashjoin_create(bdb_state_type *bdb_state,
+                                            int *bdberr);
 struct temp_table *bdb_temp_table_create_flags(bdb_state_type *bdb_state,
                                                int flags, int *bdberr);
 
@@ -1260,6 +1269,17 @@ int bdb_temp_table_find(bdb_state_type *bdb_state, struct temp_cursor *cursor,
 int bdb_temp_table_find_exact(bdb_state_type *bdb_state,
                               struct temp_cursor *cursor, void *key, int keylen,
                               int *bdberr);
+
+/* temp hash join tables */
+int bdb_temp_table_put_hashed(bdb_state_type *bdb_state,
+                              struct temp_table *table, unsigned int hash,
+                              void *key, int keylen, void *data, int dtalen,
+                              void *unpacked, int *bdberr);
+int bdb_temp_table_find_hashed(bdb_state_type *bdb_state,
+                               struct temp_cursor *cursor, unsigned int hash,
+                               int *bdberr);
+int bdb_temp_table_spill(bdb_state_type *bdb_state, struct temp_table *table,
+                         int *bdberr);
 void bdb_temp_table_reset_datapointers(struct temp_cursor *cur);
 
 void *bdb_temp_table_get_cur(struct temp_cursor *skippy);
@@ -1377,6 +1397,17 @@ void bdb_fingerprint_rtstats_clear(void);
 int bdb_fingerprint_rtstats_get(const unsigned char *fingerprint, size_t fplen, uint64_t *n_pagein_read,
                                 uint64_t *n_pagein_read_io);
 
+/* Changed page tracking, for incremental backups.  A snapshot holds the pages
+ * written since the last one; *valid is set if it holds every page written
+ * since the last acknowledged one. */
+int bdb_changed_pages_snapshot(bdb_state_type *bdb_state, int *valid,
+                               char *chain, size_t chainlen);
+int bdb_changed_pages_ack(bdb_state_type *bdb_state, const char *chain);
+
+/* Sum of the change generations of the data, blob and index files of a table.
+ * It goes up whenever a page of the table is dirtied. */
+uint64_t bdb_table_chg_gen(bdb_state_type *bdb_state);
+
 /* Format and print the thread stats.  printfn() is a function which accepts
  * a line to print (\n\0 terminated) and a context pointer. Its return value
  * is ignored.  bdb_fprintf_stats is a convenience wrapper which uses fputs()
@@ -1744,6 +1775,45 @@ int bdb_get_seqno(tran_type *t, int64_t *seqno);
 int bdb_set_seqno(tran_type *t, int64_t seqno);
 int bdb_del_seqno(tran_type *t);
 
+/* Zone maps: min/max of the fixed size ondisk columns of runs of records of
+ * a data stripe, keyed by the sequence part of the first genid of the run */
+typedef struct bdb_zone_col {
+    uint16_t fld; /* ondisk field number */
+    uint16_t len; /* ondisk length, with the field header */
+    uint32_t off; /* ondisk offset */
+    uint8_t *min;
+    uint8_t *max;
+} bdb_zone_col_t;
+
+typedef struct bdb_zone {
+    uint64_t version; /* table version the zone was summarized at */
+    uint64_t lo;      /* first and last sequence covered */
+    uint64_t hi;
+    uint32_t nrows;
+    uint16_t ncols;
+    bdb_zone_col_t *cols;
+} bdb_zone_t;
+
+int bdb_zonemap_find(tran_type *t, const char *tablename, int stripe,
+                     uint64_t seq, uint64_t *lo, void **zone, int *zonelen,
+                     int *bdberr);
+int bdb_zonemap_find_next(tran_type *t, const char *tablename, int stripe,
+                          uint64_t seq, uint64_t *lo, int *bdberr);
+int bdb_zonemap_put(tran_type *t, const char *tablename, int stripe,
+                    uint64_t lo, void *zone, int zonelen, int *bdberr);
+int bdb_zonemap_del_all(tran_type *t, const char *tablename, int *bdberr);
+
+uint64_t bdb_genid_seq(unsigned long long genid);
+unsigned long long bdb_seq_to_genid(uint64_t seq, int stripe);
+int bdb_zone_pack(const bdb_zone_t *zone, void **buf, int *len);
+int bdb_zone_unpack(uint64_t lo, void *buf, int len, bdb_zone_t *zone);
+void bdb_zone_free(bdb_zone_t *zone);
+void bdb_zonemap_raise_frontier(bdb_state_type *bdb_state, int stripe,
+                                uint64_t hi);
+int bdb_zonemap_widen(bdb_state_type *bdb_state, tran_type *tran,
+                      unsigned long long genid, const void *dta, int dtalen,
+                      int *bdberr);
+
 typedef struct {
     uint64_t genid;
     unsigned int file;
@@ -1961,6 +2031,7 @@ void bdb_verify_dbreg(bdb_state_type *bdb_state);
 int bdb_the_lock_desired(void);
 
 int bdb_is_hashtable(struct temp_table *);
+int bdb_is_hashjoin(struct temp_table *);
 
 void analyze_set_headroom(uint64_t);
 
@@ -2433,6 +2504,9 @@ typedef struct repl_wait_and_net_use {
     double max_wait_over_1min;
     char lsn_text[LSN_TEXT_WIDTH];
     uint64_t lsn_bytes_behind;
+    unsigned long long msgs_written;
+    unsigned long long msgs_read;
+    unsigned long long write_calls;
 } repl_wait_and_net_use_t;
 repl_wait_and_net_use_t *bdb_get_repl_wait_and_net_stats(bdb_state_type *bdb_state, int *pnnodes);
 
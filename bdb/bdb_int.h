@@ -920,6 +920,9 @@ struct bdb_state_tag {
     unsigned long long dtavers[1 + MAXBLOBS];
     unsigned long long ixvers[MAXINDEX];
     unsigned long long qvers[BDB_QUEUEDB_MAX_FILES];
+
+    /* zone map frontiers of the data stripes, see zonemap.c */
+    struct zonemap_frontier *zonemap;
 };
 
 #include <net_types.h>
@@ -2204,7 +2204,13 @@ repl_wait_and_net_use_t *bdb_get_repl_wait_and_net_stats(
                                         &pos->bytes_read,
                                         &pos->throttle_waits,
                                         &pos->reorders);
-                                            
+        if (rc == 0) {
+            rc = net_get_host_message_usage(p_netinfo, host,
+                                            &pos->msgs_written,
+                                            &pos->msgs_read,
+                                            &pos->write_calls);
+        }
+
         struct hostinfo *h = retrieve_hostinfo(nodes[i].host_interned);
         Pthread_mutex_lock(&(bdb_state->seqnum_info->lock));
 
@@ -2220,6 +2226,9 @@ repl_wait_and_net_use_t *bdb_get_repl_wait_and_net_stats(
             pos->max_wait_over_1min = 0;
             pos->lsn_text[0] = '\0';
             pos->lsn_bytes_behind = 0;
+            pos->msgs_written = 0;
+            pos->msgs_read = 0;
+            pos->write_calls = 0;
         } else {
             pos->avg_wait_over_10secs = averager_avg(h->time_10seconds);
             pos->max_wait_over_10secs = averager_max(h->time_10seconds);
@@ -180,6 +180,7 @@ typedef enum {
     LLMETA_SCHEMACHANGE_LIST = 57,            /* list of all sc-s in a uuid txh */
     LLMETA_SCHEMACHANGE_STATUS_PROTOBUF = 58, /* Indicate protobuf sc */
     LLMETA_MAX_SEQNO = 59,
+    LLMETA_ZONEMAP = 60, /* 60 + TABLENAME + STRIPE + FIRST SEQ -> ZONE */
 } llmetakey_t;
 
 struct llmeta_file_type_key {
@@ -7492,6 +7493,9 @@ int bdb_llmeta_print_record(bdb_state_type *bdb_state, void *key, int keylen,
     case LLMETA_MAX_SEQNO:
         logmsg(LOGMSG_USER, "LLMETA_MAX_SEQNO: %"PRIu64"\n", flibc_ntohll(*(int64_t *)p_buf_data));
         break;
+    case LLMETA_ZONEMAP:
+        logmsg(LOGMSG_USER, "LLMETA_ZONEMAP\n");
+        break;
     default:
          logmsg(LOGMSG_USER, "Todo (type=%d)\n", type);
          break;
@@ -11580,3 +11584,114 @@ int bdb_del_seqno(tran_type *t)
         logmsg(LOGMSG_WARN, "%s: kv_del rc %d bdberr %d\n", __func__, rc, bdberr);
     return rc;
 }
+
+/* Zone map of a data stripe: one entry per zone, keyed by the sequence part
+ * of the first genid the zone covers. */
+struct llmeta_zonemap_key {
+    int file_type;
+    char tablename[LLMETA_TBLLEN + 1];
+    char pad[3];
+    int stripe;
+    int pad2;
+    uint64_t lo;
+};
+enum { LLMETA_ZONEMAP_KEY_LEN = 4 + LLMETA_TBLLEN + 1 + 3 + 4 + 4 + 8 };
+
+BB_COMPILE_TIME_ASSERT(llmeta_zonemap_key_len,
+                       sizeof(struct llmeta_zonemap_key) ==
+                           LLMETA_ZONEMAP_KEY_LEN);
+
+typedef union {
+    struct llmeta_zonemap_key key;
+    uint8_t buf[LLMETA_IXLEN];
+} llmeta_zonemap_key;
+
+static void zonemap_key(llmeta_zonemap_key *k, const char *tablename,
+                        int stripe, uint64_t lo)
+{
+    memset(k, 0, sizeof(*k));
+    k->key.file_type = htonl(LLMETA_ZONEMAP);
+    strncpy0(k->key.tablename, tablename, sizeof(k->key.tablename));
+    k->key.stripe = htonl(stripe);
+    k->key.lo = flibc_htonll(lo);
+}
+
+/* Fetches the zone of `stripe' starting at or before `seq' (dir < 0), or the
+ * first zone starting after `seq' (dir > 0).  Returns 0 and sets `lo', and
+ * `zone'/`zonelen' if they are given, if there is one, 1 if there is none and
+ * -1 on error.  *zone is malloced. */
+static int zonemap_fetch(tran_type *t, const char *tablename, int stripe,
+                         uint64_t seq, int dir, uint64_t *lo, void **zone,
+                         int *zonelen, int *bdberr)
+{
+    llmeta_zonemap_key k, fnd;
+    int numfnd = 0;
+    int rc;
+
+    /* the backward fetch returns keys before the given one, the forward
+     * fetch keys after it */
+    *bdberr = BDBERR_NOERROR;
+    zonemap_key(&k, tablename, stripe, dir < 0 ? seq + 1 : seq);
+    if (dir < 0)
+        rc = bdb_lite_fetch_keys_bwd_tran(llmeta_bdb_state, t, &k, &fnd, 1,
+                                          &numfnd, bdberr);
+    else
+        rc = bdb_lite_fetch_keys_fwd_tran(llmeta_bdb_state, t, &k, &fnd, 1,
+                                          &numfnd, bdberr);
+    if (rc || (*bdberr != BDBERR_NOERROR && *bdberr != BDBERR_FETCH_DTA))
+        return -1;
+    *bdberr = BDBERR_NOERROR;
+    if (numfnd == 0 ||
+        memcmp(&fnd, &k, offsetof(struct llmeta_zonemap_key, lo)) != 0)
+        return 1;
+
+    *lo = flibc_ntohll(fnd.key.lo);
+    if (zone == NULL)
+        return 0;
+    rc = bdb_lite_exact_var_fetch_tran(llmeta_bdb_state, t, &fnd, zone,
+                                       zonelen, bdberr);
+    if (rc || *bdberr != BDBERR_NOERROR)
+        return -1;
+    return 0;
+}
+
+int bdb_zonemap_find(tran_type *t, const char *tablename, int stripe,
+                     uint64_t seq, uint64_t *lo, void **zone, int *zonelen,
+                     int *bdberr)
+{
+    return zonemap_fetch(t, tablename, stripe, seq, -1, lo, zone, zonelen,
+                         bdberr);
+}
+
+int bdb_zonemap_find_next(tran_type *t, const char *tablename, int stripe,
+                          uint64_t seq, uint64_t *lo, int *bdberr)
+{
+    return zonemap_fetch(t, tablename, stripe, seq, 1, lo, NULL, NULL, bdberr);
+}
+
+int bdb_zonemap_put(tran_type *t, const char *tablename, int stripe,
+                    uint64_t lo, void *zone, int zonelen, int *bdberr)
+{
+    llmeta_zonemap_key k;
+    zonemap_key(&k, tablename, stripe, lo);
+    return kv_put(t, &k, zone, zonelen, bdberr);
+}
+
+int bdb_zonemap_del_all(tran_type *t, const char *tablename, int *bdberr)
+{
+    llmeta_zonemap_key k;
+    void **keys = NULL;
+    int nkeys = 0;
+    int rc;
+
+    zonemap_key(&k, tablename, 0, 0);
+    rc = kv_get_keys(t, &k, offsetof(struct llmeta_zonemap_key, stripe),
+                     &keys, &nkeys, bdberr);
+    for (int i = 0; i < nkeys; ++i) {
+        if (rc == 0)
+            rc = kv_del(t, keys[i], bdberr);
+        free(keys[i]);
+    }
+    free(keys);
+    return rc;
+}
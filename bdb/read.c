@@ -44,10 +44,10 @@
 #include "genid.h"
 #include "bdb_api.h"
 
-static int bdb_fetch_next_genids_int(bdb_state_type *bdb_state, int ixnum,
-                                     int ixlen, unsigned char *ix,
-                                     unsigned long long *genids, int numgenids,
-                                     int *num_genids_gotten, int *bdberr)
+static int bdb_fetch_genids_int(bdb_state_type *bdb_state, int ixnum,
+                                int ixlen, unsigned char *ix,
+                                unsigned long long *genids, int numgenids,
+                                int *num_genids_gotten, int prev, int *bdberr)
 {
     DBT dbt_key, dbt_data;
     int rc;
@@ -76,12 +76,15 @@ static int bdb_fetch_next_genids_int(bdb_state_type *bdb_state, int ixnum,
     dbt_key.size = ixlen;
     dbt_key.ulen = 512;
 
+    /* only the genid, datacopy indexes carry the row after it */
     dbt_data.data = &found_genid;
     dbt_data.size = sizeof(unsigned long long);
     dbt_data.ulen = sizeof(unsigned long long);
+    dbt_data.dlen = sizeof(unsigned long long);
+    dbt_data.doff = 0;
 
     dbt_key.flags |= DB_DBT_USERMEM;
-    dbt_data.flags |= DB_DBT_USERMEM;
+    dbt_data.flags |= DB_DBT_USERMEM | DB_DBT_PARTIAL;
 
     rc = bdb_state->dbp_ix[ixnum]->cursor(bdb_state->dbp_ix[ixnum], 0, &dbcp,
                                           cursor_flags);
@@ -100,23 +103,17 @@ static int bdb_fetch_next_genids_int(bdb_state_type *bdb_state, int ixnum,
     num++;
 
     for (i = 1; i < numgenids; i++) {
-        rc = dbcp->c_get(dbcp, &dbt_key, &dbt_data, DB_NEXT);
-        if (rc != 0) {
-            dbcp->c_close(dbcp);
-            outrc = 0;
-            return 0;
-        }
+        rc = dbcp->c_get(dbcp, &dbt_key, &dbt_data, prev ? DB_PREV : DB_NEXT);
+        if (rc != 0)
+            break;
 
         memcpy(genids + num, dbt_data.data, sizeof(unsigned long long));
         num++;
     }
 
     dbcp->c_close(dbcp);
-    outrc = 0;
 
-    if (outrc == 0) {
-        *num_genids_gotten = num;
-    }
+    *num_genids_gotten = num;
 
     return outrc;
 }
@@ -129,8 +126,91 @@ int bdb_fetch_next_genids(bdb_state_type *bdb_state, int ixnum, int ixlen,
 
     BDB_READLOCK("bdb_fetch_next_genids");
 
-    rc = bdb_fetch_next_genids_int(bdb_state, ixnum, ixlen, ix, genids,
-                                   numgenids, num_genids_gotten, bdberr);
+    rc = bdb_fetch_genids_int(bdb_state, ixnum, ixlen, ix, genids, numgenids,
+                              num_genids_gotten, 0, bdberr);
+
+    BDB_RELLOCK();
+
+    return rc;
+}
+
+int bdb_fetch_prev_genids(bdb_state_type *bdb_state, int ixnum, int ixlen,
+                          unsigned char *ix, unsigned long long *genids,
+                          int numgenids, int *num_genids_gotten, int *bdberr)
+{
+    int rc;
+
+    BDB_READLOCK("bdb_fetch_prev_genids");
+
+    rc = bdb_fetch_genids_int(bdb_state, ixnum, ixlen, ix, genids, numgenids,
+                              num_genids_gotten, 1, bdberr);
+
+    BDB_RELLOCK();
+
+    return rc;
+}
+
+/* walk num records of the data stripe holding genid, starting at genid and
+ * moving in the scan direction; this pulls the pages a data scan is about
+ * to read into the bufferpool */
+static int bdb_prefault_dta_int(bdb_state_type *bdb_state,
+                                unsigned long long genid, int num, int prev,
+                                int *num_gotten)
+{
+    DBT dbt_key, dbt_data;
+    DBC *dbcp = NULL;
+    DB *dbp;
+    unsigned long long search_genid;
+    int stripe;
+    int rc;
+    int i;
+
+    *num_gotten = 0;
+
+    stripe = get_dtafile_from_genid(genid);
+    if (stripe < 0 || stripe >= bdb_state->attr->dtastripe)
+        return -1;
+    dbp = bdb_state->dbp_data[0][stripe];
+    if (!dbp)
+        return -1;
+
+    search_genid = get_search_genid(bdb_state, genid);
+
+    memset(&dbt_key, 0, sizeof(dbt_key));
+    memset(&dbt_data, 0, sizeof(dbt_data));
+
+    dbt_key.data = &search_genid;
+    dbt_key.size = sizeof(search_genid);
+    dbt_key.ulen = sizeof(search_genid);
+    dbt_key.flags = DB_DBT_USERMEM;
+
+    /* the page read is what we are after, not the row */
+    dbt_data.flags = DB_DBT_PARTIAL;
+    dbt_data.dlen = 0;
+    dbt_data.doff = 0;
+
+    rc = dbp->cursor(dbp, 0, &dbcp, DB_DIRTY_READ);
+    if (rc != 0)
+        return -2;
+
+    rc = dbcp->c_get(dbcp, &dbt_key, &dbt_data, DB_SET_RANGE);
+    for (i = 0; rc == 0 && i < num; i++)
+        rc = dbcp->c_get(dbcp, &dbt_key, &dbt_data, prev ? DB_PREV : DB_NEXT);
+    *num_gotten = i;
+
+    dbcp->c_close(dbcp);
+
+    return 0;
+}
+
+int bdb_prefault_dta(bdb_state_type *bdb_state, unsigned long long genid,
+                     int num, int prev, int *num_gotten)
+{
+    int rc;
+
+    BDB_READLOCK("bdb_prefault_dta");
+
+    rc = bdb_prefault_dta_int(bdb_state, genid, num, prev, num_gotten);
 
     BDB_RELLOCK();
 
@@ -79,6 +79,8 @@ extern char *gbl_crypto;
 extern int64_t gbl_temptable_created;
 extern int64_t gbl_temptable_create_reqs;
 extern int64_t gbl_temptable_spills;
+extern int64_t gbl_temptable_hash_joins;
+extern int64_t gbl_temptable_hash_join_spills;
 
 struct hashobj {
     int len;
@@ -143,6 +145,10 @@ struct temp_cursor {
     int ind;
     int keymalloclen;
     int datamalloclen;
+    struct sl_node *node;
+    struct hj_row *hj_row;
+    unsigned int hj_hash;
+    int hj_chained; /* next stays on rows with hj_hash */
 };
 
 typedef struct arr_elem {
@@ -186,10 +192,67 @@ typedef struct arr_elem {
    a temparray will fall back to a temptable.
    A temparray is more efficient than a temptable. Besides, it uses far
    less memory than a temptable for small and medium-sized requests. */
+
+/* A temp skiplist is an in-memory temptable for tables that grow large,
+   like osql shadow tables, where the O(n) inserts of a temparray would not
+   do.  Rows are carved out of a per-table arena and linked in key order
+   into a skiplist; tables compared with memcmp also index their rows in a
+   hash, for exact finds and inserts.  A deleted row stays linked, but is
+   skipped, until the table is truncated, so a cursor never points to freed
+   memory.  Past `temptable_skiplist_maxsz' bytes of arena, the rows are
+   copied into a btree, as with a temparray. */
+#define SL_MAXLEVEL 16
+#define SL_CHUNK_MIN 16384
+#define SL_CHUNK_MAX 1048576
+
+struct sl_key {
+    uint8_t *key;
+    int keylen;
+};
+
+typedef struct sl_node {
+    struct sl_key k; /* first, this is what the hash indexes */
+    uint8_t *dta;
+    int dtalen;
+    int dtacap;
+    int deleted;
+    int height;
+    struct sl_node *prev;
+    struct sl_node *next[/*height*/]; /* followed by the key, then the data */
+} sl_node_t;
+
+struct sl_chunk {
+    struct sl_chunk *next;
+    size_t size;
+    size_t used;
+    uint8_t mem[];
+};
+
+/* A temp hash join table holds the build side of a hash join.  Rows are
+   carved out of an arena, as in a temp skiplist, and chained in buckets by
+   a hash of their join columns, which the caller computes: a find by hash
+   lands on the first row with that hash and next walks the others, leaving
+   the caller to check the join columns.  First and next without a find
+   return the rows in insertion order.  Past `temptable_hashjoin_maxsz'
+   bytes, or on anything that needs the rows in order (a find by key, last,
+   prev, delete, update), the rows are copied into a btree. */
+#define HJ_BUCKETS_MIN 1024
+
+typedef struct hj_row {
+    struct hj_row *chain; /* next row in the bucket */
+    struct hj_row *next;  /* next row in insertion order */
+    unsigned int hash;
+    int keylen;
+    int dtalen;
+    uint8_t mem[]; /* the key, then the data */
+} hj_row_t;
+
 enum {
     TEMP_TABLE_TYPE_BTREE,
     TEMP_TABLE_TYPE_HASH,
-    TEMP_TABLE_TYPE_ARRAY
+    TEMP_TABLE_TYPE_ARRAY,
+    TEMP_TABLE_TYPE_SKIPLIST,
+    TEMP_TABLE_TYPE_HASHJOIN
 };
 
 struct temp_table {
@@ -213,7 +276,25 @@ struct temp_table {
 
     unsigned long long inmemsz;
     unsigned long long cachesz;
+    uint32_t acct_epoch; /* of the memory account charged for inmemsz and
+                            sl_memsz */
     arr_elem_t *elements;
+
+    /* temp skiplist */
+    sl_node_t *sl_head;
+    sl_node_t *sl_tail;
+    int sl_level;
+    uint64_t sl_rand;
+    struct sl_chunk *sl_chunks;
+    unsigned long long sl_memsz;
+    unsigned long long sl_maxsz;
+    hash_t *sl_hash;
+
+    /* temp hash join table; rows come from the skiplist arena */
+    hj_row_t **hj_buckets;
+    unsigned int hj_nbuckets;
+    hj_row_t *hj_first;
+    hj_row_t *hj_last;
 };
 
 enum { TMPTBL_PRIORITY, TMPTBL_WAIT };
@@ -239,6 +320,27 @@ static int bdb_temp_table_insert_put(bdb_state_type *, struct temp_table *,
 
 void *bdb_temp_table_get_cur(struct temp_cursor *skippy) { return skippy->cur; }
 
+/* What a table keeps in memory is charged to the query which filled it,
+ * even if the table is emptied under a later one */
+static inline void tbl_acct_charge(struct temp_table *tbl, long long n)
+{
+    if (n < 0) {
+        comdb2ma_acct_uncharge(tbl->acct_epoch, -n);
+        return;
+    }
+    if (tbl->inmemsz == 0 && tbl->sl_memsz == 0)
+        tbl->acct_epoch = comdb2ma_acct_epoch();
+    if (tbl->acct_epoch != 0 && tbl->acct_epoch == comdb2ma_acct_epoch())
+        comdb2ma_acct_charge(n);
+}
+
+/* The rows an array keeps in memory are charged to the query using it */
+static inline void arr_memsz_add(struct temp_table *tbl, long long n)
+{
+    tbl_acct_charge(tbl, n);
+    tbl->inmemsz += n;
+}
+
 static int histcmpfunc(const void *key1, const void *key2, int len)
 {
     return !pthread_equal(*(pthread_t *)key1, *(pthread_t *)key2);
@@ -362,7 +464,7 @@ static int bdb_array_copy_to_temp_db(bdb_state_type *bdb_state,
         elem = &tbl->elements[ii];
         free(elem->key);
     }
-    tbl->inmemsz = 0;
+    arr_memsz_add(tbl, -(long long)tbl->inmemsz);
     tbl->num_mem_entries = nents;
 
     /* its now a btree! */
@@ -468,6 +570,458 @@ done:
     return rc;
 }
 
+static unsigned int sl_hashfunc(const void *key, int len)
+{
+    const struct sl_key *k = key;
+    return hash_default_fixedwidth(k->key, k->keylen);
+}
+
+static int sl_hashcmpfunc(const void *key1, const void *key2, int len)
+{
+    const struct sl_key *k1 = key1, *k2 = key2;
+    if (k1->keylen != k2->keylen)
+        return 1;
+    return memcmp(k1->key, k2->key, k1->keylen);
+}
+
+/* Only memcmp equality agrees with the hash; other tables use the list. */
+#define SL_HASHED(tbl) ((tbl)->cmpfunc == key_memcmp)
+
+static void *sl_alloc(struct temp_table *tbl, size_t sz)
+{
+    struct sl_chunk *chunk = tbl->sl_chunks;
+    void *p;
+
+    sz = (sz + 7) & ~(size_t)7;
+    if (chunk == NULL || chunk->size - chunk->used < sz) {
+        size_t chunksz = chunk ? chunk->size * 2 : SL_CHUNK_MIN;
+        if (chunksz > SL_CHUNK_MAX)
+            chunksz = SL_CHUNK_MAX;
+        if (chunksz < sz)
+            chunksz = sz;
+        chunk = malloc(offsetof(struct sl_chunk, mem) + chunksz);
+        if (chunk == NULL)
+            return NULL;
+        chunk->size = chunksz;
+        chunk->used = 0;
+        chunk->next = tbl->sl_chunks;
+        tbl->sl_chunks = chunk;
+        tbl_acct_charge(tbl, chunksz);
+        tbl->sl_memsz += chunksz;
+    }
+    p = chunk->mem + chunk->used;
+    chunk->used += sz;
+    return p;
+}
+
+/* Drops all rows; cursors are the caller's business. */
+static void sl_reset(struct temp_table *tbl)
+{
+    struct sl_chunk *chunk;
+
+    while ((chunk = tbl->sl_chunks) != NULL) {
+        tbl->sl_chunks = chunk->next;
+        free(chunk);
+    }
+    tbl_acct_charge(tbl, -(long long)tbl->sl_memsz);
+    tbl->sl_memsz = 0;
+    if (tbl->sl_head)
+        memset(tbl->sl_head->next, 0, SL_MAXLEVEL * sizeof(sl_node_t *));
+    tbl->sl_tail = NULL;
+    tbl->sl_level = 1;
+    if (tbl->sl_hash)
+        hash_clear(tbl->sl_hash);
+}
+
+static int sl_random_height(struct temp_table *tbl)
+{
+    uint64_t r = tbl->sl_rand;
+    int height = 1;
+
+    r ^= r << 13;
+    r ^= r >> 7;
+    r ^= r << 17;
+    tbl->sl_rand = r;
+    while (height < SL_MAXLEVEL && (r & 3) == 0) {
+        ++height;
+        r >>= 2;
+    }
+    return height;
+}
+
+static inline int sl_cmp(struct temp_table *tbl, const sl_node_t *x,
+                         const void *key, int keylen)
+{
+    return tbl->cmpfunc(tbl->usermem, x->k.keylen, x->k.key, keylen, key);
+}
+
+/* Returns the first row not less than `key', deleted or not, and the last
+   row before it on every level in `update'. */
+static sl_node_t *sl_seek(struct temp_table *tbl, const void *key, int keylen,
+                          sl_node_t **update)
+{
+    sl_node_t *x = tbl->sl_head;
+
+    for (int i = tbl->sl_level - 1; i >= 0; --i) {
+        while (x->next[i] && sl_cmp(tbl, x->next[i], key, keylen) < 0)
+            x = x->next[i];
+        if (update)
+            update[i] = x;
+    }
+    return x->next[0];
+}
+
+/* Returns the row with `key', deleted or not. */
+static sl_node_t *sl_lookup(struct temp_table *tbl, const void *key,
+                            int keylen)
+{
+    sl_node_t *x;
+
+    if (SL_HASHED(tbl)) {
+        struct sl_key k = {.key = (uint8_t *)key, .keylen = keylen};
+        return hash_find(tbl->sl_hash, &k);
+    }
+    x = sl_seek(tbl, key, keylen, NULL);
+    if (x && sl_cmp(tbl, x, key, keylen) == 0)
+        return x;
+    return NULL;
+}
+
+static inline sl_node_t *sl_live_next(sl_node_t *x)
+{
+    while (x && x->deleted)
+        x = x->next[0];
+    return x;
+}
+
+static inline sl_node_t *sl_live_prev(sl_node_t *x)
+{
+    while (x && x->deleted)
+        x = x->prev;
+    return x;
+}
+
+static int sl_set_data(struct temp_table *tbl, sl_node_t *x, const void *data,
+                       int dtalen)
+{
+    if (dtalen > x->dtacap) {
+        uint8_t *dta = sl_alloc(tbl, dtalen);
+        if (dta == NULL)
+            return -1;
+        x->dta = dta;
+        x->dtacap = dtalen;
+    }
+    if (dtalen > 0)
+        memcpy(x->dta, data, dtalen);
+    x->dtalen = dtalen;
+    return 0;
+}
+
+/* Adds a row, or replaces the data of the row with the same key, like a
+   btree put. */
+static int sl_insert(struct temp_table *tbl, const void *key, int keylen,
+                     const void *data, int dtalen)
+{
+    sl_node_t *update[SL_MAXLEVEL];
+    sl_node_t *x;
+    int height;
+
+    if (SL_HASHED(tbl)) {
+        struct sl_key k = {.key = (uint8_t *)key, .keylen = keylen};
+        if ((x = hash_find(tbl->sl_hash, &k)) == NULL)
+            sl_seek(tbl, key, keylen, update);
+    } else {
+        x = sl_seek(tbl, key, keylen, update);
+        if (x && sl_cmp(tbl, x, key, keylen) != 0)
+            x = NULL;
+    }
+
+    if (x) {
+        if (sl_set_data(tbl, x, data, dtalen))
+            return -1;
+        if (x->deleted) {
+            x->deleted = 0;
+            ++tbl->num_mem_entries;
+        }
+        return 0;
+    }
+
+    height = sl_random_height(tbl);
+    x = sl_alloc(tbl, offsetof(sl_node_t, next) +
+                          height * sizeof(sl_node_t *) + keylen + dtalen);
+    if (x == NULL)
+        return -1;
+    x->k.key = (uint8_t *)&x->next[height];
+    x->k.keylen = keylen;
+    memcpy(x->k.key, key, keylen);
+    x->dta = x->k.key + keylen;
+    x->dtalen = x->dtacap = dtalen;
+    if (dtalen > 0)
+        memcpy(x->dta, data, dtalen);
+    x->deleted = 0;
+    x->height = height;
+
+    if (SL_HASHED(tbl) && hash_add(tbl->sl_hash, x) != 0)
+        return -1;
+
+    for (int i = tbl->sl_level; i < height; ++i)
+        update[i] = tbl->sl_head;
+    if (height > tbl->sl_level)
+        tbl->sl_level = height;
+    for (int i = 0; i < height; ++i) {
+        x->next[i] = update[i]->next[i];
+        update[i]->next[i] = x;
+    }
+    x->prev = (update[0] == tbl->sl_head) ? NULL : update[0];
+    if (x->next[0])
+        x->next[0]->prev = x;
+    else
+        tbl->sl_tail = x;
+
+    ++tbl->num_mem_entries;
+    return 0;
+}
+
+static int sl_copy_to_cur(struct temp_cursor *cur, sl_node_t *x)
+{
+    /* keep the buffers malloc'ed: callers may take the data */
+    if (cur->key == NULL || cur->keymalloclen < x->k.keylen) {
+        cur->key = malloc_resize(cur->key, x->k.keylen + 1);
+        cur->keymalloclen = x->k.keylen;
+    }
+    if (cur->data == NULL || cur->datamalloclen < x->dtalen) {
+        cur->data = malloc_resize(cur->data, x->dtalen + 1);
+        cur->datamalloclen = x->dtalen;
+    }
+    if (cur->key == NULL || cur->data == NULL) {
+        cur->node = NULL;
+        cur->valid = 0;
+        return -1;
+    }
+    memcpy(cur->key, x->k.key, x->k.keylen);
+    memcpy(cur->data, x->dta, x->dtalen);
+    cur->keylen = x->k.keylen;
+    cur->datalen = x->dtalen;
+    cur->node = x;
+    cur->valid = 1;
+    return 0;
+}
+
+static int bdb_skiplist_copy_to_temp_db(bdb_state_type *bdb_state,
+                                        struct temp_table *tbl, int *bdberr)
+{
+    int rc = 0;
+    DBT dbt_key, dbt_data;
+    struct temp_cursor *cur;
+    sl_node_t *x;
+
+    if (tbl->dbenv_temp == NULL &&
+        create_temp_db_env(bdb_state, tbl, bdberr) != 0)
+        return -1;
+
+    bzero(&dbt_key, sizeof(DBT));
+    bzero(&dbt_data, sizeof(DBT));
+    dbt_key.flags = dbt_data.flags = DB_DBT_USERMEM;
+    for (x = sl_live_next(tbl->sl_head->next[0]); x;
+         x = sl_live_next(x->next[0])) {
+        dbt_key.ulen = dbt_key.size = x->k.keylen;
+        dbt_key.data = x->k.key;
+        dbt_data.ulen = dbt_data.size = x->dtalen;
+        dbt_data.data = x->dta;
+        rc = tbl->tmpdb->put(tbl->tmpdb, NULL, &dbt_key, &dbt_data, 0);
+        if (rc) {
+            logmsg(LOGMSG_ERROR, "%s:%d put rc %d\n", __FILE__, __LINE__, rc);
+            return rc;
+        }
+    }
+
+    /* Keep the cursors where they are.  A cursor on a deleted row goes to
+       the row before it, so that moving next still finds the row after. */
+    LISTC_FOR_EACH(&tbl->cursors, cur, lnk)
+    {
+        rc = tbl->tmpdb->cursor(tbl->tmpdb, NULL, &cur->cur, 0);
+        if (rc) {
+            cur->cur = NULL;
+            logmsg(LOGMSG_ERROR, "%s:%d cursor rc %d\n", __FILE__, __LINE__,
+                   rc);
+            return rc;
+        }
+        x = cur->valid ? sl_live_prev(cur->node) : NULL;
+        cur->node = NULL;
+        if (x == NULL) {
+            cur->valid = 0;
+            continue;
+        }
+        dbt_key.ulen = dbt_key.size = x->k.keylen;
+        dbt_key.data = x->k.key;
+        dbt_data.flags = DB_DBT_USERMEM | DB_DBT_PARTIAL;
+        dbt_data.ulen = dbt_data.dlen = dbt_data.doff = 0;
+        dbt_data.data = NULL;
+        if (cur->cur->c_get(cur->cur, &dbt_key, &dbt_data, DB_SET) != 0)
+            cur->valid = 0;
+        dbt_data.flags = DB_DBT_USERMEM;
+    }
+
+    sl_reset(tbl);
+
+    /* its now a btree! */
+    tbl->temp_table_type = TEMP_TABLE_TYPE_BTREE;
+    return 0;
+}
+
+/* Drops all rows and buckets; cursors are the caller's business. */
+static void hj_reset(struct temp_table *tbl)
+{
+    free(tbl->hj_buckets);
+    tbl->hj_buckets = NULL;
+    tbl->hj_nbuckets = 0;
+    tbl->hj_first = tbl->hj_last = NULL;
+    sl_reset(tbl); /* releases the buckets' charge too */
+}
+
+static int hj_grow(struct temp_table *tbl)
+{
+    unsigned int nbuckets = tbl->hj_nbuckets ? tbl->hj_nbuckets * 2
+                                             : HJ_BUCKETS_MIN;
+    hj_row_t **buckets = calloc(nbuckets, sizeof(hj_row_t *));
+    if (buckets == NULL)
+        return -1;
+    for (hj_row_t *r = tbl->hj_first; r; r = r->next) {
+        hj_row_t **b = &buckets[r->hash & (nbuckets - 1)];
+        r->chain = *b;
+        *b = r;
+    }
+    free(tbl->hj_buckets);
+    size_t grown = (nbuckets - tbl->hj_nbuckets) * sizeof(hj_row_t *);
+    tbl_acct_charge(tbl, grown);
+    tbl->sl_memsz += grown;
+    tbl->hj_buckets = buckets;
+    tbl->hj_nbuckets = nbuckets;
+    return 0;
+}
+
+static int hj_insert(struct temp_table *tbl, unsigned int hash,
+                     const void *key, int keylen, const void *data,
+                     int dtalen)
+{
+    hj_row_t *r, **b;
+
+    if (tbl->num_mem_entries >= tbl->hj_nbuckets && hj_grow(tbl))
+        return -1;
+    r = sl_alloc(tbl, offsetof(hj_row_t, mem) + keylen + dtalen);
+    if (r == NULL)
+        return -1;
+    r->hash = hash;
+    r->keylen = keylen;
+    r->dtalen = dtalen;
+    memcpy(r->mem, key, keylen);
+    if (dtalen > 0)
+        memcpy(r->mem + keylen, data, dtalen);
+    b = &tbl->hj_buckets[hash & (tbl->hj_nbuckets - 1)];
+    r->chain = *b;
+    *b = r;
+    r->next = NULL;
+    if (tbl->hj_last)
+        tbl->hj_last->next = r;
+    else
+        tbl->hj_first = r;
+    tbl->hj_last = r;
+    ++tbl->num_mem_entries;
+    return 0;
+}
+
+/* Rows stay put until the table is truncated, so cursors point into them. */
+static int hj_set_cur(struct temp_cursor *cur, hj_row_t *r)
+{
+    cur->hj_row = r;
+    if (r == NULL) {
+        cur->valid = 0;
+        return IX_PASTEOF;
+    }
+    cur->key = r->mem;
+    cur->keylen = r->keylen;
+    cur->data = r->mem + r->keylen;
+    cur->datalen = r->dtalen;
+    cur->valid = 1;
+    return IX_FND;
+}
+
+static hj_row_t *hj_chain_from(hj_row_t *r, unsigned int hash)
+{
+    while (r && r->hash != hash)
+        r = r->chain;
+    return r;
+}
+
+static int bdb_hashjoin_copy_to_temp_db(bdb_state_type *bdb_state,
+                                        struct temp_table *tbl, int *bdberr)
+{
+    int rc = 0;
+    DBT dbt_key, dbt_data;
+    struct temp_cursor *cur;
+    hj_row_t *r;
+
+    if (tbl->dbenv_temp == NULL &&
+        create_temp_db_env(bdb_state, tbl, bdberr) != 0)
+        return -1;
+
+    bzero(&dbt_key, sizeof(DBT));
+    bzero(&dbt_data, sizeof(DBT));
+    dbt_key.flags = dbt_data.flags = DB_DBT_USERMEM;
+    for (r = tbl->hj_first; r; r = r->next) {
+        dbt_key.ulen = dbt_key.size = r->keylen;
+        dbt_key.data = r->mem;
+        dbt_data.ulen = dbt_data.size = r->dtalen;
+        dbt_data.data = r->mem + r->keylen;
+        rc = tbl->tmpdb->put(tbl->tmpdb, NULL, &dbt_key, &dbt_data, 0);
+        if (rc) {
+            logmsg(LOGMSG_ERROR, "%s:%d put rc %d\n", __FILE__, __LINE__, rc);
+            return rc;
+        }
+    }
+
+    /* Keep the cursors where they are; their key and data pointed into the
+       arena, and are the btree's to malloc from now on. */
+    LISTC_FOR_EACH(&tbl->cursors, cur, lnk)
+    {
+        rc = tbl->tmpdb->cursor(tbl->tmpdb, NULL, &cur->cur, 0);
+        if (rc) {
+            cur->cur = NULL;
+            logmsg(LOGMSG_ERROR, "%s:%d cursor rc %d\n", __FILE__, __LINE__,
+                   rc);
+            return rc;
+        }
+        r = cur->valid ? cur->hj_row : NULL;
+        cur->hj_row = NULL;
+        cur->hj_chained = 0;
+        cur->key = cur->data = NULL;
+        cur->keylen = cur->datalen = 0;
+        cur->valid = 0;
+        if (r == NULL)
+            continue;
+        dbt_key.ulen = dbt_key.size = r->keylen;
+        dbt_key.data = r->mem;
+        dbt_data.flags = DB_DBT_MALLOC;
+        if (cur->cur->c_get(cur->cur, &dbt_key, &dbt_data, DB_SET) == 0) {
+            cur->data = dbt_data.data;
+            cur->datalen = dbt_data.size;
+            if ((cur->key = malloc(r->keylen)) != NULL) {
+                memcpy(cur->key, r->mem, r->keylen);
+                cur->keylen = r->keylen;
+                cur->valid = 1;
+            }
+        }
+        dbt_data.flags = DB_DBT_USERMEM;
+    }
+
+    hj_reset(tbl);
+    ++gbl_temptable_hash_join_spills;
+
+    /* its now a btree! */
+    tbl->temp_table_type = TEMP_TABLE_TYPE_BTREE;
+    return 0;
+}
+
 static void bdb_temp_table_reset(struct temp_table *tbl)
 {
     tbl->rowid = 0;
@@ -779,6 +1333,25 @@ static struct temp_table *bdb_temp_table_create_type(bdb_state_type *bdb_state,
                 }
             }
             break;
+        case TEMP_TABLE_TYPE_SKIPLIST:
+            if (table->sl_head == NULL) {
+                table->sl_head = calloc(1, offsetof(sl_node_t, next) +
+                                               SL_MAXLEVEL * sizeof(sl_node_t *));
+                table->sl_hash = hash_init_user(sl_hashfunc, sl_hashcmpfunc, 0, 0);
+                if (table->sl_head == NULL || table->sl_hash == NULL) {
+                    bdb_temp_table_destroy_pool_wrapper(table, bdb_state);
+                    return NULL;
+                }
+                hash_set_open_addressing(table->sl_hash);
+                table->sl_rand = (uintptr_t)table | 1;
+            }
+            table->sl_level = 1;
+            table->sl_maxsz = bdb_state->attr->temptable_skiplist_maxsz;
+            break;
+        case TEMP_TABLE_TYPE_HASHJOIN:
+            table->sl_maxsz = bdb_state->attr->temptable_hashjoin_maxsz;
+            ++gbl_temptable_hash_joins;
+            break;
         }
 
         table->num_mem_entries = 0;
@@ -815,6 +1388,20 @@ struct temp_table *bdb_temp_array_create(bdb_state_type *bdb_state, int *bdberr)
     return bdb_temp_table_create_type(bdb_state, TEMP_TABLE_TYPE_ARRAY, bdberr);
 }
 
+struct temp_table *bdb_temp_skiplist_create(bdb_state_type *bdb_state,
+                                            int *bdberr)
+{
+    return bdb_temp_table_create_type(bdb_state, TEMP_TABLE_TYPE_SKIPLIST,
+                                      bdberr);
+}
+
+struct temp_table *bdb_temp_hashjoin_create(bdb_state_type *bdb_state,
+                                            int *bdberr)
+{
+    return bdb_temp_table_create_type(bdb_state, TEMP_TABLE_TYPE_HASHJOIN,
+                                      bdberr);
+}
+
 struct temp_cursor *bdb_temp_table_cursor(bdb_state_type *bdb_state,
                                           struct temp_table *tbl, void *usermem,
                                           int *bdberr)
@@ -842,6 +1429,14 @@ struct temp_cursor *bdb_temp_table_cursor(bdb_state_type *bdb_state,
     case TEMP_TABLE_TYPE_ARRAY:
         cur->ind = 0;
         break;
+
+    case TEMP_TABLE_TYPE_SKIPLIST:
+        cur->node = NULL;
+        break;
+
+    case TEMP_TABLE_TYPE_HASHJOIN:
+        cur->hj_row = NULL;
+        break;
     }
 
     if (rc) {
@@ -914,6 +1509,24 @@ int bdb_temp_table_update(bdb_state_type *bdb_state, struct temp_cursor *cur,
     arr_elem_t *elem;
     uint8_t *keycopy, *dtacopy;
 
+    if (cur->tbl->temp_table_type == TEMP_TABLE_TYPE_HASHJOIN &&
+        bdb_hashjoin_copy_to_temp_db(bdb_state, cur->tbl, bdberr))
+        return -1;
+
+    if (cur->tbl->temp_table_type == TEMP_TABLE_TYPE_SKIPLIST) {
+        struct temp_table *tbl = cur->tbl;
+        if (!cur->valid || cur->node == NULL || cur->node->deleted)
+            return -1;
+        if (sl_set_data(tbl, cur->node, data, dtalen))
+            return -1;
+        if (tbl->sl_memsz > tbl->sl_maxsz) {
+            gbl_temptable_spills++;
+            if (bdb_skiplist_copy_to_temp_db(bdb_state, tbl, bdberr))
+                return -1;
+        }
+        return 0;
+    }
+
     if (cur->tbl->temp_table_type != TEMP_TABLE_TYPE_BTREE &&
         cur->tbl->temp_table_type != TEMP_TABLE_TYPE_ARRAY) {
         logmsg(LOGMSG_ERROR, "bdb_temp_table_update operation "
@@ -928,7 +1541,7 @@ int bdb_temp_table_update(bdb_state_type *bdb_state, struct temp_cursor *cur,
         /* Free the existing elements and update the memory footprint. */
         elem = &cur->tbl->elements[cur->ind];
         free(elem->key);
-        cur->tbl->inmemsz -= (elem->keylen + elem->dtalen);
+        arr_memsz_add(cur->tbl, -(elem->keylen + elem->dtalen));
 
         /* malloc and copy */
         keycopy = malloc(keylen + dtalen);
@@ -943,7 +1556,7 @@ int bdb_temp_table_update(bdb_state_type *bdb_state, struct temp_cursor *cur,
         elem->key = keycopy;
         elem->dtalen = dtalen;
         elem->dta = dtacopy;
-        cur->tbl->inmemsz += (elem->keylen + elem->dtalen);
+        arr_memsz_add(cur->tbl, elem->keylen + elem->dtalen);
     }
 
     REOPEN_CURSOR(cur);
@@ -993,6 +1606,8 @@ unsigned long long bdb_temp_table_new_rowid(struct temp_table *tbl)
         }
         break;
     case TEMP_TABLE_TYPE_ARRAY:
+    case TEMP_TABLE_TYPE_SKIPLIST:
+    case TEMP_TABLE_TYPE_HASHJOIN:
         if (tbl->num_mem_entries == 0)
             tbl->rowid = 0;
         break;
@@ -1080,6 +1695,28 @@ static int bdb_temp_table_first_last(bdb_state_type *bdb_state,
         return 0;
     }
 
+    if (cur->tbl->temp_table_type == TEMP_TABLE_TYPE_HASHJOIN) {
+        if (how == DB_FIRST) {
+            cur->hj_chained = 0;
+            return hj_set_cur(cur, cur->tbl->hj_first) == IX_FND ? 0
+                                                                 : IX_EMPTY;
+        }
+        if (bdb_hashjoin_copy_to_temp_db(bdb_state, cur->tbl, bdberr))
+            return -1;
+    }
+
+    if (cur->tbl->temp_table_type == TEMP_TABLE_TYPE_SKIPLIST) {
+        sl_node_t *x = (how == DB_LAST)
+                           ? sl_live_prev(cur->tbl->sl_tail)
+                           : sl_live_next(cur->tbl->sl_head->next[0]);
+        if (x == NULL) {
+            cur->node = NULL;
+            cur->valid = 0;
+            return IX_EMPTY;
+        }
+        return sl_copy_to_cur(cur, x);
+    }
+
     REOPEN_CURSOR(cur);
 
     /*Pthread_setspecific(cur->tbl->curkey, cur);*/
@@ -1162,6 +1799,35 @@ static int bdb_temp_table_next_prev_norewind(bdb_state_type *bdb_state,
         return 0;
     }
 
+    if (cur->tbl->temp_table_type == TEMP_TABLE_TYPE_HASHJOIN) {
+        hj_row_t *r = cur->hj_row;
+        if (how == DB_NEXT) {
+            if (r == NULL)
+                return IX_PASTEOF;
+            if (cur->hj_chained)
+                return hj_set_cur(cur, hj_chain_from(r->chain, cur->hj_hash));
+            return hj_set_cur(cur, r->next);
+        }
+        cur->valid = 1;
+        if (bdb_hashjoin_copy_to_temp_db(bdb_state, cur->tbl, bdberr))
+            return -1;
+        if (!cur->valid)
+            return IX_PASTEOF;
+        cur->valid = 0;
+    }
+
+    if (cur->tbl->temp_table_type == TEMP_TABLE_TYPE_SKIPLIST) {
+        sl_node_t *x = cur->node;
+        if (x != NULL)
+            x = (how == DB_NEXT) ? sl_live_next(x->next[0])
+                                 : sl_live_prev(x->prev);
+        if (x == NULL) {
+            cur->node = NULL;
+            return IX_PASTEOF;
+        }
+        return sl_copy_to_cur(cur, x);
+    }
+
     REOPEN_CURSOR(cur);
 
     /*Pthread_setspecific(cur->tbl->curkey, cur);*/
@@ -1426,10 +2092,31 @@ int bdb_temp_table_truncate(bdb_state_type *bdb_state, struct temp_table *tbl,
             elem = &tbl->elements[ii];
             free(elem->key);
         }
-        tbl->inmemsz = 0;
+        arr_memsz_add(tbl, -(long long)tbl->inmemsz);
         tbl->num_mem_entries = 0;
         break;
 
+    case TEMP_TABLE_TYPE_SKIPLIST: {
+        struct temp_cursor *cur;
+        sl_reset(tbl);
+        LISTC_FOR_EACH(&tbl->cursors, cur, lnk)
+        {
+            cur->node = NULL;
+            cur->valid = 0;
+        }
+    } break;
+
+    case TEMP_TABLE_TYPE_HASHJOIN: {
+        struct temp_cursor *cur;
+        hj_reset(tbl);
+        LISTC_FOR_EACH(&tbl->cursors, cur, lnk)
+        {
+            cur->hj_row = NULL;
+            cur->key = cur->data = NULL;
+            cur->valid = 0;
+        }
+    } break;
+
     case TEMP_TABLE_TYPE_BTREE:
         rc = tbl->tmpdb->size(tbl->tmpdb, &sz);
         if (tbl->num_mem_entries < 100 && (rc == 0 && sz < gbl_temptable_recreate_size))
@@ -1661,6 +2348,7 @@ int bdb_temp_table_destroy_lru(struct temp_table *tbl,
             elem = &tbl->elements[ii];
             free(elem->key);
         }
+        arr_memsz_add(tbl, -(long long)tbl->inmemsz);
         break;
 
     case TEMP_TABLE_TYPE_BTREE:
@@ -1670,6 +2358,11 @@ int bdb_temp_table_destroy_lru(struct temp_table *tbl,
     if (tbl->temp_hash_tbl != NULL)
         hash_free(tbl->temp_hash_tbl);
     free(tbl->elements);
+    free(tbl->hj_buckets);
+    sl_reset(tbl);
+    if (tbl->sl_hash != NULL)
+        hash_free(tbl->sl_hash);
+    free(tbl->sl_head);
 
     /* close the environments*/
     if (tbl->dbenv_temp != NULL)
@@ -1726,7 +2419,7 @@ int bdb_temp_table_delete(bdb_state_type *bdb_state, struct temp_cursor *cur,
         elem = &cur->tbl->elements[cur->ind];
         free(elem->key);
         --cur->tbl->num_mem_entries;
-        cur->tbl->inmemsz -= (elem->keylen + elem->dtalen);
+        arr_memsz_add(cur->tbl, -(elem->keylen + elem->dtalen));
         memmove(elem, elem + 1,
                 sizeof(arr_elem_t) * (cur->tbl->num_mem_entries - cur->ind));
         /* Move backward all open cursors to the right of deletion point
@@ -1740,6 +2433,27 @@ int bdb_temp_table_delete(bdb_state_type *bdb_state, struct temp_cursor *cur,
         goto done;
     }
 
+    if (cur->tbl->temp_table_type == TEMP_TABLE_TYPE_HASHJOIN) {
+        if (bdb_hashjoin_copy_to_temp_db(bdb_state, cur->tbl, bdberr))
+            return -1;
+        if (!cur->valid) {
+            rc = -1;
+            goto done;
+        }
+    }
+
+    if (cur->tbl->temp_table_type == TEMP_TABLE_TYPE_SKIPLIST) {
+        /* stays linked, so this and other cursors can move on from it */
+        if (cur->node == NULL || cur->node->deleted) {
+            rc = -1;
+            goto done;
+        }
+        cur->node->deleted = 1;
+        --cur->tbl->num_mem_entries;
+        rc = 0;
+        goto done;
+    }
+
     REOPEN_CURSOR(cur);
 
     rc = cur->cur->c_del(cur->cur, 0);
@@ -1843,6 +2557,10 @@ int bdb_temp_table_find(bdb_state_type *bdb_state, struct temp_cursor *cur,
         return bdb_temp_table_find_hash(cur, key, keylen);
     }
 
+    if (cur->tbl->temp_table_type == TEMP_TABLE_TYPE_HASHJOIN &&
+        bdb_hashjoin_copy_to_temp_db(bdb_state, cur->tbl, bdberr))
+        return -1;
+
     if (cur->tbl->temp_table_type == TEMP_TABLE_TYPE_ARRAY) {
 
         /* Find the 1st occurrence of `key'. If `key' is not found,
@@ -1886,6 +2604,19 @@ int bdb_temp_table_find(bdb_state_type *bdb_state, struct temp_cursor *cur,
         return 0;
     }
 
+    if (cur->tbl->temp_table_type == TEMP_TABLE_TYPE_SKIPLIST) {
+        /* like a btree: the first row not less than `key', else the last */
+        sl_node_t *x = sl_live_next(sl_seek(cur->tbl, key, keylen, NULL));
+        if (x == NULL)
+            x = sl_live_prev(cur->tbl->sl_tail);
+        if (x == NULL) {
+            cur->node = NULL;
+            cur->valid = 0;
+            return IX_EMPTY;
+        }
+        return sl_copy_to_cur(cur, x);
+    }
+
     REOPEN_CURSOR(cur);
 
     /*Pthread_setspecific(cur->tbl->curkey, cur);*/
@@ -1993,6 +2724,10 @@ int bdb_temp_table_find_exact(bdb_state_type *bdb_state,
         return bdb_temp_table_find_exact_hash(cur, key, keylen);
     }
 
+    if (cur->tbl->temp_table_type == TEMP_TABLE_TYPE_HASHJOIN &&
+        bdb_hashjoin_copy_to_temp_db(bdb_state, cur->tbl, bdberr))
+        return -1;
+
     if (cur->tbl->temp_table_type == TEMP_TABLE_TYPE_ARRAY) {
 
         /* Find the 1st occurrence of `key'. */
@@ -2032,6 +2767,16 @@ int bdb_temp_table_find_exact(bdb_state_type *bdb_state,
         return 0;
     }
 
+    if (cur->tbl->temp_table_type == TEMP_TABLE_TYPE_SKIPLIST) {
+        sl_node_t *x = sl_lookup(cur->tbl, key, keylen);
+        if (x == NULL || x->deleted) {
+            cur->node = NULL;
+            cur->valid = 0;
+            return IX_NOTFND;
+        }
+        return sl_copy_to_cur(cur, x) ? -1 : IX_FND;
+    }
+
     REOPEN_CURSOR(cur);
 
     /* Make a copy of the user key */
@@ -2111,8 +2856,11 @@ static int bdb_temp_table_reset_cursor(bdb_state_type *bdb_state, struct temp_cu
     struct temp_table *tbl;
     tbl = cur->tbl;
 
+    cur->node = NULL;
+    cur->hj_row = NULL;
     if (tbl->temp_table_type == TEMP_TABLE_TYPE_BTREE ||
-        tbl->temp_table_type == TEMP_TABLE_TYPE_ARRAY) {
+        tbl->temp_table_type == TEMP_TABLE_TYPE_ARRAY ||
+        tbl->temp_table_type == TEMP_TABLE_TYPE_SKIPLIST) {
         if (cur->key) {
             free(cur->key);
             cur->key = NULL;
@@ -2216,6 +2964,64 @@ inline int bdb_is_hashtable(struct temp_table *tt)
     return (tt->temp_table_type == TEMP_TABLE_TYPE_HASH);
 }
 
+inline int bdb_is_hashjoin(struct temp_table *tt)
+{
+    return (tt->temp_table_type == TEMP_TABLE_TYPE_HASHJOIN);
+}
+
+/* Adds a row under `hash'; like bdb_temp_table_put() once the table is a
+   btree. */
+int bdb_temp_table_put_hashed(bdb_state_type *bdb_state, struct temp_table *tbl,
+                              unsigned int hash, void *key, int keylen,
+                              void *data, int dtalen, void *unpacked,
+                              int *bdberr)
+{
+    if (tbl->temp_table_type != TEMP_TABLE_TYPE_HASHJOIN)
+        return bdb_temp_table_put(bdb_state, tbl, key, keylen, data, dtalen,
+                                  unpacked, bdberr);
+    if (hj_insert(tbl, hash, key, keylen, data, dtalen))
+        return -1;
+    if (tbl->sl_memsz > tbl->sl_maxsz) {
+        gbl_temptable_spills++;
+        if (bdb_hashjoin_copy_to_temp_db(bdb_state, tbl, bdberr))
+            return -1;
+    }
+    return 0;
+}
+
+/* Moves to the first row added under `hash'; next then moves to the others.
+   Only for temp hash join tables. */
+int bdb_temp_table_find_hashed(bdb_state_type *bdb_state,
+                               struct temp_cursor *cur, unsigned int hash,
+                               int *bdberr)
+{
+    struct temp_table *tbl = cur->tbl;
+    hj_row_t *r = NULL;
+
+    if (tbl->temp_table_type != TEMP_TABLE_TYPE_HASHJOIN) {
+        *bdberr = BDBERR_BADARGS;
+        return -1;
+    }
+    if (tbl->num_mem_entries == 0) {
+        cur->hj_row = NULL;
+        cur->valid = 0;
+        return IX_EMPTY;
+    }
+    cur->hj_hash = hash;
+    cur->hj_chained = 1;
+    r = hj_chain_from(tbl->hj_buckets[hash & (tbl->hj_nbuckets - 1)], hash);
+    return hj_set_cur(cur, r) == IX_FND ? IX_FND : IX_NOTFND;
+}
+
+/* Turns a temp hash join table into a btree; a no-op for other tables. */
+int bdb_temp_table_spill(bdb_state_type *bdb_state, struct temp_table *tbl,
+                         int *bdberr)
+{
+    if (tbl->temp_table_type != TEMP_TABLE_TYPE_HASHJOIN)
+        return 0;
+    return bdb_hashjoin_copy_to_temp_db(bdb_state, tbl, bdberr);
+}
+
 int bdb_temp_table_maybe_set_priority_thread(bdb_state_type *bdb_state)
 {
     int rc = TMPTBL_WAIT;
@@ -2287,6 +3093,11 @@ static int bdb_temp_table_insert_put(bdb_state_type *bdb_state,
     arr_elem_t *elem;
     uint8_t *keycopy, *dtacopy;
 
+    /* rows added without a hash can't be found by one */
+    if (tbl->temp_table_type == TEMP_TABLE_TYPE_HASHJOIN &&
+        bdb_hashjoin_copy_to_temp_db(bdb_state, tbl, bdberr))
+        return -1;
+
     if (tbl->temp_table_type == TEMP_TABLE_TYPE_HASH) {
         void *hash_data;
         void *old;
@@ -2361,7 +3172,7 @@ static int bdb_temp_table_insert_put(bdb_state_type *bdb_state,
         elem->dta = dtacopy;
 
         ++tbl->num_mem_entries;
-        tbl->inmemsz += (keylen + dtalen);
+        arr_memsz_add(tbl, keylen + dtalen);
 
         if (tbl->num_mem_entries == tbl->max_mem_entries ||
             tbl->inmemsz > tbl->cachesz) {
@@ -2375,6 +3186,19 @@ static int bdb_temp_table_insert_put(bdb_state_type *bdb_state,
         return 0;
     }
 
+    if (tbl->temp_table_type == TEMP_TABLE_TYPE_SKIPLIST) {
+        if (sl_insert(tbl, key, keylen, data, dtalen))
+            return -1;
+        if (tbl->sl_memsz > tbl->sl_maxsz) {
+            gbl_temptable_spills++;
+            rc = bdb_skiplist_copy_to_temp_db(bdb_state, tbl, bdberr);
+            if (unlikely(rc)) {
+                return -1;
+            }
+        }
+        return 0;
+    }
+
     assert (tbl->temp_table_type == TEMP_TABLE_TYPE_BTREE);
     tbl->num_mem_entries++;
 
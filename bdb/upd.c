@@ -261,6 +261,10 @@ static int bdb_prim_updvrfy_int(bdb_state_type *bdb_state, tran_type *tran,
             *bdberr = BDBERR_MISC;
         }
         rc = -1;
+    } else if (bdb_zonemap_widen(bdb_state, tran,
+                                 (newgenid && *newgenid) ? *newgenid : oldgenid,
+                                 newdta, newdtaln, bdberr)) {
+        rc = -1;
     }
 
     return rc;
@@ -0,0 +1,332 @@
+/*
+   Copyright 2026 Bloomberg Finance L.P.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+ */
+
+/*
+ * Zone maps.
+ *
+ * A zone is a run of consecutive records of a data stripe, and a zone map
+ * keeps, for each zone, the min and max ondisk value of the fixed size
+ * columns of a table.  Zones are stored in llmeta, keyed by table, stripe
+ * and the sequence part of the first genid they cover.  The master writes
+ * them in the background (see db/zonemap.c) and table scans skip the zones
+ * whose ranges cannot satisfy the WHERE clause.
+ *
+ * A record added, or updated in place, with a genid inside a zone widens
+ * the zone in the same transaction.  To keep appends, which land past the
+ * last zone, away from llmeta, every stripe has a frontier: the end of its
+ * last zone.  The summarizer raises the frontier after it has read, and
+ * page locked, the records of a new zone and before it commits it.  A
+ * writer past the frontier has nothing to widen.  A writer which wrote
+ * before the summarizer read its page is in the zone already, and one which
+ * wrote after waits for the summarizer to commit and then widens the zone.
+ */
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <arpa/inet.h>
+
+#include <build/db.h>
+#include <plhash_glue.h>
+#include <logmsg.h>
+#include <str0.h>
+#include "bdb_int.h"
+#include "genid.h"
+#include "flibc.h"
+
+enum { ZONE_FORMAT = 1 };
+
+/* packed zone:
+ *   u8 format, u8 pad, u16 ncols, u32 nrows, u64 version, u64 hi
+ *   then per column: u16 fld, u16 len, u32 off, min[len], max[len] */
+enum { ZONE_HDR_LEN = 24, ZONE_COL_HDR_LEN = 8 };
+
+struct zonemap_frontier {
+    char tablename[MAXTABLELEN + 1];
+    pthread_mutex_t lk;
+    /* end of the last zone of each stripe, valid while gen is the current
+     * replication generation */
+    uint32_t gen[MAXDTASTRIPE];
+    uint64_t seq[MAXDTASTRIPE];
+};
+
+static pthread_mutex_t frontiers_lk = PTHREAD_MUTEX_INITIALIZER;
+static hash_t *frontiers;
+
+uint64_t bdb_genid_seq(unsigned long long genid)
+{
+    return bdb_genid_to_host_order(genid) >> 16;
+}
+
+unsigned long long bdb_seq_to_genid(uint64_t seq, int stripe)
+{
+    return flibc_htonll((seq << 16) | (stripe & 0xf));
+}
+
+int bdb_zone_pack(const bdb_zone_t *zone, void **buf, int *len)
+{
+    int sz = ZONE_HDR_LEN;
+    for (int i = 0; i < zone->ncols; ++i)
+        sz += ZONE_COL_HDR_LEN + 2 * zone->cols[i].len;
+
+    uint8_t *p = malloc(sz);
+    if (p == NULL)
+        return -1;
+    *buf = p;
+    *len = sz;
+
+    uint16_t u16;
+    uint32_t u32;
+    uint64_t u64;
+
+    p[0] = ZONE_FORMAT;
+    p[1] = 0;
+    u16 = htons(zone->ncols);
+    memcpy(p + 2, &u16, 2);
+    u32 = htonl(zone->nrows);
+    memcpy(p + 4, &u32, 4);
+    u64 = flibc_htonll(zone->version);
+    memcpy(p + 8, &u64, 8);
+    u64 = flibc_htonll(zone->hi);
+    memcpy(p + 16, &u64, 8);
+    p += ZONE_HDR_LEN;
+
+    for (int i = 0; i < zone->ncols; ++i) {
+        const bdb_zone_col_t *c = &zone->cols[i];
+        u16 = htons(c->fld);
+        memcpy(p, &u16, 2);
+        u16 = htons(c->len);
+        memcpy(p + 2, &u16, 2);
+        u32 = htonl(c->off);
+        memcpy(p + 4, &u32, 4);
+        p += ZONE_COL_HDR_LEN;
+        memcpy(p, c->min, c->len);
+        memcpy(p + c->len, c->max, c->len);
+        p += 2 * c->len;
+    }
+    return 0;
+}
+
+/* The columns of the unpacked zone point into `buf'. */
+int bdb_zone_unpack(uint64_t lo, void *buf, int len, bdb_zone_t *zone)
+{
+    uint8_t *p = buf, *end = p + len;
+    uint16_t u16;
+    uint32_t u32;
+    uint64_t u64;
+
+    if (len < ZONE_HDR_LEN || p[0] != ZONE_FORMAT)
+        return -1;
+
+    memset(zone, 0, sizeof(*zone));
+    zone->lo = lo;
+    memcpy(&u16, p + 2, 2);
+    zone->ncols = ntohs(u16);
+    memcpy(&u32, p + 4, 4);
+    zone->nrows = ntohl(u32);
+    memcpy(&u64, p + 8, 8);
+    zone->version = flibc_ntohll(u64);
+    memcpy(&u64, p + 16, 8);
+    zone->hi = flibc_ntohll(u64);
+    p += ZONE_HDR_LEN;
+
+    if (zone->ncols == 0)
+        return 0;
+    zone->cols = malloc(zone->ncols * sizeof(bdb_zone_col_t));
+    if (zone->cols == NULL)
+        return -1;
+    for (int i = 0; i < zone->ncols; ++i) {
+        bdb_zone_col_t *c = &zone->cols[i];
+        if (end - p < ZONE_COL_HDR_LEN)
+            goto bad;
+        memcpy(&u16, p, 2);
+        c->fld = ntohs(u16);
+        memcpy(&u16, p + 2, 2);
+        c->len = ntohs(u16);
+        memcpy(&u32, p + 4, 4);
+        c->off = ntohl(u32);
+        p += ZONE_COL_HDR_LEN;
+        if (end - p < 2 * c->len)
+            goto bad;
+        c->min = p;
+        c->max = p + c->len;
+        p += 2 * c->len;
+    }
+    return 0;
+
+bad:
+    free(zone->cols);
+    zone->cols = NULL;
+    return -1;
+}
+
+void bdb_zone_free(bdb_zone_t *zone)
+{
+    free(zone->cols);
+    zone->cols = NULL;
+}
+
+static struct zonemap_frontier *get_frontier(bdb_state_type *bdb_state,
+                                             const char *tablename)
+{
+    struct zonemap_frontier *f;
+
+    if (bdb_state && bdb_state->zonemap)
+        return bdb_state->zonemap;
+
+    Pthread_mutex_lock(&frontiers_lk);
+    if (frontiers == NULL)
+        frontiers = hash_init_str(offsetof(struct zonemap_frontier, tablename));
+    f = hash_find(frontiers, tablename);
+    if (f == NULL && (f = calloc(1, sizeof(*f))) != NULL) {
+        strncpy0(f->tablename, tablename, sizeof(f->tablename));
+        Pthread_mutex_init(&f->lk, NULL);
+        hash_add(frontiers, f);
+    }
+    Pthread_mutex_unlock(&frontiers_lk);
+
+    if (bdb_state)
+        bdb_state->zonemap = f;
+    return f;
+}
+
+/* Returns the frontier of `stripe', reading it from llmeta in `tran' if it
+ * was not read in this replication generation.  Zones being summarized are
+ * not in llmeta yet, so the frontier never goes below what the summarizer
+ * raised it to. */
+static int frontier_get(bdb_state_type *bdb_state, tran_type *tran,
+                        int stripe, uint64_t *seq, int *bdberr)
+{
+    bdb_state_type *parent = bdb_state->parent ? bdb_state->parent : bdb_state;
+    struct zonemap_frontier *f = get_frontier(bdb_state, bdb_state->name);
+    uint32_t gen = bdb_get_rep_gen(parent);
+    int fresh;
+
+    if (f == NULL) {
+        *bdberr = BDBERR_MALLOC;
+        return -1;
+    }
+
+    Pthread_mutex_lock(&f->lk);
+    fresh = (f->gen[stripe] == gen);
+    *seq = f->seq[stripe];
+    Pthread_mutex_unlock(&f->lk);
+    if (fresh)
+        return 0;
+
+    uint64_t lo, hi = 0;
+    void *buf = NULL;
+    int len = 0;
+    int rc = bdb_zonemap_find(tran, bdb_state->name, stripe, UINT64_MAX >> 16,
+                              &lo, &buf, &len, bdberr);
+    if (rc < 0)
+        return -1;
+    if (rc == 0) {
+        bdb_zone_t zone;
+        if (bdb_zone_unpack(lo, buf, len, &zone) == 0) {
+            hi = zone.hi;
+            bdb_zone_free(&zone);
+        } else {
+            hi = UINT64_MAX >> 16;
+        }
+        free(buf);
+    }
+
+    Pthread_mutex_lock(&f->lk);
+    f->gen[stripe] = gen;
+    if (f->seq[stripe] < hi)
+        f->seq[stripe] = hi;
+    *seq = f->seq[stripe];
+    Pthread_mutex_unlock(&f->lk);
+    return 0;
+}
+
+void bdb_zonemap_raise_frontier(bdb_state_type *bdb_state, int stripe,
+                                uint64_t hi)
+{
+    struct zonemap_frontier *f = get_frontier(bdb_state, bdb_state->name);
+
+    if (f == NULL)
+        return;
+    Pthread_mutex_lock(&f->lk);
+    if (f->seq[stripe] < hi)
+        f->seq[stripe] = hi;
+    Pthread_mutex_unlock(&f->lk);
+}
+
+int bdb_zonemap_widen(bdb_state_type *bdb_state, tran_type *tran,
+                      unsigned long long genid, const void *dta, int dtalen,
+                      int *bdberr)
+{
+    int stripe = get_dtafile_from_genid(genid);
+    uint64_t seq = bdb_genid_seq(genid);
+    uint64_t frontier, lo;
+    bdb_zone_t zone;
+    void *buf = NULL;
+    int len = 0;
+    int rc, widened = 0;
+
+    *bdberr = BDBERR_NOERROR;
+    if (gbl_rowlocks || tran == NULL || tran->tranclass == TRANCLASS_LOGICAL ||
+        bdb_state->parent == NULL)
+        return 0;
+
+    if (frontier_get(bdb_state, tran, stripe, &frontier, bdberr))
+        return -1;
+    if (seq > frontier)
+        return 0;
+
+    rc = bdb_zonemap_find(tran, bdb_state->name, stripe, seq, &lo, &buf, &len,
+                          bdberr);
+    if (rc)
+        return rc < 0 ? -1 : 0;
+    if (bdb_zone_unpack(lo, buf, len, &zone)) {
+        free(buf);
+        return 0;
+    }
+    if (seq > zone.hi)
+        goto done;
+
+    for (int i = 0; i < zone.ncols; ++i) {
+        bdb_zone_col_t *c = &zone.cols[i];
+        const uint8_t *v = (const uint8_t *)dta + c->off;
+        /* zones of an older schema are ignored and rebuilt */
+        if (c->off + c->len > dtalen)
+            continue;
+        if (memcmp(v, c->min, c->len) < 0) {
+            memcpy(c->min, v, c->len);
+            widened = 1;
+        }
+        if (memcmp(v, c->max, c->len) > 0) {
+            memcpy(c->max, v, c->len);
+            widened = 1;
+        }
+    }
+    if (widened) {
+        /* the columns point into buf, which is updated in place */
+        rc = bdb_zonemap_put(tran, bdb_state->name, stripe, lo, buf, len,
+                             bdberr);
+        if (rc && *bdberr != BDBERR_DEADLOCK)
+            logmsg(LOGMSG_ERROR, "%s: %s stripe %d zone %" PRIu64
+                   " rc %d bdberr %d\n", __func__, bdb_state->name, stripe, lo,
+                   rc, *bdberr);
+    }
+
+done:
+    bdb_zone_free(&zone);
+    free(buf);
+    return rc ? -1 : 0;
+}
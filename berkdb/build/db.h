@@ -176,6 +176,9 @@ struct __mempv_cache; typedef struct __mempv_cache MEMPV_CACHE;
 struct __mempv_cache_page_header; typedef struct __mempv_cache_page_header MEMPV_CACHE_PAGE_HEADER;
 struct __mempv_cache_page_key; typedef struct __mempv_cache_page_key MEMPV_CACHE_PAGE_KEY;
 struct __mempv_cache_page_versions; typedef struct __mempv_cache_page_versions MEMPV_CACHE_PAGE_VERSIONS;
+struct __mempv_delta_cache; typedef struct __mempv_delta_cache MEMPV_DELTA_CACHE;
+struct __mempv_delta; typedef struct __mempv_delta MEMPV_DELTA;
+struct __mempv_delta_key; typedef struct __mempv_delta_key MEMPV_DELTA_KEY;
 
 struct txn_properties;
 
@@ -2936,8 +2939,37 @@ struct __mempv_cache
 	LISTC_T(struct __mempv_cache_page_header) evict_list;
 };
 
+/*
+ * A page delta is the log record that moved a page to LSN `lsn'.  Undoing it
+ * yields the previous version of the page, whose LSN keys the next delta of
+ * the chain.
+ */
+struct __mempv_delta_key
+{
+	u_int8_t ufid[DB_FILE_ID_LEN];
+	db_pgno_t pgno;
+	DB_LSN lsn;
+};
+
+struct __mempv_delta
+{
+	struct __mempv_delta_key key;
+	u_int32_t size;
+	LINKC_T(struct __mempv_delta) lru_link;
+	u_int8_t data[1];
+};
+
+struct __mempv_delta_cache
+{
+	hash_t *deltas;
+	size_t bytes;
+	pthread_mutex_t lock;
+	LISTC_T(struct __mempv_delta) lru;
+};
+
 struct __mempv {
 	struct __mempv_cache cache;
+	struct __mempv_delta_cache deltas;
 };
 
 struct __mempv_cache_page_versions
@@ -3135,6 +3167,12 @@ void bb_berkdb_fingerprint_rtstats_bump_pagein(int did_io);
 int bb_berkdb_fingerprint_rtstats_get(const unsigned char *fingerprint, size_t fplen,
     uint64_t *n_pagein_read, uint64_t *n_pagein_read_io);
 
+int bb_berkdb_changed_pages_snapshot(DB_ENV *dbenv, int *valid, char *chain,
+    size_t chainlen);
+int bb_berkdb_changed_pages_ack(DB_ENV *dbenv, const char *chain);
+
+u_int64_t bb_berkdb_mpf_chg_gen(DB *dbp);
+
 extern int gbl_bb_berkdb_enable_thread_stats;
 extern int gbl_bb_berkdb_enable_lock_timing;
 extern int gbl_bb_berkdb_enable_memp_timing;
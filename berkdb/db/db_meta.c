@@ -482,10 +482,15 @@ __db_new(dbc, type, pagepp)
 		 * (1) want sequential IO, and (2) we want it in a contiguous region on disk.
 		 * fallocate() is an even stronger hint, but we'd need a linux kernel from this millennium
 		 * for that. */
+		/* Marked before and after the write, as the bufferpool does */
+		__memp_chgtrack_mark(dbc->dbp->dbenv, __memp_fn(mpf), firstpage,
+		    page_extent_size);
 		ret =
 		    pwrite(mpf->fhp->fd, pagebuf,
 		    meta->pagesize * page_extent_size,
 		    firstpage * meta->pagesize);
+		__memp_chgtrack_mark(dbc->dbp->dbenv, __memp_fn(mpf), firstpage,
+		    page_extent_size);
 		if (ret != meta->pagesize * page_extent_size)
 			goto err;
 
@@ -260,6 +260,13 @@ struct __mpoolfile {
 	 */
 	DB_MPOOL_FSTAT stat;		/* Per-file mpool statistics. */
 
+	/*
+	 * Bumped atomically each time a page of the file is put or set dirty.
+	 * A new MPOOLFILE starts above anything an earlier one could have
+	 * reached, so the value never goes back for a file name.
+	 */
+	u_int64_t chg_gen;
+
 	/*
 	 * The remaining fields are initialized at open and never subsequently
 	 * modified.
@@ -358,9 +358,11 @@ __dbenv_open(dbenv, db_home, flags, mode)
 	if (rep_check)
 		__env_rep_enter(dbenv);
 
-	if (LF_ISSET(DB_INIT_MPOOL))
+	if (LF_ISSET(DB_INIT_MPOOL)) {
 		if ((ret = __memp_open(dbenv)) != 0)
 			goto err;
+		__memp_chgtrack_open(dbenv);
+	}
 	/*
 	 * Initialize the ciphering area prior to any running of recovery so
 	 * that we can initialize the keys, etc. before recovery.
@@ -1079,6 +1081,9 @@ __dbenv_refresh(dbenv, orig_flags, rep_check)
 			    (t_ret = __memp_sync(dbenv, NULL)) != 0 && ret == 0)
 				ret = t_ret;
 
+			/* Every page is written: save the changed pages */
+			__memp_chgtrack_close(dbenv);
+
 			if ((t_ret = __memp_dbenv_refresh(dbenv)) != 0 &&
 			    ret == 0)
 				ret = t_ret;
@@ -23,6 +23,7 @@ static const char revid[] = "$Id: log.c,v 11.133 2003/09/13 19:20:37 bostic Exp
 #include "dbinc/crypto.h"
 #include "dbinc/hmac.h"
 #include "dbinc/log.h"
+#include "dbinc/mp.h"
 #include "dbinc/db_swap.h"
 #include "dbinc/txn.h"
 #include <logmsg.h>
@@ -1223,6 +1224,10 @@ __log_vtruncate(dbenv, lsn, ckplsn, trunclsn)
 	if ((ret = __log_zero(dbenv, &lp->lsn, &end_lsn)) != 0)
 		goto err;
 
+	/* Page deltas past the truncation point are no longer valid. */
+	if (dbenv->mempv != NULL)
+		__mempv_delta_truncate(dbenv, &dbenv->mempv->deltas, lsn);
+
 err:	R_UNLOCK(dbenv, &dblp->reginfo);
 	Pthread_rwlock_unlock(&dbenv->loglk);
 	return (ret);
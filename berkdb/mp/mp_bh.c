@@ -973,6 +973,13 @@ __memp_pgwrite_multi(dbenv, dbmfp, hps, bhps, numpages, wrrec)
 		bparray[i] = bhp->buf;
 	}
 
+	/*
+	 * Mark the pages for changed page tracking both before and after the
+	 * write, so a snapshot taken while it is in flight has them in either
+	 * the snapshot or the one after it.
+	 */
+	__memp_chgtrack_mark(dbenv, __memp_fn(dbmfp), bhps[0]->pgno, numpages);
+
 	/* Write the page. */
 	if ((ret = __os_iov(dbenv, DB_IO_WRITE, dbmfp->fhp,
 		    bhps[0]->pgno, mfp->stat.st_pagesize,
@@ -989,6 +996,7 @@ __memp_pgwrite_multi(dbenv, dbmfp, hps, bhps, numpages, wrrec)
 
 	mfp->file_written = 1;
 	mfp->stat.st_page_out += numpages;
+	__memp_chgtrack_mark(dbenv, __memp_fn(dbmfp), bhps[0]->pgno, numpages);
 	mfp->stat.st_rw_merges += numpages - 1;
 
 err:
@@ -0,0 +1,573 @@
+/*-
+ * See the file LICENSE for redistribution information.
+ *
+ * Copyright (c) 2026
+ *	Bloomberg Finance L.P.  All rights reserved.
+ */
+#include "db_config.h"
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <arpa/inet.h>
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "db_int.h"
+
+#include "logmsg.h"
+#include "sys_wrap.h"
+
+/*
+ * Changed page tracking.
+ *
+ * With changed_page_tracking on, every page the bufferpool writes to a file
+ * is marked in a bitmap kept for that file.  An incremental backup (comdb2ar
+ * c -I inc) asks for a snapshot over its logdelete socket: the pages marked
+ * since the last snapshot are moved into the snapshot, which is written out
+ * to CHGTRACK_DIR in the environment home, one bitmap per file, and the
+ * backup only looks at the pages in it.  Once the backup is complete it
+ * acknowledges the snapshot, which clears it.  A backup which fails leaves
+ * its snapshot to be merged into the next one.
+ *
+ * The bitmaps only hold the pages written since the last acknowledgement,
+ * whichever chain of increments it came from, so an acknowledgement names
+ * its chain (the fingerprint of the increment it completed) and a snapshot
+ * reports it.  comdb2ar only uses a snapshot for an increment to that chain.
+ *
+ * Pages are marked both before and after they are written: a snapshot taken
+ * during a write has them in it or in the next one.
+ *
+ * The bitmaps survive a clean close, which writes them out along with the
+ * CHGTRACK_CLEAN marker.  After a crash, or if tracking was off for a while,
+ * snapshots are invalid until one has been acknowledged, and comdb2ar goes
+ * back to looking at every page.
+ */
+
+#define CHGTRACK_DIR "changed_pages"
+#define CHGTRACK_CLEAN "CLEAN"
+#define CHGTRACK_CHAIN "CHAIN"
+#define CHGTRACK_CHAIN_LEN 64
+#define CHGTRACK_HDR_LEN 16
+
+static const char chgtrack_magic[8] = {'c', 'd', 'b', '2', 'c', 'h', 'p', 'g'};
+
+int gbl_changed_page_tracking = 0;
+
+struct chgtrack_file {
+	char *name;		/* hash key: file name in the environment home */
+	u_int8_t *since;	/* pages written since the last snapshot */
+	size_t since_len;
+	u_int8_t *snap;		/* pages in the snapshot */
+	size_t snap_len;
+};
+
+static pthread_mutex_t chgtrack_lk = PTHREAD_MUTEX_INITIALIZER;
+/* Held by snapshots and acknowledgements, which own the snap bitmaps */
+static pthread_mutex_t chgtrack_snap_lk = PTHREAD_MUTEX_INITIALIZER;
+static DB_ENV *chgtrack_env;
+static hash_t *chgtrack_files;
+/* The bitmaps hold every page written since the last acknowledged snapshot */
+static int chgtrack_valid;
+/* Every page written since the last snapshot was marked */
+static int chgtrack_intact;
+static int chgtrack_snapped;
+/* The chain of increments the last acknowledgement came from */
+static char chgtrack_chain[CHGTRACK_CHAIN_LEN + 1];
+
+static const char *
+chgtrack_name(const char *fname)
+{
+	const char *p;
+
+	if ((p = strrchr(fname, '/')) != NULL)
+		fname = p + 1;
+	if (strncmp(fname, "XXX.", 4) == 0)
+		fname += 4;
+	return (fname);
+}
+
+static struct chgtrack_file *
+chgtrack_get(const char *name)
+{
+	struct chgtrack_file *f;
+
+	if ((f = hash_find(chgtrack_files, &name)) != NULL)
+		return (f);
+	if ((f = calloc(1, sizeof(*f))) == NULL)
+		return (NULL);
+	if ((f->name = strdup(name)) == NULL) {
+		free(f);
+		return (NULL);
+	}
+	hash_add(chgtrack_files, f);
+	return (f);
+}
+
+static int
+chgtrack_grow(u_int8_t **map, size_t *len, size_t need)
+{
+	u_int8_t *m;
+	size_t n;
+
+	if (need <= *len)
+		return (0);
+	for (n = *len ? *len : 1024; n < need; n *= 2)
+		;
+	if ((m = realloc(*map, n)) == NULL)
+		return (ENOMEM);
+	memset(m + *len, 0, n - *len);
+	*map = m;
+	*len = n;
+	return (0);
+}
+
+static void
+chgtrack_invalidate(void)
+{
+	chgtrack_valid = 0;
+	chgtrack_intact = 0;
+}
+
+/*
+ * __memp_chgtrack_mark --
+ *	Mark npages pages from pgno as written to fname.
+ *
+ * PUBLIC: void __memp_chgtrack_mark __P((DB_ENV *, const char *, db_pgno_t, int));
+ */
+void
+__memp_chgtrack_mark(dbenv, fname, pgno, npages)
+	DB_ENV *dbenv;
+	const char *fname;
+	db_pgno_t pgno;
+	int npages;
+{
+	struct chgtrack_file *f;
+	db_pgno_t last;
+
+	if (dbenv != chgtrack_env || fname == NULL ||
+	    (!gbl_changed_page_tracking && !chgtrack_intact))
+		return;
+
+	Pthread_mutex_lock(&chgtrack_lk);
+	if (!gbl_changed_page_tracking) {
+		chgtrack_invalidate();
+	} else if ((f = chgtrack_get(chgtrack_name(fname))) == NULL ||
+	    chgtrack_grow(&f->since, &f->since_len,
+		(pgno + npages - 1) / 8 + 1) != 0) {
+		logmsg(LOGMSG_ERROR, "%s: out of memory tracking %s\n",
+		    __func__, fname);
+		chgtrack_invalidate();
+	} else {
+		for (last = pgno + npages; pgno < last; pgno++)
+			f->since[pgno / 8] |= 1 << (pgno % 8);
+	}
+	Pthread_mutex_unlock(&chgtrack_lk);
+}
+
+static int
+chgtrack_merge(void *obj, void *arg)
+{
+	struct chgtrack_file *f = obj;
+	size_t i;
+
+	if (chgtrack_grow(&f->snap, &f->snap_len, f->since_len) != 0) {
+		chgtrack_invalidate();
+		return (0);
+	}
+	for (i = 0; i < f->since_len; i++)
+		f->snap[i] |= f->since[i];
+	memset(f->since, 0, f->since_len);
+	return (0);
+}
+
+static int
+chgtrack_clear_snap(void *obj, void *arg)
+{
+	struct chgtrack_file *f = obj;
+
+	if (f->snap)
+		memset(f->snap, 0, f->snap_len);
+	return (0);
+}
+
+static int
+chgtrack_collect(void *obj, void *arg)
+{
+	struct chgtrack_file ***next = arg;
+
+	*(*next)++ = obj;
+	return (0);
+}
+
+static int
+chgtrack_free(void *obj, void *arg)
+{
+	struct chgtrack_file *f = obj;
+
+	free(f->name);
+	free(f->since);
+	free(f->snap);
+	free(f);
+	return (0);
+}
+
+static void
+chgtrack_path(dbenv, name, path, len)
+	DB_ENV *dbenv;
+	const char *name;
+	char *path;
+	size_t len;
+{
+	snprintf(path, len, "%s/%s%s%s", dbenv->db_home ? dbenv->db_home : ".",
+	    CHGTRACK_DIR, name ? "/" : "", name ? name : "");
+}
+
+static int
+chgtrack_fsync_dir(dbenv)
+	DB_ENV *dbenv;
+{
+	char path[PATH_MAX];
+	int fd, ret;
+
+	chgtrack_path(dbenv, NULL, path, sizeof(path));
+	if ((fd = open(path, O_RDONLY)) == -1)
+		return (errno);
+	ret = fsync(fd) == -1 ? errno : 0;
+	close(fd);
+	return (ret);
+}
+
+/* Removes everything in CHGTRACK_DIR, creating it if need be */
+static int
+chgtrack_clear_dir(dbenv)
+	DB_ENV *dbenv;
+{
+	char path[PATH_MAX];
+	struct dirent *ent;
+	DIR *d;
+	int ret = 0;
+
+	chgtrack_path(dbenv, NULL, path, sizeof(path));
+	if (mkdir(path, 0755) == -1 && errno != EEXIST)
+		return (errno);
+	if ((d = opendir(path)) == NULL)
+		return (errno);
+	while ((ent = readdir(d)) != NULL) {
+		if (ent->d_name[0] == '.')
+			continue;
+		chgtrack_path(dbenv, ent->d_name, path, sizeof(path));
+		if (unlink(path) == -1 && errno != ENOENT) {
+			ret = errno;
+			break;
+		}
+	}
+	closedir(d);
+	return (ret);
+}
+
+static int
+chgtrack_write_file(dbenv, name, map, len, sync)
+	DB_ENV *dbenv;
+	const char *name;
+	const u_int8_t *map;
+	size_t len;
+	int sync;
+{
+	u_int8_t hdr[CHGTRACK_HDR_LEN];
+	char path[PATH_MAX];
+	u_int32_t u32;
+	int fd, ret = 0;
+
+	memcpy(hdr, chgtrack_magic, sizeof(chgtrack_magic));
+	u32 = htonl(1);
+	memcpy(hdr + 8, &u32, 4);
+	u32 = htonl((u_int32_t)len);
+	memcpy(hdr + 12, &u32, 4);
+
+	chgtrack_path(dbenv, name, path, sizeof(path));
+	if ((fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644)) == -1)
+		return (errno);
+	if (write(fd, hdr, sizeof(hdr)) != sizeof(hdr) ||
+	    (len && write(fd, map, len) != (ssize_t)len) ||
+	    (sync && fsync(fd) == -1))
+		ret = errno ? errno : EIO;
+	close(fd);
+	return (ret);
+}
+
+static int
+chgtrack_empty(const u_int8_t *map, size_t len)
+{
+	size_t i;
+
+	for (i = 0; i < len; i++)
+		if (map[i])
+			return (0);
+	return (1);
+}
+
+/*
+ * Writes the snap bitmaps which aren't empty to CHGTRACK_DIR.  The caller
+ * holds chgtrack_snap_lk.
+ */
+static int
+chgtrack_write_snap(dbenv, files, nfiles, sync)
+	DB_ENV *dbenv;
+	struct chgtrack_file **files;
+	int nfiles, sync;
+{
+	int i, ret;
+
+	if ((ret = chgtrack_clear_dir(dbenv)) != 0)
+		return (ret);
+	for (i = 0; i < nfiles; i++) {
+		if (chgtrack_empty(files[i]->snap, files[i]->snap_len))
+			continue;
+		if ((ret = chgtrack_write_file(dbenv, files[i]->name,
+		    files[i]->snap, files[i]->snap_len, sync)) != 0)
+			return (ret);
+	}
+	return (0);
+}
+
+/* Collects the tracked files.  The caller holds chgtrack_lk. */
+static struct chgtrack_file **
+chgtrack_list(int *nfiles)
+{
+	struct chgtrack_file **files, **next;
+
+	*nfiles = hash_get_num_entries(chgtrack_files);
+	if ((files = malloc((*nfiles + 1) * sizeof(*files))) == NULL)
+		return (NULL);
+	next = files;
+	hash_for(chgtrack_files, chgtrack_collect, &next);
+	return (files);
+}
+
+static int
+chgtrack_load_file(dbenv, name)
+	DB_ENV *dbenv;
+	const char *name;
+{
+	u_int8_t hdr[CHGTRACK_HDR_LEN];
+	struct chgtrack_file *f;
+	char path[PATH_MAX];
+	u_int32_t u32;
+	size_t len;
+	int fd, ret = 0;
+
+	chgtrack_path(dbenv, name, path, sizeof(path));
+	if ((fd = open(path, O_RDONLY)) == -1)
+		return (errno);
+	if (read(fd, hdr, sizeof(hdr)) != sizeof(hdr) ||
+	    memcmp(hdr, chgtrack_magic, sizeof(chgtrack_magic)) != 0) {
+		ret = EINVAL;
+		goto done;
+	}
+	memcpy(&u32, hdr + 12, 4);
+	len = ntohl(u32);
+	if (strcmp(name, CHGTRACK_CHAIN) == 0) {
+		if (len > CHGTRACK_CHAIN_LEN ||
+		    read(fd, chgtrack_chain, len) != (ssize_t)len)
+			ret = EINVAL;
+		chgtrack_chain[ret ? 0 : len] = '\0';
+		goto done;
+	}
+	if ((f = chgtrack_get(name)) == NULL ||
+	    chgtrack_grow(&f->since, &f->since_len, len) != 0) {
+		ret = ENOMEM;
+		goto done;
+	}
+	if (read(fd, f->since, len) != (ssize_t)len)
+		ret = EINVAL;
+done:
+	close(fd);
+	return (ret);
+}
+
+/* Loads the bitmaps written by the last close, if it was clean */
+static int
+chgtrack_load(dbenv)
+	DB_ENV *dbenv;
+{
+	char path[PATH_MAX];
+	struct dirent *ent;
+	struct stat st;
+	DIR *d;
+	int ret = 0;
+
+	chgtrack_path(dbenv, CHGTRACK_CLEAN, path, sizeof(path));
+	if (stat(path, &st) == -1)
+		return (ENOENT);
+	/* A crash from here on loses the pages we mark */
+	if (unlink(path) == -1 || (ret = chgtrack_fsync_dir(dbenv)) != 0)
+		return (ret ? ret : errno);
+
+	chgtrack_path(dbenv, NULL, path, sizeof(path));
+	if ((d = opendir(path)) == NULL)
+		return (errno);
+	while ((ent = readdir(d)) != NULL && ret == 0) {
+		if (ent->d_name[0] == '.')
+			continue;
+		ret = chgtrack_load_file(dbenv, ent->d_name);
+	}
+	closedir(d);
+	return (ret);
+}
+
+/*
+ * __memp_chgtrack_open --
+ *	Start tracking the pages written to the files of dbenv.  Only one
+ *	environment per process is tracked.
+ *
+ * PUBLIC: void __memp_chgtrack_open __P((DB_ENV *));
+ */
+void
+__memp_chgtrack_open(dbenv)
+	DB_ENV *dbenv;
+{
+	int ret;
+
+	Pthread_mutex_lock(&chgtrack_lk);
+	if (chgtrack_env != NULL) {
+		Pthread_mutex_unlock(&chgtrack_lk);
+		return;
+	}
+	chgtrack_env = dbenv;
+	chgtrack_files = hash_init_strptr(offsetof(struct chgtrack_file, name));
+	chgtrack_valid = 0;
+	chgtrack_intact = 0;
+	chgtrack_snapped = 0;
+	chgtrack_chain[0] = '\0';
+	if (gbl_changed_page_tracking) {
+		chgtrack_intact = 1;
+		if ((ret = chgtrack_load(dbenv)) == 0)
+			chgtrack_valid = 1;
+		else
+			logmsg(LOGMSG_INFO, "changed page tracking starts over, "
+			    "rc %d\n", ret);
+	}
+	Pthread_mutex_unlock(&chgtrack_lk);
+}
+
+/*
+ * __memp_chgtrack_close --
+ *	Stop tracking dbenv, writing the bitmaps out if they are valid.  This
+ *	is called once every page has been written.
+ *
+ * PUBLIC: void __memp_chgtrack_close __P((DB_ENV *));
+ */
+void
+__memp_chgtrack_close(dbenv)
+	DB_ENV *dbenv;
+{
+	struct chgtrack_file **files;
+	int nfiles, ret;
+
+	Pthread_mutex_lock(&chgtrack_snap_lk);
+	Pthread_mutex_lock(&chgtrack_lk);
+	if (dbenv != chgtrack_env) {
+		Pthread_mutex_unlock(&chgtrack_lk);
+		Pthread_mutex_unlock(&chgtrack_snap_lk);
+		return;
+	}
+
+	if (gbl_changed_page_tracking && chgtrack_valid && chgtrack_intact) {
+		hash_for(chgtrack_files, chgtrack_merge, NULL);
+		if (chgtrack_valid && (files = chgtrack_list(&nfiles)) != NULL) {
+			ret = chgtrack_write_snap(dbenv, files, nfiles, 1);
+			if (ret == 0)
+				ret = chgtrack_write_file(dbenv, CHGTRACK_CHAIN,
+				    (u_int8_t *)chgtrack_chain,
+				    strlen(chgtrack_chain), 1);
+			if (ret == 0)
+				ret = chgtrack_write_file(dbenv, CHGTRACK_CLEAN,
+				    NULL, 0, 1);
+			if (ret == 0)
+				ret = chgtrack_fsync_dir(dbenv);
+			if (ret)
+				logmsg(LOGMSG_ERROR, "%s: error writing changed "
+				    "pages rc %d\n", __func__, ret);
+			free(files);
+		}
+	}
+
+	hash_for(chgtrack_files, chgtrack_free, NULL);
+	hash_free(chgtrack_files);
+	chgtrack_files = NULL;
+	chgtrack_env = NULL;
+	chgtrack_valid = 0;
+	chgtrack_intact = 0;
+	Pthread_mutex_unlock(&chgtrack_lk);
+	Pthread_mutex_unlock(&chgtrack_snap_lk);
+}
+
+/*
+ * Moves the pages written since the last snapshot into the snapshot, and
+ * writes it out.  Sets *valid if the snapshot holds every page written since
+ * the last acknowledged one, and copies the chain that acknowledged it to
+ * chain.
+ */
+int
+bb_berkdb_changed_pages_snapshot(DB_ENV *dbenv, int *valid, char *chain,
+    size_t chainlen)
+{
+	struct chgtrack_file **files;
+	int nfiles, ret;
+
+	Pthread_mutex_lock(&chgtrack_snap_lk);
+	Pthread_mutex_lock(&chgtrack_lk);
+	if (dbenv != chgtrack_env) {
+		Pthread_mutex_unlock(&chgtrack_lk);
+		Pthread_mutex_unlock(&chgtrack_snap_lk);
+		return (EINVAL);
+	}
+	hash_for(chgtrack_files, chgtrack_merge, NULL);
+	*valid = chgtrack_valid;
+	snprintf(chain, chainlen, "%s", chgtrack_chain);
+	chgtrack_intact = gbl_changed_page_tracking;
+	chgtrack_snapped = 1;
+	files = chgtrack_list(&nfiles);
+	Pthread_mutex_unlock(&chgtrack_lk);
+
+	/* Pages written from here on are marked in the since bitmaps */
+	ret = files ? chgtrack_write_snap(dbenv, files, nfiles, 0) : ENOMEM;
+	free(files);
+	Pthread_mutex_unlock(&chgtrack_snap_lk);
+	return (ret);
+}
+
+/*
+ * Clears the snapshot, once every page in it has been backed up by an
+ * increment to chain.
+ */
+int
+bb_berkdb_changed_pages_ack(DB_ENV *dbenv, const char *chain)
+{
+	int ret;
+
+	Pthread_mutex_lock(&chgtrack_snap_lk);
+	Pthread_mutex_lock(&chgtrack_lk);
+	if (dbenv != chgtrack_env || !chgtrack_snapped) {
+		Pthread_mutex_unlock(&chgtrack_lk);
+		Pthread_mutex_unlock(&chgtrack_snap_lk);
+		return (EINVAL);
+	}
+	hash_for(chgtrack_files, chgtrack_clear_snap, NULL);
+	chgtrack_valid = chgtrack_intact;
+	chgtrack_snapped = 0;
+	snprintf(chgtrack_chain, sizeof(chgtrack_chain), "%s",
+	    chain ? chain : "");
+	Pthread_mutex_unlock(&chgtrack_lk);
+
+	ret = chgtrack_clear_dir(dbenv);
+	Pthread_mutex_unlock(&chgtrack_snap_lk);
+	return (ret);
+}
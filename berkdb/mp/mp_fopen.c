@@ -25,6 +25,7 @@ static const char revid[] = "$Id: mp_fopen.c,v 11.120 2003/11/07 18:45:15 ubell
 #include "dbinc/mp.h"
 #include "sys_wrap.h"
 #include "assert.h"
+#include "comdb2_atomic.h"
 
 #ifdef HAVE_RPC
 #include "dbinc_auto/db_server.h"
@@ -43,6 +44,9 @@ static int __memp_get_pgcookie __P((DB_MPOOLFILE *, DBT *));
 static int __memp_get_priority __P((DB_MPOOLFILE *, DB_CACHE_PRIORITY *));
 static int __memp_set_priority __P((DB_MPOOLFILE *, DB_CACHE_PRIORITY));
 
+/* Counts MPOOLFILEs allocated; see the chg_gen field of MPOOLFILE. */
+static u_int64_t memp_chg_gen_base;
+
 /*
  * __memp_fcreate_pp --
  *	DB_ENV->memp_fcreate pre/post processing.
@@ -897,6 +901,7 @@ alloc:	/* Allocate and initialize a new MPOOLFILE. */
 	    dbmp, dbmp->reginfo, NULL, sizeof(MPOOLFILE), NULL, &mfp)) != 0)
 		goto err;
 	memset(mfp, 0, sizeof(MPOOLFILE));
+	mfp->chg_gen = ATOMIC_ADD64(memp_chg_gen_base, 1) << 40;
 	mfp->mpf_cnt = 1;
 	mfp->ftype = dbmfp->ftype;
 	mfp->stat.st_pagesize = pagesize;
@@ -1540,3 +1545,17 @@ __memp_fns(dbmp, mfp)
 
 	return ((char *)R_ADDR(dbmp->reginfo, mfp->path_off));
 }
+
+/*
+ * bb_berkdb_mpf_chg_gen --
+ *	Return the change generation of the file underneath dbp: it goes up
+ *	whenever a page of the file is dirtied.
+ */
+u_int64_t
+bb_berkdb_mpf_chg_gen(dbp)
+	DB *dbp;
+{
+	if (dbp == NULL || dbp->mpf == NULL || dbp->mpf->mfp == NULL)
+		return (0);
+	return (ATOMIC_LOAD64(dbp->mpf->mfp->chg_gen));
+}
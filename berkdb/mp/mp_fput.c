@@ -162,6 +162,8 @@ __memp_fput_internal(dbmfp, pgaddr, flags, pgorder)
 		ATOMIC_ADD32(c_mp->stat.st_page_dirty, -1);
 		F_CLR(bhp, BH_DIRTY);
 	}
+	if (LF_ISSET(DB_MPOOL_DIRTY))
+		ATOMIC_ADD64(dbmfp->mfp->chg_gen, 1);
 	if (LF_ISSET(DB_MPOOL_DIRTY) && !F_ISSET(bhp, BH_DIRTY)) {
 		ATOMIC_ADD32(hp->hash_page_dirty, 1);
 		ATOMIC_ADD32(c_mp->stat.st_page_dirty, 1);
@@ -61,6 +61,7 @@ int __mempv_cache_init(dbenv, cache)
 		ret = ENOMEM;
 		goto done;
 	}
+	hash_set_open_addressing(cache->pages);
 
 	listc_init(&cache->evict_list, offsetof(MEMPV_CACHE_PAGE_HEADER, evict_link)); 
 
@@ -0,0 +1,209 @@
+#include "db_config.h"
+#include "db_int.h"
+#include "dbinc/mp.h"
+#include "dbinc/log.h"
+
+#include "logmsg.h"
+
+/*
+ * Page delta store of the versioned memory pool.
+ *
+ * Rolling a page back to a snapshot undoes, newest first, the log records
+ * that modified it.  Readers of a hot page need the same records over and
+ * over, so the records are kept in memory, keyed by file, page and the LSN
+ * the record moved the page to.  Starting from the current page, the chain
+ * is followed by looking up the LSN of the rolled back image.  Records are
+ * evicted in LRU order past `mempv_delta_cache_size' bytes; a missing record
+ * is read from the log again.
+ */
+
+static void __mempv_delta_evict(dbenv, dc, delta)
+	DB_ENV *dbenv;
+	MEMPV_DELTA_CACHE *dc;
+	MEMPV_DELTA *delta;
+{
+	hash_del(dc->deltas, delta);
+	listc_rfl(&dc->lru, delta);
+	dc->bytes -= delta->size;
+	__os_free(dbenv, delta);
+}
+
+/*
+ * __mempv_delta_init --
+ * Initializes the page delta store.
+ *
+ * Returns 0 on success and non-0 on failure.
+ *
+ * PUBLIC: int __mempv_delta_init
+ * PUBLIC:	__P((DB_ENV *, MEMPV_DELTA_CACHE *));
+ */
+int __mempv_delta_init(dbenv, dc)
+	DB_ENV *dbenv;
+	MEMPV_DELTA_CACHE *dc;
+{
+	dc->bytes = 0;
+	dc->deltas = hash_init_o(offsetof(MEMPV_DELTA, key), sizeof(MEMPV_DELTA_KEY));
+	if (dc->deltas == NULL) {
+		return ENOMEM;
+	}
+	hash_set_open_addressing(dc->deltas);
+	listc_init(&dc->lru, offsetof(MEMPV_DELTA, lru_link));
+	pthread_mutex_init(&dc->lock, NULL);
+	return 0;
+}
+
+/*
+ * __mempv_delta_destroy --
+ * Frees the page delta store.
+ *
+ * PUBLIC: void __mempv_delta_destroy
+ * PUBLIC:	__P((DB_ENV *, MEMPV_DELTA_CACHE *));
+ */
+void __mempv_delta_destroy(dbenv, dc)
+	DB_ENV *dbenv;
+	MEMPV_DELTA_CACHE *dc;
+{
+	MEMPV_DELTA *delta;
+
+	while ((delta = listc_rtl(&dc->lru)) != NULL) {
+		__os_free(dbenv, delta);
+	}
+	hash_free(dc->deltas);
+	dc->deltas = NULL;
+	pthread_mutex_destroy(&dc->lock);
+}
+
+/*
+ * __mempv_delta_get --
+ * Copies the log record that moved page `pgno' of file `file_id' to `lsn'
+ * into `dbt', which must be a DB_DBT_REALLOC dbt.
+ *
+ * Returns 0 on a hit and DB_NOTFOUND on a miss.
+ *
+ * PUBLIC: int __mempv_delta_get
+ * PUBLIC:	__P((DB_ENV *, MEMPV_DELTA_CACHE *, u_int8_t[DB_FILE_ID_LEN], db_pgno_t, DB_LSN, DBT *));
+ */
+int __mempv_delta_get(dbenv, dc, file_id, pgno, lsn, dbt)
+	DB_ENV *dbenv;
+	MEMPV_DELTA_CACHE *dc;
+	u_int8_t file_id[DB_FILE_ID_LEN];
+	db_pgno_t pgno;
+	DB_LSN lsn;
+	DBT *dbt;
+{
+	MEMPV_DELTA_KEY key;
+	MEMPV_DELTA *delta;
+	int ret;
+
+	if (dbenv->attr.mempv_delta_cache_size <= 0) {
+		return DB_NOTFOUND;
+	}
+
+	memset(&key, 0, sizeof(key));
+	memcpy(key.ufid, file_id, DB_FILE_ID_LEN);
+	key.pgno = pgno;
+	key.lsn = lsn;
+
+	ret = DB_NOTFOUND;
+	pthread_mutex_lock(&dc->lock);
+	if ((delta = hash_find(dc->deltas, &key)) != NULL) {
+		/*
+		 * A DB_DBT_REALLOC dbt's ulen is not kept up to date by
+		 * __db_retcopy, so always size the buffer to the record.
+		 */
+		if (__os_realloc(dbenv, delta->size, &dbt->data) != 0) {
+			goto done;
+		}
+		memcpy(dbt->data, delta->data, delta->size);
+		dbt->size = delta->size;
+		listc_rfl(&dc->lru, delta);
+		listc_abl(&dc->lru, delta);
+		ret = 0;
+	}
+done:
+	pthread_mutex_unlock(&dc->lock);
+	return ret;
+}
+
+/*
+ * __mempv_delta_put --
+ * Adds a copy of the log record in `dbt' that moved page `pgno' of file
+ * `file_id' to `lsn', evicting the least recently used records past
+ * `mempv_delta_cache_size' bytes.
+ *
+ * PUBLIC: void __mempv_delta_put
+ * PUBLIC:	__P((DB_ENV *, MEMPV_DELTA_CACHE *, u_int8_t[DB_FILE_ID_LEN], db_pgno_t, DB_LSN, DBT *));
+ */
+void __mempv_delta_put(dbenv, dc, file_id, pgno, lsn, dbt)
+	DB_ENV *dbenv;
+	MEMPV_DELTA_CACHE *dc;
+	u_int8_t file_id[DB_FILE_ID_LEN];
+	db_pgno_t pgno;
+	DB_LSN lsn;
+	DBT *dbt;
+{
+	MEMPV_DELTA *delta, *old;
+	size_t max;
+	int cap;
+
+	cap = dbenv->attr.mempv_delta_cache_size;
+	if (cap <= 0 || dbt->size > (u_int32_t)cap / 4) {
+		return;
+	}
+	max = (size_t)cap;
+
+	if (__os_malloc(dbenv, offsetof(MEMPV_DELTA, data) + dbt->size, &delta) != 0) {
+		return;
+	}
+	memset(&delta->key, 0, sizeof(delta->key));
+	memcpy(delta->key.ufid, file_id, DB_FILE_ID_LEN);
+	delta->key.pgno = pgno;
+	delta->key.lsn = lsn;
+	delta->size = dbt->size;
+	memcpy(delta->data, dbt->data, dbt->size);
+
+	pthread_mutex_lock(&dc->lock);
+	if ((old = hash_find(dc->deltas, &delta->key)) != NULL) {
+		/* Another reader rolled back the same page. */
+		pthread_mutex_unlock(&dc->lock);
+		__os_free(dbenv, delta);
+		return;
+	}
+	while (dc->bytes + delta->size > max && (old = listc_rtl(&dc->lru)) != NULL) {
+		hash_del(dc->deltas, old);
+		dc->bytes -= old->size;
+		__os_free(dbenv, old);
+	}
+	if (hash_add(dc->deltas, delta) != 0) {
+		pthread_mutex_unlock(&dc->lock);
+		__os_free(dbenv, delta);
+		return;
+	}
+	listc_abl(&dc->lru, delta);
+	dc->bytes += delta->size;
+	pthread_mutex_unlock(&dc->lock);
+}
+
+/*
+ * __mempv_delta_truncate --
+ * Drops the records past `lsn', after the log was truncated to it.  Their
+ * LSNs are about to be reused by other records.
+ *
+ * PUBLIC: void __mempv_delta_truncate
+ * PUBLIC:	__P((DB_ENV *, MEMPV_DELTA_CACHE *, DB_LSN *));
+ */
+void __mempv_delta_truncate(dbenv, dc, lsn)
+	DB_ENV *dbenv;
+	MEMPV_DELTA_CACHE *dc;
+	DB_LSN *lsn;
+{
+	MEMPV_DELTA *delta, *tmp;
+
+	pthread_mutex_lock(&dc->lock);
+	LISTC_FOR_EACH_SAFE(&dc->lru, delta, tmp, lru_link) {
+		if (log_compare(&delta->key.lsn, lsn) > 0) {
+			__mempv_delta_evict(dbenv, dc, delta);
+		}
+	}
+	pthread_mutex_unlock(&dc->lock);
+}
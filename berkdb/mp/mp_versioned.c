@@ -56,6 +56,10 @@ int __mempv_init(dbenv)
 		goto done;
 	}
 
+	if ((ret = __mempv_delta_init(dbenv, &(mempv->deltas))), ret != 0) {
+		goto done;
+	}
+
 	dbenv->mempv = mempv;
 
 done:
@@ -73,6 +77,7 @@ void __mempv_destroy(dbenv)
 	DB_ENV *dbenv;
 {
 	__mempv_cache_destroy(&(dbenv->mempv->cache));
+	__mempv_delta_destroy(dbenv, &(dbenv->mempv->deltas));
 	__os_free(dbenv, dbenv->mempv);
 	dbenv->mempv = NULL;
 }
@@ -264,11 +269,6 @@ int __mempv_fget(mpf, dbp, pgno, target_lsn, highest_checkpoint_lsn, ret_page, f
 					"Failed to return initial page version to base memory pool\n");
 				goto err;
 			}
-
-			if ((ret = __log_cursor(dbenv, &logc)) != 0) {
-				__mempv_logmsg(LOGMSG_ERROR, caller_id, "Failed to create log cursor\n");
-				goto err;
-			}
 		}
 	}
 
@@ -292,13 +292,27 @@ int __mempv_fget(mpf, dbp, pgno, target_lsn, highest_checkpoint_lsn, ret_page, f
 			goto err;
 		}
 		
-		ret = __log_c_get(logc, &current_lsn, &dbt, DB_SET);
-		if (ret || (dbt.size < sizeof(int))) {
-			__mempv_logmsg(LOGMSG_ERROR, caller_id,
-				"Failed to get log cursor at LSN %"PRIu32":%"PRIu32"\n",
-				current_lsn.file, current_lsn.offset);
-			ret = ret ? ret : 1;
-			goto err;
+		if (__mempv_delta_get(dbenv, &dbenv->mempv->deltas, mpf->fileid, pgno, current_lsn, &dbt) == 0) {
+			if (mempv_debug) {
+				__mempv_logmsg(LOGMSG_USER, caller_id, "Found log record at %"PRIu32":%"PRIu32" in delta store\n",
+					current_lsn.file, current_lsn.offset);
+			}
+		} else {
+			if (logc == NULL && (ret = __log_cursor(dbenv, &logc)) != 0) {
+				__mempv_logmsg(LOGMSG_ERROR, caller_id, "Failed to create log cursor\n");
+				goto err;
+			}
+
+			ret = __log_c_get(logc, &current_lsn, &dbt, DB_SET);
+			if (ret || (dbt.size < sizeof(int))) {
+				__mempv_logmsg(LOGMSG_ERROR, caller_id,
+					"Failed to get log cursor at LSN %"PRIu32":%"PRIu32"\n",
+					current_lsn.file, current_lsn.offset);
+				ret = ret ? ret : 1;
+				goto err;
+			}
+
+			__mempv_delta_put(dbenv, &dbenv->mempv->deltas, mpf->fileid, pgno, current_lsn, &dbt);
 		}
 
 		u_int32_t rectype;
@@ -1493,6 +1493,15 @@ void cdb2_hndl_set_max_retries(cdb2_hndl_tp *hndl, int max_retries)
         hndl->max_retries = max_retries;
     }
 }
+
+/* Shuts down the connection of `hndl', so that a thread blocked reading
+ * from it gets an error.  The handle still has to be closed. */
+void cdb2_hndl_shutdown(cdb2_hndl_tp *hndl)
+{
+    COMDB2BUF *sb = hndl->sb;
+    if (sb)
+        shutdown(cdb2buf_fileno(sb), SHUT_RDWR);
+}
 #endif
 
 void cdb2_set_comdb2db_config(char *cfg_file)
@@ -33,6 +33,7 @@ static int exec_rowlocks_enable(void *tran, bpfunc_t *func,
                                 struct errstat *err);
 static int exec_genid48_enable(void *tran, bpfunc_t *func, struct errstat *err);
 static int exec_set_skipscan(void *tran, bpfunc_t *func, struct errstat *err);
+static int exec_set_zonemap(void *tran, bpfunc_t *func, struct errstat *err);
 static int exec_delete_from_sc_history(void *tran, bpfunc_t *func, struct errstat *err);
 */
 
@@ -538,6 +539,30 @@ static int exec_set_skipscan(void *tran, bpfunc_t *func, struct errstat *err)
     return rc;
 }
 
+static int exec_set_zonemap(void *tran, bpfunc_t *func, struct errstat *err)
+{
+    BpfuncAnalyzeCoverage *cov_f = func->arg->an_cov;
+    int bdberr;
+    int rc;
+
+    if (cov_f->newvalue == 1) {
+        if (gbl_rowlocks) {
+            errstat_set_rcstrf(err, -1, "zone maps are not supported with rowlocks");
+            return -1;
+        }
+        rc = bdb_set_table_parameter(tran, cov_f->tablename, "zonemap", "true");
+    } else {
+        rc = bdb_clear_table_parameter(tran, cov_f->tablename, "zonemap");
+        if (!rc)
+            rc = bdb_zonemap_del_all(tran, cov_f->tablename, &bdberr);
+    }
+    if (!rc)
+        bdb_llog_analyze(thedb->bdb_env, 1, &bdberr);
+    if (rc)
+        errstat_set_rcstrf(err, rc, "%s failed", __func__);
+    return rc;
+}
+
 static int exec_genid48_enable(void *tran, bpfunc_t *func, struct errstat *err)
 {
     BpfuncGenid48Enable *gn = func->arg->gn_enable;
@@ -579,6 +604,15 @@ static int exec_rowlocks_enable(void *tran, bpfunc_t *func, struct errstat *err)
         return -1;
     }
 
+    /* rowlocks writers do not widen zones */
+    for (int i = 0; rl->enable && i < thedb->num_dbs; i++) {
+        if (thedb->dbs[i]->zonemap) {
+            errstat_set_rcstrf(err, -1, "%s -- table %s has zone maps",
+                               __func__, thedb->dbs[i]->tablename);
+            return -1;
+        }
+    }
+
     rc = set_rowlocks(tran, rl->enable);
     if (!rc) {
         struct ireq *iq = (struct ireq *)func->info->iq;
@@ -662,6 +696,10 @@ static int prepare_methods(bpfunc_t *func, bpfunc_info *info)
         func->exec = exec_delete_from_sc_history;
         break;
 
+    case BPFUNC_SET_ZONEMAP:
+        func->exec = exec_set_zonemap;
+        break;
+
     default:
         logmsg(LOGMSG_ERROR, "Unknown function_id in bplog function\n");
         return -1;
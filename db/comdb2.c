@@ -148,6 +148,7 @@ void berk_memp_sync_alarm_ms(int);
 #include "str_util.h" /* QUOTE */
 #include "machcache.h"
 #include "gen_shard.h"
+#include "zonemap.h"
 
 #define tokdup strndup
 
@@ -301,6 +302,8 @@ int gbl_sqlreadaheadthresh = 0;
 
 int gbl_iothreads = 0;
 int gbl_sqlreadahead = 0;
+/* readaheads requested by sequential sql cursor scans */
+int64_t gbl_sql_readaheads;
 int gbl_ioqueue = 0;
 int gbl_prefaulthelperthreads = 0;
 int gbl_osqlpfault_threads = 0;
@@ -807,6 +810,8 @@ extern int gbl_legacy_defaults;
 int64_t gbl_temptable_created;
 int64_t gbl_temptable_create_reqs;
 int64_t gbl_temptable_spills;
+int64_t gbl_temptable_hash_joins;
+int64_t gbl_temptable_hash_join_spills;
 
 int gbl_osql_odh_blob = 1;
 
@@ -1937,6 +1942,11 @@ void cleanup_newdb(dbtable *tbl)
         tbl->sqlixuse = NULL;
     }
 
+    if (tbl->sqlixlookups) {
+        free(tbl->sqlixlookups);
+        tbl->sqlixlookups = NULL;
+    }
+
     if (tbl->rev_constraints) {
         free(tbl->rev_constraints);
         tbl->rev_constraints = NULL;
@@ -3963,6 +3973,11 @@ static int init(int argc, char **argv)
         return -1;
     }
 
+    if (sqlsorter_init()) {
+        logmsg(LOGMSG_FATAL, "failed to initialise sql sorter threads\n");
+        return -1;
+    }
+
     if (gbl_ctrace_dbdir)
         ctrace_openlog_taskname(thedb->basedir, dbname);
     else {
@@ -5885,6 +5900,8 @@ int main(int argc, char **argv)
 
     create_watchdog_thread(thedb);
     create_old_blkseq_thread(thedb);
+    create_zonemap_thread(thedb);
+    create_commit_ack_thread(thedb);
     create_stat_thread(thedb);
 
     /* create the offloadsql repository */
@@ -725,6 +725,7 @@ typedef struct dbtable {
     /* index stats */
     unsigned long long *ixuse;
     unsigned long long *sqlixuse;
+    unsigned long long *sqlixlookups; /* data rows read through each index */
 
     /* Used during schema change to describe how we will form the new table
      * from the old table.  The add/update/delete routines will only look at
@@ -801,9 +802,14 @@ typedef struct dbtable {
 
     unsigned disableskipscan : 1;
     unsigned do_local_replication : 1;
+    /* zone maps are kept and used for table scans, see zonemap.c */
+    unsigned zonemap : 1;
 
     /* name of the timepartition, if this is a shard */
     const char *timepartition_name;
+    /* shard was frozen after it stopped being the current shard; sql
+       writes are rejected */
+    int timepartition_frozen;
 
     /* generic sharding metadata */
     uint32_t numdbs;
@@ -1410,6 +1416,12 @@ struct ireq {
     /* socksql/recom storage */
     osql_sess_t *sorese;
 
+    /* the replication wait of the commit, and the sorese reply, are left to
+     * the commit ack queue */
+    int commit_ack_deferred;
+    int commit_ack_startms;
+    db_seqnum_type commit_ack_seqnum;
+
     /* debug osql */
     osql_bp_timings_t timings;
 
@@ -1700,6 +1712,7 @@ extern int gbl_maxblockops;
 extern int gbl_rangextunit;
 extern int gbl_honor_rangextunit_for_old_apis;
 extern int gbl_sqlreadahead;
+extern int64_t gbl_sql_readaheads;
 extern int gbl_sqlreadaheadthresh;
 extern int gbl_iothreads;
 extern int gbl_ioqueue;
@@ -1976,6 +1989,8 @@ void sqlnet_init(void);
 int sqlpool_init(void);
 int schema_init(void);
 int osqlpfthdpool_init(void);
+int sqlsorter_init(void);
+const char *sqlsorter_tz(void);
 int init_opcode_handlers();
 void toblock_init(void);
 int mach_class_cluster_init(void);
@@ -2205,6 +2220,13 @@ int trans_discard_prepared(struct ireq *iq, void *trans);
 int trans_wait_for_seqnum(struct ireq *iq, char *source_host,
                           db_seqnum_type *ss);
 int trans_wait_for_last_seqnum(struct ireq *iq, char *source_host);
+void coherency_lease_wait(void);
+
+/* commit ack queue */
+int commit_ack_defer(struct ireq *iq, db_seqnum_type *ss, int timeoutms,
+                     int adaptive);
+void commit_ack_enqueue(struct ireq *iq, int rc);
+void create_commit_ack_thread(struct dbenv *dbenv);
 
 /* find context for pseudo-stable cursors */
 int get_context(struct ireq *iq, unsigned long long *context);
@@ -2337,6 +2359,11 @@ int ix_prev_blobs_auxdb(int auxdb, int lookahead, struct ireq *iq, int ixnum,
 int get_next_genids(struct ireq *iq, int ixnum, void *key, int keylen,
                     unsigned long long *genids, int maxgenids,
                     int *num_genids_gotten);
+int get_prev_genids(struct ireq *iq, int ixnum, void *key, int keylen,
+                    unsigned long long *genids, int maxgenids,
+                    int *num_genids_gotten);
+int prefault_dta_records(struct ireq *iq, unsigned long long genid, int num,
+                         int prev);
 
 int ix_find_auxdb_by_rrn_and_genid(int auxdb, struct ireq *iq, int rrn,
                                    unsigned long long genid, void *fnddta,
@@ -3642,6 +3669,8 @@ int sc_timepart_add_table(const char *existingTableName,
 int sc_timepart_drop_table(const char *tableName, struct errstat *err);
 int sc_timepart_truncate_table(const char *tableName, struct errstat *err,
                                void *partition);
+int sc_timepart_freeze_table(const char *tableName, int compress,
+                             int compress_blobs, struct errstat *err);
 
 /* SCHEMACHANGE DECLARATIONS*/
 
@@ -3726,6 +3755,13 @@ void plugin_post_dbenv_hook(struct dbenv *dbenv);
 extern int64_t gbl_temptable_created;
 extern int64_t gbl_temptable_create_reqs;
 extern int64_t gbl_temptable_spills;
+extern int64_t gbl_temptable_hash_joins;
+extern int64_t gbl_temptable_hash_join_spills;
+extern int64_t gbl_sql_vectorized_agg_rows;
+extern int64_t gbl_osql_streamed_txns;
+extern int64_t gbl_commit_acks_deferred;
+extern int64_t gbl_physrep_lag_bytes;
+extern int64_t gbl_physrep_lag_seconds;
 
 extern int gbl_disable_tpsc_tblvers;
 
@@ -0,0 +1,263 @@
+/*
+   Copyright 2026 Bloomberg Finance L.P.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+ */
+
+/*
+ * Commit ack queue.
+ *
+ * A block processor thread which committed an osql transaction waits for
+ * the replicants to acknowledge the commit LSN before it replies to the sql
+ * thread.  With async_commit_ack, it leaves the LSN and a copy of the reply
+ * here instead and goes back to the writer pool.  A single waiter thread
+ * waits for the highest LSN queued, which covers every commit before it,
+ * and then sends the replies.  The sql thread sees the same reply, at the
+ * same time, as if the writer had waited.
+ */
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <build/db.h>
+#include <epochlib.h>
+#include <list.h>
+#include "comdb2.h"
+#include "bdb_api.h"
+#include "osqlcomm.h"
+#include "thrman.h"
+#include "thread_util.h"
+#include "logmsg.h"
+#include "comdb2_atomic.h"
+
+int gbl_async_commit_ack = 0;
+int gbl_async_commit_ack_max_pending = 1000;
+int64_t gbl_commit_acks_deferred = 0;
+
+extern int gbl_debug_add_replication_latency;
+int durable_change_rcode(struct ireq *iq);
+
+struct commit_ack {
+    db_seqnum_type seqnum;
+    int is_final;
+    int durable_rcode;
+    int startms;
+
+    /* the reply */
+    osql_target_t target;
+    unsigned long long rqid;
+    uuid_t uuid;
+    int nops;
+    struct errstat errstat;
+    snap_uid_t snap;
+    int has_snap;
+    int rc;
+
+    LINKC_T(struct commit_ack) lnk;
+};
+
+static pthread_mutex_t commit_ack_lk = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t commit_ack_cd = PTHREAD_COND_INITIALIZER;
+static LISTC_T(struct commit_ack) commit_acks;
+/* deferred commits not acknowledged yet, queued or not */
+static int commit_ack_pending;
+static int commit_ack_thread_running;
+
+/* Called by trans_commit_int() after committing the parent transaction of
+ * `iq'.  Returns 1 if its replication wait is left to the commit ack queue,
+ * in which case handle_ireq() queues the reply with commit_ack_enqueue().
+ * The queue waits like trans_commit_adaptive(); commits asking for another
+ * wait keep waiting in the writer. */
+int commit_ack_defer(struct ireq *iq, db_seqnum_type *ss, int timeoutms,
+                     int adaptive)
+{
+    if (!gbl_async_commit_ack || !adaptive || timeoutms != -1)
+        return 0;
+    if (iq->sorese == NULL || iq->sorese->target.type != OSQL_OVER_NET ||
+        iq->sorese->dist_txnid || iq->sc_pending || iq->tranddl ||
+        thedb->rep_sync != REP_SYNC_FULL ||
+        gbl_debug_add_replication_latency)
+        return 0;
+
+    Pthread_mutex_lock(&commit_ack_lk);
+    if (!commit_ack_thread_running ||
+        commit_ack_pending >= gbl_async_commit_ack_max_pending) {
+        Pthread_mutex_unlock(&commit_ack_lk);
+        return 0;
+    }
+    commit_ack_pending++;
+    Pthread_mutex_unlock(&commit_ack_lk);
+
+    memcpy(iq->commit_ack_seqnum, ss, sizeof(db_seqnum_type));
+    iq->commit_ack_startms = comdb2_time_epochms();
+    iq->commit_ack_deferred = 1;
+    return 1;
+}
+
+/* The request stats were updated when the block processor finished, before
+ * the replication wait; account for it here (locklessly, like toblock.c) */
+static int commit_ack_reptime(struct commit_ack *ca, int timeoutms)
+{
+    int reptimems = comdb2_time_epochms() - ca->startms;
+
+    if (timeoutms > thedb->max_timeout_ms)
+        thedb->max_timeout_ms = timeoutms;
+    thedb->total_timeouts_ms += timeoutms;
+    if (reptimems > thedb->max_reptime_ms)
+        thedb->max_reptime_ms = reptimems;
+    thedb->total_reptime_ms += reptimems;
+    return reptimems;
+}
+
+static void commit_ack_reply(struct commit_ack *ca, int waitrc)
+{
+    if (waitrc == BDBERR_NOT_DURABLE && ca->durable_rcode) {
+        /* committed, but not replicated: have the client retry */
+        ca->errstat.errval = ERR_NOT_DURABLE;
+        ca->rc = ERR_NOT_DURABLE;
+    }
+    osql_comm_signal_sqlthr_rc(&ca->target, ca->rqid, ca->uuid, ca->nops,
+                               &ca->errstat, ca->has_snap ? &ca->snap : NULL,
+                               ca->rc);
+}
+
+/* Queues the reply handle_ireq() would have sent for the deferred commit of
+ * `iq'.  If that fails, waits for the commit and replies right here. */
+void commit_ack_enqueue(struct ireq *iq, int rc)
+{
+    struct commit_ack lcl, *ca;
+
+    ca = malloc(sizeof(struct commit_ack));
+    if (ca == NULL)
+        ca = &lcl;
+
+    memcpy(ca->seqnum, iq->commit_ack_seqnum, sizeof(db_seqnum_type));
+    ca->is_final = iq->sorese->is_final;
+    ca->startms = iq->commit_ack_startms;
+    ca->durable_rcode = durable_change_rcode(iq);
+    ca->target = iq->sorese->target;
+    ca->rqid = iq->sorese->rqid;
+    comdb2uuidcpy(ca->uuid, iq->sorese->uuid);
+    ca->nops = iq->sorese->nops;
+    ca->errstat = iq->errstat;
+    ca->has_snap = (IQ_SNAPINFO(iq) != NULL);
+    if (ca->has_snap)
+        ca->snap = *IQ_SNAPINFO(iq);
+    ca->rc = rc;
+    iq->commit_ack_deferred = 0;
+
+    if (ca != &lcl) {
+        Pthread_mutex_lock(&commit_ack_lk);
+        if (commit_ack_thread_running) {
+            listc_abl(&commit_acks, ca);
+            Pthread_cond_signal(&commit_ack_cd);
+            Pthread_mutex_unlock(&commit_ack_lk);
+            ATOMIC_ADD64(gbl_commit_acks_deferred, 1);
+            return;
+        }
+        Pthread_mutex_unlock(&commit_ack_lk);
+    }
+
+    int timeoutms = -1;
+    int waitrc = bdb_wait_for_seqnum_from_all_int(
+        thedb->bdb_env, (seqnum_type *)ca->seqnum, &timeoutms, ca->is_final);
+    coherency_lease_wait();
+    iq->timeoutms = timeoutms;
+    iq->reptimems += commit_ack_reptime(ca, timeoutms);
+    commit_ack_reply(ca, waitrc);
+    if (ca != &lcl)
+        free(ca);
+
+    Pthread_mutex_lock(&commit_ack_lk);
+    commit_ack_pending--;
+    Pthread_mutex_unlock(&commit_ack_lk);
+}
+
+static void *commit_ack_thread(void *arg)
+{
+    struct dbenv *dbenv = arg;
+    LISTC_T(struct commit_ack) acks;
+    struct commit_ack *ca, *last;
+
+    thrman_register(THRTYPE_GENERIC);
+    thread_started("commit_ack");
+    backend_thread_event(dbenv, COMDB2_THR_EVENT_START);
+
+    listc_init(&acks, offsetof(struct commit_ack, lnk));
+
+    while (1) {
+        Pthread_mutex_lock(&commit_ack_lk);
+        while (listc_size(&commit_acks) == 0 && !db_is_exiting()) {
+            struct timespec ts;
+            clock_gettime(CLOCK_REALTIME, &ts);
+            ts.tv_sec += 1;
+            pthread_cond_timedwait(&commit_ack_cd, &commit_ack_lk, &ts);
+        }
+        if (listc_size(&commit_acks) == 0) {
+            commit_ack_thread_running = 0;
+            Pthread_mutex_unlock(&commit_ack_lk);
+            break;
+        }
+        while ((ca = listc_rtl(&commit_acks)) != NULL)
+            listc_abl(&acks, ca);
+        Pthread_mutex_unlock(&commit_ack_lk);
+
+        /* waiting for the last commit waits for all of them; which replies
+         * turn a NOT_DURABLE wait into ERR_NOT_DURABLE is up to each one */
+        int is_final = 1, n = 0;
+        last = NULL;
+        LISTC_FOR_EACH(&acks, ca, lnk) {
+            if (last == NULL || log_compare((DB_LSN *)ca->seqnum,
+                                            (DB_LSN *)last->seqnum) > 0)
+                last = ca;
+            if (!ca->is_final)
+                is_final = 0;
+        }
+
+        int timeoutms = -1;
+        int waitrc = bdb_wait_for_seqnum_from_all_int(
+            dbenv->bdb_env, (seqnum_type *)last->seqnum, &timeoutms, is_final);
+        if (waitrc != 0)
+            logmsg(LOGMSG_ERROR,
+                   "*WARNING* %s: error syncing all nodes rc %d\n", __func__,
+                   waitrc);
+        coherency_lease_wait();
+
+        while ((ca = listc_rtl(&acks)) != NULL) {
+            commit_ack_reptime(ca, timeoutms);
+            commit_ack_reply(ca, waitrc);
+            free(ca);
+            n++;
+        }
+
+        Pthread_mutex_lock(&commit_ack_lk);
+        commit_ack_pending -= n;
+        Pthread_mutex_unlock(&commit_ack_lk);
+    }
+
+    backend_thread_event(dbenv, COMDB2_THR_EVENT_DONE);
+    return NULL;
+}
+
+void create_commit_ack_thread(struct dbenv *dbenv)
+{
+    pthread_t tid;
+
+    if (commit_ack_thread_running)
+        return;
+    listc_init(&commit_acks, offsetof(struct commit_ack, lnk));
+    commit_ack_thread_running = 1;
+    Pthread_create(&tid, &gbl_pthread_attr_detached, commit_ack_thread, dbenv);
+}
@@ -28,6 +28,7 @@
 #include "tohex.h"
 #include "string_ref.h"
 #include <ctrace.h>
+#include "comdb2_atomic.h"
 
 extern int gbl_old_column_names;
 
@@ -228,7 +229,10 @@ void add_fingerprint(struct sqlclntstate *clnt, sqlite3_stmt *stmt, struct strin
     }
 
     Pthread_mutex_lock(&gbl_fingerprint_hash_mu);
-    if (gbl_fingerprint_hash == NULL) gbl_fingerprint_hash = hash_init(FINGERPRINTSZ);
+    if (gbl_fingerprint_hash == NULL) {
+        gbl_fingerprint_hash = hash_init(FINGERPRINTSZ);
+        hash_set_open_addressing(gbl_fingerprint_hash);
+    }
     struct fingerprint_track *t = hash_find(gbl_fingerprint_hash, fingerprint);
     if (t == NULL) {
         /* make sure we haven't generated an unreasonable number of these */
@@ -252,6 +256,7 @@ void add_fingerprint(struct sqlclntstate *clnt, sqlite3_stmt *stmt, struct strin
         t->time = time;
         t->prepTime = prepTime;
         t->rows = nrows;
+        t->mem_peak = ATOMIC_LOAD64(clnt->mem.acct.peak);
         t->curr_analyze_gen = gbl_analyze_gen;
         t->zNormSql = strdup(zNormSql);
         t->nNormSql = nNormSql;
@@ -260,7 +265,7 @@ void add_fingerprint(struct sqlclntstate *clnt, sqlite3_stmt *stmt, struct strin
             t->query_plan_hash = hash_init(FINGERPRINTSZ);
             t->alert_once_query_plan = 1;
             t->alert_once_query_plan_max = 1;
-            add_query_plan(cost, nrows, t, zSql_ref, query_plan_ref, plan_fingerprint, params);
+            add_query_plan(stmt, cost, nrows, t, zSql_ref, query_plan_ref, plan_fingerprint, params);
         } else {
             t->query_plan_hash = NULL;
         }
@@ -305,13 +310,14 @@ void add_fingerprint(struct sqlclntstate *clnt, sqlite3_stmt *stmt, struct strin
         t->time += time;
         t->prepTime += prepTime;
         t->rows += nrows;
+        t->mem_peak = ATOMIC_LOAD64(clnt->mem.acct.peak);
         if (calc_query_plan) {
             if (!t->query_plan_hash) {
                 t->query_plan_hash = hash_init(FINGERPRINTSZ);
                 t->alert_once_query_plan = 1;
                 t->alert_once_query_plan_max = 1;
             }
-            add_query_plan(cost, nrows, t, zSql_ref, query_plan_ref, plan_fingerprint, params);
+            add_query_plan(stmt, cost, nrows, t, zSql_ref, query_plan_ref, plan_fingerprint, params);
         }
 
         /* Do a check after an interval */
@@ -366,3 +372,18 @@ done:
         put_ref(&query_plan_ref);
     free(params);
 }
+
+/* Peak memory of the last execution of a query, or -1 if not known */
+int64_t fingerprint_mem_peak(const unsigned char fingerprint[FINGERPRINTSZ])
+{
+    int64_t peak = -1;
+
+    Pthread_mutex_lock(&gbl_fingerprint_hash_mu);
+    if (gbl_fingerprint_hash != NULL) {
+        struct fingerprint_track *t = hash_find(gbl_fingerprint_hash, fingerprint);
+        if (t != NULL)
+            peak = t->mem_peak;
+    }
+    Pthread_mutex_unlock(&gbl_fingerprint_hash_mu);
+    return peak;
+}
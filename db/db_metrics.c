@@ -33,6 +33,7 @@
 #include <sys/resource.h>
 #include "comdb2_query_preparer.h"
 #include "net_int.h"
+#include "zonemap.h"
 
 struct comdb2_metrics_store {
     int64_t cache_hits;
@@ -95,6 +96,25 @@ struct comdb2_metrics_store {
     int64_t temptable_created;
     int64_t temptable_create_reqs;
     int64_t temptable_spills;
+    int64_t sql_hash_joins;
+    int64_t sql_hash_join_spills;
+    int64_t sql_vectorized_agg_rows;
+    int64_t sql_readaheads;
+    int64_t osql_streamed_txns;
+    int64_t commit_acks_deferred;
+    int64_t physrep_lag_bytes;
+    int64_t physrep_lag_seconds;
+    int64_t sql_mem_reserved;
+    int64_t sql_mem_queued;
+    int64_t sql_mem_rejected;
+    int64_t sql_result_cache_hits;
+    int64_t sql_result_cache_misses;
+    int64_t sql_result_cache_stores;
+    int64_t sql_result_cache_bytes;
+    int64_t newsql_mux_connections;
+    int64_t newsql_mux_sessions;
+    int64_t zonemap_zones_summarized;
+    int64_t zonemap_zones_skipped;
     int64_t net_drops;
     int64_t net_queue_size;
     int64_t rep_deadlocks;
@@ -284,6 +304,44 @@ comdb2_metric gbl_metrics[] = {
      STATISTIC_COLLECTION_TYPE_CUMULATIVE, &stats.temptable_create_reqs, NULL},
     {"temptable_spills", "Number of temporary tables that had to be spilled to disk-backed tables", STATISTIC_INTEGER,
      STATISTIC_COLLECTION_TYPE_CUMULATIVE, &stats.temptable_spills, NULL},
+    {"sql_hash_joins", "Number of hash tables built for sql joins", STATISTIC_INTEGER,
+     STATISTIC_COLLECTION_TYPE_CUMULATIVE, &stats.sql_hash_joins, NULL},
+    {"sql_hash_join_spills", "Number of sql join hash tables that were turned into disk-backed indexes",
+     STATISTIC_INTEGER, STATISTIC_COLLECTION_TYPE_CUMULATIVE, &stats.sql_hash_join_spills, NULL},
+    {"sql_vectorized_agg_rows", "Number of rows aggregated in batches by vectorized aggregation", STATISTIC_INTEGER,
+     STATISTIC_COLLECTION_TYPE_CUMULATIVE, &stats.sql_vectorized_agg_rows, NULL},
+    {"sql_readaheads", "Number of readaheads requested by sequential sql cursor scans", STATISTIC_INTEGER,
+     STATISTIC_COLLECTION_TYPE_CUMULATIVE, &stats.sql_readaheads, NULL},
+    {"osql_streamed_txns", "Number of transactions applied while their bplog was still arriving", STATISTIC_INTEGER,
+     STATISTIC_COLLECTION_TYPE_CUMULATIVE, &stats.osql_streamed_txns, NULL},
+    {"commit_acks_deferred", "Number of commits acknowledged by the commit ack thread", STATISTIC_INTEGER,
+     STATISTIC_COLLECTION_TYPE_CUMULATIVE, &stats.commit_acks_deferred, NULL},
+    {"physrep_lag_bytes", "Bytes of log the physical replicant is behind its source", STATISTIC_INTEGER,
+     STATISTIC_COLLECTION_TYPE_LATEST, &stats.physrep_lag_bytes, NULL},
+    {"physrep_lag_seconds", "Seconds the physical replicant is behind its source", STATISTIC_INTEGER,
+     STATISTIC_COLLECTION_TYPE_LATEST, &stats.physrep_lag_seconds, NULL},
+    {"sql_mem_reserved", "Bytes of memory reserved by running queries", STATISTIC_INTEGER,
+     STATISTIC_COLLECTION_TYPE_LATEST, &stats.sql_mem_reserved, NULL},
+    {"sql_mem_queued", "Number of queries which waited for memory", STATISTIC_INTEGER,
+     STATISTIC_COLLECTION_TYPE_CUMULATIVE, &stats.sql_mem_queued, NULL},
+    {"sql_mem_rejected", "Number of queries rejected for lack of memory", STATISTIC_INTEGER,
+     STATISTIC_COLLECTION_TYPE_CUMULATIVE, &stats.sql_mem_rejected, NULL},
+    {"sql_result_cache_hits", "Number of queries answered from the result cache", STATISTIC_INTEGER,
+     STATISTIC_COLLECTION_TYPE_CUMULATIVE, &stats.sql_result_cache_hits, NULL},
+    {"sql_result_cache_misses", "Number of cacheable queries not found in the result cache", STATISTIC_INTEGER,
+     STATISTIC_COLLECTION_TYPE_CUMULATIVE, &stats.sql_result_cache_misses, NULL},
+    {"sql_result_cache_stores", "Number of results added to the result cache", STATISTIC_INTEGER,
+     STATISTIC_COLLECTION_TYPE_CUMULATIVE, &stats.sql_result_cache_stores, NULL},
+    {"sql_result_cache_bytes", "Bytes of results in the result cache", STATISTIC_INTEGER,
+     STATISTIC_COLLECTION_TYPE_LATEST, &stats.sql_result_cache_bytes, NULL},
+    {"newsql_mux_connections", "Number of multiplexed newsql connections", STATISTIC_INTEGER,
+     STATISTIC_COLLECTION_TYPE_LATEST, &stats.newsql_mux_connections, NULL},
+    {"newsql_mux_sessions", "Number of sessions on multiplexed newsql connections", STATISTIC_INTEGER,
+     STATISTIC_COLLECTION_TYPE_LATEST, &stats.newsql_mux_sessions, NULL},
+    {"zonemap_zones_summarized", "Number of zone map zones written by the master", STATISTIC_INTEGER,
+     STATISTIC_COLLECTION_TYPE_CUMULATIVE, &stats.zonemap_zones_summarized, NULL},
+    {"zonemap_zones_skipped", "Number of zones skipped by table scans", STATISTIC_INTEGER,
+     STATISTIC_COLLECTION_TYPE_CUMULATIVE, &stats.zonemap_zones_skipped, NULL},
     {"net_drops", "Number of packets that didn't fit on network queue and were dropped", STATISTIC_INTEGER,
      STATISTIC_COLLECTION_TYPE_CUMULATIVE, &stats.net_drops, NULL},
     {"net_queue_size", "Size of largest outgoing net queue", STATISTIC_INTEGER, STATISTIC_COLLECTION_TYPE_LATEST,
@@ -463,6 +521,8 @@ extern int64_t gbl_incoherent_slow_skips;
 extern int64_t gbl_inmem_repdb_memory;
 extern int64_t gbl_physrep_metadb_sql_count;
 extern int gbl_physrep_no_viable_source;
+extern int32_t gbl_newsql_mux_conns;
+extern int32_t gbl_newsql_mux_sessions;
 
 static void update_sqllogfill_metrics()
 {
@@ -721,6 +781,25 @@ int refresh_metrics(void)
     stats.temptable_created = gbl_temptable_created;
     stats.temptable_create_reqs = gbl_temptable_create_reqs;
     stats.temptable_spills = gbl_temptable_spills;
+    stats.sql_hash_joins = gbl_temptable_hash_joins;
+    stats.sql_hash_join_spills = gbl_temptable_hash_join_spills;
+    stats.sql_vectorized_agg_rows = gbl_sql_vectorized_agg_rows;
+    stats.sql_readaheads = gbl_sql_readaheads;
+    stats.osql_streamed_txns = gbl_osql_streamed_txns;
+    stats.commit_acks_deferred = gbl_commit_acks_deferred;
+    stats.physrep_lag_bytes = gbl_physrep_lag_bytes;
+    stats.physrep_lag_seconds = gbl_physrep_lag_seconds;
+    stats.sql_mem_reserved = sql_mem_reserved();
+    stats.sql_mem_queued = gbl_sql_mem_queued;
+    stats.sql_mem_rejected = gbl_sql_mem_rejected;
+    stats.sql_result_cache_hits = gbl_sql_rcache_hits;
+    stats.sql_result_cache_misses = gbl_sql_rcache_misses;
+    stats.sql_result_cache_stores = gbl_sql_rcache_stores;
+    stats.sql_result_cache_bytes = sql_rcache_bytes();
+    stats.newsql_mux_connections = gbl_newsql_mux_conns;
+    stats.newsql_mux_sessions = gbl_newsql_mux_sessions;
+    stats.zonemap_zones_summarized = gbl_zonemap_zones_summarized;
+    stats.zonemap_zones_skipped = gbl_zonemap_zones_skipped;
 
     stats.net_drops = get_hosts_metric("replication", NET_DROPS);
 
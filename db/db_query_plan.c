@@ -71,8 +71,9 @@ struct string_ref *form_query_plan(struct sqlclntstate *clnt, sqlite3_stmt *stmt
 
 // assumed to have fingerprint lock
 // assume t->query_plan_hash is not NULL
-void add_query_plan(int64_t cost, int64_t nrows, struct fingerprint_track *t, struct string_ref *zSql_ref,
-                    struct string_ref *query_plan_ref, unsigned char *plan_fingerprint, char *params)
+void add_query_plan(sqlite3_stmt *stmt, int64_t cost, int64_t nrows, struct fingerprint_track *t,
+                    struct string_ref *zSql_ref, struct string_ref *query_plan_ref, unsigned char *plan_fingerprint,
+                    char *params)
 {
     if (nrows < 0) {
         return;
@@ -117,6 +118,12 @@ void add_query_plan(int64_t cost, int64_t nrows, struct fingerprint_track *t, st
         }
     }
 
+    if (stmt) {
+        Vdbe *v = (Vdbe *)stmt;
+        q->est_cost = v->nPlanCost;
+        q->planner_steps = v->nPlanSteps;
+    }
+
     // add to queries sample if there exists a plan
     if (gbl_sample_queries && q->plan_ref)
         add_query_to_samples_queries(t->fingerprint, q->plan_fingerprint, zSql_ref, q->plan_ref, params);
@@ -122,6 +122,16 @@ extern int gbl_fdb_push_redirect_foreign;
 extern int gbl_fdb_push_remote;
 extern int gbl_fdb_push_remote_write;
 extern int gbl_fdb_remsql_cdb2api;
+extern int gbl_fdb_rcache;
+extern int gbl_sql_vectorized_agg;
+extern int gbl_sql_vectorized_agg_batch;
+extern int gbl_fdb_remote_projection;
+extern int gbl_fdb_prefetch_rows;
+extern int gbl_fdb_prefetch_pages;
+extern int gbl_fdb_prefetch_threads;
+extern int gbl_fdb_rcache_max_rows;
+extern int gbl_fdb_rcache_max_bytes;
+extern int gbl_fdb_rcache_lsn_check_msec;
 extern int gbl_goslow;
 extern int gbl_heartbeat_send;
 extern int gbl_keycompr;
@@ -140,9 +150,17 @@ extern int gbl_max_lua_source_len;
 extern int gbl_max_sqlcache;
 extern int __gbl_max_mpalloc_sleeptime;
 extern int gbl_mem_nice;
+extern int gbl_comdb2ma_tcache;
+extern int gbl_comdb2ma_tcache_size;
 extern int gbl_notimeouts;
 extern int gbl_watchdog_disable_at_start;
 extern int gbl_osql_verify_retries_max;
+extern int gbl_osql_shadtbl_skiplist;
+extern int gbl_osql_stream_bplog_threshold;
+extern int gbl_zonemap_rows;
+extern int gbl_zonemap_summarize_interval;
+extern int gbl_zonemap_max_column_size;
+extern int gbl_zonemap_scan;
 extern int gbl_dump_history_on_too_many_verify_errors;
 extern int gbl_page_latches;
 extern int gbl_pb_connectmsg;
@@ -169,9 +187,22 @@ extern int gbl_slow_rep_process_txn_freq;
 extern int gbl_slow_rep_process_txn_minms;
 extern int gbl_slow_rep_process_txn_maxms;
 extern int gbl_sqlite_sorter_mem;
+extern int gbl_sql_sorter_query_threads;
+extern int gbl_sql_sorter_parallel_min_records;
+extern int gbl_async_commit_ack;
+extern int gbl_async_commit_ack_max_pending;
+extern int gbl_physrep_stream_batches;
+extern int gbl_physrep_batch_bytes;
+extern int gbl_physrep_batch_queue;
+extern int gbl_changed_page_tracking;
+extern int gbl_sql_mem_accounting;
+extern int gbl_sql_mem_budget_mb;
+extern int gbl_sql_mem_admission_wait_ms;
+extern int gbl_sql_mem_default_estimate_kb;
 extern int gbl_sqlite_use_temptable_for_rowset;
 extern int gbl_allow_bplog_restarts;
 extern int gbl_sqlite_stat4_scan;
+extern int gbl_sql_exact_index_coverage;
 extern int gbl_test_blob_race;
 extern int gbl_test_trigger_deadlock;
 extern int gbl_llmeta_deadlock_poll;
@@ -488,6 +519,8 @@ extern int gbl_instrument_consumer_lock;
 extern int gbl_reject_mixed_ddl_dml;
 extern int gbl_debug_create_master_entry;
 extern int eventlog_nkeep;
+extern int gbl_eventlog_binary;
+extern int gbl_eventlog_ring_size;
 extern int gbl_debug_systable_locks;
 extern int gbl_assert_systable_locks;
 extern int gbl_assert_no_schemalk_in_distributed_commit;
@@ -618,6 +651,10 @@ extern int gbl_partition_sc_reorder;
 extern int gbl_retro_tpt;
 extern int gbl_retro_tpt_verbose;
 extern int gbl_retro_tpt_start;
+extern int gbl_timepart_freeze_shards;
+extern int gbl_timepart_freeze_delay;
+extern int gbl_timepart_freeze_compr;
+extern int gbl_timepart_freeze_compr_blobs;
 extern int gbl_legacy_tpt;
 extern int gbl_dohsql_joins;
 extern int gbl_altersc_latency;
@@ -649,6 +686,7 @@ int gbl_nudge_replication_when_idle = 100;
 
 extern int gbl_new_connection_grace_ms;
 extern int gbl_accept_headroom;
+extern int gbl_newsql_mux;
 extern int gbl_db_track_open;
 extern int gbl_clear_ufid_on_db_close;
 extern int gbl_get_peer_fqdn;
@@ -685,6 +723,18 @@ static int init_with_compr_blobs_update(void *context, void *algo)
     return 0;
 }
 
+static int timepart_freeze_compr_update(void *context, void *algo)
+{
+    gbl_timepart_freeze_compr = bdb_compr2algo((char *)algo);
+    return 0;
+}
+
+static int timepart_freeze_compr_blobs_update(void *context, void *algo)
+{
+    gbl_timepart_freeze_compr_blobs = bdb_compr2algo((char *)algo);
+    return 0;
+}
+
 static int init_with_queue_compr_update(void *context, void *algo)
 {
     gbl_init_with_queue_compr = bdb_compr2algo((char *)algo);
@@ -1273,6 +1323,29 @@ static int file_copier_update(void *context, void *value)
     return 0;
 }
 
+static int sql_rcache_mb_update(void *context, void *value)
+{
+    gbl_sql_rcache_mb = *(int *)value;
+    if (gbl_sql_rcache_mb <= 0)
+        sql_rcache_flush();
+    return 0;
+}
+
+static int sql_rcache_list_update(void *context, void *value)
+{
+    comdb2_tunable *tunable = (comdb2_tunable *)context;
+    int rc;
+    if (tunable->var == &gbl_sql_rcache_tables)
+        rc = sql_rcache_set_tables(value);
+    else
+        rc = sql_rcache_set_fingerprints(value);
+    if (rc)
+        return rc;
+    free(*(char **)tunable->var);
+    *(char **)tunable->var = strdup((char *)value);
+    return 0;
+}
+
 static int iam_metrics_namespace_update(void *context, void *value)
 {
     comdb2_tunable *tunable = (comdb2_tunable *)context;
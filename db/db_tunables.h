@@ -838,6 +838,15 @@ REGISTER_TUNABLE("max_query_fingerprints",
                  "hash (Default: 1000)",
                  TUNABLE_INTEGER, &gbl_fingerprint_max_queries, 0, NULL,
                  NULL, NULL, NULL);
+REGISTER_TUNABLE("comdb2ma_tcache",
+                 "Cache small blocks freed by a thread for its next allocations "
+                 "from the same allocator. (Default: on)",
+                 TUNABLE_BOOLEAN, &gbl_comdb2ma_tcache, 0, NULL, NULL, NULL,
+                 NULL);
+REGISTER_TUNABLE("comdb2ma_tcache_size",
+                 "Maximum number of bytes cached by a thread. (Default: 262144)",
+                 TUNABLE_INTEGER, &gbl_comdb2ma_tcache_size, 0, NULL, NULL,
+                 NULL, NULL);
 REGISTER_TUNABLE("memnice", NULL, TUNABLE_INTEGER, &gbl_mem_nice,
                  READONLY | NOARG, NULL, NULL, memnice_update, NULL);
 REGISTER_TUNABLE("mempget_timeout", NULL, TUNABLE_INTEGER,
@@ -961,8 +970,21 @@ REGISTER_TUNABLE("osql_bkoff_netsend", NULL, TUNABLE_INTEGER,
                  &gbl_osql_bkoff_netsend, READONLY, NULL, NULL, NULL, NULL);
 REGISTER_TUNABLE("osql_bkoff_netsend_lmt", NULL, TUNABLE_INTEGER,
                  &gbl_osql_bkoff_netsend_lmt, READONLY, NULL, NULL, NULL, NULL);
+REGISTER_TUNABLE("osql_shadtbl_skiplist",
+                 "Keep the shadow tables of osql transactions in in-memory "
+                 "skiplists, up to temptable_skiplist_maxsz bytes each. "
+                 "(Default: on)",
+                 TUNABLE_BOOLEAN, &gbl_osql_shadtbl_skiplist, 0, NULL, NULL,
+                 NULL, NULL);
 REGISTER_TUNABLE("osqlprefaultthreads", "If set, send prefaulting hints to nodes. (Default: 0)", TUNABLE_INTEGER,
                  &gbl_osqlpfault_threads, READONLY, NULL, NULL, NULL, NULL);
+REGISTER_TUNABLE("osql_stream_bplog_threshold",
+                 "Dispatch a transaction to the block processor once this many "
+                 "of its ops reached the master, and apply the rest as they "
+                 "arrive instead of waiting for the commit. 0 disables "
+                 "streaming. (Default: 0)",
+                 TUNABLE_INTEGER, &gbl_osql_stream_bplog_threshold, 0, NULL,
+                 NULL, NULL, NULL);
 REGISTER_TUNABLE("osql_verify_ext_chk",
                  "For block transaction mode only - after this many verify "
                  "errors, check if transaction is non-commitable (see default "
@@ -1150,10 +1172,21 @@ REGISTER_TUNABLE("version_spfile", NULL, TUNABLE_STRING, &gbl_user_vers_spfile_n
 REGISTER_TUNABLE("timepartitions", NULL, TUNABLE_STRING,
                  &gbl_timepart_file_name, READONLY, NULL, NULL, file_update,
                  NULL);
-REGISTER_TUNABLE("sqlreadahead", NULL, TUNABLE_INTEGER, &gbl_sqlreadahead,
-                 READONLY, NULL, NULL, NULL, NULL);
-REGISTER_TUNABLE("sqlreadaheadthresh", NULL, TUNABLE_INTEGER,
-                 &gbl_sqlreadaheadthresh, READONLY, NULL, NULL, NULL, NULL);
+REGISTER_TUNABLE("sql_vectorized_agg",
+                 "Compute count, sum, total, avg, min and max over numeric columns of a single table scan "
+                 "on batches of rows.  (Default: off)",
+                 TUNABLE_BOOLEAN, &gbl_sql_vectorized_agg, 0, NULL, NULL, NULL, NULL);
+REGISTER_TUNABLE("sql_vectorized_agg_batch",
+                 "Number of rows per batch of the vectorized aggregation.  (Default: 4096)",
+                 TUNABLE_INTEGER, &gbl_sql_vectorized_agg_batch, 0, NULL, NULL, NULL, NULL);
+REGISTER_TUNABLE("sqlreadahead",
+                 "Maximum number of rows prefaulted ahead of a sequential sql cursor scan; needs "
+                 "prefaulthelperthreads.  0 disables.  (Default: 0)",
+                 TUNABLE_INTEGER, &gbl_sqlreadahead, 0, NULL, NULL, NULL, NULL);
+REGISTER_TUNABLE("sqlreadaheadthresh",
+                 "Number of consecutive moves in the same direction that make a sql cursor scan sequential.  "
+                 "(Default: 0)",
+                 TUNABLE_INTEGER, &gbl_sqlreadaheadthresh, 0, NULL, NULL, NULL, NULL);
 REGISTER_TUNABLE("sqlsortermem", "Maximum amount of memory to be "
                                  "allocated to the sqlite sorter. "
                                  "(Default: 314572800)",
@@ -2204,6 +2237,16 @@ REGISTER_TUNABLE("longreq_log_freq_sec",
 REGISTER_TUNABLE("eventlog_nkeep", "Keep this many eventlog files (Default: 2)",
                  TUNABLE_INTEGER, &eventlog_nkeep, 0, NULL, NULL, NULL, NULL);
 
+REGISTER_TUNABLE("eventlog_binary",
+                 "Write the event log in the compact binary format from a background "
+                 "thread; convert with cdb2_evtojson. (Default: off)",
+                 TUNABLE_BOOLEAN, &gbl_eventlog_binary, 0, NULL, NULL, NULL, NULL);
+
+REGISTER_TUNABLE("eventlog_ring_size",
+                 "Bytes of binary events a thread can queue for the event log writer "
+                 "before dropping them. (Default: 262144)",
+                 TUNABLE_INTEGER, &gbl_eventlog_ring_size, 0, NULL, NULL, NULL, NULL);
+
 REGISTER_TUNABLE("waitalive_iterations",
                  "Wait this many iterations for a "
                  "socket to be usable.  (Default: 3)",
@@ -2427,6 +2470,14 @@ REGISTER_TUNABLE("sc_logbytes_per_second",
                  "Throttle schema-changes to this many logbytes per second.  (Default: 10000000)",
                  TUNABLE_INTEGER, &gbl_sc_logbytes_per_second, EXPERIMENTAL | INTERNAL, NULL, NULL, NULL, NULL);
 
+REGISTER_TUNABLE("net_reader_policy",
+                 "Reader thread assignment for cluster connections: single, per_net, per_host or per_event. "
+                 "(Default: per_net)",
+                 TUNABLE_ENUM, NULL, READONLY, net_reader_policy_value, NULL, net_reader_policy_update, NULL);
+REGISTER_TUNABLE("net_writer_policy",
+                 "Writer thread assignment for cluster connections: single, per_net, per_host or per_event. "
+                 "per_event gives every connection a dedicated writer thread. (Default: per_host)",
+                 TUNABLE_ENUM, NULL, READONLY, net_writer_policy_value, NULL, net_writer_policy_update, NULL);
 REGISTER_TUNABLE("net_somaxconn",
                  "listen() backlog setting.  (Default: 0, implies system default)",
                  TUNABLE_INTEGER, &gbl_net_maxconn, READONLY, NULL, NULL, NULL, NULL);
@@ -2570,6 +2621,28 @@ REGISTER_TUNABLE("fdb_io_error_retries_phase_2_poll",
 REGISTER_TUNABLE("fdb_remsql_cdb2api",
                  "Switch the standalone remote sql queries to cdb2api",
                  TUNABLE_BOOLEAN, &gbl_fdb_remsql_cdb2api, 0, NULL, NULL, NULL, NULL);
+REGISTER_TUNABLE("fdb_rcache",
+                 "Cache the results of standalone remote sql reads, invalidated by remote table version and "
+                 "remote lsn changes.  (Default: off)",
+                 TUNABLE_BOOLEAN, &gbl_fdb_rcache, 0, NULL, NULL, NULL, NULL);
+REGISTER_TUNABLE("fdb_rcache_max_rows", "Do not cache remote results larger than this many rows.  (Default: 1000)",
+                 TUNABLE_INTEGER, &gbl_fdb_rcache_max_rows, 0, NULL, NULL, NULL, NULL);
+REGISTER_TUNABLE("fdb_rcache_max_bytes", "Size of the remote result cache, per remote db.  (Default: 64MB)",
+                 TUNABLE_INTEGER, &gbl_fdb_rcache_max_bytes, 0, NULL, NULL, NULL, NULL);
+REGISTER_TUNABLE("fdb_rcache_lsn_check_msec",
+                 "Check if the remote lsn advanced, invalidating cached remote results, at most this often.  "
+                 "(Default: 1000)",
+                 TUNABLE_INTEGER, &gbl_fdb_rcache_lsn_check_msec, 0, NULL, NULL, NULL, NULL);
+REGISTER_TUNABLE("fdb_remote_projection",
+                 "Only fetch the columns used by the query when scanning remote tables.  (Default: on)",
+                 TUNABLE_BOOLEAN, &gbl_fdb_remote_projection, 0, NULL, NULL, NULL, NULL);
+REGISTER_TUNABLE("fdb_prefetch_rows",
+                 "Read ahead remote table scans in pages of this many rows; 0 disables read ahead.  (Default: 0)",
+                 TUNABLE_INTEGER, &gbl_fdb_prefetch_rows, 0, NULL, NULL, NULL, NULL);
+REGISTER_TUNABLE("fdb_prefetch_pages", "Number of pages read ahead of a remote table scan.  (Default: 4)",
+                 TUNABLE_INTEGER, &gbl_fdb_prefetch_pages, 0, NULL, NULL, NULL, NULL);
+REGISTER_TUNABLE("fdb_prefetch_threads", "Maximum number of remote read ahead threads.  (Default: 16)",
+                 TUNABLE_INTEGER, &gbl_fdb_prefetch_threads, READONLY, NULL, NULL, NULL, NULL);
 REGISTER_TUNABLE("unexpected_last_type_warn",
                  "print a line of trace if the last response server sent before sockpool reset isn't LAST_ROW",
                  TUNABLE_INTEGER, &gbl_unexpected_last_type_warn, EXPERIMENTAL | INTERNAL, NULL, NULL, NULL, NULL);
@@ -2626,6 +2699,19 @@ REGISTER_TUNABLE(
     "partition_retroactively_start",
     "Block any retroactively time partitioning if start is earlier that that many hours in the future (Default: 24)",
     TUNABLE_INTEGER, &gbl_retro_tpt_start, 0, NULL, NULL, NULL, NULL);
+REGISTER_TUNABLE("timepart_freeze_shards",
+                 "Make time partition shards read-only once they are no longer current, and rebuild them with "
+                 "timepart_freeze_compr compression (Default: OFF)",
+                 TUNABLE_BOOLEAN, &gbl_timepart_freeze_shards, 0, NULL, NULL, NULL, NULL);
+REGISTER_TUNABLE("timepart_freeze_delay",
+                 "Seconds after a rollout before the previous shard is frozen (Default: 60)", TUNABLE_INTEGER,
+                 &gbl_timepart_freeze_delay, 0, NULL, NULL, NULL, NULL);
+REGISTER_TUNABLE("timepart_freeze_compr", "Record compression of frozen time partition shards (Default: zlib)",
+                 TUNABLE_ENUM, &gbl_timepart_freeze_compr, 0, init_with_compr_value, NULL,
+                 timepart_freeze_compr_update, NULL);
+REGISTER_TUNABLE("timepart_freeze_compr_blobs", "Blob compression of frozen time partition shards (Default: zlib)",
+                 TUNABLE_ENUM, &gbl_timepart_freeze_compr_blobs, 0, init_with_compr_value, NULL,
+                 timepart_freeze_compr_blobs_update, NULL);
 
 REGISTER_TUNABLE("dohsql_joins", "Enable to support joins in parallel sql execution (default: on)", TUNABLE_BOOLEAN,
                  &gbl_dohsql_joins, 0, NULL, NULL, NULL, NULL);
@@ -2701,6 +2787,10 @@ REGISTER_TUNABLE("prefer_non_blocking_coherency_check",
                  TUNABLE_BOOLEAN, &gbl_prefer_non_blocking_coherency_check, 0, NULL, NULL, NULL, NULL);
 REGISTER_TUNABLE("new_connection_grace_ms", "Time (in ms) before new connection is eligible for eviction (Default: 100ms)",
                  TUNABLE_INTEGER, &gbl_new_connection_grace_ms, INTERNAL, NULL, NULL, NULL, NULL);
+REGISTER_TUNABLE("newsql_mux",
+                 "Accept connections multiplexing many newsql sessions, as "
+                 "opened by cdb2sockpool -m. (Default: on)",
+                 TUNABLE_BOOLEAN, &gbl_newsql_mux, 0, NULL, NULL, NULL, NULL);
 REGISTER_TUNABLE("accept_headroom", "", TUNABLE_INTEGER, &gbl_accept_headroom, INTERNAL, NULL, NULL, NULL, NULL);
 #ifdef COMDB2_TEST
 REGISTER_TUNABLE("simpleauth", NULL, TUNABLE_BOOLEAN, &gbl_uses_simpleauth, NOARG | READEARLY, NULL, NULL, NULL, NULL);
@@ -2719,4 +2809,117 @@ REGISTER_TUNABLE("rep_verify_peer_hostname",
                  "only in environments without reliable reverse DNS. "
                  "(Default: off)",
                  TUNABLE_BOOLEAN, &gbl_rep_verify_peer_hostname, 0, NULL, NULL, NULL, NULL);
+REGISTER_TUNABLE("zonemap_rows",
+                 "Number of records of a data stripe summarized by each zone "
+                 "of a zone map. (Default: 8192)",
+                 TUNABLE_INTEGER, &gbl_zonemap_rows, NOZERO, NULL, NULL, NULL,
+                 NULL);
+REGISTER_TUNABLE("zonemap_summarize_interval",
+                 "Seconds between the passes of the master over the tables "
+                 "with zone maps. 0 stops summarizing. (Default: 10)",
+                 TUNABLE_INTEGER, &gbl_zonemap_summarize_interval, 0, NULL,
+                 NULL, NULL, NULL);
+REGISTER_TUNABLE("zonemap_max_column_size",
+                 "Columns larger than this many bytes are left out of zone "
+                 "maps. (Default: 64)",
+                 TUNABLE_INTEGER, &gbl_zonemap_max_column_size, NOZERO, NULL,
+                 NULL, NULL, NULL);
+REGISTER_TUNABLE("zonemap_scan",
+                 "Skip the zones of a table scan which cannot match its WHERE "
+                 "clause. (Default: on)",
+                 TUNABLE_BOOLEAN, &gbl_zonemap_scan, 0, NULL, NULL, NULL, NULL);
+REGISTER_TUNABLE("sql_exact_index_coverage",
+                 "Check the columns a statement reads when deciding whether "
+                 "an index covers it, for tables wider than 63 columns and "
+                 "indexes on expressions. (Default: on)",
+                 TUNABLE_BOOLEAN, &gbl_sql_exact_index_coverage, 0, NULL, NULL,
+                 NULL, NULL);
+REGISTER_TUNABLE("sql_sorter_query_threads",
+                 "Maximum number of sorter threads a single sort runs on, on "
+                 "top of the query thread. 0 sorts on the query thread only. "
+                 "(Default: 4)",
+                 TUNABLE_INTEGER, &gbl_sql_sorter_query_threads, 0, NULL, NULL,
+                 NULL, NULL);
+REGISTER_TUNABLE("sql_sorter_parallel_min_records",
+                 "Minimum number of records each thread of a parallel sort is "
+                 "given. (Default: 65536)",
+                 TUNABLE_INTEGER, &gbl_sql_sorter_parallel_min_records, NOZERO,
+                 NULL, NULL, NULL, NULL);
+REGISTER_TUNABLE("async_commit_ack",
+                 "Leave the replication wait of osql transactions, and the "
+                 "reply to the sql thread, to the commit ack thread so that "
+                 "the writer thread can take the next transaction. "
+                 "(Default: off)",
+                 TUNABLE_BOOLEAN, &gbl_async_commit_ack, 0, NULL, NULL, NULL,
+                 NULL);
+REGISTER_TUNABLE("async_commit_ack_max_pending",
+                 "Maximum number of commits waiting on the commit ack thread. "
+                 "Writers past this wait for replication themselves. "
+                 "(Default: 1000)",
+                 TUNABLE_INTEGER, &gbl_async_commit_ack_max_pending, NOZERO,
+                 NULL, NULL, NULL, NULL);
+REGISTER_TUNABLE("physrep_stream_batches",
+                 "Physical replicants read the log of their source in "
+                 "compressed batches from comdb2_transaction_log_batches, "
+                 "rather than a row per log record. (Default: off)",
+                 TUNABLE_BOOLEAN, &gbl_physrep_stream_batches, 0, NULL, NULL,
+                 NULL, NULL);
+REGISTER_TUNABLE("physrep_batch_bytes",
+                 "Size of the log batches physical replicants ask for. "
+                 "(Default: 1048576)",
+                 TUNABLE_INTEGER, &gbl_physrep_batch_bytes, NOZERO, NULL, NULL,
+                 NULL, NULL);
+REGISTER_TUNABLE("physrep_batch_queue",
+                 "Number of log batches a physical replicant receives ahead "
+                 "of the one it applies. (Default: 16)",
+                 TUNABLE_INTEGER, &gbl_physrep_batch_queue, NOZERO, NULL, NULL,
+                 NULL, NULL);
+REGISTER_TUNABLE("changed_page_tracking",
+                 "Keep a bitmap of the pages written to each file since the "
+                 "last incremental backup, so that the next one only reads "
+                 "those. (Default: off)",
+                 TUNABLE_BOOLEAN, &gbl_changed_page_tracking, 0, NULL, NULL,
+                 NULL, NULL);
+REGISTER_TUNABLE("sql_mem_accounting",
+                 "Charge the memory a query allocates from the sqlite heap, "
+                 "lua and in-memory temp tables to the query. (Default: on)",
+                 TUNABLE_BOOLEAN, &gbl_sql_mem_accounting, 0, NULL, NULL,
+                 NULL, NULL);
+REGISTER_TUNABLE("sql_mem_budget_mb",
+                 "Memory the queries running at once may use. A query which "
+                 "does not fit waits, then is rejected. 0 to disable. "
+                 "(Default: 0)",
+                 TUNABLE_INTEGER, &gbl_sql_mem_budget_mb, 0, NULL, NULL,
+                 NULL, NULL);
+REGISTER_TUNABLE("sql_mem_admission_wait_ms",
+                 "How long a query waits to fit in sql_mem_budget_mb before "
+                 "it is rejected. (Default: 1000)",
+                 TUNABLE_INTEGER, &gbl_sql_mem_admission_wait_ms, 0, NULL,
+                 NULL, NULL, NULL);
+REGISTER_TUNABLE("sql_mem_default_estimate_kb",
+                 "Memory reserved for a query whose fingerprint has not run "
+                 "before. (Default: 1024)",
+                 TUNABLE_INTEGER, &gbl_sql_mem_default_estimate_kb, 0, NULL,
+                 NULL, NULL, NULL);
+REGISTER_TUNABLE("sql_result_cache_mb",
+                 "Memory for the results of read-only queries, written back "
+                 "to clients running them again while the tables they read "
+                 "are unchanged. 0 to disable. (Default: 0)",
+                 TUNABLE_INTEGER, &gbl_sql_rcache_mb, 0, NULL, NULL,
+                 sql_rcache_mb_update, NULL);
+REGISTER_TUNABLE("sql_result_cache_max_entry_kb",
+                 "Do not cache query results larger than this. "
+                 "(Default: 1024)",
+                 TUNABLE_INTEGER, &gbl_sql_rcache_max_entry_kb, 0, NULL,
+                 NULL, NULL, NULL);
+REGISTER_TUNABLE("sql_result_cache_tables",
+                 "Comma separated list of the tables whose queries are "
+                 "cached, or * for all tables. (Default: none)",
+                 TUNABLE_STRING, &gbl_sql_rcache_tables, 0, NULL, NULL,
+                 sql_rcache_list_update, NULL);
+REGISTER_TUNABLE("sql_result_cache_fingerprints",
+                 "Comma separated list of the fingerprints of the queries "
+                 "which are cached. (Default: none)",
+                 TUNABLE_STRING, &gbl_sql_rcache_fingerprints, 0, NULL, NULL,
+                 sql_rcache_list_update, NULL);
 #endif /* _DB_TUNABLES_H */
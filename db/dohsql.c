@@ -73,6 +73,7 @@ struct dohsql_connector {
     int nparams;            /* parameters for the child */
     struct param_data *params;
     dohsql_connector_stats_t stats;
+    comdb2ma_acct *mem_acct; /* memory account of the parent query */
 };
 typedef struct dohsql_connector dohsql_connector_t;
 
@@ -196,6 +197,9 @@ static void sqlengine_work_shard(struct thdpool *pool, void *work,
 
     thr_set_user("shard thread", (intptr_t) clnt->appsock_id);
 
+    /* charge what the shard allocates to the parent query */
+    comdb2ma_acct_set(((dohsql_connector_t *)clnt->plugin.state)->mem_acct);
+
     rdlock_schema_lk();
     sqlengine_prepare_engine(thd, clnt, 0);
     unlock_schema_lk();
@@ -205,6 +209,7 @@ static void sqlengine_work_shard(struct thdpool *pool, void *work,
     rc = get_curtran(thedb->bdb_env, clnt);
     if (rc) {
         handle_child_error(clnt, rc);
+        comdb2ma_acct_set(NULL);
         return;
     }
 
@@ -246,6 +251,8 @@ static void sqlengine_work_shard(struct thdpool *pool, void *work,
 
     /*thrman_setid(thrman_self(), "[done]");*/
 
+    comdb2ma_acct_set(NULL);
+
     /* after this clnt is toast */
     _mark_shard_done(clnt->plugin.state);
 }
@@ -288,6 +295,7 @@ static void trimQue(dohsql_connector_t *conn, sqlite3_stmt *stmt,
                    que == conn->que ? "que" : "que_free", que, row_size, limit);
         free(row->packed);
         free(row);
+        comdb2ma_acct_charge(-(int64_t)(sizeof(row_t) + row_size));
 
         if (gbl_dohsql_max_queued_kb_highwm) {
             conn->queue_size -= row_size;
@@ -422,6 +430,8 @@ static int inner_row(struct sqlclntstate *clnt, struct response_data *resp,
         return SHARD_ERR_GENERIC;
     }
 
+    comdb2ma_acct_charge(sizeof(row_t) + row->row_size);
+
     Pthread_mutex_lock(&conn->mtx);
     conn->rc = SQLITE_ROW;
     if (queue_add(conn->que, row))
@@ -1035,6 +1045,7 @@ static int _shard_connect(struct sqlclntstate *clnt, dohsql_connector_t *conn,
     memcpy(conn->clnt->tzname, clnt->tzname, sizeof(clnt->tzname));
     make_dohsql_plugin(conn->clnt);
     conn->clnt->plugin.state = conn;
+    conn->mem_acct = &clnt->mem.acct;
     where = thrman_get_where(thrman_self());
     conn->thr_where = strdup(where ? where : "");
     conn->nparams = nparams;
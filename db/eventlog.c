@@ -22,6 +22,8 @@
 #include <unistd.h>
 #include <stddef.h>
 #include <sys/time.h>
+#include <sys/stat.h>
+#include <poll.h>
 #include <inttypes.h>
 #include <dirent.h>
 #include <bb_oscompat.h>
@@ -43,6 +45,8 @@
 #include "cson.h"
 #include "comdb2_atomic.h"
 #include "string_ref.h"
+#include "eventlog_bin.h"
+#include "thread_util.h"
 
 #include <carray.h>
 
@@ -64,7 +68,15 @@ static int eventlog_every_n = 1;
 static int64_t eventlog_count = 0;
 static int eventlog_debug_events = 0;
 
+int gbl_eventlog_binary = 0;
+int gbl_eventlog_ring_size = 256 * 1024;
+static int eventlog_is_binary = 0;  /* format of the open file */
+static int64_t eventlog_file_gen = 0; /* bumped on every close */
+static int64_t eventlog_dropped = 0;
+static int eventlog_writer_started = 0;
+
 static void eventlog_roll(void);
+static void eventlog_bin_drain_locked(int *call_roll_cleanup);
 
 struct sqltrack {
     char fingerprint[FINGERPRINTSZ];
@@ -98,12 +110,14 @@ static void eventlog_roll_cleanup()
     int ret = snprintf(eventflstok, sizeof(eventflstok), "%s.events.", thedb->envname);
     if (ret >= sizeof(eventflstok)) {
         logmsg(LOGMSG_ERROR, "eventlog_roll_cleanup: File name token truncated to %s\n", eventflstok);
-        abort();
+        return;
     }
 
     char *dname = comdb2_location("eventlog", NULL);
-    if (dname == NULL)
-        abort();
+    if (dname == NULL) {
+        logmsg(LOGMSG_ERROR, "%s: no eventlog location\n", __func__);
+        return;
+    }
 
     int cnt = 100;
     int num = 0;
@@ -152,6 +166,8 @@ static gzFile eventlog_open(char *fname, int append)
 {
     gbl_eventlog_fname = fname;
     const char *mode = append ? "2a" : "2w";
+    struct stat st;
+    int empty = !append || stat(fname, &st) != 0 || st.st_size == 0;
     gzFile f = gzopen(fname, mode);
     if (f == NULL) {
         logmsg(LOGMSG_ERROR, "Failed to open log file = %s\n", fname);
@@ -160,6 +176,14 @@ static gzFile eventlog_open(char *fname, int append)
         return NULL;
     }
     gbl_eventlog_fname = fname;
+    eventlog_is_binary = gbl_eventlog_binary;
+    if (eventlog_is_binary) {
+        /* the writer thread hands zlib large blocks; let it deflate them in
+         * one go */
+        gzbuffer(f, 1024 * 1024);
+        if (empty)
+            gzwrite(f, EVENTLOG_BIN_MAGIC, EVENTLOG_BIN_MAGIC_LEN);
+    }
     return f;
 }
 
@@ -169,6 +193,7 @@ static void eventlog_close(void)
     gzclose(eventlog);
     eventlog = NULL;
     bytes_written = 0;
+    eventlog_file_gen++;
     struct sqltrack *t = listc_rtl(&sql_statements);
     while (t) {
         hash_del(seen_sql, t);
@@ -606,6 +631,776 @@ static inline void add_to_fingerprints(const struct reqlogger *logger)
     }
 }
 
+/*
+ * Binary event log (eventlog_binary).
+ *
+ * A SQL thread encodes its event in the format of eventlog_bin.h into a
+ * ring of its own, without taking eventlog_lk.  A writer thread drains all
+ * rings, tracks which statements the current file has a "newsql" event for,
+ * and hands zlib large blocks.  When a ring stays full, events are dropped
+ * and counted rather than stalling the query.  Events of one thread keep
+ * their order; events of different threads may be interleaved differently
+ * than their end times.  cdb2_evtojson turns a binary file back into the
+ * JSON event log.
+ */
+
+#define EVENTLOG_BIN_BLOCK (1024 * 1024)
+
+/* ring record kinds */
+#define EVR_EVENT 'E' /* encoded event */
+#define EVR_SQL 'Q'   /* fingerprint, time, [sql], encoded event */
+
+struct evbuf {
+    uint8_t *buf;
+    size_t len;
+    size_t cap;
+    int failed; /* an append did not fit; the contents are incomplete */
+};
+
+static int evb_reserve(struct evbuf *b, size_t n)
+{
+    if (b->failed)
+        return -1;
+    if (b->len + n <= b->cap)
+        return 0;
+    size_t cap = b->cap ? b->cap : 1024;
+    while (cap < b->len + n)
+        cap *= 2;
+    uint8_t *buf = realloc(b->buf, cap);
+    if (buf == NULL) {
+        b->failed = 1;
+        return -1;
+    }
+    b->buf = buf;
+    b->cap = cap;
+    return 0;
+}
+
+static inline void evb_reset(struct evbuf *b)
+{
+    b->len = 0;
+    b->failed = 0;
+}
+
+static void evb_bytes(struct evbuf *b, const void *p, size_t n)
+{
+    if (evb_reserve(b, n))
+        return;
+    memcpy(b->buf + b->len, p, n);
+    b->len += n;
+}
+
+static void evb_tag(struct evbuf *b, uint8_t tag)
+{
+    if (evb_reserve(b, 1))
+        return;
+    b->buf[b->len++] = tag;
+}
+
+static void evb_varint(struct evbuf *b, uint64_t v)
+{
+    if (evb_reserve(b, EVB_VARINT_MAX))
+        return;
+    b->len += evb_put_varint(b->buf + b->len, v);
+}
+
+static void evb_key(struct evbuf *b, const char *key)
+{
+    size_t n = strlen(key);
+    evb_varint(b, n);
+    evb_bytes(b, key, n);
+}
+
+static void evb_int(struct evbuf *b, int64_t v)
+{
+    evb_tag(b, EVB_INT);
+    evb_varint(b, evb_zigzag(v));
+}
+
+static void evb_double(struct evbuf *b, double v)
+{
+    uint64_t bits;
+    uint8_t le[8];
+    memcpy(&bits, &v, sizeof(bits));
+    for (int i = 0; i < 8; ++i)
+        le[i] = bits >> (8 * i);
+    evb_tag(b, EVB_DOUBLE);
+    evb_bytes(b, le, sizeof(le));
+}
+
+static void evb_str(struct evbuf *b, const char *s, size_t n)
+{
+    evb_tag(b, EVB_STRING);
+    evb_varint(b, n);
+    evb_bytes(b, s, n);
+}
+
+static void evb_cstr(struct evbuf *b, const char *s)
+{
+    evb_str(b, s, strlen(s));
+}
+
+static void evb_json(struct evbuf *b, const void *json, size_t n)
+{
+    evb_tag(b, EVB_JSON);
+    evb_varint(b, n);
+    evb_bytes(b, json, n);
+}
+
+static void evb_hex(struct evbuf *b, const char *bytes, int len)
+{
+    char hex[2 * len + 1];
+    util_tohex(hex, bytes, len);
+    evb_str(b, hex, 2 * len);
+}
+
+#define evb_begin_object(b) evb_tag(b, EVB_OBJECT)
+#define evb_end_object(b) evb_varint(b, 0)
+#define evb_begin_array(b) evb_tag(b, EVB_ARRAY)
+#define evb_end_array(b) evb_tag(b, EVB_ARRAY_END)
+
+/* Same members, in the same order, as populate_obj() */
+static void populate_bin(struct evbuf *b, const struct reqlogger *logger)
+{
+    evb_begin_object(b);
+    evb_key(b, "time");
+    evb_int(b, logger->startus);
+    if (logger->event_type != EV_UNSET) {
+        evb_key(b, "type");
+        evb_cstr(b, ev_str[logger->event_type]);
+    }
+
+    if (logger->sql_ref && eventlog_detailed) {
+        evb_key(b, "sql");
+        evb_str(b, string_ref_cstr(logger->sql_ref), string_ref_len(logger->sql_ref));
+        if (logger->bound_param_cson) {
+            cson_buffer params;
+            cson_output_buffer(logger->bound_param_cson, &params);
+            evb_key(b, "bound_parameters");
+            evb_json(b, params.mem, params.used);
+        }
+    }
+
+    snap_uid_t snap, *p = NULL;
+    if (logger->iq && IQ_HAS_SNAPINFO(logger->iq))
+        p = IQ_SNAPINFO(logger->iq);
+    else if (logger->clnt && get_cnonce(logger->clnt, &snap) == 0)
+        p = &snap;
+    if (p) {
+        evb_key(b, "cnonce");
+        if (gbl_print_cnonce_as_hex)
+            evb_hex(b, p->key, p->keylen);
+        else
+            evb_str(b, p->key, p->keylen);
+    }
+
+    if (logger->have_id) {
+        evb_key(b, "id");
+        evb_cstr(b, logger->id);
+    }
+    if (logger->sqlcost) {
+        evb_key(b, "cost");
+        evb_double(b, logger->sqlcost);
+    }
+    if (logger->sqlrows) {
+        evb_key(b, "rows");
+        evb_int(b, logger->sqlrows);
+    }
+    if (logger->vreplays) {
+        evb_key(b, "replays");
+        evb_int(b, logger->vreplays);
+    }
+
+    if (logger->error) {
+        evb_key(b, "rc");
+        evb_int(b, logger->rc);
+        evb_key(b, "error_code");
+        evb_int(b, logger->error_code);
+        evb_key(b, "error");
+        evb_cstr(b, logger->error);
+        if (logger->iq && logger->iq->retries > 0) {
+            evb_key(b, "deadlockretries");
+            evb_int(b, logger->iq->retries);
+        }
+    }
+
+    evb_key(b, "host");
+    evb_cstr(b, logger->origin);
+
+    if (logger->have_fingerprint) {
+        evb_key(b, "fingerprint");
+        evb_hex(b, logger->fingerprint, FINGERPRINTSZ);
+    }
+
+    if (logger->clnt) {
+        uint64_t clientstarttime = get_client_starttime(logger->clnt);
+        if (clientstarttime && logger->startus > clientstarttime) {
+            evb_key(b, "startlag");
+            evb_int(b, logger->startus - clientstarttime);
+        }
+        int clientretries = get_client_retries(logger->clnt);
+        if (clientretries > 0) {
+            evb_key(b, "clientretries");
+            evb_int(b, clientretries);
+        }
+        evb_key(b, "connid");
+        evb_int(b, logger->clnt->connid);
+        evb_key(b, "pid");
+        evb_int(b, logger->clnt->last_pid);
+        if (logger->clnt->argv0) {
+            evb_key(b, "client");
+            evb_cstr(b, logger->clnt->argv0);
+        }
+    }
+
+    if (logger->nwrites > 0) {
+        evb_key(b, "nwrites");
+        evb_int(b, logger->nwrites);
+    }
+    if (logger->cascaded_nwrites > 0) {
+        evb_key(b, "casc_nwrites");
+        evb_int(b, logger->cascaded_nwrites);
+    }
+
+    if (logger->ncontext > 0) {
+        evb_key(b, "context");
+        evb_begin_array(b);
+        for (int i = 0; i < logger->ncontext; i++)
+            evb_cstr(b, logger->context[i]);
+        evb_end_array(b);
+    }
+
+    const struct berkdb_thread_stats *thread_stats = bdb_get_thread_stats();
+    evb_key(b, "perf");
+    evb_begin_object(b);
+    evb_key(b, "tottime");
+    evb_int(b, logger->durationus);
+    evb_key(b, "processingtime");
+    evb_int(b, logger->durationus - logger->queuetimeus);
+    if (logger->netwaitus) {
+        evb_key(b, "netwaitus");
+        evb_int(b, logger->netwaitus);
+    }
+    if (logger->queuetimeus) {
+        evb_key(b, "qtime");
+        evb_int(b, logger->queuetimeus);
+    }
+    if (thread_stats->n_lock_waits) {
+        evb_key(b, "lockwaits");
+        evb_int(b, thread_stats->n_lock_waits);
+        evb_key(b, "lockwaittime");
+        evb_int(b, thread_stats->lock_wait_time_us);
+    }
+    if (thread_stats->n_preads) {
+        evb_key(b, "reads");
+        evb_int(b, thread_stats->n_preads);
+        evb_key(b, "readtime");
+        evb_int(b, thread_stats->pread_time_us);
+    }
+    if (thread_stats->n_pwrites) {
+        evb_key(b, "writes");
+        evb_int(b, thread_stats->n_pwrites);
+        evb_key(b, "writetime");
+        evb_int(b, thread_stats->pwrite_time_us);
+    }
+    evb_end_object(b);
+
+    if (logger->ntables > 0) {
+        evb_key(b, "tables");
+        evb_begin_array(b);
+        for (int i = 0; i < logger->ntables; i++)
+            evb_cstr(b, logger->sqltables[i]);
+        evb_end_array(b);
+    }
+
+    if (logger->path && logger->path->n_components > 0) {
+        evb_key(b, "path");
+        evb_begin_array(b);
+        for (int i = 0; i < logger->path->n_components; i++) {
+            struct client_query_path_component *c = &logger->path->path_stats[i];
+            evb_begin_object(b);
+            if (c->table[0]) {
+                evb_key(b, "table");
+                evb_cstr(b, c->table);
+            }
+            if (c->ix != -1) {
+                evb_key(b, "index");
+                evb_int(b, c->ix);
+            }
+            if (c->nfind) {
+                evb_key(b, "find");
+                evb_int(b, c->nfind);
+            }
+            if (c->nnext) {
+                evb_key(b, "next");
+                evb_int(b, c->nnext);
+            }
+            if (c->nwrite) {
+                evb_key(b, "write");
+                evb_int(b, c->nwrite);
+            }
+            evb_end_object(b);
+        }
+        evb_end_array(b);
+    }
+    evb_end_object(b);
+}
+
+/* Single producer (the owning thread), single consumer (the writer) */
+struct evring {
+    uint8_t *buf;
+    uint64_t mask;
+    uint64_t head; /* bytes produced */
+    uint64_t tail; /* bytes consumed */
+    int orphaned;  /* owning thread exited */
+    LINKC_T(struct evring) lnk;
+};
+
+struct evthread {
+    struct evring *ring;
+    hash_t *seen_fp; /* fingerprints whose sql was handed to the writer */
+    int64_t sql_epoch; /* evsql_epoch seen_fp is valid for */
+    struct evbuf enc;
+};
+
+/* statements known to the writer */
+struct evsql {
+    char fingerprint[FINGERPRINTSZ];
+    int64_t gen; /* file the newsql event was written to */
+    size_t len;
+    char sql[1];
+};
+
+#define EVTHREAD_MAX_SEEN 10000
+#define EVSQL_MAX 100000
+
+static LISTC_T(struct evring) evrings;
+static pthread_mutex_t evrings_lk = PTHREAD_MUTEX_INITIALIZER;
+static pthread_mutex_t evwriter_lk = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t evwriter_cond = PTHREAD_COND_INITIALIZER;
+static int evwriter_kick = 0;
+static pthread_once_t evwriter_once = PTHREAD_ONCE_INIT;
+static pthread_key_t evthread_key;
+static hash_t *evsql_hash;
+static int64_t evsql_hash_gen; /* file the hash was last pruned for */
+/* bumped whenever the writer forgets statements, so that the threads
+ * hand their sql over again */
+static int64_t evsql_epoch;
+
+static void evring_copy_in(struct evring *r, uint64_t pos, const void *src, size_t n)
+{
+    size_t off = pos & r->mask;
+    size_t first = min(n, r->mask + 1 - off);
+    memcpy(r->buf + off, src, first);
+    memcpy(r->buf, (const uint8_t *)src + first, n - first);
+}
+
+static void evring_copy_out(struct evring *r, uint64_t pos, void *dst, size_t n)
+{
+    size_t off = pos & r->mask;
+    size_t first = min(n, r->mask + 1 - off);
+    memcpy(dst, r->buf + off, first);
+    memcpy((uint8_t *)dst + first, r->buf, n - first);
+}
+
+static void eventlog_writer_wakeup(void)
+{
+    Pthread_mutex_lock(&evwriter_lk);
+    evwriter_kick = 1;
+    Pthread_cond_signal(&evwriter_cond);
+    Pthread_mutex_unlock(&evwriter_lk);
+}
+
+/* Returns 0 if the record was queued, non-0 if it was dropped */
+static int evring_put(struct evring *r, const void *rec, uint32_t len)
+{
+    uint64_t size = r->mask + 1;
+    uint64_t need = sizeof(len) + len;
+    uint64_t tail;
+
+    if (need > size)
+        goto drop;
+    for (int i = 0;; ++i) {
+        tail = ATOMIC_LOAD64(r->tail);
+        if (r->head + need - tail <= size)
+            break;
+        if (i == 10)
+            goto drop;
+        if (i == 0)
+            eventlog_writer_wakeup();
+        poll(NULL, 0, 1);
+    }
+    evring_copy_in(r, r->head, &len, sizeof(len));
+    evring_copy_in(r, r->head + sizeof(len), rec, len);
+    uint64_t head = r->head + need;
+    XCHANGE64(r->head, head);
+    if (head - tail > size / 2)
+        eventlog_writer_wakeup();
+    return 0;
+
+drop:
+    ATOMIC_ADD64(eventlog_dropped, 1);
+    return 1;
+}
+
+static int evthread_free_fp(void *obj, void *arg)
+{
+    free(obj);
+    return 0;
+}
+
+static void evthread_free(void *p)
+{
+    struct evthread *t = p;
+    XCHANGE32(t->ring->orphaned, 1);
+    hash_for(t->seen_fp, evthread_free_fp, NULL);
+    hash_free(t->seen_fp);
+    free(t->enc.buf);
+    free(t);
+}
+
+static struct evthread *evthread_get(void)
+{
+    struct evthread *t = pthread_getspecific(evthread_key);
+    if (t)
+        return t;
+
+    uint64_t size = 64 * 1024;
+    while (size < gbl_eventlog_ring_size)
+        size *= 2;
+    struct evring *r = calloc(1, sizeof(struct evring));
+    t = calloc(1, sizeof(struct evthread));
+    if (r == NULL || t == NULL || (r->buf = malloc(size)) == NULL) {
+        free(r);
+        free(t);
+        return NULL;
+    }
+    r->mask = size - 1;
+    t->ring = r;
+    t->seen_fp = hash_init_o(0, FINGERPRINTSZ);
+    Pthread_setspecific(evthread_key, t);
+
+    Pthread_mutex_lock(&evrings_lk);
+    listc_abl(&evrings, r);
+    Pthread_mutex_unlock(&evrings_lk);
+    return t;
+}
+
+static void evthread_forget_fp(struct evthread *t, const char *fingerprint)
+{
+    char *fp = hash_find(t->seen_fp, fingerprint);
+    if (fp) {
+        hash_del(t->seen_fp, fp);
+        free(fp);
+    }
+}
+
+static int evsql_forget_older(void *obj, void *arg)
+{
+    struct evsql *s = obj;
+    if (s->gen < *(int64_t *)arg) {
+        hash_del(evsql_hash, s);
+        free(s);
+    }
+    return 0;
+}
+
+/* Forgets the statements last logged before file generation gen */
+static void evsql_forget(int64_t gen)
+{
+    int n = hash_get_num_entries(evsql_hash);
+    hash_for(evsql_hash, evsql_forget_older, &gen);
+    if (hash_get_num_entries(evsql_hash) != n)
+        ATOMIC_ADD64(evsql_epoch, 1);
+}
+
+/* Writer side of an EVR_SQL record: remember the statement, and return a
+ * newsql event for it if the current file does not have one yet. */
+static const uint8_t *eventlog_bin_newsql(const uint8_t *p, const uint8_t *end,
+                                          struct evbuf *newsql)
+{
+    const char *fingerprint = (const char *)p;
+    uint64_t time = 0, len = 0;
+    int has_sql;
+
+    p += FINGERPRINTSZ;
+    p += evb_get_varint(p, end - p, &time);
+    has_sql = *p++;
+
+    struct evsql *s = hash_find(evsql_hash, fingerprint);
+    if (has_sql) {
+        p += evb_get_varint(p, end - p, &len);
+        if (s == NULL) {
+            if (hash_get_num_entries(evsql_hash) >= EVSQL_MAX)
+                evsql_forget(INT64_MAX);
+            s = malloc(offsetof(struct evsql, sql) + len + 1);
+            if (s) {
+                memcpy(s->fingerprint, fingerprint, FINGERPRINTSZ);
+                s->gen = -1;
+                s->len = len;
+                memcpy(s->sql, p, len);
+                s->sql[len] = 0;
+                hash_add(evsql_hash, s);
+            } else {
+                /* have the threads send it again */
+                ATOMIC_ADD64(evsql_epoch, 1);
+            }
+        }
+        p += len;
+    }
+
+    evb_reset(newsql);
+    if (s == NULL || s->gen == eventlog_file_gen)
+        return p;
+
+    evb_begin_object(newsql);
+    evb_key(newsql, "time");
+    evb_int(newsql, time);
+    evb_key(newsql, "type");
+    evb_cstr(newsql, "newsql");
+    if (s->len) {
+        evb_key(newsql, "sql");
+        evb_str(newsql, s->sql, s->len);
+    }
+    evb_key(newsql, "fingerprint");
+    evb_hex(newsql, s->fingerprint, FINGERPRINTSZ);
+    evb_end_object(newsql);
+    if (newsql->failed)
+        evb_reset(newsql);
+    else
+        s->gen = eventlog_file_gen;
+    return p;
+}
+
+static void eventlog_bin_write(struct evbuf *block)
+{
+    if (block->len == 0)
+        return;
+    write_json(eventlog, block->buf, block->len);
+    block->len = 0;
+}
+
+static void eventlog_bin_frame(struct evbuf *block, const void *p, size_t n)
+{
+    size_t len = block->len;
+    evb_varint(block, n);
+    evb_bytes(block, p, n);
+    if (block->failed) {
+        /* drop the event, keep the ones already framed */
+        block->len = len;
+        block->failed = 0;
+        ATOMIC_ADD64(eventlog_dropped, 1);
+        return;
+    }
+    if (block->len >= EVENTLOG_BIN_BLOCK)
+        eventlog_bin_write(block);
+}
+
+/* Drains every ring into the event log file, or discards the events if
+ * there is nowhere to write them.  Must be called holding eventlog_lk. */
+static void eventlog_bin_drain_locked(int *call_roll_cleanup)
+{
+    static struct evbuf block, rec, newsql;
+    struct evring *r, *tmp;
+
+    if (!eventlog_writer_started)
+        return;
+
+    int write = eventlog != NULL && eventlog_enabled;
+    if (write && !eventlog_is_binary) {
+        if (gbl_eventlog_binary) {
+            eventlog_roll();
+            *call_roll_cleanup = 1;
+            write = eventlog != NULL;
+        } else {
+            /* switched back to json; what is left has nowhere to go */
+            write = 0;
+        }
+    }
+    if (write && eventlog_rollat > 0 && bytes_written > eventlog_rollat) {
+        eventlog_roll();
+        *call_roll_cleanup = 1;
+        write = eventlog != NULL;
+    }
+    /* keep the statements seen in the file just closed, they are
+     * likely to be logged again */
+    if (evsql_hash_gen != eventlog_file_gen) {
+        evsql_forget(eventlog_file_gen - 1);
+        evsql_hash_gen = eventlog_file_gen;
+    }
+
+    Pthread_mutex_lock(&evrings_lk);
+    LISTC_FOR_EACH_SAFE(&evrings, r, tmp, lnk)
+    {
+        uint64_t head = ATOMIC_LOAD64(r->head);
+        uint64_t tail = r->tail;
+        while (tail < head) {
+            uint32_t len;
+            evring_copy_out(r, tail, &len, sizeof(len));
+            evb_reset(&rec);
+            if (evb_reserve(&rec, len)) {
+                tail += sizeof(len) + len;
+                ATOMIC_ADD64(eventlog_dropped, 1);
+                continue;
+            }
+            evring_copy_out(r, tail + sizeof(len), rec.buf, len);
+            tail += sizeof(len) + len;
+
+            const uint8_t *p = rec.buf + 1;
+            const uint8_t *end = rec.buf + len;
+            evb_reset(&newsql);
+            /* statements are tracked even when not writing, the threads
+             * will not send them again */
+            if (rec.buf[0] == EVR_SQL)
+                p = eventlog_bin_newsql(p, end, &newsql);
+            if (!write)
+                continue;
+            if (newsql.len)
+                eventlog_bin_frame(&block, newsql.buf, newsql.len);
+            eventlog_bin_frame(&block, p, end - p);
+        }
+        XCHANGE64(r->tail, tail);
+        if (ATOMIC_LOAD32(r->orphaned) && tail == ATOMIC_LOAD64(r->head)) {
+            listc_rfl(&evrings, r);
+            free(r->buf);
+            free(r);
+        }
+    }
+    Pthread_mutex_unlock(&evrings_lk);
+
+    if (write)
+        eventlog_bin_write(&block);
+}
+
+static void *eventlog_writer_thread(void *arg)
+{
+    comdb2_name_thread(__func__);
+    thread_started("eventlog writer");
+
+    while (1) {
+        struct timespec ts;
+        clock_gettime(CLOCK_REALTIME, &ts);
+        ts.tv_nsec += 100 * 1000 * 1000;
+        if (ts.tv_nsec >= 1000000000) {
+            ts.tv_sec++;
+            ts.tv_nsec -= 1000000000;
+        }
+        Pthread_mutex_lock(&evwriter_lk);
+        if (!evwriter_kick)
+            pthread_cond_timedwait(&evwriter_cond, &evwriter_lk, &ts);
+        evwriter_kick = 0;
+        Pthread_mutex_unlock(&evwriter_lk);
+
+        int call_roll_cleanup = 0;
+        Pthread_mutex_lock(&eventlog_lk);
+        eventlog_bin_drain_locked(&call_roll_cleanup);
+        Pthread_mutex_unlock(&eventlog_lk);
+        if (call_roll_cleanup)
+            eventlog_roll_cleanup();
+    }
+    return NULL;
+}
+
+static void eventlog_writer_start(void)
+{
+    pthread_t tid;
+    listc_init(&evrings, offsetof(struct evring, lnk));
+    evsql_hash = hash_init_o(offsetof(struct evsql, fingerprint), FINGERPRINTSZ);
+    Pthread_key_create(&evthread_key, evthread_free);
+    Pthread_create(&tid, &gbl_pthread_attr_detached, eventlog_writer_thread, NULL);
+    eventlog_writer_started = 1;
+}
+
+static void eventlog_bin_put(struct evthread *t, const char *fingerprint)
+{
+    int rc;
+    if (t->enc.failed) {
+        /* could not encode it */
+        ATOMIC_ADD64(eventlog_dropped, 1);
+        rc = 1;
+    } else {
+        rc = evring_put(t->ring, t->enc.buf, t->enc.len);
+    }
+    if (rc != 0 && fingerprint)
+        evthread_forget_fp(t, fingerprint);
+}
+
+static void eventlog_add_binary(const struct reqlogger *logger)
+{
+    pthread_once(&evwriter_once, eventlog_writer_start);
+    struct evthread *t = evthread_get();
+    if (t == NULL) {
+        ATOMIC_ADD64(eventlog_dropped, 1);
+        return;
+    }
+
+    struct evbuf *b = &t->enc;
+    const char *fingerprint = NULL;
+    int isSqlErr = logger->error && logger->sql_ref;
+    evb_reset(b);
+    if (EV_SQL == logger->event_type || isSqlErr) {
+        evb_tag(b, EVR_SQL);
+        evb_bytes(b, logger->fingerprint, FINGERPRINTSZ);
+        evb_varint(b, logger->startus);
+        int64_t epoch = ATOMIC_LOAD64(evsql_epoch);
+        if (t->sql_epoch != epoch ||
+            hash_get_num_entries(t->seen_fp) >= EVTHREAD_MAX_SEEN) {
+            hash_for(t->seen_fp, evthread_free_fp, NULL);
+            hash_clear(t->seen_fp);
+            t->sql_epoch = epoch;
+        }
+        if (hash_find(t->seen_fp, logger->fingerprint)) {
+            evb_tag(b, 0);
+        } else {
+            char *fp = malloc(FINGERPRINTSZ);
+            if (fp) {
+                memcpy(fp, logger->fingerprint, FINGERPRINTSZ);
+                hash_add(t->seen_fp, fp);
+                fingerprint = fp;
+            }
+
+            evb_tag(b, 1);
+            if (logger->sql_ref) {
+                evb_varint(b, string_ref_len(logger->sql_ref));
+                evb_bytes(b, string_ref_cstr(logger->sql_ref), string_ref_len(logger->sql_ref));
+            } else {
+                evb_varint(b, 0);
+            }
+        }
+    } else {
+        evb_tag(b, EVR_EVENT);
+    }
+    populate_bin(b, logger);
+    eventlog_bin_put(t, fingerprint);
+
+    if (eventlog_verbose) {
+        cson_value *val = cson_value_new_object();
+        populate_obj(cson_value_get_object(val), logger);
+        cson_output_FILE(val, stdout);
+        cson_value_free(val);
+    } else if (logger->sql_ref && eventlog_detailed && logger->bound_param_cson) {
+        /* populate_obj() hands these to the event it builds */
+        cson_value_free(logger->bound_param_cson);
+    }
+}
+
+/* for the rare events built as cson */
+static void eventlog_add_binary_json(cson_value *val)
+{
+    pthread_once(&evwriter_once, eventlog_writer_start);
+    struct evthread *t = evthread_get();
+    if (t == NULL) {
+        ATOMIC_ADD64(eventlog_dropped, 1);
+        return;
+    }
+    cson_buffer json;
+    cson_output_buffer(val, &json);
+    evb_reset(&t->enc);
+    evb_tag(&t->enc, EVR_EVENT);
+    evb_json(&t->enc, json.mem, json.used);
+    eventlog_bin_put(t, NULL);
+}
+
 void eventlog_add(const struct reqlogger *logger)
 {
     if (eventlog == NULL || !eventlog_enabled ||
@@ -618,6 +1413,11 @@ void eventlog_add(const struct reqlogger *logger)
         return;
     }
 
+    if (gbl_eventlog_binary) {
+        eventlog_add_binary(logger);
+        return;
+    }
+
     cson_value *val = cson_value_new_object();
     cson_object *obj = cson_value_get_object(val);
     populate_obj(obj, logger);
@@ -626,7 +1426,8 @@ void eventlog_add(const struct reqlogger *logger)
     Pthread_mutex_lock(&eventlog_lk);
 
     if (eventlog != NULL && eventlog_enabled) {
-        if (eventlog_rollat > 0 && bytes_written > eventlog_rollat) {
+        if (eventlog_is_binary ||
+            (eventlog_rollat > 0 && bytes_written > eventlog_rollat)) {
             eventlog_roll();
             call_roll_cleanup = 1;
         }
@@ -647,9 +1448,12 @@ void eventlog_add(const struct reqlogger *logger)
 
 void eventlog_status(void)
 {
-    if (eventlog_enabled == 1)
+    if (eventlog_enabled == 1) {
         logmsg(LOGMSG_USER, "Eventlog enabled, file:%s\n", gbl_eventlog_fname);
-    else
+        if (eventlog_is_binary)
+            logmsg(LOGMSG_USER, "Binary event log, dropped events:%" PRId64 "\n",
+                   ATOMIC_LOAD64(eventlog_dropped));
+    } else
         logmsg(LOGMSG_USER, "Eventlog disabled\n");
 }
 
@@ -688,7 +1492,9 @@ static void eventlog_disable(void)
 
 void eventlog_stop(void)
 {
+    int call_roll_cleanup = 0;
     Pthread_mutex_lock(&eventlog_lk);
+    eventlog_bin_drain_locked(&call_roll_cleanup);
     eventlog_disable();
     Pthread_mutex_unlock(&eventlog_lk);
 }
@@ -823,6 +1629,7 @@ static void eventlog_process_message_locked(char *line, int lline, int *toff, in
             logmsg(LOGMSG_ERROR, "Expected on/off for 'verbose'\n");
         }
     } else if (tokcmp(tok, ltok, "flush") == 0) {
+        eventlog_bin_drain_locked(call_roll_cleanup);
         if (eventlog)
             gzflush(eventlog, 1);
     } else if (tokcmp(tok, ltok, "file") == 0) {
@@ -889,8 +1696,15 @@ void eventlog_debug(char *fmt, ...) {
     cson_object_set(obj, "debug", cson_value_new_string(s, strlen(s)));
     os_free(s);
 
+    if (gbl_eventlog_binary) {
+        eventlog_add_binary_json(vobj);
+        cson_value_free(vobj);
+        return;
+    }
+
     Pthread_mutex_lock(&eventlog_lk);
-    cson_output(vobj, write_json, eventlog);
+    if (eventlog_enabled && eventlog != NULL && !eventlog_is_binary)
+        cson_output(vobj, write_json, eventlog);
     Pthread_mutex_unlock(&eventlog_lk);
     cson_value_free(vobj);
 }
@@ -930,8 +1744,13 @@ void eventlog_deadlock_cycle(locker_info *idmap, u_int32_t *deadmap,
     cson_object_set(obj, "time", cson_new_int(startus));
     cson_object_set(obj, "host", host);
     cson_object_set(obj, "deadlock_cycle", dd_list);
+    if (gbl_eventlog_binary) {
+        eventlog_add_binary_json(dval);
+        cson_value_free(dval);
+        return;
+    }
     Pthread_mutex_lock(&eventlog_lk);
-    if (eventlog_enabled && eventlog != NULL)
+    if (eventlog_enabled && eventlog != NULL && !eventlog_is_binary)
         cson_output(dval, write_json, eventlog);
     Pthread_mutex_unlock(&eventlog_lk);
     cson_value_free(dval);
@@ -88,6 +88,10 @@ int gbl_fdb_io_error_retries_phase_1 = 6;
 int gbl_fdb_io_error_retries_phase_2_poll = 100;
 int gbl_fdb_auth_enabled = 1;
 int gbl_fdb_remsql_cdb2api = 1;
+int gbl_fdb_remote_projection = 1; /* push column projection for table cursors */
+int gbl_fdb_prefetch_rows = 0;     /* rows per prefetched page, 0 disables */
+int gbl_fdb_prefetch_pages = 4;    /* pages prefetched ahead of the consumer */
+int gbl_fdb_prefetch_threads = 16; /* max prefetch threads */
 int gbl_fdb_emulate_old = 0;
 int gbl_fdb_watchdog_debug = 0;         /* keep fdbs mutex blocked for this many seconds for watchdog testing */
 int gbl_fdb_add_stat_delay_ms = 0;      /* testing only: sleep this many ms in the schema/stats retrieval window
@@ -191,6 +195,8 @@ struct fdb {
     pthread_mutex_t sqlstats_mtx;  /* mutex for stats */
     fdb_sqlstat_cache_t *sqlstats; /* cache of sqlite stats, per foreign db */
 
+    fdb_rcache_t *rcache; /* cache of remote read results */
+
     int has_sqlstat1; /* if sqlstat1 was found */
     int has_sqlstat4; /* if sqlstat4 was found */
 
@@ -254,8 +260,49 @@ struct fdb_cursor {
     uuid_t tiduuid; /* UUID/fastseed storage for transaction, if any, or 0 */
     char *node;     /* connected to where? */
     int need_ssl;   /* uses ssl */
+
+    fdb_rcache_ent_t *rc_ent;   /* cached result replayed, if any */
+    int rc_row;                 /* current row in rc_ent */
+    fdb_rcache_fill_t *rc_fill; /* result being recorded, if any */
+
+    struct fdb_prefetch *pf; /* rows streamed ahead by a prefetch thread */
+    int pf_tried;            /* read ahead was tried for the current query */
+};
+
+/* a page of rows read ahead from a cdb2api cursor */
+struct fdb_prefetch_page {
+    char *buf;  /* row images, back to back */
+    int *offs;  /* nrows + 1 offsets in buf */
+    int nrows;
+    int bytes;
+    int balloc;
+};
+
+/**
+ * Remote rows are read ahead in pages by a prefetch thread while the
+ * sqlite engine consumes the current page; at most npages pages are
+ * buffered, after which the prefetch thread waits for the consumer
+ *
+ */
+struct fdb_prefetch {
+    pthread_mutex_t mtx;
+    pthread_cond_t cond;
+    cdb2_hndl_tp *hndl; /* owned by the prefetch thread until done */
+    struct fdb_prefetch_page *pages;
+    int npages;
+    int nrows;                   /* rows per page */
+    unsigned long long produced; /* pages filled */
+    unsigned long long consumed; /* pages released by the consumer */
+    int row;                     /* current row in the consumed page */
+    int started;                 /* the consumer is on a page */
+    int done;                    /* prefetch thread is done */
+    int rc;                      /* the last cdb2_next_record rc */
+    int stop;                    /* consumer wants the prefetch to end */
 };
 
+static struct thdpool *fdb_prefetch_pool;
+static struct thdpool *fdb_rcache_probe_pool;
+
 typedef struct fdb_systable_info {
     fdb_systable_ent_t *arr;
     int narr;
@@ -313,6 +360,8 @@ static void fdb_cursor_get_found_data_cdb2api(BtCursor *pCur,
                                               unsigned long long *genid,
                                               int *datalen, char **data);
 static int fdb_cursor_move_sql_cdb2api(BtCursor *pCur, int how);
+static void _rcache_release(BtCursor *pCur);
+static void _prefetch_stop(fdb_cursor_t *fdbc);
 static int fdb_cursor_find_sql_cdb2api(BtCursor *pCur, Mem *key, int nfields,
                                        int bias);
 
@@ -367,6 +416,24 @@ int fdb_cache_init(int n)
     fdbs.h_curs = hash_init_i4(0);
     Pthread_rwlock_init(&fdbs.h_curs_lock, NULL);
 
+    /* no queueing, a busy pool means we read synchronously */
+    fdb_prefetch_pool = thdpool_create("fdbprefetchpool", 0);
+    if (!gbl_exit_on_pthread_create_fail)
+        thdpool_unset_exit(fdb_prefetch_pool);
+    thdpool_set_minthds(fdb_prefetch_pool, 0);
+    thdpool_set_maxthds(fdb_prefetch_pool, gbl_fdb_prefetch_threads);
+    thdpool_set_maxqueue(fdb_prefetch_pool, 0);
+    thdpool_set_linger(fdb_prefetch_pool, 30);
+
+    /* one thread checks the remote lsns of the result caches, in turn */
+    fdb_rcache_probe_pool = thdpool_create("fdbrcacheprobepool", 0);
+    if (!gbl_exit_on_pthread_create_fail)
+        thdpool_unset_exit(fdb_rcache_probe_pool);
+    thdpool_set_minthds(fdb_rcache_probe_pool, 0);
+    thdpool_set_maxthds(fdb_rcache_probe_pool, 1);
+    thdpool_set_maxqueue(fdb_rcache_probe_pool, 1000);
+    thdpool_set_linger(fdb_rcache_probe_pool, 30);
+
     return 0;
 }
 
@@ -463,6 +530,7 @@ static void _free_fdb(fdb_t *fdb)
     }
 
     fdb_sqlstat_cache_destroy(&fdb->sqlstats);
+    fdb_rcache_destroy(&fdb->rcache);
 
     free(fdb->dbname);
     Pthread_mutex_destroy(&fdb->tables_mtx);
@@ -600,6 +668,7 @@ static void _init_fdb(fdb_t *fdb, const char *dbname)
     fdb->h_tbls_name = hash_init_strptr(0);
     Pthread_mutex_init(&fdb->sqlstats_mtx, NULL);
     Pthread_mutex_init(&fdb->dbcon_mtx, NULL);
+    fdb->rcache = fdb_rcache_create();
 }
 
 /* Check that fdb class/local still matches current gbl tunable settings.
@@ -2738,6 +2807,8 @@ static void fdb_cursor_close_on_open(BtCursor *pCur, int cache)
         hash_del(fdbs.h_curs, fdbc);
         Pthread_rwlock_unlock(&fdbs.h_curs_lock);
 
+        _rcache_release(pCur);
+
         if (fdbc->type == FCON_TYPE_LEGACY) {
             if (cache && fdbc->ent && fdbc->ent->tbl &&
                 fdbc->streaming == FDB_CUR_IDLE) {
@@ -2750,6 +2821,7 @@ static void fdb_cursor_close_on_open(BtCursor *pCur, int cache)
             }
             fdb_msg_clean_message(fdbc->msg);
         } else {
+            _prefetch_stop(fdbc);
             cdb2_close(fdbc->fcon.api.hndl);
         }
 
@@ -2820,6 +2892,13 @@ static char *_build_run_sql_from_hint(BtCursor *pCur, Mem *m, int ncols,
             using_col_filter = 1;
         } else {
             tableName = fdbc->ent->name;
+
+            /* only ship the used columns; writes need full rows */
+            if (gbl_fdb_remote_projection && !fdbc->trans) {
+                columnsDesc = sqlite3DescribeTableColumns(
+                    sqlitedb, fdbc->ent->name, fdbc->ent->tbl->fdb->dbname,
+                    pCur->col_mask);
+            }
         }
     }
 
@@ -3205,6 +3284,9 @@ static void _fdb_handle_sqlite_schema_err(fdb_cursor_t *fdbc, char *errstr)
     pthread_mutex_lock(&fdbc->ent->tbl->need_version_mtx);
     fdbc->ent->tbl->need_version = remote_version + 1;
     pthread_mutex_unlock(&fdbc->ent->tbl->need_version_mtx);
+
+    if (fdbc->ent->tbl->fdb->rcache)
+        fdb_rcache_flush(fdbc->ent->tbl->fdb->rcache, fdbc->ent->tbl->name);
 }
 
 static int _fdb_handle_io_read_error(BtCursor *pCur, int *retry, int *pollms,
@@ -3735,6 +3817,46 @@ static inline char *_get_tblname(fdb_cursor_t *fdbc)
                : NULL;
 }
 
+/* remember the tables a transaction wrote, to invalidate their cached reads */
+static void _fdb_tran_wrote(fdb_tran_t *tran, const char *tblname)
+{
+    char **wrtbls;
+    int i;
+
+    if (!tran->fdb->rcache)
+        return;
+
+    for (i = 0; i < tran->nwrtbls; i++) {
+        if (strcasecmp(tran->wrtbls[i], tblname) == 0)
+            break;
+    }
+    if (i == tran->nwrtbls) {
+        wrtbls = realloc(tran->wrtbls, sizeof(char *) * (tran->nwrtbls + 1));
+        if (!wrtbls)
+            return;
+        tran->wrtbls = wrtbls;
+        if ((tran->wrtbls[tran->nwrtbls] = strdup(tblname)) == NULL)
+            return;
+        tran->nwrtbls++;
+    }
+    tran->wrtbls_nwrites++;
+}
+
+/* drop the cached reads of what a committed transaction wrote; writes which
+   were not done through cursors (pushed sql, ddl) drop everything */
+static void _fdb_tran_rcache_flush(fdb_tran_t *tran)
+{
+    if (!tran->nwrites || !tran->fdb->rcache)
+        return;
+
+    if (tran->wrtbls_nwrites != tran->nwrites) {
+        fdb_rcache_flush(tran->fdb->rcache, NULL);
+        return;
+    }
+    for (int i = 0; i < tran->nwrtbls; i++)
+        fdb_rcache_flush(tran->fdb->rcache, tran->wrtbls[i]);
+}
+
 static int fdb_cursor_insert(BtCursor *pCur, sqlclntstate *clnt,
                              fdb_tran_t *trans, unsigned long long genid,
                              int datalen, char *data)
@@ -3782,6 +3904,7 @@ static int fdb_cursor_insert(BtCursor *pCur, sqlclntstate *clnt,
     trans->seq++;
     trans->nwrites++;
     trans->writes_status = FDB_TRAN_WRITES;
+    _fdb_tran_wrote(trans, fdbc->ent->tbl->name);
 
     return rc;
 }
@@ -3832,6 +3955,7 @@ static int fdb_cursor_delete(BtCursor *pCur, sqlclntstate *clnt,
     trans->seq++;
     trans->nwrites++;
     trans->writes_status = FDB_TRAN_WRITES;
+    _fdb_tran_wrote(trans, fdbc->ent->tbl->name);
 
     if (rc == 0) {
         rc = fdb_set_genid_deleted(trans, genid);
@@ -3903,6 +4027,7 @@ static int fdb_cursor_update(BtCursor *pCur, sqlclntstate *clnt,
     trans->seq++;
     trans->nwrites++;
     trans->writes_status = FDB_TRAN_WRITES;
+    _fdb_tran_wrote(trans, fdbc->ent->tbl->name);
 
     if (rc == 0) {
         rc = fdb_set_genid_deleted(trans, genid);
@@ -4109,6 +4234,9 @@ static void _free_fdb_tran(fdb_distributed_tran_t *dtran, fdb_tran_t *tran)
     listc_rfl(&dtran->fdb_trans, tran);
 
     free(tran->errstr);
+    for (int i = 0; i < tran->nwrtbls; i++)
+        free(tran->wrtbls[i]);
+    free(tran->wrtbls);
 
     if (tran->is_cdb2api) {
         rc = cdb2_close(tran->fcon.hndl);
@@ -4315,6 +4443,9 @@ int fdb_trans_commit(sqlclntstate *clnt, enum trans_clntcomm sideeffects, int *i
         if (sideeffects == TRANS_CLNTCOMM_CHUNK && tran->nwrites == 0)
             continue;
 
+        /* our own writes have to be visible to the next read */
+        _fdb_tran_rcache_flush(tran);
+
         _free_fdb_tran(dtran, tran);
     }
 
@@ -4829,6 +4960,30 @@ static void _info_fdb(const char *dbname, fdb_systable_info_t *info)
     }
 }
 
+/**
+ * Report or flush the remote result cache for all dbs
+ *
+ */
+static void _rcache_info(int flush)
+{
+    fdb_t *fdb;
+    int i;
+
+    Pthread_mutex_lock(&fdbs.arr_mtx);
+    for (i = 0; i < fdbs.nused; i++) {
+        fdb = fdbs.arr[i];
+
+        if (!fdb || !fdb->rcache)
+            continue;
+
+        if (flush)
+            fdb_rcache_flush(fdb->rcache, NULL);
+        else
+            fdb_rcache_stats(fdb->rcache, fdb->dbname);
+    }
+    Pthread_mutex_unlock(&fdbs.arr_mtx);
+}
+
 /**
  * Process remote messages
  *
@@ -4857,7 +5012,11 @@ int fdb_process_message(const char *line, int lline)
                         "    fdb info db                       = print cached "
                         "tables names and their versions for all dbs\n"
                         "    fdb info db dbname                = print cached "
-                        "tables names and their versions in db \"dbname\"\n");
+                        "tables names and their versions in db \"dbname\"\n"
+                        "    fdb rcache                        = print remote "
+                        "result cache statistics\n"
+                        "    fdb rcache flush                  = removes "
+                        "cached remote results\n");
     } else if (tokcmp(tok, ltok, "init") == 0) {
         fdb_init();
     } else if (tokcmp(tok, ltok, "force") == 0) {
@@ -4950,6 +5109,16 @@ int fdb_process_message(const char *line, int lline)
             logmsg(LOGMSG_ERROR, "fdb info error: unrecognized argument\n");
             return FDB_ERR_GENERIC;
         }
+    } else if (tokcmp(tok, ltok, "rcache") == 0) {
+        tok = segtok((char *)line, lline, &st, &ltok);
+        if (ltok == 0) {
+            _rcache_info(0);
+        } else if (tokcmp(tok, ltok, "flush") == 0) {
+            _rcache_info(1);
+        } else {
+            logmsg(LOGMSG_ERROR, "fdb rcache error: unrecognized argument\n");
+            return FDB_ERR_GENERIC;
+        }
     } else if (tokcmp(tok, ltok, "test") == 0) {
         tok = segtok((char*) line, lline, &st, &ltok);
         if (ltok == 0) {
@@ -5533,10 +5702,30 @@ void fdb_systable_info_free(void *data, int npoints)
     free(ient);
 }
 
+/* current row, either streamed by cdb2api, prefetched, or replayed from
+ * result cache */
+static char *_cdb2api_row(BtCursor *pCur, int *len)
+{
+    fdb_cursor_t *fdbc = pCur->fdbc->impl;
+
+    if (fdbc->rc_ent)
+        return fdb_rcache_ent_row(fdbc->rc_ent, fdbc->rc_row, len);
+
+    if (fdbc->pf && fdbc->pf->started) {
+        struct fdb_prefetch *pf = fdbc->pf;
+        struct fdb_prefetch_page *pg = &pf->pages[pf->consumed % pf->npages];
+        *len = pg->offs[pf->row + 1] - pg->offs[pf->row];
+        return pg->buf + pg->offs[pf->row];
+    }
+
+    *len = cdb2_column_size(fdbc->fcon.api.hndl, 0);
+    return cdb2_column_value(fdbc->fcon.api.hndl, 0);
+}
+
 #define CHECK_ROW_LEN(ret) \
     do { \
-    cdb2_hndl_tp *hndl = pCur->fdbc->impl->fcon.api.hndl; \
-    int len = cdb2_column_size(hndl, 0); \
+    int len; \
+    _cdb2api_row(pCur, &len); \
     if (len <= sizeof(unsigned long long)) { \
         logmsg(LOGMSG_ERROR, "%s: BUG, row length is too small %d\n", \
                __func__, len); \
@@ -5580,9 +5769,8 @@ static void fdb_cursor_get_found_data_cdb2api(BtCursor *pCur,
                                               unsigned long long *genid,
                                               int *datalen, char **data)
 {
-    cdb2_hndl_tp *hndl = pCur->fdbc->impl->fcon.api.hndl;
-    char *value = cdb2_column_value(hndl, 0);
-    int len = cdb2_column_size(hndl, 0);
+    int len;
+    char *value = _cdb2api_row(pCur, &len);
     if (len <= sizeof(unsigned long long)) {
         logmsg(LOGMSG_ERROR, "%s: BUG, row length is too small %d\n",
                __func__, len);
@@ -5814,10 +6002,392 @@ done:
     return rc;
 }
 
-static int fdb_cursor_move_sql_cdb2api(BtCursor *pCur, int how)
+/**
+ * Remote result cache support
+ *
+ * Only standalone reads are cached; a transaction has to see its own
+ * writes and the remote snapshot it reads from.  Reads run under the
+ * identity of the user are not cached either, since what the remote
+ * returns depends on who asks, and neither are prepare only runs.
+ *
+ */
+static int _rcache_usable(BtCursor *pCur)
+{
+    extern void *(*externalComdb2getAuthIdBlob)(void *ID);
+    fdb_cursor_t *fdbc = pCur->fdbc->impl;
+    sqlclntstate *clnt = pCur->clnt;
+
+    if (!gbl_fdb_rcache || !pCur->bt->fdb->rcache || !fdbc->ent ||
+        fdbc->trans || fdbc->is_schema || !clnt || clnt->intrans ||
+        clnt->prepare_only)
+        return 0;
+
+    /* see fdb_client_set_identityBlob */
+    if (gbl_fdb_auth_enabled && externalComdb2getAuthIdBlob &&
+        get_authdata(clnt) != NULL)
+        return 0;
+
+    return 1;
+}
+
+static void _rcache_release(BtCursor *pCur)
 {
     fdb_cursor_t *fdbc = pCur->fdbc->impl;
+
+    if (fdbc->rc_ent) {
+        fdb_rcache_put(pCur->bt->fdb->rcache, fdbc->rc_ent);
+        fdbc->rc_ent = NULL;
+    }
+    if (fdbc->rc_fill) {
+        fdb_rcache_fill_done(pCur->bt->fdb->rcache, fdbc->rc_fill, 0);
+        fdbc->rc_fill = NULL;
+    }
+}
+
+struct rcache_probe {
+    fdb_rcache_t *rcache;
+    char *dbname;
+    enum mach_class class;
+    int local;
+};
+
+/* largest applied lsn in the remote cluster */
+static int _rcache_probe_lsn(struct rcache_probe *probe, int *file,
+                             int *offset)
+{
     cdb2_hndl_tp *hndl;
+    const char *class;
+    long long *lfile, *loffset;
+    int rc;
+
+    hndl = fdb_connect(probe->dbname, probe->class, probe->local, &class, 0);
+    if (!hndl)
+        return -1;
+
+    rc = cdb2_run_statement(hndl, "select logfile, logoffset from comdb2_cluster "
+                                  "order by logfile desc, logoffset desc limit 1");
+    if (!rc && (rc = cdb2_next_record(hndl)) == CDB2_OK) {
+        lfile = cdb2_column_value(hndl, 0);
+        loffset = cdb2_column_value(hndl, 1);
+        while (cdb2_next_record(hndl) == CDB2_OK)
+            ;
+        if (lfile && loffset) {
+            *file = *lfile;
+            *offset = *loffset;
+            rc = 0;
+        } else {
+            /* no node reported its lsn */
+            logmsg(LOGMSG_ERROR, "%s: no lsn from %s:%s\n", __func__,
+                   probe->dbname, class);
+            rc = -1;
+        }
+    } else {
+        logmsg(LOGMSG_ERROR, "%s: failed to retrieve lsn from %s:%s rc %d \"%s\"\n", __func__, probe->dbname, class,
+               rc, cdb2_errstr(hndl));
+        rc = -1;
+    }
+    cdb2_close(hndl);
+
+    return rc;
+}
+
+static void _rcache_probe_work(struct thdpool *pool, void *work,
+                               void *thddata, int op)
+{
+    struct rcache_probe *probe = work;
+    int file = 0;
+    int offset = 0;
+    int rc = -1;
+
+    /* a probe that does not run leaves the cache invalid until the next */
+    if (op == THD_RUN)
+        rc = _rcache_probe_lsn(probe, &file, &offset);
+    fdb_rcache_lsn_update(probe->rcache, rc, file, offset);
+
+    free(probe->dbname);
+    free(probe);
+}
+
+/**
+ * Return 1 if cached results for this fdb are still current; a due check of
+ * the remote lsn runs in the background, and bypasses the cache until done
+ *
+ */
+static int _rcache_valid(fdb_t *fdb)
+{
+    struct rcache_probe *probe;
+    int rc;
+
+    rc = fdb_rcache_lsn_check_due(fdb->rcache);
+    if (rc <= 0)
+        return rc == 0;
+
+    probe = calloc(1, sizeof(struct rcache_probe));
+    if (probe && (probe->dbname = strdup(fdb->dbname)) != NULL) {
+        probe->rcache = fdb->rcache;
+        probe->class = fdb->class;
+        probe->local = fdb->local;
+        if (fdb_rcache_probe_pool &&
+            thdpool_enqueue(fdb_rcache_probe_pool, _rcache_probe_work, probe, 0,
+                            NULL, 0) == 0)
+            return 0;
+        free(probe->dbname);
+    }
+    free(probe);
+    fdb_rcache_lsn_update(fdb->rcache, -1, 0, 0);
+
+    return 0;
+}
+
+/**
+ * Look up the result of "sql" in the remote result cache; on a hit the
+ * cursor replays the cached rows and this returns 1, otherwise the result
+ * of the remote query is recorded as it is streamed
+ *
+ */
+static int _rcache_lookup(BtCursor *pCur, const char *sql)
+{
+    fdb_cursor_t *fdbc = pCur->fdbc->impl;
+    fdb_t *fdb = pCur->bt->fdb;
+    char settings[64];
+
+    _rcache_release(pCur);
+
+    if (!_rcache_usable(pCur) || !_rcache_valid(fdb))
+        return 0;
+
+    /* session settings that change the remote row images */
+    snprintf(settings, sizeof(settings), "%s %d", pCur->clnt->tzname,
+             pCur->clnt->dtprec);
+
+    fdbc->rc_ent = fdb_rcache_get(fdb->rcache, fdbc->ent->tbl->name,
+                                  fdbc->ent->tbl->version, settings, sql);
+    if (fdbc->rc_ent) {
+        fdbc->rc_row = 0;
+        if (gbl_fdb_track)
+            logmsg(LOGMSG_USER, "Cached %d rows \"%s\"\n",
+                   fdb_rcache_ent_nrows(fdbc->rc_ent), sql);
+        return 1;
+    }
+
+    fdbc->rc_fill = fdb_rcache_fill_start(
+        fdb->rcache, fdbc->ent->tbl->name, fdbc->ent->tbl->version, settings,
+        sql);
+    return 0;
+}
+
+/* next row from cache */
+static int _rcache_next(fdb_cursor_t *fdbc, int first)
+{
+    if (!first)
+        fdbc->rc_row++;
+    return (fdbc->rc_row < fdb_rcache_ent_nrows(fdbc->rc_ent)) ? IX_FNDMORE
+                                                               : IX_EMPTY;
+}
+
+/* record the row just streamed, or complete the recording */
+static void _rcache_record(BtCursor *pCur, int rc)
+{
+    fdb_cursor_t *fdbc = pCur->fdbc->impl;
+    char *row;
+    int len;
+
+    if (!fdbc->rc_fill)
+        return;
+
+    if (rc == CDB2_OK) {
+        row = _cdb2api_row(pCur, &len);
+        if (!fdb_rcache_fill_add(fdbc->rc_fill, row, len))
+            return;
+    }
+
+    fdb_rcache_fill_done(pCur->bt->fdb->rcache, fdbc->rc_fill,
+                         rc == CDB2_OK_DONE);
+    fdbc->rc_fill = NULL;
+}
+
+static int _prefetch_page_add(struct fdb_prefetch_page *pg, const char *row,
+                              int len)
+{
+    if (pg->bytes + len > pg->balloc) {
+        int balloc = (pg->bytes + len) * 2;
+        char *buf = realloc(pg->buf, balloc);
+        if (!buf)
+            return -1;
+        pg->buf = buf;
+        pg->balloc = balloc;
+    }
+    memcpy(pg->buf + pg->bytes, row, len);
+    pg->bytes += len;
+    pg->offs[++pg->nrows] = pg->bytes;
+    return 0;
+}
+
+static void _prefetch_work(struct thdpool *pool, void *work, void *thddata,
+                           int op)
+{
+    struct fdb_prefetch *pf = work;
+    struct fdb_prefetch_page *pg;
+    unsigned long long produced = 0;
+    int rc = CDB2ERR_UNKNOWN;
+
+    while (op == THD_RUN) {
+        Pthread_mutex_lock(&pf->mtx);
+        while (!pf->stop && produced - pf->consumed >= pf->npages)
+            Pthread_cond_wait(&pf->cond, &pf->mtx);
+        Pthread_mutex_unlock(&pf->mtx);
+        if (pf->stop)
+            break;
+
+        pg = &pf->pages[produced % pf->npages];
+        pg->nrows = pg->bytes = 0;
+        while (pg->nrows < pf->nrows && !pf->stop) {
+            rc = cdb2_next_record(pf->hndl);
+            if (rc != CDB2_OK)
+                break;
+            if (_prefetch_page_add(pg, cdb2_column_value(pf->hndl, 0),
+                                   cdb2_column_size(pf->hndl, 0))) {
+                rc = CDB2ERR_INTERNAL;
+                break;
+            }
+        }
+
+        Pthread_mutex_lock(&pf->mtx);
+        if (pg->nrows)
+            pf->produced = ++produced;
+        Pthread_cond_signal(&pf->cond);
+        Pthread_mutex_unlock(&pf->mtx);
+
+        if (rc != CDB2_OK)
+            break;
+    }
+
+    Pthread_mutex_lock(&pf->mtx);
+    pf->rc = rc;
+    pf->done = 1;
+    Pthread_cond_signal(&pf->cond);
+    Pthread_mutex_unlock(&pf->mtx);
+}
+
+/* start reading ahead the rows of the current query, if possible */
+static void _prefetch_start(fdb_cursor_t *fdbc)
+{
+    struct fdb_prefetch *pf;
+    int i;
+
+    /* transactional cursors share the handle with the remote writes */
+    if (gbl_fdb_prefetch_rows <= 0 || gbl_fdb_prefetch_pages <= 0 ||
+        !fdb_prefetch_pool || fdbc->trans || fdbc->pf_tried)
+        return;
+
+    /* once per query; a busy pool means this query reads synchronously */
+    fdbc->pf_tried = 1;
+    if (thdpool_get_nbusythds(fdb_prefetch_pool) >=
+        thdpool_get_maxthds(fdb_prefetch_pool))
+        return;
+
+    pf = calloc(1, sizeof(struct fdb_prefetch));
+    if (!pf)
+        return;
+    pf->npages = gbl_fdb_prefetch_pages;
+    pf->nrows = gbl_fdb_prefetch_rows;
+    pf->pages = calloc(pf->npages, sizeof(struct fdb_prefetch_page));
+    if (!pf->pages)
+        goto err;
+    for (i = 0; i < pf->npages; i++) {
+        pf->pages[i].offs = calloc(pf->nrows + 1, sizeof(int));
+        if (!pf->pages[i].offs)
+            goto err;
+    }
+    pf->hndl = fdbc->fcon.api.hndl;
+    Pthread_mutex_init(&pf->mtx, NULL);
+    Pthread_cond_init(&pf->cond, NULL);
+
+    if (thdpool_enqueue(fdb_prefetch_pool, _prefetch_work, pf, 0, NULL, 0)) {
+        Pthread_cond_destroy(&pf->cond);
+        Pthread_mutex_destroy(&pf->mtx);
+        goto err;
+    }
+    fdbc->pf = pf;
+    return;
+
+err:
+    for (i = 0; pf->pages && i < pf->npages; i++)
+        free(pf->pages[i].offs);
+    free(pf->pages);
+    free(pf);
+}
+
+/* stop the read ahead and take back the cdb2api handle */
+static void _prefetch_stop(fdb_cursor_t *fdbc)
+{
+    struct fdb_prefetch *pf = fdbc->pf;
+    int i;
+
+    fdbc->pf_tried = 0;
+    if (!pf)
+        return;
+
+    Pthread_mutex_lock(&pf->mtx);
+    pf->stop = 1;
+    Pthread_cond_signal(&pf->cond);
+    while (!pf->done)
+        Pthread_cond_wait(&pf->cond, &pf->mtx);
+    Pthread_mutex_unlock(&pf->mtx);
+
+    for (i = 0; i < pf->npages; i++) {
+        free(pf->pages[i].buf);
+        free(pf->pages[i].offs);
+    }
+    free(pf->pages);
+    Pthread_cond_destroy(&pf->cond);
+    Pthread_mutex_destroy(&pf->mtx);
+    free(pf);
+    fdbc->pf = NULL;
+}
+
+/* next prefetched row; returns a cdb2_next_record rc */
+static int _prefetch_next(struct fdb_prefetch *pf)
+{
+    int rc;
+
+    Pthread_mutex_lock(&pf->mtx);
+    if (pf->started) {
+        if (++pf->row < pf->pages[pf->consumed % pf->npages].nrows) {
+            Pthread_mutex_unlock(&pf->mtx);
+            return CDB2_OK;
+        }
+        /* page consumed, let the prefetch thread reuse it */
+        pf->consumed++;
+        pf->started = 0;
+        Pthread_cond_signal(&pf->cond);
+    }
+    /* like cdb2_next_record on the sql thread, waits for the remote */
+    while (pf->consumed == pf->produced && !pf->done)
+        Pthread_cond_wait(&pf->cond, &pf->mtx);
+    if (pf->consumed < pf->produced) {
+        pf->started = 1;
+        pf->row = 0;
+        rc = CDB2_OK;
+    } else {
+        rc = pf->rc;
+    }
+    Pthread_mutex_unlock(&pf->mtx);
+
+    return rc;
+}
+
+/* next row for a cdb2api cursor */
+static int _cdb2api_next(fdb_cursor_t *fdbc)
+{
+    if (fdbc->pf)
+        return _prefetch_next(fdbc->pf);
+    return cdb2_next_record(fdbc->fcon.api.hndl);
+}
+
+static int fdb_cursor_move_sql_cdb2api(BtCursor *pCur, int how)
+{
+    fdb_cursor_t *fdbc = pCur->fdbc->impl;
     char *sql; /* freed by _fdb_run_sql */
     int rc = 0;
 
@@ -5828,8 +6398,6 @@ static int fdb_cursor_move_sql_cdb2api(BtCursor *pCur, int how)
         return FDB_ERR_BUG;
     }
 
-    hndl = fdbc->fcon.api.hndl;
-
     /* if absolute move, send new query */
     if (how == CFIRST || how == CLAST) {
 version_retry:
@@ -5837,6 +6405,14 @@ version_retry:
         if (rc)
             return rc;
 
+        _prefetch_stop(fdbc);
+
+        if (_rcache_lookup(pCur, sql)) {
+            if (fdbc->sql_hint != sql)
+                sqlite3_free(sql);
+            return _rcache_next(fdbc, 1);
+        }
+
         rc = _fdb_run_sql(pCur, sql);
         if (rc  == FDB_ERR_FDB_VERSION) {
             /* might move cursor to different backend */
@@ -5846,7 +6422,6 @@ version_retry:
 
             /* new cursor */
             fdbc = pCur->fdbc->impl;
-            hndl = fdbc->fcon.api.hndl;
 
             /* do we need to pre-cdb2api version */
             if (pCur->bt->fdb->server_version <= FDB_VER_AUTH) {
@@ -5855,11 +6430,17 @@ version_retry:
             /* just an older cdb2api version, gonna run same backend */
             goto version_retry;
         }
+    } else if (fdbc->rc_ent) {
+        return _rcache_next(fdbc, 0);
+    } else if (!fdbc->pf) {
+        /* this is a scan, read ahead */
+        _prefetch_start(fdbc);
     }
 
     if (!rc) {
         /* read genid */
-        rc = cdb2_next_record(hndl);
+        rc = _cdb2api_next(fdbc);
+        _rcache_record(pCur, rc);
         if (rc == CDB2_OK) {
             rc = IX_FNDMORE;
         } else if (rc == CDB2_OK_DONE) {
@@ -5880,7 +6461,6 @@ static int fdb_cursor_find_sql_cdb2api(BtCursor *pCur, Mem *key, int nfields,
        find/find_last + a followup move)
      */
     fdb_cursor_t *fdbc = pCur->fdbc->impl;
-    cdb2_hndl_tp *hndl;
     char *sql; /* freed by _fdb_run_sql */
     int rc = 0;
 
@@ -5889,13 +6469,19 @@ static int fdb_cursor_find_sql_cdb2api(BtCursor *pCur, Mem *key, int nfields,
         return FDB_ERR_BUG;
     }
 
-    hndl = fdbc->fcon.api.hndl;
-
 version_retry:
     rc = _fdb_build_find_str(pCur, key, nfields, bias, &sql, NULL);
     if (rc)
         return rc;
 
+    _prefetch_stop(fdbc);
+
+    if (_rcache_lookup(pCur, sql)) {
+        if (fdbc->sql_hint != sql)
+            sqlite3_free(sql);
+        return _rcache_next(fdbc, 1);
+    }
+
     rc = _fdb_run_sql(pCur, sql);
     if (rc == FDB_ERR_FDB_VERSION) {
         /* might move cursor to different backend */
@@ -5905,7 +6491,6 @@ version_retry:
 
         /* new cursor */
         fdbc = pCur->fdbc->impl;
-        hndl = fdbc->fcon.api.hndl;
 
         /* do we need to pre-cdb2api version */
         if (pCur->bt->fdb->server_version <= FDB_VER_AUTH) {
@@ -5918,7 +6503,8 @@ version_retry:
 
     if (!rc) {
         /* read genid */
-        rc = cdb2_next_record(hndl);
+        rc = _cdb2api_next(fdbc);
+        _rcache_record(pCur, rc);
         if (rc == CDB2_OK) {
             rc = IX_FNDMORE;
         } else if (rc == CDB2_OK_DONE) {
@@ -143,6 +143,10 @@ struct fdb_tran {
     int nwrites;                        /* how many writes were done; rows for dml; ddl instructions for ddl */
     enum fdb_tran_status writes_status; /* what status is this connection */
 
+    char **wrtbls; /* tables written through cursors, for the result cache */
+    int nwrtbls;
+    int wrtbls_nwrites; /* writes accounted for in wrtbls */
+
     /**
      * libevent heartbeats
      */
@@ -21,6 +21,7 @@
 #include <sql.h>
 #include <bdb_api.h>
 #include <util.h>
+#include <epochlib.h>
 
 #include "fdb_fend.h"
 #include "fdb_fend_cache.h"
@@ -470,3 +471,388 @@ static int fdb_sqlstat_cursor_update(BtCursor *pCur, struct sqlclntstate *clnt,
 {
     abort();
 }
+
+/**
+ * Remote result cache
+ *
+ * Results of read-only remote queries are cached per foreign db, keyed by
+ * table name, remote table version and the generated remote sql (which
+ * embeds the probed key values).  The cache is invalidated when the
+ * remote table version changes, when the remote cluster log advances
+ * (probed by the caller in the background at most every
+ * fdb_rcache_lsn_check_msec), or when this node writes to the remote db.
+ *
+ */
+
+int gbl_fdb_rcache = 0;                        /* enable remote result cache */
+int gbl_fdb_rcache_max_rows = 1000;            /* do not cache larger results */
+int gbl_fdb_rcache_max_bytes = 64 * 1024 * 1024; /* per foreign db */
+int gbl_fdb_rcache_lsn_check_msec = 1000;      /* remote lsn probe interval */
+
+struct fdb_rcache_ent {
+    char *key;     /* tblname, version, sql and session settings */
+    char *tblname; /* remote table this result was read from */
+    char *buf;     /* row images, back to back */
+    int *offs;     /* nrows + 1 offsets in buf */
+    int nrows;
+    int bytes;
+    int refcnt;   /* cursors replaying this entry, plus one for the cache */
+    LINKC_T(struct fdb_rcache_ent) lnk; /* lru */
+};
+
+struct fdb_rcache_fill {
+    char *key;
+    char *tblname;
+    char *buf;
+    int *offs;
+    int nrows;
+    int nalloc;
+    int bytes;
+    int balloc;
+    unsigned int gen; /* cache generation when the remote query was sent */
+};
+
+struct fdb_rcache {
+    pthread_mutex_t mtx;
+    hash_t *h_ents;                          /* entries, by key */
+    LISTC_T(struct fdb_rcache_ent) lru;      /* most recently used at top */
+    int bytes;                               /* total cached bytes */
+    unsigned int gen;                        /* bumped on every invalidation */
+
+    int refs; /* the fdb, plus one for a running lsn probe */
+
+    int lsn_file; /* last seen remote cluster lsn */
+    int lsn_offset;
+    int lsn_checkms; /* when the remote lsn was last probed */
+    int lsn_probed;  /* set once a probe ran */
+    int lsn_valid;   /* set if the last probe succeeded */
+    int lsn_probing; /* set while a probe runs */
+
+    unsigned long long hits;
+    unsigned long long misses;
+    unsigned long long stores;
+    unsigned long long evicts;
+    unsigned long long invalidations;
+};
+
+fdb_rcache_t *fdb_rcache_create(void)
+{
+    fdb_rcache_t *cache = calloc(1, sizeof(fdb_rcache_t));
+    if (!cache) {
+        logmsg(LOGMSG_ERROR, "%s: malloc!\n", __func__);
+        return NULL;
+    }
+    Pthread_mutex_init(&cache->mtx, NULL);
+    cache->refs = 1;
+    cache->h_ents = hash_init_strptr(offsetof(struct fdb_rcache_ent, key));
+    listc_init(&cache->lru, offsetof(struct fdb_rcache_ent, lnk));
+    return cache;
+}
+
+static void _rcache_ent_free(fdb_rcache_ent_t *ent)
+{
+    free(ent->key);
+    free(ent->tblname);
+    free(ent->buf);
+    free(ent->offs);
+    free(ent);
+}
+
+/* unlink an entry from cache; cache lock held */
+static void _rcache_unlink(fdb_rcache_t *cache, fdb_rcache_ent_t *ent)
+{
+    hash_del(cache->h_ents, ent);
+    listc_rfl(&cache->lru, ent);
+    cache->bytes -= ent->bytes;
+    if (--ent->refcnt == 0)
+        _rcache_ent_free(ent);
+}
+
+/* remove the entries of "tblname", or all if NULL; cache lock held */
+static void _rcache_flush(fdb_rcache_t *cache, const char *tblname)
+{
+    fdb_rcache_ent_t *ent, *tmp;
+
+    LISTC_FOR_EACH_SAFE(&cache->lru, ent, tmp, lnk)
+    {
+        if (!tblname || strcasecmp(tblname, ent->tblname) == 0)
+            _rcache_unlink(cache, ent);
+    }
+    cache->gen++;
+    cache->invalidations++;
+}
+
+/* drop a reference; the last one frees the cache */
+static void _rcache_unref(fdb_rcache_t *cache)
+{
+    int refs;
+
+    Pthread_mutex_lock(&cache->mtx);
+    refs = --cache->refs;
+    Pthread_mutex_unlock(&cache->mtx);
+
+    if (refs)
+        return;
+
+    hash_free(cache->h_ents);
+    Pthread_mutex_destroy(&cache->mtx);
+    free(cache);
+}
+
+void fdb_rcache_destroy(fdb_rcache_t **pcache)
+{
+    fdb_rcache_t *cache = *pcache;
+
+    if (!cache)
+        return;
+
+    fdb_rcache_flush(cache, NULL);
+    _rcache_unref(cache);
+
+    *pcache = NULL;
+}
+
+/**
+ * Remove the cached results for table "tblname", or all if NULL
+ *
+ */
+void fdb_rcache_flush(fdb_rcache_t *cache, const char *tblname)
+{
+    Pthread_mutex_lock(&cache->mtx);
+    _rcache_flush(cache, tblname);
+    Pthread_mutex_unlock(&cache->mtx);
+}
+
+static char *_rcache_key(const char *tblname, unsigned long long version,
+                         const char *settings, const char *sql)
+{
+    return sqlite3_mprintf("%s\n%llx\n%s\n%s", tblname, version, settings,
+                           sql);
+}
+
+/**
+ * Lookup a cached result; a found entry is pinned until fdb_rcache_put
+ *
+ */
+fdb_rcache_ent_t *fdb_rcache_get(fdb_rcache_t *cache, const char *tblname,
+                                 unsigned long long version,
+                                 const char *settings, const char *sql)
+{
+    fdb_rcache_ent_t *ent;
+    char *key = _rcache_key(tblname, version, settings, sql);
+    if (!key)
+        return NULL;
+
+    Pthread_mutex_lock(&cache->mtx);
+    ent = hash_find_readonly(cache->h_ents, &key);
+    if (ent) {
+        ent->refcnt++;
+        listc_rfl(&cache->lru, ent);
+        listc_atl(&cache->lru, ent);
+        cache->hits++;
+    } else {
+        cache->misses++;
+    }
+    Pthread_mutex_unlock(&cache->mtx);
+
+    sqlite3_free(key);
+    return ent;
+}
+
+void fdb_rcache_put(fdb_rcache_t *cache, fdb_rcache_ent_t *ent)
+{
+    Pthread_mutex_lock(&cache->mtx);
+    if (--ent->refcnt == 0)
+        _rcache_ent_free(ent);
+    Pthread_mutex_unlock(&cache->mtx);
+}
+
+int fdb_rcache_ent_nrows(fdb_rcache_ent_t *ent)
+{
+    return ent->nrows;
+}
+
+char *fdb_rcache_ent_row(fdb_rcache_ent_t *ent, int row, int *len)
+{
+    *len = ent->offs[row + 1] - ent->offs[row];
+    return ent->buf + ent->offs[row];
+}
+
+/**
+ * Start recording the result of a remote query
+ *
+ */
+fdb_rcache_fill_t *fdb_rcache_fill_start(fdb_rcache_t *cache,
+                                         const char *tblname,
+                                         unsigned long long version,
+                                         const char *settings, const char *sql)
+{
+    fdb_rcache_fill_t *fill = calloc(1, sizeof(fdb_rcache_fill_t));
+    if (!fill)
+        return NULL;
+
+    char *key = _rcache_key(tblname, version, settings, sql);
+    if (key) {
+        fill->key = strdup(key);
+        sqlite3_free(key);
+    }
+    fill->tblname = strdup(tblname);
+    fill->nalloc = 16;
+    fill->offs = malloc(sizeof(int) * (fill->nalloc + 1));
+    if (!fill->key || !fill->tblname || !fill->offs) {
+        fdb_rcache_fill_done(cache, fill, 0);
+        return NULL;
+    }
+    fill->offs[0] = 0;
+
+    Pthread_mutex_lock(&cache->mtx);
+    fill->gen = cache->gen;
+    Pthread_mutex_unlock(&cache->mtx);
+
+    return fill;
+}
+
+/**
+ * Record one row; returns !0 if the result became too large to cache
+ *
+ */
+int fdb_rcache_fill_add(fdb_rcache_fill_t *fill, const char *row, int len)
+{
+    if (fill->nrows >= gbl_fdb_rcache_max_rows ||
+        fill->bytes + len > gbl_fdb_rcache_max_bytes / 4)
+        return -1;
+
+    if (fill->nrows == fill->nalloc) {
+        int *offs = realloc(fill->offs, sizeof(int) * (2 * fill->nalloc + 1));
+        if (!offs)
+            return -1;
+        fill->offs = offs;
+        fill->nalloc *= 2;
+    }
+    if (fill->bytes + len > fill->balloc) {
+        int balloc = (fill->bytes + len) * 2;
+        char *buf = realloc(fill->buf, balloc);
+        if (!buf)
+            return -1;
+        fill->buf = buf;
+        fill->balloc = balloc;
+    }
+    memcpy(fill->buf + fill->bytes, row, len);
+    fill->bytes += len;
+    fill->offs[++fill->nrows] = fill->bytes;
+
+    return 0;
+}
+
+/**
+ * Done recording; if "publish" is set, the complete result is cached
+ * unless the cache was invalidated since the recording started
+ *
+ */
+void fdb_rcache_fill_done(fdb_rcache_t *cache, fdb_rcache_fill_t *fill,
+                          int publish)
+{
+    fdb_rcache_ent_t *ent = NULL;
+
+    if (publish && (ent = calloc(1, sizeof(fdb_rcache_ent_t))) != NULL) {
+        ent->key = fill->key;
+        ent->tblname = fill->tblname;
+        ent->buf = fill->buf;
+        ent->offs = fill->offs;
+        ent->nrows = fill->nrows;
+        ent->bytes = fill->bytes + sizeof(*ent) + strlen(ent->key) +
+                     sizeof(int) * (fill->nalloc + 1);
+        ent->refcnt = 1;
+
+        Pthread_mutex_lock(&cache->mtx);
+        if (fill->gen != cache->gen ||
+            hash_find_readonly(cache->h_ents, &ent->key)) {
+            /* stale, or a concurrent cursor won the race */
+            Pthread_mutex_unlock(&cache->mtx);
+            goto free;
+        }
+        while (cache->bytes + ent->bytes > gbl_fdb_rcache_max_bytes &&
+               cache->lru.bot) {
+            _rcache_unlink(cache, cache->lru.bot);
+            cache->evicts++;
+        }
+        hash_add(cache->h_ents, ent);
+        listc_atl(&cache->lru, ent);
+        cache->bytes += ent->bytes;
+        cache->stores++;
+        Pthread_mutex_unlock(&cache->mtx);
+
+        free(fill);
+        return;
+    }
+
+free:
+    free(fill->key);
+    free(fill->tblname);
+    free(fill->buf);
+    free(fill->offs);
+    free(fill);
+    free(ent);
+}
+
+/**
+ * Check if the remote lsn needs to be probed; if this returns 1, the caller
+ * owns the probe, which holds a reference to the cache, and must call
+ * fdb_rcache_lsn_update(); a negative return means the cache cannot be
+ * trusted right now, which is the case until a due probe completes
+ *
+ */
+int fdb_rcache_lsn_check_due(fdb_rcache_t *cache)
+{
+    int now = comdb2_time_epochms();
+    int rc;
+
+    Pthread_mutex_lock(&cache->mtx);
+    if (cache->lsn_probing) {
+        rc = -1;
+    } else if (cache->lsn_probed &&
+               now - cache->lsn_checkms < gbl_fdb_rcache_lsn_check_msec) {
+        rc = cache->lsn_valid ? 0 : -1;
+    } else {
+        cache->lsn_probing = 1;
+        cache->refs++;
+        rc = 1;
+    }
+    Pthread_mutex_unlock(&cache->mtx);
+
+    return rc;
+}
+
+/**
+ * Record the probed remote lsn, invalidating everything if it moved;
+ * rc != 0 means the probe failed.  Drops the probe's reference.
+ *
+ */
+void fdb_rcache_lsn_update(fdb_rcache_t *cache, int rc, int file, int offset)
+{
+    Pthread_mutex_lock(&cache->mtx);
+    if (rc || file != cache->lsn_file || offset != cache->lsn_offset) {
+        _rcache_flush(cache, NULL);
+        cache->lsn_file = rc ? 0 : file;
+        cache->lsn_offset = rc ? 0 : offset;
+    }
+    cache->lsn_checkms = comdb2_time_epochms();
+    cache->lsn_probed = 1;
+    cache->lsn_valid = !rc;
+    cache->lsn_probing = 0;
+    Pthread_mutex_unlock(&cache->mtx);
+
+    _rcache_unref(cache);
+}
+
+void fdb_rcache_stats(fdb_rcache_t *cache, const char *dbname)
+{
+    Pthread_mutex_lock(&cache->mtx);
+    logmsg(LOGMSG_USER,
+           "Db \"%s\" result cache: entries %d bytes %d hits %llu misses %llu "
+           "stores %llu evicts %llu invalidations %llu lsn %d:%d\n",
+           dbname, hash_get_num_entries(cache->h_ents), cache->bytes,
+           cache->hits, cache->misses, cache->stores, cache->evicts,
+           cache->invalidations, cache->lsn_file, cache->lsn_offset);
+    Pthread_mutex_unlock(&cache->mtx);
+}
@@ -42,4 +42,46 @@ int fdb_sqlstat_cache_create(struct sqlclntstate *clnt, fdb_t *fdb,
  */
 void fdb_sqlstat_cache_destroy(fdb_sqlstat_cache_t **pcache);
 
+/**
+ * Remote result cache, one per foreign db
+ *
+ */
+typedef struct fdb_rcache fdb_rcache_t;
+typedef struct fdb_rcache_ent fdb_rcache_ent_t;
+typedef struct fdb_rcache_fill fdb_rcache_fill_t;
+
+extern int gbl_fdb_rcache;
+extern int gbl_fdb_rcache_max_rows;
+extern int gbl_fdb_rcache_max_bytes;
+extern int gbl_fdb_rcache_lsn_check_msec;
+
+fdb_rcache_t *fdb_rcache_create(void);
+void fdb_rcache_destroy(fdb_rcache_t **pcache);
+
+/* remove the cached results for table "tblname", or all if NULL */
+void fdb_rcache_flush(fdb_rcache_t *cache, const char *tblname);
+
+/* lookup a cached result; a found entry is pinned until fdb_rcache_put */
+fdb_rcache_ent_t *fdb_rcache_get(fdb_rcache_t *cache, const char *tblname,
+                                 unsigned long long version,
+                                 const char *settings, const char *sql);
+void fdb_rcache_put(fdb_rcache_t *cache, fdb_rcache_ent_t *ent);
+int fdb_rcache_ent_nrows(fdb_rcache_ent_t *ent);
+char *fdb_rcache_ent_row(fdb_rcache_ent_t *ent, int row, int *len);
+
+/* record the result of a remote query while it is streamed */
+fdb_rcache_fill_t *fdb_rcache_fill_start(fdb_rcache_t *cache,
+                                         const char *tblname,
+                                         unsigned long long version,
+                                         const char *settings, const char *sql);
+int fdb_rcache_fill_add(fdb_rcache_fill_t *fill, const char *row, int len);
+void fdb_rcache_fill_done(fdb_rcache_t *cache, fdb_rcache_fill_t *fill,
+                          int publish);
+
+/* remote lsn based invalidation */
+int fdb_rcache_lsn_check_due(fdb_rcache_t *cache);
+void fdb_rcache_lsn_update(fdb_rcache_t *cache, int rc, int file, int offset);
+
+void fdb_rcache_stats(fdb_rcache_t *cache, const char *dbname);
+
 #endif
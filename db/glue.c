@@ -635,6 +635,17 @@ static const char *sync_to_str(int sync)
     }
 }
 
+/* with coherency leases, a commit is only acknowledged once every replicant
+   has a lease covering it */
+void coherency_lease_wait(void)
+{
+    if (bdb_attr_get(thedb->bdb_attr, BDB_ATTR_COHERENCY_LEASE)) {
+        uint64_t now = gettimeofday_ms(), next_commit = next_commit_timestamp();
+        if (next_commit > now)
+            poll(0, 0, next_commit - now);
+    }
+}
+
 static int trans_wait_for_seqnum_int(void *bdb_handle, struct dbenv *dbenv,
                                      struct ireq *iq, char *source_node,
                                      int timeoutms, int adaptive,
@@ -724,11 +735,7 @@ static int trans_wait_for_seqnum_int(void *bdb_handle, struct dbenv *dbenv,
         break;
     }
 
-    if (bdb_attr_get(dbenv->bdb_attr, BDB_ATTR_COHERENCY_LEASE)) {
-        uint64_t now = gettimeofday_ms(), next_commit = next_commit_timestamp();
-        if (next_commit > now)
-            poll(0, 0, next_commit - now);
-    }
+    coherency_lease_wait();
 
     end_ms = comdb2_time_epochms();
     iq->reptimems += (end_ms - start_ms);
@@ -846,7 +853,12 @@ static int trans_commit_int(struct ireq *iq, void *trans, char *source_host, int
         return rc;
     }
 
-    if (nowait == 0) {
+    /* release_schema_lk == parent-tran */
+    if (nowait == 0 && release_schema_lk && commit_ack_defer(iq, &ss, timeoutms, adaptive)) {
+        if (gbl_debug_disttxn_trace) {
+            logmsg(LOGMSG_USER, "%s wait-for-seqnum deferred\n", __func__);
+        }
+    } else if (nowait == 0) {
         startms = comdb2_time_epochms();
         rc = trans_wait_for_seqnum_int(bdb_handle, thedb, iq, source_host, timeoutms, adaptive, &ss);
         endms = comdb2_time_epochms();
@@ -1846,6 +1858,39 @@ int get_next_genids(struct ireq *iq, int ixnum, void *key, int keylen,
     return rc;
 }
 
+int get_prev_genids(struct ireq *iq, int ixnum, void *key, int keylen,
+                    unsigned long long *genids, int numgenids,
+                    int *num_genids_gotten)
+{
+    int rc;
+    void *bdb_handle;
+    int bdb_err;
+
+    bdb_handle = get_bdb_handle(iq->usedb, AUXDB_NONE);
+    if (!bdb_handle)
+        return ERR_NO_AUXDB;
+
+    rc = bdb_fetch_prev_genids(bdb_handle, ixnum, keylen, key, genids,
+                               numgenids, num_genids_gotten, &bdb_err);
+
+    return rc;
+}
+
+/* fault in the data record genid and the num records after it (before it if
+   prev is set) */
+int prefault_dta_records(struct ireq *iq, unsigned long long genid, int num,
+                         int prev)
+{
+    void *bdb_handle;
+    int num_gotten;
+
+    bdb_handle = get_bdb_handle(iq->usedb, AUXDB_NONE);
+    if (!bdb_handle)
+        return ERR_NO_AUXDB;
+
+    return bdb_prefault_dta(bdb_handle, genid, num, prev, &num_gotten);
+}
+
 int ix_find_flags(struct ireq *iq, void *trans, int ixnum, void *key,
                   int keylen, void *fndkey, int *fndrrn,
                   unsigned long long *genid, void *fnddta, int *fndlen,
@@ -3994,6 +4039,23 @@ static void get_disable_skipscan(struct dbtable *tbl, tran_type *tran)
     free(str);
 }
 
+static void get_zonemap(struct dbtable *tbl, tran_type *tran)
+{
+    if (tbl->dbtype != DBTYPE_TAGGED_TABLE)
+        return;
+
+    char *str = NULL;
+    int rc = bdb_get_table_parameter_tran(tbl->tablename, "zonemap", &str,
+                                          tran);
+    if (rc != 0) {
+        tbl->zonemap = 0;
+        return;
+    }
+
+    tbl->zonemap = (strncmp(str, "true", 4) == 0);
+    free(str);
+}
+
 
 void get_disable_skipscan_all() 
 {
@@ -4004,6 +4066,7 @@ void get_disable_skipscan_all()
     for (int ii = 0; ii < thedb->num_dbs; ii++) {
         struct dbtable *d = thedb->dbs[ii];
         get_disable_skipscan(d, tran);
+        get_zonemap(d, tran);
     }
     curtran_puttran(tran);
 }
@@ -4187,6 +4250,7 @@ int backend_open_tran(struct dbenv *dbenv, tran_type *tran, uint32_t flags)
             }
 
             get_disable_skipscan(tbl, tran);
+            get_zonemap(tbl, tran);
         }
 
         if (bthashsz) {
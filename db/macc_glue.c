@@ -280,6 +280,7 @@ static dbtable *newdb_from_schema(struct dbenv *env, char *tblname, int dbnum)
     }     /* if (n_constraints > 0) */
     tbl->ixuse = calloc(tbl->nix, sizeof(unsigned long long));
     tbl->sqlixuse = calloc(tbl->nix, sizeof(unsigned long long));
+    tbl->sqlixlookups = calloc(tbl->nix, sizeof(unsigned long long));
     return tbl;
 }
 
@@ -168,6 +168,7 @@ int osql_blkseq_init(void)
         logmsg(LOGMSG_FATAL, "UNABLE TO init hash\n");
         abort();
     }
+    hash_set_open_addressing(hiqs);
 
     hiqs_cnonce = hash_init_user(cnonce_hashfunc, cnonce_hashcmpfunc, 0, 0);
     if (!hiqs) {
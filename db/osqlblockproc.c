@@ -44,6 +44,7 @@
 #include "block_internal.h"
 #include "osqlsession.h"
 #include "osqlcomm.h"
+#include "comdb2_atomic.h"
 #include "sqloffload.h"
 #include "comdb2uuid.h"
 #include "logmsg.h"
@@ -86,6 +87,13 @@ struct blocksql_tran {
 
     /* prefetch */
     struct dbtable *last_db;
+
+    /* streaming: the block processor applies ops while they arrive;
+       all protected by store_mtx */
+    pthread_cond_t stream_cond; /* signalled when an op is saved */
+    int is_streaming;           /* dispatched before the last op arrived */
+    int stream_done;            /* no more ops will be saved */
+    struct errstat stream_err;  /* errval set if the stream failed */
 };
 
 typedef struct oplog_key {
@@ -105,6 +113,15 @@ typedef struct {
 
 int gbl_selectv_writelock_on_update = 1;
 
+/* dispatch sessions to the block processor once they have this many ops,
+   without waiting for the commit; 0 disables streaming */
+int gbl_osql_stream_bplog_threshold = 0;
+int64_t gbl_osql_streamed_txns = 0;
+
+/* a streamed bplog that gets no new op for this long fails, rather than
+   keep the locks of its transaction and a writer thread */
+#define OSQL_STREAM_STALL_MS 10000
+
 static int apply_changes(struct ireq *iq, blocksql_tran_t *tran, void *iq_tran,
                          int *nops, struct block_err *err,
                          int (*func)(struct ireq *, uuid_t, void *, char **,
@@ -214,6 +231,7 @@ blocksql_tran_t *osql_bplog_create(int is_uuid, int is_reorder)
 
     tran->is_uuid = is_uuid;
     Pthread_mutex_init(&tran->store_mtx, NULL);
+    Pthread_cond_init(&tran->stream_cond, NULL);
     tran->tbl_idx = USHRT_MAX; /* Mark as uninitialized until USEDB */
 
     /* init temporary table and cursor */
@@ -343,9 +361,11 @@ int osql_bplog_commit(struct ireq *iq, void *iq_trans, int *nops,
     ckgenid_state_t cgstate = {.iq = iq, .trans = iq_trans, .err = err};
     int rc;
 
-    /* Pre-process selectv's, getting a writelock on rows that are later updated
+    /* Pre-process selectv's, getting a writelock on rows that are later updated;
+     * a streamed bplog is still growing, its selectv's are checked in order
      */
-    if ((rc = osql_process_selectv(tran, pselectv_callback, &cgstate)) != 0) {
+    if (!tran->is_streaming &&
+        (rc = osql_process_selectv(tran, pselectv_callback, &cgstate)) != 0) {
         iq->timings.req_applied = osql_log_time();
         return rc;
     }
@@ -409,6 +429,7 @@ void osql_bplog_close(blocksql_tran_t **ptran)
     }
 
     Pthread_mutex_destroy(&tran->store_mtx);
+    Pthread_cond_destroy(&tran->stream_cond);
 
     rc = bdb_temp_table_close(thedb->bdb_env, tran->db, &bdberr);
     if (rc != 0) {
@@ -607,6 +628,9 @@ static int _pre_process_saveop(osql_sess_t *sess, blocksql_tran_t *tran,
     case OSQL_PARTICIPANT:
         sess_save_participant(sess, tran->is_uuid, rpl, rplen);
         break;
+    case OSQL_SNAPINFO:
+        osql_extract_early_snap_info(sess, rpl, rplen);
+        break;
     }
 
     if (tran->is_selectv_wl_upd) {
@@ -632,6 +656,42 @@ static int _pre_process_saveop(osql_sess_t *sess, blocksql_tran_t *tran,
     return rc;
 }
 
+/* called with store_mtx held */
+static void stream_set_err(blocksql_tran_t *tran, int rc, const char *errstr)
+{
+    if (!tran->stream_err.errval)
+        errstat_set_rcstrf(&tran->stream_err, rc, "%s",
+                           errstr ? errstr : "streamed transaction cancelled");
+}
+
+static void stream_fail(blocksql_tran_t *tran, int rc, const char *errstr)
+{
+    Pthread_mutex_lock(&tran->store_mtx);
+    stream_set_err(tran, rc, errstr);
+    Pthread_cond_broadcast(&tran->stream_cond);
+    Pthread_mutex_unlock(&tran->store_mtx);
+}
+
+/* ops that change how the block processor sets up the transaction cannot
+   arrive once it started applying it */
+static const char *stream_unsupported_op(blocksql_tran_t *tran, char *rpl,
+                                         int rplen, int type)
+{
+    switch (type) {
+    case OSQL_SCHEMACHANGE:
+        return "schema change in a streamed transaction";
+    case OSQL_PREPARE:
+    case OSQL_DIST_TXNID:
+    case OSQL_PARTICIPANT:
+        return "distributed commit of a streamed transaction";
+    case OSQL_BPFUNC:
+        if (need_views_lock(rpl, rplen, tran->is_uuid) == 1)
+            return "partitioned view change in a streamed transaction";
+        break;
+    }
+    return NULL;
+}
+
 #if DEBUG_REORDER
 #define DEBUG_PRINT_TMPBL_SAVING()                                             \
     uuidstr_t mus;                                                             \
@@ -671,6 +731,21 @@ int osql_bplog_saveop(osql_sess_t *sess, blocksql_tran_t *tran, char *rpl,
     DEBUGMSG("uuid=%s type=%d (%s) seq=%lld\n", us, type, osql_reqtype_str(type), tran->seq);
 #endif
 
+    if (tran->is_streaming) {
+        /* the block processor is applying the ops already; once the stream
+           failed, the rest of the bplog is dropped until the last op */
+        const char *errstr = stream_unsupported_op(tran, rpl, rplen, type);
+        if (errstr) {
+            logmsg(LOGMSG_ERROR, "%s: seq=%u %s\n", __func__, tran->seq, errstr);
+            stream_fail(tran, ERR_INTERNAL, errstr);
+        }
+        Pthread_mutex_lock(&tran->store_mtx);
+        rc = tran->stream_err.errval;
+        Pthread_mutex_unlock(&tran->store_mtx);
+        if (rc)
+            return 0;
+    }
+
     rc = _pre_process_saveop(sess, tran, rpl, rplen, type);
     if (rc) {
         logmsg(LOGMSG_ERROR, "%s: fail to preprocess oplog seq=%u rc=%d\n",
@@ -714,6 +789,8 @@ int osql_bplog_saveop(osql_sess_t *sess, blocksql_tran_t *tran, char *rpl,
                                &sess->iq->osql_step_ix, sess->rqid, sess->uuid,
                                tran->seq);
         }
+        if (tran->is_streaming)
+            Pthread_cond_signal(&tran->stream_cond);
     }
 
     Pthread_mutex_unlock(&tran->store_mtx);
@@ -721,6 +798,59 @@ int osql_bplog_saveop(osql_sess_t *sess, blocksql_tran_t *tran, char *rpl,
     return rc;
 }
 
+/**
+ * Returns 1 if the session has enough ops to be dispatched now, with the
+ * rest of its bplog streamed to the block processor while it applies it
+ */
+int osql_bplog_stream_ready(osql_sess_t *sess, blocksql_tran_t *tran)
+{
+    if (gbl_osql_stream_bplog_threshold <= 0 ||
+        tran->seq < gbl_osql_stream_bplog_threshold)
+        return 0;
+
+    /* reordered bplogs are applied in key order, not in arrival order;
+       schema changes, views and 2pc are set up from the session before
+       the first op is applied */
+    if (tran->is_reorder_on || sess->scs.count || sess->is_tptlock ||
+        sess->is_participant || sess->is_coordinator)
+        return 0;
+
+    /* the blkseq (cnonce) replay check runs before the first op is applied;
+       only replicants that send their snap info ahead of the ops, once they
+       commit, are streamed (see OSQL_SNAPINFO) */
+    if (!sess->snap_info)
+        return 0;
+
+    return 1;
+}
+
+/**
+ * Mark the bplog as streamed; called before dispatching the session
+ */
+void osql_bplog_stream_start(blocksql_tran_t *tran)
+{
+    Pthread_mutex_lock(&tran->store_mtx);
+    tran->is_streaming = 1;
+    Pthread_mutex_unlock(&tran->store_mtx);
+    ATOMIC_ADD64(gbl_osql_streamed_txns, 1);
+}
+
+/**
+ * No more ops will be saved in a streamed bplog; a non-zero rc fails the
+ * transaction (replicant rolled back, went away, or ops could not be saved)
+ */
+void osql_bplog_stream_end(blocksql_tran_t *tran, int rc, const char *errstr)
+{
+    Pthread_mutex_lock(&tran->store_mtx);
+    if (!tran->stream_done) {
+        tran->stream_done = 1;
+        if (rc)
+            stream_set_err(tran, rc, errstr);
+    }
+    Pthread_cond_broadcast(&tran->stream_cond);
+    Pthread_mutex_unlock(&tran->store_mtx);
+}
+
 /**
  * Set proper blkseq from session to iq
  * NOTE: We don't need to create buffers _SEQ, _SEQV2 for it
@@ -989,6 +1119,85 @@ get_next_merge_tmps(struct temp_cursor *dbc, struct temp_cursor *dbc_ins,
 #define DEBUG_PRINT_TMPBL_READ()
 #endif
 
+/* Wait until op `seq' of a streamed bplog is saved, or the stream ends.
+ * The replicant sends the rest of a streamed bplog in one go when it
+ * commits, so this waits on the network only briefly; a stream that stalls
+ * fails.  A failed stream is reported right away, the ops that arrive after
+ * the session is closed are dropped.
+ * Called with store_mtx held.  Returns 0 if the op is there, IX_PASTEOF if
+ * the bplog ended before it, or the rc that failed the stream. */
+static int stream_wait_op(blocksql_tran_t *tran, uint32_t seq)
+{
+    struct timespec ts;
+    int waitms = 0;
+
+    while (1) {
+        if (tran->stream_err.errval)
+            return tran->stream_err.errval;
+        if (seq < tran->seq)
+            return 0;
+        if (tran->stream_done)
+            return IX_PASTEOF;
+
+        if (bdb_lock_desired(thedb->bdb_env))
+            return ERR_NOMASTER;
+
+        if (waitms >= OSQL_STREAM_STALL_MS) {
+            errstat_set_rcstrf(&tran->stream_err, ERR_INTERNAL,
+                               "streamed bplog stalled at op %u", seq);
+            return ERR_INTERNAL;
+        }
+
+        clock_gettime(CLOCK_REALTIME, &ts);
+        ts.tv_nsec += 100 * 1000 * 1000;
+        if (ts.tv_nsec >= 1000000000) {
+            ts.tv_sec++;
+            ts.tv_nsec -= 1000000000;
+        }
+        pthread_cond_timedwait(&tran->stream_cond, &tran->store_mtx, &ts);
+        waitms += 100;
+    }
+}
+
+/* Position dbc on op `seq' of a streamed bplog.  Ops are read by sequence
+ * rather than with next, since saving more ops can rebuild the temptable
+ * under the cursor.  Returns IX_PASTEOF past the last op; failures are
+ * returned in rc_out. */
+static int stream_next_op(struct ireq *iq, blocksql_tran_t *tran,
+                          struct temp_cursor *dbc, uint32_t seq, int *bdberr,
+                          struct block_err *err, int *rc_out)
+{
+    oplog_key_t key = {0};
+    int rc;
+
+    rc = stream_wait_op(tran, seq);
+    if (rc == 0) {
+        key.seq = seq;
+        rc = bdb_temp_table_find_exact(thedb->bdb_env, dbc, &key, sizeof(key),
+                                       bdberr);
+        if (rc == IX_FND)
+            return 0;
+        logmsg(LOGMSG_ERROR, "%s: missing op seq=%u rc=%d bdberr=%d\n",
+               __func__, seq, rc, *bdberr);
+        rc = ERR_INTERNAL;
+    } else if (rc == IX_PASTEOF) {
+        return rc;
+    }
+
+    err->blockop_num = seq;
+    err->errcode = rc;
+    err->ixnum = 0;
+    if (rc == ERR_NOMASTER) {
+        reqlog_set_error(iq->reqlogger, "ERR_NOMASTER", rc);
+    } else {
+        reqerrstr(iq, COMDB2_BLK_RC_FAIL_COMMIT, "%s",
+                  tran->stream_err.errstr);
+        reqlog_set_error(iq->reqlogger, "streamed transaction failed", rc);
+    }
+    *rc_out = rc;
+    return 0;
+}
+
 static int process_this_session(
     struct ireq *iq, void *iq_tran, osql_sess_t *sess, int *bdberr, int *nops,
     struct block_err *err, struct temp_cursor *dbc, struct temp_cursor *dbc_ins,
@@ -1005,6 +1214,8 @@ static int process_this_session(
     int step = 0;
     int receivedrows = 0;
     int flags = 0;
+    blocksql_tran_t *tran = sess->tran;
+    int streaming = tran->is_streaming;
 
     iq->queryid = osql_sess_queryid(sess);
     if (gbl_max_time_per_txn_ms)
@@ -1029,8 +1240,14 @@ static int process_this_session(
 #endif
 
     /* go through each record */
-    rc = bdb_temp_table_first(thedb->bdb_env, dbc, bdberr);
-    if (rc && rc != IX_EMPTY && rc != IX_NOTFND) {
+    if (streaming) {
+        rc = stream_next_op(iq, tran, dbc, 0, bdberr, err, &rc_out);
+        if (rc_out)
+            return rc_out;
+    } else {
+        rc = bdb_temp_table_first(thedb->bdb_env, dbc, bdberr);
+    }
+    if (rc && rc != IX_EMPTY && rc != IX_NOTFND && rc != IX_PASTEOF) {
         reqlog_set_error(iq->reqlogger, "bdb_temp_table_first failed", rc);
         logmsg(LOGMSG_ERROR, "%s: bdb_temp_table_first failed rc=%d bdberr=%d\n",
                 __func__, rc, *bdberr);
@@ -1081,11 +1298,18 @@ static int process_this_session(
 
         lastrcv = receivedrows;
 
+        /* let the reader save more ops of a streamed bplog meanwhile */
+        if (streaming)
+            Pthread_mutex_unlock(&tran->store_mtx);
+
         /* This call locks pages:func is osql_process_packet */
         rc_out = func(iq, sess->uuid, iq_tran, &data, datalen,
                       &flags, &updCols, blobs, step, err, &receivedrows);
         free(data);
 
+        if (streaming)
+            Pthread_mutex_lock(&tran->store_mtx);
+
         EVENTLOG_DEBUG(
             if (rc_out != 0 && rc_out != OSQL_RC_DONE) {
                 uuidstr_t uuid;
@@ -1105,8 +1329,15 @@ static int process_this_session(
         }
 
         step++;
-        rc = get_next_merge_tmps(dbc, dbc_ins, &opkey, &opkey_ins, &drain_adds,
-                                 bdberr, add_stripe);
+        if (streaming) {
+            rc = stream_next_op(iq, tran, dbc, opkey->seq + 1, bdberr, err,
+                                &rc_out);
+            if (rc == 0 && rc_out == 0)
+                opkey = (oplog_key_t *)bdb_temp_table_key(dbc);
+        } else {
+            rc = get_next_merge_tmps(dbc, dbc_ins, &opkey, &opkey_ins,
+                                     &drain_adds, bdberr, add_stripe);
+        }
     }
 
     if (iq->osql_step_ix)
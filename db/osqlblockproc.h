@@ -88,6 +88,23 @@ void osql_bplog_close(blocksql_tran_t **ptran);
 int osql_bplog_saveop(osql_sess_t *sess, blocksql_tran_t *tran, char *rpl,
                       int rplen, int type);
 
+/**
+ * Returns 1 if the session has enough ops to be dispatched now, with the
+ * rest of its bplog streamed to the block processor while it applies it
+ */
+int osql_bplog_stream_ready(osql_sess_t *sess, blocksql_tran_t *tran);
+
+/**
+ * Mark the bplog as streamed; called before dispatching the session
+ */
+void osql_bplog_stream_start(blocksql_tran_t *tran);
+
+/**
+ * No more ops will be saved in a streamed bplog; a non-zero rc fails the
+ * transaction
+ */
+void osql_bplog_stream_end(blocksql_tran_t *tran, int rc, const char *errstr);
+
 /**
  * Construct a blockprocessor transaction buffer containing
  * a sock sql /recom  / snapisol / serial transaction
@@ -3698,6 +3698,7 @@ int osql_comm_is_done(osql_sess_t *sess, int type, char *rpl, int rpllen,
     case OSQL_DELIDX:
     case OSQL_QBLOB:
     case OSQL_STARTGEN:
+    case OSQL_SNAPINFO:
         break;
     case OSQL_DONE_SNAP:
         osql_extract_snap_info(sess, rpl, rpllen);
@@ -4028,6 +4029,40 @@ int osql_send_startgen(osql_target_t *target, unsigned long long rqid, uuid_t uu
     return rc;
 }
 
+int osql_send_snap_info(osql_target_t *target, uuid_t uuid,
+                        snap_uid_t *snap_info, int type)
+{
+    uint8_t buf[OSQLCOMM_UUID_RPL_TYPE_LEN + sizeof(snap_uid_t)] = {0};
+    uint8_t *p_buf = buf;
+    uint8_t *p_buf_end = buf + sizeof(buf);
+    osql_uuid_rpl_t hd = {0};
+    int rc;
+
+    if (check_master(target))
+        return OSQL_SEND_ERROR_WRONGMASTER;
+
+    hd.type = OSQL_SNAPINFO;
+    comdb2uuidcpy(hd.uuid, uuid);
+    if (!(p_buf = osqlcomm_uuid_rpl_type_put(&hd, p_buf, p_buf_end)) ||
+        !(p_buf = (uint8_t *)snap_uid_put(snap_info, p_buf, p_buf_end))) {
+        logmsg(LOGMSG_ERROR, "%s failed to pack snap info\n", __func__);
+        return -1;
+    }
+
+    if (gbl_enable_osql_logging) {
+        uuidstr_t us;
+        logmsg(LOGMSG_DEBUG, "[%s] send OSQL_SNAPINFO keylen %d\n",
+               comdb2uuidstr(uuid, us), snap_info->keylen);
+    }
+
+    type = osql_net_type_to_net_uuid_type(type);
+    rc = target->send(target, type, buf, sizeof(buf), 0, NULL, 0);
+    if (rc)
+        logmsg(LOGMSG_ERROR, "%s target->send returns rc=%d\n", __func__, rc);
+
+    return rc;
+}
+
 /**
  * Send USEDB op
  * It handles remote/local connectivity
@@ -7856,7 +7891,8 @@ done_delete:
 
     case OSQL_DIST_TXNID:
     case OSQL_PARTICIPANT:
-    case OSQL_PREPARE: {
+    case OSQL_PREPARE:
+    case OSQL_SNAPINFO: {
         /* handled in pre_process_saveop */
         return 0;
     } break;
@@ -8626,6 +8662,16 @@ static void osql_extract_snap_info(osql_sess_t *sess, void *rpl, int rpllen)
     if ((p_buf = snap_uid_get(snap_info, p_buf, p_buf_end)) == NULL)
         abort();
 
+    if (sess->snap_info) {
+        /* sent ahead of the ops (OSQL_SNAPINFO), and possibly in use by the
+         * block processor already; keep its key and its write effects */
+        sess->snap_info->replicant_is_able_to_retry =
+            snap_info->replicant_is_able_to_retry;
+        sess->snap_info->effects.num_selected = snap_info->effects.num_selected;
+        free(snap_info);
+        return;
+    }
+
     sess->snap_info = snap_info;
 
     /* Reset 'write' query effects as master will repopulate them
@@ -8637,6 +8683,34 @@ static void osql_extract_snap_info(osql_sess_t *sess, void *rpl, int rpllen)
     sess->snap_info->effects.num_inserted = 0;
 }
 
+/* OSQL_SNAPINFO: the replicant sends its snap info ahead of the ops, so the
+ * session can be dispatched before its commit message arrives */
+void osql_extract_early_snap_info(osql_sess_t *sess, void *rpl, int rpllen)
+{
+    if (gbl_disable_cnonce_blkseq || sess->snap_info)
+        return;
+
+    snap_uid_t *snap_info = calloc(1, sizeof(snap_uid_t));
+    if (!snap_info) {
+        logmsg(LOGMSG_ERROR, "%s malloc failure, no cnonce\n", __func__);
+        return;
+    }
+
+    const uint8_t *p_buf = (uint8_t *)rpl + sizeof(osql_uuid_rpl_t);
+    const uint8_t *p_buf_end = (const uint8_t *)rpl + rpllen;
+    if (snap_uid_get(snap_info, p_buf, p_buf_end) == NULL) {
+        logmsg(LOGMSG_ERROR, "%s short snap info %d\n", __func__, rpllen);
+        free(snap_info);
+        return;
+    }
+
+    sess->snap_info = snap_info;
+    sess->snap_info->effects.num_affected = 0;
+    sess->snap_info->effects.num_updated = 0;
+    sess->snap_info->effects.num_deleted = 0;
+    sess->snap_info->effects.num_inserted = 0;
+}
+
 #define UNK_ERR_SEND_RETRY 10
 
 int offload_net_send(const char *host, int usertype, void *data, int datalen,
@@ -158,6 +158,20 @@ int osql_send_commit(osql_target_t *target, uuid_t uuid, int nops,
 int osql_send_startgen(osql_target_t *target, unsigned long long rqid,
                        uuid_t uuid, uint32_t start_gen, int type);
 
+/**
+ * Send the snap info of a transaction ahead of its ops, so that the master
+ * can stream its bplog (uuid sessions only)
+ *
+ */
+int osql_send_snap_info(osql_target_t *target, uuid_t uuid,
+                        snap_uid_t *snap_info, int type);
+
+/**
+ * Save the snap info sent ahead of the ops in the session
+ *
+ */
+void osql_extract_early_snap_info(osql_sess_t *sess, void *rpl, int rpllen);
+
 /**
  * Prepare record
  *
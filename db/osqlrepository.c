@@ -62,6 +62,8 @@ int osql_repository_init(void)
 
     if (!tmp->rqs || !tmp->rqsuuid)
         goto error;
+    hash_set_open_addressing(tmp->rqs);
+    hash_set_open_addressing(tmp->rqsuuid);
 
     theosql = tmp;
     return 0;
@@ -45,6 +45,7 @@ struct sess_impl {
     int clients; /* number of threads using the session */
 
     unsigned dispatched : 1; /* Set when session is dispatched to handle_buf */
+    unsigned streaming : 1;  /* Set if dispatched before the last op arrived */
     unsigned terminate : 1;  /* Set when this session is about to be terminated */
     unsigned socket : 1;     /* Set if request comes over socket instead of net */
     unsigned embedded_sql : 1; /* Set if sql is part of session malloc object */
@@ -53,7 +54,7 @@ struct sess_impl {
 };
 
 static void _destroy_session(osql_sess_t **psess);
-static int handle_buf_sorese(osql_sess_t *psess);
+static int handle_buf_sorese(osql_sess_t *psess, int streaming);
 static osql_sess_t *_osql_sess_create(osql_sess_t *sess, char *tzname, int type, unsigned long long rqid, uuid_t uuid,
                                       const char *host, int is_reorder_on, int is_final);
 
@@ -212,9 +213,9 @@ static void _destroy_session(osql_sess_t **psess)
 /**
  * Mark that the reader thread is working on this session
  *
- * Return error if session is dispatched; it is silently
- * ignored in implementations when redundant packets can
- * arrive
+ * Return error if session is dispatched, unless its bplog is
+ * still streaming; it is silently ignored in implementations
+ * when redundant packets can arrive
  */
 int osql_sess_addclient(osql_sess_t *psess)
 {
@@ -222,7 +223,7 @@ int osql_sess_addclient(osql_sess_t *psess)
     int rc = 0;
 
     Pthread_mutex_lock(&sess->mtx);
-    if (sess->dispatched) {
+    if (sess->dispatched && !sess->streaming) {
         rc = -1;
     } else
         sess->clients += 1;
@@ -358,7 +359,7 @@ int osql_prepare(const char *dist_txnid, const char *coordinator_dbname, const c
         }
         return 0;
     }
-    return handle_buf_sorese(sess);
+    return handle_buf_sorese(sess, 0);
 }
 
 /* Coordinator asked participant to discard this session */
@@ -397,6 +398,50 @@ int osql_discard(const char *dist_txnid)
 
 // int osql_abort_prepared(unsigned long long rqid, uuid_t uuid)
 
+/**
+ * Handles a new op for a session already dispatched to the block processor;
+ * the block processor owns the session, which is never closed here
+ */
+static int osql_sess_rcvop_streamed(osql_sess_t *sess, int type, void *data,
+                                    int datalen, int is_msg_done,
+                                    struct errstat *perr)
+{
+    int rc = 0;
+
+    if (is_msg_done && perr) {
+        /* the replicant rolled back; the block processor aborts, and replies
+           with the replicant's own error */
+        struct errstat xerr = {0};
+        osqlcomm_errstat_type_get(&xerr, (const uint8_t *)perr,
+                                  (const uint8_t *)(perr + 1));
+        xerr.errstr[sizeof(xerr.errstr) - 1] = '\0';
+        osql_bplog_stream_end(sess->tran,
+                              xerr.errval ? xerr.errval : ERR_INTERNAL,
+                              xerr.errstr);
+    } else if ((rc = osql_bplog_saveop(sess, sess->tran, data, datalen,
+                                       type)) != 0) {
+        osql_bplog_stream_end(sess->tran, ERR_INTERNAL,
+                              "failed to save streamed op");
+    } else if (is_msg_done) {
+        osql_bplog_stream_end(sess->tran, 0, NULL);
+    }
+
+    osql_repository_put(sess);
+    return rc;
+}
+
+static int osql_sess_is_streaming(osql_sess_t *psess)
+{
+    sess_impl_t *sess = psess->impl;
+    int streaming;
+
+    Pthread_mutex_lock(&sess->mtx);
+    streaming = sess->streaming;
+    Pthread_mutex_unlock(&sess->mtx);
+
+    return streaming;
+}
+
 /**
  * Handles a new op received for session "uuid"
  * It saves the packet in the local bplog
@@ -423,6 +468,12 @@ int osql_sess_rcvop(uuid_t uuid, int type, void *data, int datalen, int *found)
     is_msg_done =
         osql_comm_is_done(sess, type, data, datalen, &perr, NULL) != 0;
 
+    if (osql_sess_is_streaming(sess)) {
+        *found = 1;
+        return osql_sess_rcvop_streamed(sess, type, data, datalen, is_msg_done,
+                                        perr);
+    }
+
     /* we have received an OSQL_XERR; replicant wants to abort the transaction;
        discard the session and be done */
     if (is_msg_done && perr) {
@@ -445,6 +496,11 @@ int osql_sess_rcvop(uuid_t uuid, int type, void *data, int datalen, int *found)
         /* failed to save into bplog; discard and be done */
         goto failed_stream;
     }
+
+    /* large transaction: start applying it while the rest arrives */
+    if (!is_msg_done && osql_bplog_stream_ready(sess, sess->tran))
+        return handle_buf_sorese(sess, 1);
+
     int dispatch = 0;
     int cancel = 0;
     if (is_msg_done) {
@@ -489,7 +545,7 @@ int osql_sess_rcvop(uuid_t uuid, int type, void *data, int datalen, int *found)
 
     /* IT WAS A DONE MESSAGE
        HERE IS THE DISPATCH */
-    return handle_buf_sorese(sess);
+    return handle_buf_sorese(sess, 0);
 
 failed_stream:
     if (is_msg_done && perr)
@@ -546,7 +602,7 @@ int osql_sess_rcvop_socket(osql_sess_t *sess, int type, void *data, int datalen,
         logmsg(LOGMSG_ERROR, "%p Dispatching transaction\n", (void *)pthread_self());
     /* IT WAS A DONE MESSAGE
        HERE IS THE DISPATCH */
-    return handle_buf_sorese(sess);
+    return handle_buf_sorese(sess, 0);
 }
 
 int osql_sess_queryid(osql_sess_t *sess)
@@ -574,6 +630,10 @@ int osql_sess_try_terminate(osql_sess_t *psess, const char *host)
     Pthread_mutex_lock(&sess->mtx);
 
     if (sess->dispatched) {
+        /* the block processor owns the session; if it is waiting for more
+           ops, none will come */
+        if (sess->streaming)
+            osql_bplog_stream_end(psess->tran, ERR_NOMASTER, NULL);
         keep_sess = 1;
         goto done;
     }
@@ -609,8 +669,11 @@ done:
  *   If the sesssion dispatch fails (queue full?), we need to send back retry
  *   error code to the source replicant
  *
+ *   If "streaming" is set, the last op has not arrived yet; the reader
+ *   thread keeps saving ops while the block processor applies them
+ *
  */
-static int handle_buf_sorese(osql_sess_t *psess)
+static int handle_buf_sorese(osql_sess_t *psess, int streaming)
 {
     sess_impl_t *sess = psess->impl;
     int debug;
@@ -631,7 +694,10 @@ static int handle_buf_sorese(osql_sess_t *psess)
     Pthread_mutex_lock(&sess->mtx);
     /* NOTE: the session here has one client at least, so it will not be
     close; it might be terminanted but we allow to dispatch */
+    if (streaming)
+        osql_bplog_stream_start(psess->tran);
     sess->dispatched = 1;
+    sess->streaming = streaming;
     psess->sess_endus = comdb2_time_epochus();
     bzero(&psess->xerr, sizeof(psess->xerr));
     Pthread_mutex_unlock(&sess->mtx);
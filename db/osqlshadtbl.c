@@ -37,6 +37,7 @@
 #include <dbinc/queue.h>
 
 extern int g_osql_max_trans;
+int gbl_osql_shadtbl_skiplist = 1;
 extern int gbl_partial_indexes;
 extern int gbl_expressions_indexes;
 
@@ -720,7 +721,11 @@ static int create_tablecursor(bdb_state_type *bdb_env, struct tmp_table **ptbl,
         return -1;
     }
 
-    tbl->table = bdb_temp_array_create(bdb_env, bdberr);
+    /* large transactions outgrow a temparray in a few hundred rows */
+    if (gbl_osql_shadtbl_skiplist)
+        tbl->table = bdb_temp_skiplist_create(bdb_env, bdberr);
+    else
+        tbl->table = bdb_temp_array_create(bdb_env, bdberr);
 
     if (!tbl->table) {
         logmsg(LOGMSG_ERROR, "%s: bdb_temp_table_create failed, bderr=%d\n",
@@ -59,6 +59,7 @@
 extern int gbl_partial_indexes;
 extern int gbl_expressions_indexes;
 extern int gbl_reorder_socksql_no_deadlock;
+extern int gbl_osql_stream_bplog_threshold;
 
 int gbl_allow_bplog_restarts = 600;
 int gbl_master_retry_poll_ms = 100;
@@ -199,6 +200,49 @@ static inline int osql_should_restart(struct sqlclntstate *clnt, int rc,
         }                                                                                                              \
     } while (0)
 
+/* Fill in the snap info sent with the commit */
+static void osql_get_snap_info(struct sqlclntstate *clnt, snap_uid_t *snap_info)
+{
+    memset(snap_info, 0, sizeof(*snap_info));
+
+    /* SP and chunked transactions: send a dummy snap_info (keylen=0) so the
+       master tracks query effects as it applies bplog changes */
+    if (clnt->dbtran.trans_has_sp || clnt->dbtran.maxchunksize > 0)
+        return;
+
+    // Pass to master the state of verify retry.
+    // If verify retry is ON and error is retryable, don't write to
+    // blkseq on master because replicant will retry.
+    snap_info->replicant_is_able_to_retry = replicant_is_able_to_retry(clnt);
+    snap_info->effects = clnt->effects;
+
+    if (get_cnonce(clnt, snap_info) == 0) {
+        comdb2uuidcpy(snap_info->uuid, clnt->osql.uuid);
+    } else {
+        // Add dummy snap_info to let master know that the replicant wants
+        // query effects. (comdb2api does not send cnonce)
+        snap_info->keylen = 0;
+    }
+}
+
+/* Transactions kept in shadow tables start their session when they commit,
+   and send all their ops right away; with streaming on, send the snap info
+   first, so the master can start applying them while they arrive */
+static void osql_send_early_snap_info(struct sqlclntstate *clnt, int type)
+{
+    osqlstate_t *osql = &clnt->osql;
+    snap_uid_t snap_info;
+
+    if (gbl_osql_stream_bplog_threshold <= 0 ||
+        osql->rqid != OSQL_RQID_USE_UUID)
+        return;
+
+    osql_get_snap_info(clnt, &snap_info);
+    if (osql_send_snap_info(&osql->target, osql->uuid, &snap_info,
+                            req2netrpl(type)) == 0)
+        osql->replicant_numops++;
+}
+
 /* see below */
 enum { OSQL_START_KEEP_RQID = 1, OSQL_START_NO_REORDER = 2, OSQL_START_IS_FINAL = 4 };
 extern int gbl_debug_disttxn_trace;
@@ -323,6 +367,8 @@ retry:
             osql_query_dbglog(thd, clnt->queryid);
         if (clnt->is_participant)
             osql_begin_participant(thd);
+        if (clnt->dbtran.mode != TRANLEVEL_SOSQL)
+            osql_send_early_snap_info(clnt, type);
         osql->sock_started = 1;
     } else if (!keep_rqid) {
         int irc = osql_end(clnt);
@@ -1597,8 +1643,7 @@ static int osql_send_commit_logic(struct sqlclntstate *clnt, int retries, int ne
     osqlstate_t *osql = &clnt->osql;
     int rc = 0;
     int restarted;
-    snap_uid_t snap_info, *snap_info_p = NULL;
-    snap_uid_t zero_snap_info = {0};
+    snap_uid_t snap_info;
 
     /* reset the tablename */
     if (osql->tablename) {
@@ -1610,31 +1655,7 @@ static int osql_send_commit_logic(struct sqlclntstate *clnt, int retries, int ne
     }
     osql->tran_ops = 0; /* reset transaction size counter*/
 
-    if (!clnt->dbtran.trans_has_sp) {
-        if (clnt->dbtran.maxchunksize > 0) {
-            snap_info_p = &zero_snap_info;
-        } else {
-            // Pass to master the state of verify retry.
-            // If verify retry is ON and error is retryable, don't write to
-            // blkseq on master because replicant will retry.
-
-            snap_info.replicant_is_able_to_retry = replicant_is_able_to_retry(clnt);
-            snap_info.effects = clnt->effects;
-
-            if (get_cnonce(clnt, &snap_info) == 0) {
-                comdb2uuidcpy(snap_info.uuid, osql->uuid);
-            } else {
-                // Add dummy snap_info to let master know that the replicant wants
-                // query effects. (comdb2api does not send cnonce)
-                snap_info.keylen = 0;
-            }
-            snap_info_p = &snap_info;
-        }
-    } else {
-        // SP transaction: send a dummy snap_info (keylen=0) so the master
-        // tracks query effects as it applies bplog changes under OSQL_DONE_SNAP.
-        snap_info_p = &zero_snap_info;
-    }
+    osql_get_snap_info(clnt, &snap_info);
 
     do {
         rc = 0;
@@ -1666,7 +1687,7 @@ static int osql_send_commit_logic(struct sqlclntstate *clnt, int retries, int ne
         if (rc == 0) {
             osql->replicant_numops++;
             rc = osql_send_commit(&osql->target, osql->uuid, osql->replicant_numops,
-                                  &osql->xerr, nettype, clnt->query_stats, snap_info_p);
+                                  &osql->xerr, nettype, clnt->query_stats, &snap_info);
         }
         RESTART_SOCKSQL_KEEP_RQID(retries);
 
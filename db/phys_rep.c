@@ -41,6 +41,9 @@
 #include <parse_lsn.h>
 #include <logmsg.h>
 #include <comdb2_atomic.h>
+#include <list.h>
+#include "phys_rep_batch.h"
+#include "logrecord.h"
 
 /* internal implementation */
 typedef struct DB_Connection {
@@ -88,6 +91,15 @@ int gbl_started_physrep_threads = 0;
  * neither the firstfile column nor a uniform fleet. */
 int gbl_physrep_verify_source_range = 1;
 
+/* Pull the log from comdb2_transaction_log_batches, rather than a row per
+ * record from comdb2_transaction_logs */
+int gbl_physrep_stream_batches = 0;
+int gbl_physrep_batch_bytes = 1024 * 1024;
+/* Batches received ahead of the one being applied */
+int gbl_physrep_batch_queue = 16;
+int64_t gbl_physrep_lag_bytes = 0;
+int64_t gbl_physrep_lag_seconds = 0;
+
 /* Observable "nobody can serve me" state + how many consecutive no-viable-source
  * registration cycles we tolerate before latching the flag and alarming. */
 int gbl_physrep_no_viable_source = 0;
@@ -740,26 +752,53 @@ int is_valid_lsn(unsigned int file, unsigned int offset)
 extern __thread int physrep_out_of_order;
 extern __thread char *rep_apply_caller;
 
-static LOG_INFO handle_record(cdb2_hndl_tp *repl_db, LOG_INFO prev_info)
-{
-    /* vars for 1 record */
+/* A log record, from either a row of comdb2_transaction_logs or a batch */
+struct physrep_rec {
+    unsigned int file;
+    unsigned int offset;
+    int64_t rectype;
+    int64_t gen;       /* 0 if none */
+    int64_t timestamp; /* commit time, 0 if none */
+    int64_t lcgen;     /* -1 if unknown */
+    int64_t lagbytes;  /* source log past this record, -1 if unknown */
     void *blob;
     int blob_len;
-    char *lsn;
-    int64_t *timestamp;
+};
+
+static int read_row_record(cdb2_hndl_tp *repl_db, struct physrep_rec *rec)
+{
+    char *lsn = (char *)cdb2_column_value(repl_db, 0);
+    int64_t *rectype = (int64_t *)cdb2_column_value(repl_db, 1);
+    int64_t *gen = (int64_t *)cdb2_column_value(repl_db, 2);
+    int64_t *timestamp = (int64_t *)cdb2_column_value(repl_db, 3);
     int rc;
-    unsigned int file, offset;
-    int64_t *rectype;
-    lsn = (char *)cdb2_column_value(repl_db, 0);
-    rectype = (int64_t *)cdb2_column_value(repl_db, 1);
-    timestamp = (int64_t *)cdb2_column_value(repl_db, 3);
-    blob = cdb2_column_value(repl_db, 4);
-    blob_len = cdb2_column_size(repl_db, 4);
-
-    if ((rc = char_to_lsn(lsn, &file, &offset)) != 0) {
+
+    rec->rectype = *rectype;
+    rec->gen = gen ? *gen : 0;
+    rec->timestamp = timestamp ? *timestamp : 0;
+    rec->lcgen = -1;
+    /* log-cursor-gen tells us if the source has truncated its txnlog */
+    if (cdb2_numcolumns(repl_db) > 7)
+        rec->lcgen = *(int64_t *)cdb2_column_value(repl_db, 7);
+    rec->lagbytes = -1;
+    rec->blob = cdb2_column_value(repl_db, 4);
+    rec->blob_len = cdb2_column_size(repl_db, 4);
+
+    if ((rc = char_to_lsn(lsn, &rec->file, &rec->offset)) != 0) {
         physrep_logmsg(LOGMSG_ERROR, "%s:%d: Could not parse lsn %s\n",
                        __func__, __LINE__, lsn);
+        rec->file = rec->offset = -1;
     }
+    return rc;
+}
+
+static LOG_INFO handle_record(struct physrep_rec *rec, LOG_INFO prev_info)
+{
+    void *blob = rec->blob;
+    int blob_len = rec->blob_len;
+    unsigned int file = rec->file, offset = rec->offset;
+    int rc;
+
     if (file == -1 && offset == -1) {
         if (gbl_physrep_debug) {
             physrep_logmsg(LOGMSG_USER, "%s:%d requested invalid record, force reconnect\n", __func__, __LINE__);
@@ -772,16 +811,16 @@ static LOG_INFO handle_record(cdb2_hndl_tp *repl_db, LOG_INFO prev_info)
                        __func__, __LINE__, file, offset);
     }
 
-    if (gbl_deferred_phys_flag && timestamp) {
+    if (gbl_deferred_phys_flag && rec->timestamp) {
         time_t curr_time = time(NULL);
         /* Change this to sleep only once a second to test the
          * value of tunable */
-        while (stop_physrep_worker == 0 && (*timestamp + gbl_deferred_phys_update) > curr_time) {
+        while (stop_physrep_worker == 0 && (rec->timestamp + gbl_deferred_phys_update) > curr_time) {
             sleep(1);
             curr_time = time(NULL);
             if (gbl_physrep_debug) {
                 physrep_logmsg(LOGMSG_USER, "%s:%d: Deferring update, commit-ts %" PRId64 ", target %ld\n",
-                               __func__, __LINE__, *timestamp, curr_time + gbl_deferred_phys_update);
+                               __func__, __LINE__, rec->timestamp, curr_time + gbl_deferred_phys_update);
             }
         }
     }
@@ -804,7 +843,7 @@ static LOG_INFO handle_record(cdb2_hndl_tp *repl_db, LOG_INFO prev_info)
         rc = apply_log(thedb->bdb_env, file, offset, REP_LOG, blob, blob_len);
         rep_apply_caller = NULL;
 
-        if (is_commit((u_int32_t)*rectype)) {
+        if (is_commit((u_int32_t)rec->rectype)) {
             if (gbl_physrep_debug) {
                 physrep_logmsg(LOGMSG_USER, "%s:%d: Got commit record (lsn %d:%d), going to wait for other nodes to ack\n",
                                __func__, __LINE__, file, offset);
@@ -844,6 +883,221 @@ static LOG_INFO handle_record(cdb2_hndl_tp *repl_db, LOG_INFO prev_info)
     return next_info;
 }
 
+/*
+ * Log batch stream.
+ *
+ * With physrep_stream_batches, the worker reads the log of the source a
+ * batch at a time from comdb2_transaction_log_batches.  A receiver thread
+ * reads the batches off the connection, checks and decompresses them, and
+ * queues up to physrep_batch_queue of them while the worker applies the
+ * records of the previous ones.
+ */
+struct physrep_log_batch {
+    unsigned int file;
+    unsigned int offset;
+    int nrecs;
+    int64_t lcgen;
+    int64_t lagbytes;
+    uint8_t *buf;
+    const uint8_t *p;
+    const uint8_t *end;
+    LINKC_T(struct physrep_log_batch) lnk;
+};
+
+static struct {
+    cdb2_hndl_tp *hndl;
+    pthread_t tid;
+    int running;
+    int stop;
+    int done;
+    int rc;
+    pthread_mutex_t lk;
+    pthread_cond_t cd;
+    LISTC_T(struct physrep_log_batch) batches;
+    struct physrep_log_batch *cur;
+} log_stream = {.lk = PTHREAD_MUTEX_INITIALIZER, .cd = PTHREAD_COND_INITIALIZER};
+
+/* The connection time of a source which failed to stream batches */
+static int batches_unsupported_since = -1;
+
+static void free_log_batch(struct physrep_log_batch *b)
+{
+    free(b->buf);
+    free(b);
+}
+
+static int read_batch_row(cdb2_hndl_tp *repl_db, struct physrep_log_batch *b)
+{
+    char *lsn = (char *)cdb2_column_value(repl_db, 0);
+    int64_t size = *(int64_t *)cdb2_column_value(repl_db, 6);
+    int64_t checksum = *(int64_t *)cdb2_column_value(repl_db, 7);
+
+    if (char_to_lsn(lsn, &b->file, &b->offset) != 0) {
+        physrep_logmsg(LOGMSG_ERROR, "%s:%d: Could not parse lsn %s\n", __func__, __LINE__, lsn);
+        b->file = b->offset = -1;
+    }
+    b->nrecs = *(int64_t *)cdb2_column_value(repl_db, 2);
+    b->lcgen = *(int64_t *)cdb2_column_value(repl_db, 4);
+    b->lagbytes = *(int64_t *)cdb2_column_value(repl_db, 5);
+    if (b->nrecs == 0)
+        return 0;
+
+    if (physrep_batch_open(cdb2_column_value(repl_db, 8), cdb2_column_size(repl_db, 8), size, checksum, &b->buf)) {
+        physrep_logmsg(LOGMSG_ERROR, "%s:%d: Corrupt log batch at lsn %s (%d records, %" PRId64 " bytes)\n",
+                       __func__, __LINE__, lsn, b->nrecs, size);
+        return -1;
+    }
+    b->p = b->buf;
+    b->end = b->buf + size;
+    return 0;
+}
+
+static void *physrep_log_receiver(void *args)
+{
+    comdb2_name_thread(__func__);
+
+    struct physrep_log_batch *b;
+    int rc;
+
+    while ((rc = cdb2_next_record(log_stream.hndl)) == CDB2_OK) {
+        if ((b = calloc(1, sizeof(struct physrep_log_batch))) == NULL) {
+            rc = -1;
+            break;
+        }
+        if (read_batch_row(log_stream.hndl, b) != 0) {
+            free_log_batch(b);
+            rc = -1;
+            break;
+        }
+        Pthread_mutex_lock(&log_stream.lk);
+        while (!log_stream.stop && listc_size(&log_stream.batches) >= gbl_physrep_batch_queue)
+            Pthread_cond_wait(&log_stream.cd, &log_stream.lk);
+        if (log_stream.stop) {
+            Pthread_mutex_unlock(&log_stream.lk);
+            free_log_batch(b);
+            break;
+        }
+        listc_abl(&log_stream.batches, b);
+        Pthread_cond_broadcast(&log_stream.cd);
+        Pthread_mutex_unlock(&log_stream.lk);
+    }
+
+    Pthread_mutex_lock(&log_stream.lk);
+    log_stream.done = 1;
+    log_stream.rc = rc;
+    Pthread_cond_broadcast(&log_stream.cd);
+    Pthread_mutex_unlock(&log_stream.lk);
+    return NULL;
+}
+
+static void log_stream_start(cdb2_hndl_tp *repl_db)
+{
+    listc_init(&log_stream.batches, offsetof(struct physrep_log_batch, lnk));
+    log_stream.hndl = repl_db;
+    log_stream.stop = 0;
+    log_stream.done = 0;
+    log_stream.rc = 0;
+    log_stream.cur = NULL;
+    log_stream.running = 1;
+    Pthread_create(&log_stream.tid, NULL, physrep_log_receiver, NULL);
+}
+
+/* Must be called before anything else uses the connection.  Returns 1 if
+ * the stream had to be cut short, in which case the connection is shut down
+ * and must be closed */
+static int log_stream_stop(void)
+{
+    struct physrep_log_batch *b;
+    int interrupted;
+
+    if (!log_stream.running)
+        return 0;
+    Pthread_mutex_lock(&log_stream.lk);
+    log_stream.stop = 1;
+    /* with blocking physrep the source never ends the query: wake the
+     * receiver up from its read, like closing the handle used to */
+    interrupted = !log_stream.done;
+    if (interrupted)
+        cdb2_hndl_shutdown(log_stream.hndl);
+    Pthread_cond_broadcast(&log_stream.cd);
+    Pthread_mutex_unlock(&log_stream.lk);
+    Pthread_join(log_stream.tid, NULL);
+
+    if (log_stream.cur)
+        free_log_batch(log_stream.cur);
+    log_stream.cur = NULL;
+    while ((b = listc_rtl(&log_stream.batches)) != NULL)
+        free_log_batch(b);
+    log_stream.running = 0;
+    return interrupted;
+}
+
+static int next_batched_record(struct physrep_rec *rec)
+{
+    struct physrep_log_batch *b;
+    struct physrep_batch_rec r;
+    int rc;
+
+    while (1) {
+        if ((b = log_stream.cur) != NULL) {
+            if (b->nrecs == 0) {
+                /* sentinel */
+                memset(rec, 0, sizeof(*rec));
+                rec->file = b->file;
+                rec->offset = b->offset;
+                rec->lcgen = -1;
+                rec->lagbytes = -1;
+                free_log_batch(b);
+                log_stream.cur = NULL;
+                return CDB2_OK;
+            }
+            if ((rc = physrep_batch_next(&b->p, b->end, &r)) == 1) {
+                rec->file = r.file;
+                rec->offset = r.offset;
+                rec->rectype = r.rectype;
+                /* the batch row only has the highest generation of the
+                 * batch; a master change must show at its own record */
+                rec->gen = logrecord_generation((char *)r.rec);
+                rec->timestamp = r.timestamp;
+                rec->lcgen = b->lcgen;
+                rec->lagbytes = (b->p == b->end) ? b->lagbytes : -1;
+                rec->blob = (void *)r.rec;
+                rec->blob_len = r.len;
+                return CDB2_OK;
+            }
+            free_log_batch(b);
+            log_stream.cur = NULL;
+            if (rc < 0) {
+                physrep_logmsg(LOGMSG_ERROR, "%s:%d: Malformed record in log batch\n", __func__, __LINE__);
+                return -1;
+            }
+        }
+
+        Pthread_mutex_lock(&log_stream.lk);
+        while (listc_size(&log_stream.batches) == 0 && !log_stream.done)
+            Pthread_cond_wait(&log_stream.cd, &log_stream.lk);
+        log_stream.cur = listc_rtl(&log_stream.batches);
+        rc = log_stream.rc;
+        Pthread_cond_broadcast(&log_stream.cd);
+        Pthread_mutex_unlock(&log_stream.lk);
+        if (log_stream.cur == NULL)
+            return rc;
+    }
+}
+
+/* Reads the next log record from the source, returning CDB2_OK or the rcode
+ * which ended the stream */
+static int next_log_record(cdb2_hndl_tp *repl_db, struct physrep_rec *rec)
+{
+    int rc;
+
+    if (log_stream.running)
+        return next_batched_record(rec);
+    if ((rc = cdb2_next_record(repl_db)) == CDB2_OK)
+        read_row_record(repl_db, rec);
+    return rc;
+}
+
 static enum mach_class normalize_class(enum mach_class class)
 {
     if (class == CLASS_UAT)
@@ -1497,7 +1751,7 @@ static void *physrep_worker(void *args)
 
     volatile int64_t gen, highest_gen = 0;
     int64_t first_lcgen = -1;
-    size_t sql_cmd_len = 150;
+    size_t sql_cmd_len = 256;
     char sql_cmd[sql_cmd_len];
     int do_truncate = 0;
     int rc;
@@ -1506,9 +1760,10 @@ static void *physrep_worker(void *args)
     int last_revconn_check = 0;
     int last_update_registry = 0;
     int pollms;
-    unsigned int file, offset;
     LOG_INFO info;
     LOG_INFO prev_info;
+    struct physrep_rec rec;
+    time_t last_commit_time = 0;
     DB_Connection *repl_db_cnct = NULL;
 
     DB_Connection rev_db_cnct = {0};
@@ -1530,6 +1785,10 @@ static void *physrep_worker(void *args)
 
 repl_loop:
     while (stop_physrep_worker == 0) {
+        if (log_stream_stop() && repl_db_connected) {
+            close_repl_connection(repl_db_cnct, repl_db, __func__, __LINE__);
+        }
+
         if (thedb->master != gbl_myhostname) {
             if (repl_db_connected) {
                 close_repl_connection(repl_db_cnct, repl_db, __func__, __LINE__);
@@ -1713,20 +1972,45 @@ repl_loop:
 
         prev_info = info;
 
-        rc = snprintf(sql_cmd, sql_cmd_len, "select * from comdb2_transaction_logs('{%u:%u}', NULL%s)", info.file,
-                      info.offset, (gbl_blocking_physrep ? ",9" : ",8"));
-        if (rc < 0 || rc >= sql_cmd_len)
-            physrep_logmsg(LOGMSG_ERROR, "%s:%d Command buffer is not long enough!\n", __func__, __LINE__);
-        if (gbl_physrep_debug)
-            physrep_logmsg(LOGMSG_USER, "%s:%d: Executing: %s\n", __func__, __LINE__, sql_cmd);
-        if ((rc = cdb2_run_statement(repl_db, sql_cmd)) != CDB2_OK) {
-            physrep_logmsg(LOGMSG_ERROR, "Couldn't query the database, rcode=%d '%s' retrying\n", rc,
-                           cdb2_errstr(repl_db));
-            close_repl_connection(repl_db_cnct, repl_db, __func__, __LINE__);
-            goto sleep_and_retry;
+        int batched = 0;
+        if (gbl_physrep_stream_batches && batches_unsupported_since != repl_db_connect_time) {
+            rc = snprintf(sql_cmd, sql_cmd_len,
+                          "select lsn, lastlsn, nrecs, generation, logcgen, lagbytes, size, checksum, payload from "
+                          "comdb2_transaction_log_batches('{%u:%u}', %d, %d)",
+                          info.file, info.offset, (gbl_blocking_physrep ? 9 : 8), gbl_physrep_batch_bytes);
+            if (rc < 0 || rc >= sql_cmd_len)
+                physrep_logmsg(LOGMSG_ERROR, "%s:%d Command buffer is not long enough!\n", __func__, __LINE__);
+            if (gbl_physrep_debug)
+                physrep_logmsg(LOGMSG_USER, "%s:%d: Executing: %s\n", __func__, __LINE__, sql_cmd);
+            if ((rc = cdb2_run_statement(repl_db, sql_cmd)) == CDB2_OK) {
+                batched = 1;
+            } else {
+                /* an older source: stream rows until we reconnect */
+                physrep_logmsg(LOGMSG_WARN, "Source can't stream log batches, rcode=%d '%s'\n", rc,
+                               cdb2_errstr(repl_db));
+                batches_unsupported_since = repl_db_connect_time;
+            }
         }
 
-        if ((rc = cdb2_next_record(repl_db)) != CDB2_OK) {
+        if (batched) {
+            log_stream_start(repl_db);
+        } else {
+            rc = snprintf(sql_cmd, sql_cmd_len, "select * from comdb2_transaction_logs('{%u:%u}', NULL%s)",
+                          info.file, info.offset, (gbl_blocking_physrep ? ",9" : ",8"));
+            if (rc < 0 || rc >= sql_cmd_len)
+                physrep_logmsg(LOGMSG_ERROR, "%s:%d Command buffer is not long enough!\n", __func__, __LINE__);
+            if (gbl_physrep_debug)
+                physrep_logmsg(LOGMSG_USER, "%s:%d: Executing: %s\n", __func__, __LINE__, sql_cmd);
+            if ((rc = cdb2_run_statement(repl_db, sql_cmd)) != CDB2_OK) {
+                physrep_logmsg(LOGMSG_ERROR, "Couldn't query the database, rcode=%d '%s' retrying\n", rc,
+                               cdb2_errstr(repl_db));
+                close_repl_connection(repl_db_cnct, repl_db, __func__, __LINE__);
+                goto sleep_and_retry;
+            }
+        }
+
+        if ((rc = next_log_record(repl_db, &rec)) != CDB2_OK) {
+            log_stream_stop();
             if (gbl_physrep_debug) {
                 physrep_logmsg(LOGMSG_USER, "%s:%d: Can't find the next record (rc: %d '%s')\n", __func__, __LINE__, rc,
                                cdb2_errstr(repl_db));
@@ -1736,11 +2020,11 @@ repl_loop:
         }
 
         /* If this record is a sentinel, close the connection */
-        char *lsn = (char *)cdb2_column_value(repl_db, 0);
-        if (((rc = char_to_lsn(lsn, &file, &offset)) != 0) || (file == -1 && offset == -1)) {
+        if (rec.file == -1 && rec.offset == -1) {
             if (gbl_physrep_debug) {
                 physrep_logmsg(LOGMSG_USER, "%s:%d: Got sentinel record, close connection\n", __func__, __LINE__);
             }
+            log_stream_stop();
             close_repl_connection(repl_db_cnct, repl_db, __func__, __LINE__);
             do_truncate = 1;
             first_lcgen = -1;
@@ -1749,39 +2033,36 @@ repl_loop:
 
         /* our log matches, so apply each record log received */
         while (stop_physrep_worker == 0 && thedb->master == gbl_myhostname && !do_truncate &&
-               (rc = cdb2_next_record(repl_db)) == CDB2_OK) {
+               (rc = next_log_record(repl_db, &rec)) == CDB2_OK) {
             /* log-cursor-gen tells us if the source has truncated its txnlog */
-            int numcolumns = cdb2_numcolumns(repl_db);
-            if (numcolumns > 7) {
-                int64_t *lcgen = (int64_t *)cdb2_column_value(repl_db, 7);
-                if (first_lcgen > -1 && *lcgen != first_lcgen) {
-                    if (gbl_physrep_debug) {
-                        physrep_logmsg(LOGMSG_USER,
-                                       "%s:%d: source logfile has been truncated, close connection and truncate\n",
-                                       __func__, __LINE__);
-                    }
-                    close_repl_connection(repl_db_cnct, repl_db, __func__, __LINE__);
-                    do_truncate = 1;
-                    first_lcgen = -1;
-                    goto repl_loop;
+            if (rec.lcgen > -1 && first_lcgen > -1 && rec.lcgen != first_lcgen) {
+                if (gbl_physrep_debug) {
+                    physrep_logmsg(LOGMSG_USER,
+                                   "%s:%d: source logfile has been truncated, close connection and truncate\n",
+                                   __func__, __LINE__);
                 }
+                log_stream_stop();
+                close_repl_connection(repl_db_cnct, repl_db, __func__, __LINE__);
+                do_truncate = 1;
+                first_lcgen = -1;
+                goto repl_loop;
             }
 
-            int64_t *rec_gen = (int64_t *)cdb2_column_value(repl_db, 2);
-            if (rec_gen && *rec_gen > highest_gen) {
-                int64_t new_gen = *rec_gen;
+            if (rec.gen > highest_gen) {
+                int64_t new_gen = rec.gen;
                 if (gbl_physrep_debug) {
                     physrep_logmsg(LOGMSG_USER, "%s:%d: My master changed, set truncate flag\n", __func__, __LINE__);
                     physrep_logmsg(LOGMSG_USER, "%s:%d: gen: %" PRId64 ", rec_gen: %" PRId64 "\n", __func__, __LINE__,
-                                   gen, *rec_gen);
+                                   gen, rec.gen);
                 }
+                log_stream_stop();
                 close_repl_connection(repl_db_cnct, repl_db, __func__, __LINE__);
                 do_truncate = 1;
                 highest_gen = new_gen;
                 goto repl_loop;
             }
 
-            prev_info = handle_record(repl_db, prev_info);
+            prev_info = handle_record(&rec, prev_info);
             if (physrep_out_of_order) {
                 physrep_out_of_order = 0;
                 do_truncate = 1;
@@ -1789,6 +2070,14 @@ repl_loop:
             }
 
             gbl_physrep_last_applied_time = time(NULL);
+            if (rec.timestamp && is_commit((u_int32_t)rec.rectype))
+                last_commit_time = rec.timestamp;
+            if (rec.lagbytes >= 0) {
+                /* how far behind the source we are after a batch */
+                gbl_physrep_lag_bytes = rec.lagbytes;
+                gbl_physrep_lag_seconds =
+                    (rec.lagbytes > 0 && last_commit_time) ? gbl_physrep_last_applied_time - last_commit_time : 0;
+            }
             revconn_ck = gbl_physrep_revconn_check_interval;
             if (revconn_ck > 0 && comdb2_time_epoch() - last_revconn_check > revconn_ck) {
                 if (gbl_physrep_debug) {
@@ -1799,6 +2088,7 @@ repl_loop:
 
             /* Check reconnect */
             if (force_registration() || ((now = time(NULL)) - repl_db_connect_time) > gbl_physrep_reconnect_interval) {
+                log_stream_stop();
                 close_repl_connection(repl_db_cnct, repl_db, __func__, __LINE__);
                 goto repl_loop;
             }
@@ -1810,11 +2100,12 @@ repl_loop:
             }
         }
 
+        int interrupted = log_stream_stop();
         if (gbl_physrep_debug) {
             logmsg(LOGMSG_USER, "%s:%d: next-record rc = %d, '%s'\n", __func__, __LINE__, rc, cdb2_errstr(repl_db));
         }
 
-        if (thedb->master != gbl_myhostname || rc != CDB2_OK_DONE) {
+        if (thedb->master != gbl_myhostname || rc != CDB2_OK_DONE || interrupted) {
             close_repl_connection(repl_db_cnct, repl_db, __func__, __LINE__);
             do_truncate = 1;
         }
@@ -1829,6 +2120,7 @@ sleep_and_retry:
         }
     }
 
+    log_stream_stop();
     if (repl_db_connected == 1) {
         close_repl_connection(repl_db_cnct, repl_db, __func__, __LINE__);
     }
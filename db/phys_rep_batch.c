@@ -0,0 +1,178 @@
+/*
+   Copyright 2026 Bloomberg Finance L.P.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <arpa/inet.h>
+#include <lz4.h>
+
+#include <build/db.h>
+#include <crc32c.h>
+#include <flibc.h>
+#include "phys_rep_batch.h"
+
+#if LZ4_VERSION_NUMBER < 10701
+#define LZ4_compress_default LZ4_compress_limitedOutput
+#endif
+
+static int batch_reserve(uint8_t **buf, int *cap, int need)
+{
+    if (need <= *cap)
+        return 0;
+    int ncap = *cap ? *cap : 64 * 1024;
+    while (ncap < need)
+        ncap *= 2;
+    uint8_t *n = realloc(*buf, ncap);
+    if (n == NULL)
+        return -1;
+    *buf = n;
+    *cap = ncap;
+    return 0;
+}
+
+void physrep_batch_reset(struct physrep_batch *b)
+{
+    b->len = 0;
+    b->nrecs = 0;
+    b->outlen = 0;
+    b->checksum = 0;
+}
+
+void physrep_batch_free(struct physrep_batch *b)
+{
+    free(b->buf);
+    free(b->out);
+    memset(b, 0, sizeof(*b));
+}
+
+int physrep_batch_add(struct physrep_batch *b, uint32_t file, uint32_t offset,
+                      uint32_t rectype, int64_t timestamp, const void *rec,
+                      uint32_t len)
+{
+    uint32_t u32;
+    uint64_t u64;
+    uint8_t *p;
+
+    if (batch_reserve(&b->buf, &b->cap,
+                      b->len + PHYSREP_BATCH_REC_HDR_LEN + len))
+        return -1;
+    p = b->buf + b->len;
+    u32 = htonl(file);
+    memcpy(p, &u32, 4);
+    u32 = htonl(offset);
+    memcpy(p + 4, &u32, 4);
+    u32 = htonl(rectype);
+    memcpy(p + 8, &u32, 4);
+    u32 = htonl(len);
+    memcpy(p + 12, &u32, 4);
+    u64 = flibc_htonll((uint64_t)timestamp);
+    memcpy(p + 16, &u64, 8);
+    memcpy(p + PHYSREP_BATCH_REC_HDR_LEN, rec, len);
+    b->len += PHYSREP_BATCH_REC_HDR_LEN + len;
+    b->nrecs++;
+    return 0;
+}
+
+/* Checksums and compresses the packed records into b->out */
+int physrep_batch_seal(struct physrep_batch *b)
+{
+    int bound = LZ4_compressBound(b->len);
+    int rc;
+
+    b->checksum = crc32c(b->buf, b->len);
+    if (batch_reserve(&b->out, &b->outcap, bound))
+        return -1;
+    rc = LZ4_compress_default((const char *)b->buf, (char *)b->out, b->len,
+                              bound);
+    if (rc <= 0 || rc >= b->len) {
+        /* not worth it: ship the records as they are */
+        memcpy(b->out, b->buf, b->len);
+        b->outlen = b->len;
+    } else {
+        b->outlen = rc;
+    }
+    return 0;
+}
+
+int physrep_batch_open(const void *payload, int paylen, int size,
+                       uint32_t checksum, uint8_t **out)
+{
+    uint8_t *buf;
+
+    *out = NULL;
+    if (size < 0 || paylen > size)
+        return -1;
+    if ((buf = malloc(size ? size : 1)) == NULL)
+        return -1;
+    if (paylen == size) {
+        memcpy(buf, payload, size);
+    } else if (LZ4_decompress_safe(payload, (char *)buf, paylen, size) !=
+               size) {
+        free(buf);
+        return -1;
+    }
+    if (crc32c(buf, size) != checksum) {
+        free(buf);
+        return -1;
+    }
+    *out = buf;
+    return 0;
+}
+
+int physrep_batch_next(const uint8_t **p, const uint8_t *end,
+                       struct physrep_batch_rec *rec)
+{
+    const uint8_t *q = *p;
+    uint32_t u32;
+    uint64_t u64;
+
+    if (q == end)
+        return 0;
+    if (end - q < PHYSREP_BATCH_REC_HDR_LEN)
+        return -1;
+    memcpy(&u32, q, 4);
+    rec->file = ntohl(u32);
+    memcpy(&u32, q + 4, 4);
+    rec->offset = ntohl(u32);
+    memcpy(&u32, q + 8, 4);
+    rec->rectype = ntohl(u32);
+    memcpy(&u32, q + 12, 4);
+    rec->len = ntohl(u32);
+    memcpy(&u64, q + 16, 8);
+    rec->timestamp = (int64_t)flibc_ntohll(u64);
+    q += PHYSREP_BATCH_REC_HDR_LEN;
+    if (end - q < rec->len)
+        return -1;
+    rec->rec = q;
+    *p = q + rec->len;
+    return 1;
+}
+
+int64_t physrep_log_distance(DB_ENV *dbenv, uint32_t file, uint32_t offset,
+                             uint32_t tofile, uint32_t tooffset)
+{
+    u_int32_t lg_max = 0;
+    int64_t d;
+
+    if (tofile < file || (tofile == file && tooffset <= offset))
+        return 0;
+    if (tofile == file)
+        return tooffset - offset;
+    /* log files are rolled over at lg_max */
+    dbenv->get_lg_max(dbenv, &lg_max);
+    d = (int64_t)(tofile - file) * lg_max + tooffset - (int64_t)offset;
+    return d > 0 ? d : 0;
+}
@@ -0,0 +1,77 @@
+/*
+   Copyright 2026 Bloomberg Finance L.P.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+ */
+
+#ifndef PHYS_REP_BATCH_H
+#define PHYS_REP_BATCH_H
+
+#include <stdint.h>
+
+struct __db_env;
+
+/*
+ * Log batches of comdb2_transaction_log_batches.
+ *
+ * A batch is a run of consecutive log records, each one packed as
+ *   u32 file, u32 offset, u32 rectype, u32 len, i64 timestamp, record[len]
+ * in network byte order.  The batch is shipped LZ4 compressed, unless that
+ * does not make it smaller, along with the CRC32C of the packed records.
+ */
+
+enum { PHYSREP_BATCH_REC_HDR_LEN = 4 + 4 + 4 + 4 + 8 };
+
+struct physrep_batch {
+    uint8_t *buf; /* packed records */
+    int len;
+    int cap;
+    int nrecs;
+
+    uint8_t *out; /* what is shipped */
+    int outlen;
+    int outcap;
+    uint32_t checksum;
+};
+
+struct physrep_batch_rec {
+    uint32_t file;
+    uint32_t offset;
+    uint32_t rectype;
+    uint32_t len;
+    int64_t timestamp;
+    const void *rec;
+};
+
+void physrep_batch_reset(struct physrep_batch *b);
+void physrep_batch_free(struct physrep_batch *b);
+int physrep_batch_add(struct physrep_batch *b, uint32_t file, uint32_t offset,
+                      uint32_t rectype, int64_t timestamp, const void *rec,
+                      uint32_t len);
+int physrep_batch_seal(struct physrep_batch *b);
+
+/* Unpacks a shipped batch of `size' bytes into a malloc'ed buffer,
+ * checking its checksum.  Returns 0 on success. */
+int physrep_batch_open(const void *payload, int paylen, int size,
+                       uint32_t checksum, uint8_t **out);
+/* Reads the record at *p and moves past it.  Returns 1 on success, 0 at
+ * the end of the batch and -1 on a malformed record. */
+int physrep_batch_next(const uint8_t **p, const uint8_t *end,
+                       struct physrep_batch_rec *rec);
+
+/* Bytes of log from (file, offset) to (tofile, tooffset) */
+int64_t physrep_log_distance(struct __db_env *dbenv, uint32_t file,
+                             uint32_t offset, uint32_t tofile,
+                             uint32_t tooffset);
+
+#endif /* PHYS_REP_BATCH_H */
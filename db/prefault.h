@@ -129,10 +129,12 @@ typedef struct {
 
     /* for readahead prefaulting */
     struct dbtable *db;
-    short ixnum;
+    short ixnum; /* -1 for a data scan */
     short keylen;
     short numreadahead;
+    short prev; /* scan moves backwards */
     unsigned char key[MAXKEYLEN + 1];
+    unsigned long long genid; /* data scan position */
     int abort;
 
     unsigned char *pfk_bitmap;
@@ -204,11 +206,12 @@ int start_prefault_io_threads(struct dbenv *dbenv, int numthreads, int maxq);
 int prefault_toblock(struct ireq *iq, void *blkstate, int helper_thread,
                      unsigned int seqnum, int *abort);
 int prefault_readahead(struct dbtable *db, int ixnum, unsigned char *key, int keylen,
-                       int num);
+                       unsigned long long genid, int num, int prev);
 
-/* call this to initiate a readahead */
+/* call this to initiate a readahead; ixnum -1 reads ahead of genid in the
+   data file */
 int readaheadpf(struct ireq *iq, struct dbtable *db, int ixnum, unsigned char *key,
-                int keylen, int num);
+                int keylen, unsigned long long genid, int num, int prev);
 
 void prefault_stats(struct dbenv *dbenv);
 
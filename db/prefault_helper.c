@@ -68,6 +68,8 @@ static void *prefault_helper_thread(void *arg)
     int ixnum = 0;
     struct dbtable *db = NULL;
     int numreadahead = 0;
+    int prev = 0;
+    unsigned long long genid = 0;
     struct thr_handle *thr_self;
     pthread_t working_for;
 
@@ -148,6 +150,8 @@ static void *prefault_helper_thread(void *arg)
             memcpy(key, dbenv->prefault_helper.threads[i].key,
                    dbenv->prefault_helper.threads[i].keylen);
             numreadahead = dbenv->prefault_helper.threads[i].numreadahead;
+            prev = dbenv->prefault_helper.threads[i].prev;
+            genid = dbenv->prefault_helper.threads[i].genid;
 
             break;
         }
@@ -187,7 +191,8 @@ static void *prefault_helper_thread(void *arg)
 
         case PREFAULT_READAHEAD:
             thrman_where(thr_self, "prefault_readahead");
-            rc = prefault_readahead(db, ixnum, key, keylen, numreadahead);
+            rc = prefault_readahead(db, ixnum, key, keylen, genid, numreadahead,
+                                    prev);
             if (rc)
                 logmsg(LOGMSG_ERROR, "%s:%d rc=%d\n", __func__, __LINE__, rc);
             thrman_where(thr_self, NULL);
@@ -321,7 +326,7 @@ int create_prefault_helper_threads(struct dbenv *dbenv, int nthreads)
 }
 
 int readaheadpf(struct ireq *iq, struct dbtable *db, int ixnum, unsigned char *key,
-                int keylen, int num)
+                int keylen, unsigned long long genid, int num, int prev)
 {
     pthread_t my_tid;
     int i;
@@ -347,9 +352,12 @@ int readaheadpf(struct ireq *iq, struct dbtable *db, int ixnum, unsigned char *k
             iq->dbenv->prefault_helper.threads[i].db = db;
             iq->dbenv->prefault_helper.threads[i].ixnum = ixnum;
             iq->dbenv->prefault_helper.threads[i].keylen = keylen;
-            memcpy(iq->dbenv->prefault_helper.threads[i].key, key,
-                   iq->dbenv->prefault_helper.threads[i].keylen);
+            if (keylen > 0)
+                memcpy(iq->dbenv->prefault_helper.threads[i].key, key,
+                       iq->dbenv->prefault_helper.threads[i].keylen);
             iq->dbenv->prefault_helper.threads[i].numreadahead = num;
+            iq->dbenv->prefault_helper.threads[i].prev = prev;
+            iq->dbenv->prefault_helper.threads[i].genid = genid;
 
             /*fprintf(stderr, "readahead signaling helper %d\n", i);*/
 
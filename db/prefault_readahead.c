@@ -31,7 +31,7 @@
 #define MAXGENIDS 256
 
 int prefault_readahead(struct dbtable *db, int ixnum, unsigned char *key, int keylen,
-                       int num)
+                       unsigned long long genid, int num, int prev)
 {
     unsigned long long genids[MAXGENIDS];
     int rc;
@@ -45,14 +45,28 @@ int prefault_readahead(struct dbtable *db, int ixnum, unsigned char *key, int ke
     if (num > MAXGENIDS)
         num = MAXGENIDS;
 
-    /* get the next NUM genids from ix ixnum and enqueue faults for those
-       dta records */
-    rc = get_next_genids(&iq, ixnum, key, keylen, genids, num, &num_gotten);
+    /* data scan: fault in the next NUM records of the data file */
+    if (ixnum < 0)
+        return prefault_dta_records(&iq, genid, num, prev);
 
-    if (rc == 0) {
-        for (i = 0; i < num_gotten; i++) {
-            enque_pfault_olddata(db, genids[i], 0, -1, 0, 0, 1, 0);
-        }
+    /* get the next NUM genids from ix ixnum; walking the index faults in
+       the index pages */
+    if (prev)
+        rc = get_prev_genids(&iq, ixnum, key, keylen, genids, num, &num_gotten);
+    else
+        rc = get_next_genids(&iq, ixnum, key, keylen, genids, num, &num_gotten);
+    if (rc)
+        return 0;
+
+    /* a covering index does not need the data records */
+    if (db->ix_datacopy[ixnum] && db->ix_datacopylen[ixnum] == 0)
+        return 0;
+
+    /* enqueue faults for the dta records; without room in the io queue,
+       fault them in here */
+    for (i = 0; i < num_gotten; i++) {
+        if (enque_pfault_olddata(db, genids[i], 0, -1, 0, 0, 1, 0))
+            prefault_dta_records(&iq, genids[i], 0, 0);
     }
 
     return 0;
@@ -5387,8 +5387,9 @@ void ixstats(struct dbenv *dbenv)
         db = dbenv->dbs[dbn];
         logmsg(LOGMSG_USER, "table '%s'\n", db->tablename);
         for (ix = 0; ix < db->nix; ix++) {
-            logmsg(LOGMSG_USER, "  ix %2d:   %lld steps  %lld sql steps\n", ix,
-                   db->ixuse[ix], db->sqlixuse[ix]);
+            logmsg(LOGMSG_USER,
+                   "  ix %2d:   %lld steps  %lld sql steps  %lld data lookups\n",
+                   ix, db->ixuse[ix], db->sqlixuse[ix], db->sqlixlookups[ix]);
         }
     }
 }
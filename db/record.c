@@ -126,6 +126,18 @@ static inline int has_constraint(int flags)
     return !(flags & RECFLAGS_NO_CONSTRAINTS);
 }
 
+/* shards frozen by timepart_freeze_shards take no more writes; this covers
+   every path that applies them (sql bplogs and tagged requests) */
+static int check_frozen_shard(struct ireq *iq, int flags, int *opfailcode)
+{
+    if (is_event_from_sc(flags) || !iq->usedb->timepartition_frozen)
+        return 0;
+    reqerrstr(iq, COMDB2_CSTRT_RC_INVL_TBL, "shard %s of partition %s is frozen", iq->usedb->tablename,
+              iq->usedb->timepartition_name);
+    *opfailcode = OP_FAILED_BAD_REQUEST;
+    return ERR_BADREQ;
+}
+
 /*
  * For logical_livesc, function returns ERR_VERIFY if
  * the record being added is already in the btree.
@@ -183,6 +195,9 @@ int add_record(struct ireq *iq, void *trans, const uint8_t *p_buf_tag_name,
         ERR("no usedb set", 0);
     }
 
+    if ((retrc = check_frozen_shard(iq, flags, opfailcode)) != 0)
+        ERR("frozen shard %s", iq->usedb->tablename);
+
     if (iq->debug) {
         reqpushprefixf(iq, "TBL %s ", iq->usedb->tablename);
         prefixes++;
@@ -888,6 +903,9 @@ int upd_record(struct ireq *iq, void *trans, void *primkey, int rrn,
         ERR("usedb not set", 0);
     }
 
+    if ((retrc = check_frozen_shard(iq, flags, opfailcode)) != 0)
+        ERR("frozen shard %s", iq->usedb->tablename);
+
     if (iq->debug) {
         reqpushprefixf(iq, "TBL %s ", iq->usedb->tablename);
         prefixes++;
@@ -1774,6 +1792,9 @@ int del_record(struct ireq *iq, void *trans, void *primkey, int rrn,
         goto err;
     }
 
+    if ((retrc = check_frozen_shard(iq, flags, opfailcode)) != 0)
+        goto err;
+
     int d_ms = BDB_ATTR_GET(thedb->bdb_attr, DELAY_WRITES_IN_RECORD_C);
     if (d_ms) {
         if (iq->debug)
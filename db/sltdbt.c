@@ -516,9 +516,12 @@ int handle_ireq(struct ireq *iq)
 
             if (iq->sorese->rqid == 0)
                 abort();
-            osql_comm_signal_sqlthr_rc(
-                &iq->sorese->target, iq->sorese->rqid, iq->sorese->uuid,
-                iq->sorese->nops, &iq->errstat, IQ_SNAPINFO(iq), sorese_rc);
+            if (iq->commit_ack_deferred)
+                commit_ack_enqueue(iq, sorese_rc);
+            else
+                osql_comm_signal_sqlthr_rc(
+                    &iq->sorese->target, iq->sorese->rqid, iq->sorese->uuid,
+                    iq->sorese->nops, &iq->errstat, IQ_SNAPINFO(iq), sorese_rc);
 
             iq->timings.req_sentrc = osql_log_time();
 
@@ -35,6 +35,8 @@
 #include "comdb2_ruleset.h"
 #include <sp.h>
 #include "sql_stmt_cache.h"
+#include "sql_mem.h"
+#include "sql_rcache.h"
 #include "db_access.h"
 #include "sqliteInt.h"
 #include "ast.h"
@@ -61,6 +63,7 @@ struct fingerprint_track {
     int64_t max_cost; /* Max cost of any query */
     int64_t prepTime; /* Cumulative preparation time only */
     int64_t rows;     /* Cumulative number of rows selected */
+    int64_t mem_peak; /* Peak memory of the last execution */
     int64_t curr_analyze_gen; /* If the analyze gen number is different */
     int     check_next_queries; /* Check cost of next these many queries */
     int     cost_increased; /* queries with cost greater than avg cost */
@@ -387,7 +390,8 @@ enum {
     XRESPONSE(RESPONSE_ROW_STR)                                                \
     XRESPONSE(RESPONSE_TRACE)                                                  \
     XRESPONSE(RESPONSE_ROW_REMTRAN)                                            \
-    XRESPONSE(RESPONSE_RAW_PAYLOAD)
+    XRESPONSE(RESPONSE_RAW_PAYLOAD)                                            \
+    XRESPONSE(RESPONSE_CACHED_ROWS)
 
 #define XRESPONSE(x) x,
 enum WriteResponsesEnum { RESPONSE_TYPES };
@@ -515,6 +519,7 @@ struct plugin_callbacks {
     const intv_t *(*column_interval)(struct sqlclntstate *, sqlite3_stmt *, int, int);  /* sqlite3_column_interval*/
     int (*sqlite_error)(struct sqlclntstate *, sqlite3_stmt *, const char **errstr);    /* sqlite3_errcode */
     void *(*get_identity)(struct sqlclntstate *);
+    plugin_func *cache_results; /* newsql_cache_results */
 };
 
 #define make_plugin_callback(clnt, name, func)                                 \
@@ -906,6 +911,9 @@ struct sqlclntstate {
     uint64_t enque_timeus;
     uint64_t deque_timeus;
 
+    struct sql_mem mem; /* memory used and reserved by the current query */
+    struct sql_rcache_fill *rcache_fill; /* recording the result, if set */
+
     /* due to some sqlite vagaries, cursor is closed
        and I lose the side row; cache it here! */
     unsigned long long keyDdl;
@@ -1133,6 +1141,7 @@ struct Btree {
 
     hash_t *temp_tables;
     int num_temp_tables;
+    int hashjoin_nkey; /* index temp tables are hashed on this many columns */
 
     void *schema;
     void (*free_schema)(void *);
@@ -1216,6 +1225,11 @@ struct BtCursor {
     /* special case for a temp table: pointer to a temp table handle */
     struct temptable *tmptable;
 
+    /* last search of a temp hash join table, which next keeps matching */
+    struct UnpackedRecord *hj_probe;
+    void *hj_probe_buf;
+    int hj_probing;
+
     sampler_t *sampler;
 
     blob_status_t blobs;
@@ -1224,7 +1238,11 @@ struct BtCursor {
 
     int nmove, nfind, nwrite;
     int nblobs;
-    int num_nexts;
+    int nlookups; /* data rows read through this index cursor */
+    int num_nexts;  /* consecutive moves in the ra_dir direction */
+    int ra_dir;     /* direction of the last move */
+    int ra_left;    /* moves left before the next readahead */
+    int ra_window;  /* current readahead window, in rows */
 
     int numblobs;
 
@@ -1278,6 +1296,9 @@ struct BtCursor {
     unsigned char is_equality; /* sqlite will "hint" back if a SeekGE is
                                   actually a SeekEQ */
 
+    /* hinted WHERE terms checked against the zone maps of a table scan */
+    struct zonemap_scan *zonemap;
+
     unsigned long long col_mask; /* tracking first 63 columns, if bit is set,
                                     column is needed */
 
@@ -1368,6 +1389,8 @@ struct connection_info {
     int64_t in_local_cache;
     char *uuid;
     int64_t is_canceled;
+    int64_t mem_used;
+    int64_t mem_peak;
 };
 
 /* makes master swing verbose */
@@ -1612,6 +1635,7 @@ void calc_fingerprint(const char *zNormSql, size_t *pnNormSql,
                       unsigned char fingerprint[FINGERPRINTSZ]);
 void add_fingerprint(struct sqlclntstate *, sqlite3_stmt *, struct string_ref *, const char *, int64_t, int64_t,
                      int64_t, int64_t, struct reqlogger *, unsigned char *, int);
+int64_t fingerprint_mem_peak(const unsigned char fingerprint[FINGERPRINTSZ]);
 
 long long run_sql_return_ll(const char *query, struct errstat *err);
 long long run_sql_thd_return_ll(const char *query, struct sql_thread *thd,
@@ -1623,13 +1647,16 @@ struct query_plan_item {
     double avg_cost_per_row;
     double total_cost_per_row;
     int nexecutions;
+    double est_cost;  /* planner estimate, as of the last execution */
+    int planner_steps; /* loops the planner tried to add to a join order */
     int alert_once_cost; /* Only log query plan cost differences once per query plan in trace, but reset if the avg cost changes. Init to 1 */
 };
 int free_query_plan_hash(hash_t *query_plan_hash);
 int clear_query_plans();
 struct string_ref *form_query_plan(struct sqlclntstate *clnt, sqlite3_stmt *stmt);
-void add_query_plan(int64_t cost, int64_t nrows, struct fingerprint_track *t, struct string_ref *zSql_ref,
-                    struct string_ref *query_plan_ref, unsigned char *plan_fingerprint, char *params);
+void add_query_plan(sqlite3_stmt *stmt, int64_t cost, int64_t nrows, struct fingerprint_track *t,
+                    struct string_ref *zSql_ref, struct string_ref *query_plan_ref, unsigned char *plan_fingerprint,
+                    char *params);
 
 struct query_field {
     unsigned char fingerprint[FINGERPRINTSZ];
@@ -1647,6 +1674,7 @@ void add_query_to_samples_queries(const unsigned char *fingerprint, const unsign
 /* Connection tracking */
 int gather_connection_info(struct connection_info **info, int *num_connections);
 void free_connection_info(struct connection_info *info, int num_connections);
+int gather_sql_mem_usages(comdb2ma_usage **usages, int *n);
 void clnt_change_state(struct sqlclntstate *clnt, enum connection_state state);
 
 struct sqlclntstate *get_sql_clnt(void);
@@ -0,0 +1,166 @@
+/*
+   Copyright 2026 Bloomberg Finance L.P.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+ */
+
+/*
+ * Per-query memory.
+ *
+ * While a sql thread runs a query, the sqlite heap, lua states and in-memory
+ * temp tables it allocates are charged to the query's account (see
+ * comdb2ma_acct in mem.h), and so are the allocations of its dohsql shard
+ * threads and the rows they queue.  The peak of the account is saved with
+ * the query's fingerprint.
+ *
+ * With sql_mem_budget_mb set, a query reserves what its fingerprint used the
+ * last time it ran, or sql_mem_default_estimate_kb, before it starts.  A
+ * query which goes past its reservation grows it.  A query which doesn't fit
+ * in the budget waits for running queries to finish, and is rejected if it
+ * still doesn't fit after sql_mem_admission_wait_ms.  A query always fits if
+ * nothing else is running.
+ */
+
+#include <errno.h>
+#include <pthread.h>
+#include <time.h>
+
+#include "comdb2_atomic.h"
+#include <sys_wrap.h>
+#include "sql.h"
+#include "sql_mem.h"
+
+int gbl_sql_mem_accounting = 1;
+int gbl_sql_mem_budget_mb = 0;
+int gbl_sql_mem_admission_wait_ms = 1000;
+int gbl_sql_mem_default_estimate_kb = 1024;
+
+int64_t gbl_sql_mem_queued = 0;
+int64_t gbl_sql_mem_rejected = 0;
+
+/* Reservations are made and grown in steps of this many bytes */
+#define SQL_MEM_STEP (1024 * 1024)
+
+static pthread_mutex_t sql_mem_lk = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t sql_mem_cd = PTHREAD_COND_INITIALIZER;
+static int64_t sql_mem_total; /* reserved by the queries admitted */
+
+static int64_t sql_mem_round(int64_t n)
+{
+    return (n + SQL_MEM_STEP - 1) / SQL_MEM_STEP * SQL_MEM_STEP;
+}
+
+/* The query went past its reservation */
+static void sql_mem_grow(comdb2ma_acct *acct)
+{
+    struct sql_mem *m = (struct sql_mem *)acct;
+
+    Pthread_mutex_lock(&sql_mem_lk);
+    int64_t peak = ATOMIC_LOAD64(acct->peak);
+    if (m->reserved > 0 && peak >= m->reserved) {
+        /* a step past the peak, or this fires again on the next charge */
+        int64_t reserved = sql_mem_round(peak + 1);
+        sql_mem_total += reserved - m->reserved;
+        m->reserved = reserved;
+    }
+    acct->notify_at = m->reserved > 0 ? m->reserved : INT64_MAX;
+    Pthread_mutex_unlock(&sql_mem_lk);
+}
+
+int sql_mem_admit(struct sqlclntstate *clnt, int64_t projected, int wait)
+{
+    struct sql_mem *m = &clnt->mem;
+    int64_t budget = (int64_t)gbl_sql_mem_budget_mb * 1024 * 1024;
+    struct timespec deadline;
+    int queued = 0;
+    int rc = 0;
+
+    sql_mem_release(clnt);
+    if (budget <= 0)
+        return 0;
+
+    projected = sql_mem_round(projected > 0 ? projected : 1);
+
+    Pthread_mutex_lock(&sql_mem_lk);
+    while (wait && sql_mem_total > 0 && sql_mem_total + projected > budget) {
+        if (!queued) {
+            queued = 1;
+            ATOMIC_ADD64(gbl_sql_mem_queued, 1);
+            clnt_change_state(clnt, CONNECTION_QUEUED);
+            clock_gettime(CLOCK_REALTIME, &deadline);
+            deadline.tv_sec += gbl_sql_mem_admission_wait_ms / 1000;
+            deadline.tv_nsec += (gbl_sql_mem_admission_wait_ms % 1000) * 1000000;
+            if (deadline.tv_nsec >= 1000000000) {
+                deadline.tv_sec++;
+                deadline.tv_nsec -= 1000000000;
+            }
+        }
+        if (rc == ETIMEDOUT || gbl_sql_mem_admission_wait_ms <= 0) {
+            ATOMIC_ADD64(gbl_sql_mem_rejected, 1);
+            Pthread_mutex_unlock(&sql_mem_lk);
+            return -1;
+        }
+        rc = pthread_cond_timedwait(&sql_mem_cd, &sql_mem_lk, &deadline);
+    }
+    sql_mem_total += projected;
+    m->reserved = projected;
+    m->acct.notify_at = projected;
+    m->acct.notify = sql_mem_grow;
+    Pthread_mutex_unlock(&sql_mem_lk);
+
+    if (queued)
+        clnt_change_state(clnt, CONNECTION_RUNNING);
+    return 0;
+}
+
+void sql_mem_release(struct sqlclntstate *clnt)
+{
+    struct sql_mem *m = &clnt->mem;
+
+    /* only the thread running the query sets it */
+    if (m->reserved == 0)
+        return;
+
+    Pthread_mutex_lock(&sql_mem_lk);
+    sql_mem_total -= m->reserved;
+    m->reserved = 0;
+    m->acct.notify_at = INT64_MAX;
+    Pthread_cond_broadcast(&sql_mem_cd);
+    Pthread_mutex_unlock(&sql_mem_lk);
+}
+
+void sql_mem_query_start(struct sqlclntstate *clnt)
+{
+    struct sql_mem *m = &clnt->mem;
+
+    m->acct.used = 0;
+    m->acct.peak = 0;
+    m->acct.epoch = comdb2ma_acct_new_epoch();
+    if (gbl_sql_mem_accounting)
+        comdb2ma_acct_set(&m->acct);
+}
+
+void sql_mem_query_done(struct sqlclntstate *clnt)
+{
+    if (comdb2ma_thd_acct == &clnt->mem.acct)
+        comdb2ma_acct_set(NULL);
+    sql_mem_release(clnt);
+}
+
+int64_t sql_mem_reserved(void)
+{
+    Pthread_mutex_lock(&sql_mem_lk);
+    int64_t reserved = sql_mem_total;
+    Pthread_mutex_unlock(&sql_mem_lk);
+    return reserved;
+}
@@ -0,0 +1,59 @@
+/*
+   Copyright 2026 Bloomberg Finance L.P.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+ */
+
+#ifndef INCLUDED_SQL_MEM_H
+#define INCLUDED_SQL_MEM_H
+
+/*
+  Memory accounting and admission control for sql queries
+*/
+
+#include <stdint.h>
+#include <mem.h>
+
+struct sqlclntstate;
+
+struct sql_mem {
+    comdb2ma_acct acct; /* memory used by the current query */
+    int64_t reserved;   /* counted against sql_mem_budget_mb */
+};
+
+extern int gbl_sql_mem_accounting;
+extern int gbl_sql_mem_budget_mb;
+extern int gbl_sql_mem_admission_wait_ms;
+extern int gbl_sql_mem_default_estimate_kb;
+
+extern int64_t gbl_sql_mem_queued;
+extern int64_t gbl_sql_mem_rejected;
+
+/* Reserve memory for the query clnt is about to run.  Unless `wait' is 0,
+ * waits while the query doesn't fit in the budget, up to
+ * sql_mem_admission_wait_ms.  Returns 0 if the query may run. */
+int sql_mem_admit(struct sqlclntstate *clnt, int64_t projected, int wait);
+
+/* Return the memory reserved for clnt's query */
+void sql_mem_release(struct sqlclntstate *clnt);
+
+/* Charge the allocations of this thread to clnt's query, from now on */
+void sql_mem_query_start(struct sqlclntstate *clnt);
+
+/* The query is done: stop charging it and release its reservation */
+void sql_mem_query_done(struct sqlclntstate *clnt);
+
+/* Memory reserved by running queries */
+int64_t sql_mem_reserved(void);
+
+#endif /* INCLUDED_SQL_MEM_H */
@@ -0,0 +1,483 @@
+/*
+   Copyright 2026 Bloomberg Finance L.P.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+ */
+
+/*
+ * Result cache for read-only queries.
+ *
+ * A cached result is the column names and rows of a query, exactly as they
+ * were written to the client, so that a hit is written back as it is.  It is
+ * keyed by the query's fingerprint and sql, its bound parameters and the
+ * session settings which change how the result is encoded.  It also holds the
+ * schema version and change generation (see bdb_table_chg_gen()) of every
+ * table the query read, as of before it ran: the change generation of a
+ * table goes up whenever one of its pages is dirtied, which a writer does
+ * before its commit makes the change visible.  A result is only cached if
+ * none of them moved while the query ran, and a hit is only served if none
+ * moved since.
+ *
+ * Only queries on the tables in sql_result_cache_tables, or with a
+ * fingerprint in sql_result_cache_fingerprints, are cached, and only outside
+ * client transactions, under read committed, and if they call no functions
+ * whose results may change between runs.
+ */
+
+#include <pthread.h>
+#include <string.h>
+#include <strings.h>
+
+#include <sys_wrap.h>
+#include <list.h>
+#include <plhash_glue.h>
+#include <strbuf.h>
+#include <tohex.h>
+#include "logmsg.h"
+#include "sql.h"
+#include "db_access.h"
+#include "sql_rcache.h"
+#include "sqliteInt.h"
+#include "vdbeInt.h"
+
+extern int gbl_rowlocks;
+extern int gbl_typessql;
+
+int gbl_sql_rcache_mb = 0;
+int gbl_sql_rcache_max_entry_kb = 1024;
+char *gbl_sql_rcache_tables = NULL;
+char *gbl_sql_rcache_fingerprints = NULL;
+
+int64_t gbl_sql_rcache_hits = 0;
+int64_t gbl_sql_rcache_misses = 0;
+int64_t gbl_sql_rcache_stores = 0;
+
+struct sql_rcache_ent {
+    char *key; /* fingerprint, settings, parameters and sql */
+    struct sql_rcache_tbl tbls[SQL_RCACHE_MAX_TABLES];
+    int ntbls;
+    uint8_t *buf; /* responses, back to back */
+    size_t len;
+    int nrows;
+    int refcnt; /* queries replaying this entry, plus one for the cache */
+    LINKC_T(struct sql_rcache_ent) lnk; /* lru */
+};
+
+struct sql_rcache_fill {
+    char *key;
+    struct sql_rcache_tbl tbls[SQL_RCACHE_MAX_TABLES];
+    int ntbls;
+    uint8_t *buf;
+    size_t len;
+    size_t alloc;
+    int nrows;
+    int toobig;
+    unsigned int gen; /* cache generation when the query started */
+};
+
+static pthread_mutex_t rcache_mtx = PTHREAD_MUTEX_INITIALIZER;
+static hash_t *rcache_ents;                  /* entries, by key */
+static LISTC_T(struct sql_rcache_ent) rcache_lru; /* most recent at top */
+static int64_t rcache_bytes;
+static unsigned int rcache_gen; /* bumped when the cache is flushed */
+
+/* What gets cached, protected by rcache_mtx */
+static char **rcache_tbl_names;
+static int rcache_ntbl_names;
+static int rcache_all_tables;
+static char **rcache_fps; /* in hex */
+static int rcache_nfps;
+
+static void rcache_init_once(void)
+{
+    rcache_ents = hash_init_strptr(offsetof(struct sql_rcache_ent, key));
+    listc_init(&rcache_lru, offsetof(struct sql_rcache_ent, lnk));
+}
+
+static void rcache_init(void)
+{
+    static pthread_once_t once = PTHREAD_ONCE_INIT;
+    Pthread_once(&once, rcache_init_once);
+}
+
+static void rcache_ent_free(struct sql_rcache_ent *ent)
+{
+    free(ent->key);
+    free(ent->buf);
+    free(ent);
+}
+
+/* rcache_mtx held */
+static void rcache_unlink(struct sql_rcache_ent *ent)
+{
+    hash_del(rcache_ents, ent);
+    listc_rfl(&rcache_lru, ent);
+    rcache_bytes -= ent->len;
+    if (--ent->refcnt == 0)
+        rcache_ent_free(ent);
+}
+
+void sql_rcache_flush(void)
+{
+    struct sql_rcache_ent *ent, *tmp;
+
+    rcache_init();
+    Pthread_mutex_lock(&rcache_mtx);
+    LISTC_FOR_EACH_SAFE(&rcache_lru, ent, tmp, lnk)
+    {
+        rcache_unlink(ent);
+    }
+    rcache_gen++;
+    Pthread_mutex_unlock(&rcache_mtx);
+}
+
+int64_t sql_rcache_bytes(void)
+{
+    Pthread_mutex_lock(&rcache_mtx);
+    int64_t bytes = rcache_bytes;
+    Pthread_mutex_unlock(&rcache_mtx);
+    return bytes;
+}
+
+/* Split a comma separated list; returns the number of items */
+static int rcache_split(const char *list, char ***pitems)
+{
+    char *copy = strdup(list ? list : "");
+    char *last = NULL;
+    char **items = NULL;
+    int n = 0;
+
+    for (char *tok = strtok_r(copy, ",", &last); tok;
+         tok = strtok_r(NULL, ",", &last)) {
+        items = realloc(items, (n + 1) * sizeof(char *));
+        items[n++] = strdup(tok);
+    }
+    free(copy);
+    *pitems = items;
+    return n;
+}
+
+int sql_rcache_set_tables(const char *list)
+{
+    char **names;
+    int n = rcache_split(list, &names);
+    int all = 0;
+
+    for (int i = 0; i < n; i++) {
+        if (strcmp(names[i], "*") == 0)
+            all = 1;
+    }
+
+    Pthread_mutex_lock(&rcache_mtx);
+    for (int i = 0; i < rcache_ntbl_names; i++)
+        free(rcache_tbl_names[i]);
+    free(rcache_tbl_names);
+    rcache_tbl_names = names;
+    rcache_ntbl_names = n;
+    rcache_all_tables = all;
+    Pthread_mutex_unlock(&rcache_mtx);
+
+    sql_rcache_flush();
+    return 0;
+}
+
+int sql_rcache_set_fingerprints(const char *list)
+{
+    char **fps;
+    int n = rcache_split(list, &fps);
+    int rc = 0;
+
+    for (int i = 0; i < n; i++) {
+        size_t len = strlen(fps[i]);
+        if (len != FINGERPRINTSZ * 2 ||
+            strspn(fps[i], "0123456789abcdefABCDEF") != len) {
+            logmsg(LOGMSG_ERROR, "%s: bad fingerprint '%s'\n", __func__,
+                   fps[i]);
+            rc = -1;
+        }
+    }
+    if (rc) {
+        for (int i = 0; i < n; i++)
+            free(fps[i]);
+        free(fps);
+        return rc;
+    }
+
+    Pthread_mutex_lock(&rcache_mtx);
+    for (int i = 0; i < rcache_nfps; i++)
+        free(rcache_fps[i]);
+    free(rcache_fps);
+    rcache_fps = fps;
+    rcache_nfps = n;
+    Pthread_mutex_unlock(&rcache_mtx);
+
+    sql_rcache_flush();
+    return 0;
+}
+
+/* Is the query on tables or with a fingerprint we cache?  rcache_mtx held */
+static int rcache_enabled(const unsigned char *fingerprint,
+                          struct sql_rcache_tbl *tbls, int ntbls)
+{
+    if (rcache_nfps > 0) {
+        char fp[FINGERPRINTSZ * 2 + 1];
+        util_tohex(fp, (const char *)fingerprint, FINGERPRINTSZ);
+        for (int i = 0; i < rcache_nfps; i++) {
+            if (strcasecmp(rcache_fps[i], fp) == 0)
+                return 1;
+        }
+    }
+    if (rcache_all_tables)
+        return 1;
+    if (rcache_ntbl_names == 0)
+        return 0;
+    for (int i = 0; i < ntbls; i++) {
+        int found = 0;
+        for (int j = 0; j < rcache_ntbl_names && !found; j++)
+            found = strcasecmp(tbls[i].tablename, rcache_tbl_names[j]) == 0;
+        if (!found)
+            return 0;
+    }
+    return 1;
+}
+
+/* Can the result of the query be cached at all? */
+static int rcache_can_cache(struct sqlclntstate *clnt, sqlite3_stmt *stmt)
+{
+    Vdbe *v = (Vdbe *)stmt;
+
+    if (!clnt->isselect || sqlite3_stmt_isexplain(stmt))
+        return 0;
+    if (clnt->in_client_trans || clnt->modsnap_in_progress || gbl_rowlocks)
+        return 0;
+    if (clnt->dbtran.mode != TRANLEVEL_SOSQL &&
+        clnt->dbtran.mode != TRANLEVEL_RECOM)
+        return 0;
+    if (clnt->num_retry || clnt->multiline || clnt->verify_indexes ||
+        clnt->sqlite_row_format || clnt->fdb_push)
+        return 0;
+    if (v->hasVTables || stmt_has_volatile_func(stmt))
+        return 0;
+    return 1;
+}
+
+/* Everything but the tables read which tells two results apart */
+static char *rcache_key(struct sqlclntstate *clnt)
+{
+    strbuf *sb = strbuf_new();
+    struct param_data p;
+    int nparams = param_count(clnt);
+    const char *user = get_current_user(clnt);
+
+    if (user == NULL && clnt->current_user.have_name)
+        user = clnt->current_user.name; /* from a client certificate */
+
+    strbuf_hex(sb, clnt->work.aFingerprint, FINGERPRINTSZ);
+    strbuf_appendf(sb, "\n%s %d %d %d %d %d\n", clnt->tzname, clnt->dtprec,
+                   clnt->flat_col_vals, clnt->return_long_column_names,
+                   clnt->request_fp, gbl_typessql || clnt->typessql);
+    /* results the user isn't allowed to see, or which depend on who asks,
+     * must not be served to someone else */
+    if (user)
+        strbuf_hex(sb, (void *)user, strlen(user));
+    strbuf_append(sb, "\n");
+    for (int i = 0; i < nparams; i++) {
+        memset(&p, 0, sizeof(p));
+        if (param_value(clnt, &p, i) != 0 || p.arraylen > 0) {
+            strbuf_free(sb);
+            return NULL;
+        }
+        strbuf_appendf(sb, "%s %d %d %d ", p.name ? p.name : "", p.pos,
+                       p.type, p.null);
+        if (p.null)
+            ;
+        else if (p.type == CLIENT_CSTR || p.type == CLIENT_PSTR ||
+                 p.type == CLIENT_PSTR2 || p.type == CLIENT_VUTF8 ||
+                 p.type == CLIENT_BLOB || p.type == CLIENT_BYTEARRAY)
+            strbuf_hex(sb, p.u.p, p.len);
+        else
+            strbuf_hex(sb, &p.u, sizeof(p.u));
+        strbuf_append(sb, "\n");
+    }
+    strbuf_append(sb, clnt->sql);
+    return strbuf_disown(sb);
+}
+
+static int rcache_same_versions(struct sql_rcache_tbl *a, int na,
+                                struct sql_rcache_tbl *b, int nb)
+{
+    return na == nb && memcmp(a, b, na * sizeof(*a)) == 0;
+}
+
+struct sql_rcache_ent *sql_rcache_get(struct sqlclntstate *clnt,
+                                      sqlite3_stmt *stmt,
+                                      struct sql_rcache_fill **pfill)
+{
+    struct sql_rcache_tbl tbls[SQL_RCACHE_MAX_TABLES];
+    struct sql_rcache_ent *ent;
+    int enabled;
+    char *key;
+
+    *pfill = NULL;
+    if (gbl_sql_rcache_mb <= 0 || !rcache_can_cache(clnt, stmt))
+        return NULL;
+
+    memset(tbls, 0, sizeof(tbls));
+    int ntbls = sql_stmt_table_versions(stmt, tbls, SQL_RCACHE_MAX_TABLES);
+    if (ntbls <= 0)
+        return NULL;
+
+    rcache_init();
+    Pthread_mutex_lock(&rcache_mtx);
+    enabled = rcache_enabled(clnt->work.aFingerprint, tbls, ntbls);
+    Pthread_mutex_unlock(&rcache_mtx);
+    if (!enabled)
+        return NULL;
+
+    if ((key = rcache_key(clnt)) == NULL)
+        return NULL;
+
+    Pthread_mutex_lock(&rcache_mtx);
+    ent = hash_find_readonly(rcache_ents, &key);
+    if (ent && !rcache_same_versions(ent->tbls, ent->ntbls, tbls, ntbls)) {
+        rcache_unlink(ent);
+        ent = NULL;
+    }
+    if (ent) {
+        ent->refcnt++;
+        listc_rfl(&rcache_lru, ent);
+        listc_atl(&rcache_lru, ent);
+        gbl_sql_rcache_hits++;
+    } else {
+        gbl_sql_rcache_misses++;
+    }
+    unsigned int gen = rcache_gen;
+    Pthread_mutex_unlock(&rcache_mtx);
+
+    if (ent) {
+        free(key);
+        return ent;
+    }
+
+    struct sql_rcache_fill *fill = calloc(1, sizeof(struct sql_rcache_fill));
+    if (!fill) {
+        free(key);
+        return NULL;
+    }
+    fill->key = key;
+    memcpy(fill->tbls, tbls, sizeof(tbls));
+    fill->ntbls = ntbls;
+    fill->gen = gen;
+    *pfill = fill;
+    return NULL;
+}
+
+void sql_rcache_put(struct sql_rcache_ent *ent)
+{
+    Pthread_mutex_lock(&rcache_mtx);
+    if (--ent->refcnt == 0)
+        rcache_ent_free(ent);
+    Pthread_mutex_unlock(&rcache_mtx);
+}
+
+const void *sql_rcache_ent_data(struct sql_rcache_ent *ent, size_t *len)
+{
+    *len = ent->len;
+    return ent->buf;
+}
+
+int sql_rcache_ent_nrows(struct sql_rcache_ent *ent)
+{
+    return ent->nrows;
+}
+
+void *sql_rcache_fill_append(struct sql_rcache_fill *fill, size_t len,
+                             int row)
+{
+    size_t max = (size_t)gbl_sql_rcache_max_entry_kb * 1024;
+
+    if (fill->toobig || fill->len + len > max) {
+        fill->toobig = 1;
+        return NULL;
+    }
+    if (fill->len + len > fill->alloc) {
+        size_t alloc = fill->alloc ? fill->alloc * 2 : 4096;
+        while (alloc < fill->len + len)
+            alloc *= 2;
+        uint8_t *buf = realloc(fill->buf, alloc);
+        if (!buf) {
+            fill->toobig = 1;
+            return NULL;
+        }
+        fill->buf = buf;
+        fill->alloc = alloc;
+    }
+    void *out = fill->buf + fill->len;
+    fill->len += len;
+    if (row)
+        fill->nrows++;
+    return out;
+}
+
+void sql_rcache_fill_done(struct sql_rcache_fill *fill, sqlite3_stmt *stmt,
+                          int publish)
+{
+    struct sql_rcache_tbl tbls[SQL_RCACHE_MAX_TABLES];
+    struct sql_rcache_ent *ent = NULL, *old;
+    int64_t max = (int64_t)gbl_sql_rcache_mb * 1024 * 1024;
+
+    if (publish && !fill->toobig && fill->len <= max) {
+        memset(tbls, 0, sizeof(tbls));
+        int ntbls = sql_stmt_table_versions(stmt, tbls, SQL_RCACHE_MAX_TABLES);
+        publish = rcache_same_versions(fill->tbls, fill->ntbls, tbls, ntbls);
+    } else {
+        publish = 0;
+    }
+    if (publish)
+        ent = calloc(1, sizeof(struct sql_rcache_ent));
+    if (!ent) {
+        free(fill->key);
+        free(fill->buf);
+        free(fill);
+        return;
+    }
+
+    ent->key = fill->key;
+    memcpy(ent->tbls, fill->tbls, sizeof(fill->tbls));
+    ent->ntbls = fill->ntbls;
+    ent->buf = fill->buf;
+    ent->len = fill->len;
+    ent->nrows = fill->nrows;
+    ent->refcnt = 1;
+
+    Pthread_mutex_lock(&rcache_mtx);
+    if (fill->gen != rcache_gen) {
+        /* flushed while the query ran */
+        Pthread_mutex_unlock(&rcache_mtx);
+        rcache_ent_free(ent);
+        free(fill);
+        return;
+    }
+    if ((old = hash_find_readonly(rcache_ents, &ent->key)) != NULL)
+        rcache_unlink(old);
+    while (rcache_bytes + (int64_t)ent->len > max &&
+           (old = LISTC_BOT(&rcache_lru)) != NULL)
+        rcache_unlink(old);
+    hash_add(rcache_ents, ent);
+    listc_atl(&rcache_lru, ent);
+    rcache_bytes += ent->len;
+    gbl_sql_rcache_stores++;
+    Pthread_mutex_unlock(&rcache_mtx);
+
+    free(fill);
+}
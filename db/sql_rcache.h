@@ -0,0 +1,91 @@
+/*
+   Copyright 2026 Bloomberg Finance L.P.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+ */
+
+#ifndef INCLUDED_SQL_RCACHE_H
+#define INCLUDED_SQL_RCACHE_H
+
+/*
+  Result cache for read-only queries
+*/
+
+#include <stddef.h>
+#include <stdint.h>
+#include "cdb2_constants.h"
+
+struct sqlclntstate;
+struct sqlite3_stmt;
+
+/* A table read by a query, and its version when it was read */
+struct sql_rcache_tbl {
+    char tablename[MAXTABLELEN];
+    unsigned long long version; /* schema version */
+    uint64_t chg_gen;           /* see bdb_table_chg_gen() */
+};
+
+/* Most tables a cached query may read */
+#define SQL_RCACHE_MAX_TABLES 16
+
+struct sql_rcache_ent;
+struct sql_rcache_fill;
+
+extern int gbl_sql_rcache_mb;
+extern int gbl_sql_rcache_max_entry_kb;
+extern char *gbl_sql_rcache_tables;
+extern char *gbl_sql_rcache_fingerprints;
+
+extern int64_t gbl_sql_rcache_hits;
+extern int64_t gbl_sql_rcache_misses;
+extern int64_t gbl_sql_rcache_stores;
+
+/* Look up the result of the query clnt is about to run.  A found entry is
+ * pinned until sql_rcache_put().  If there is none and the query may be
+ * cached, *pfill is set to record its result. */
+struct sql_rcache_ent *sql_rcache_get(struct sqlclntstate *clnt,
+                                      struct sqlite3_stmt *stmt,
+                                      struct sql_rcache_fill **pfill);
+void sql_rcache_put(struct sql_rcache_ent *ent);
+
+/* The responses of a cached result, as they were written to the client */
+const void *sql_rcache_ent_data(struct sql_rcache_ent *ent, size_t *len);
+int sql_rcache_ent_nrows(struct sql_rcache_ent *ent);
+
+/* Return room for the next len bytes of the result, or NULL if the result
+ * got too large to be cached */
+void *sql_rcache_fill_append(struct sql_rcache_fill *fill, size_t len,
+                             int row);
+
+/* The query is done.  Its result is cached if `publish' is set and nothing
+ * it read changed while it ran. */
+void sql_rcache_fill_done(struct sql_rcache_fill *fill,
+                          struct sqlite3_stmt *stmt, int publish);
+
+/* Remove all cached results */
+void sql_rcache_flush(void);
+
+/* Set the tables and fingerprints whose queries are cached, from comma
+ * separated lists.  "*" caches the queries on all tables. */
+int sql_rcache_set_tables(const char *list);
+int sql_rcache_set_fingerprints(const char *list);
+
+int64_t sql_rcache_bytes(void);
+
+/* Fill tbls with the local tables stmt reads and their current versions.
+ * Returns how many, or -1 if stmt reads a table whose changes are not
+ * tracked. */
+int sql_stmt_table_versions(struct sqlite3_stmt *stmt,
+                            struct sql_rcache_tbl *tbls, int max);
+
+#endif /* INCLUDED_SQL_RCACHE_H */
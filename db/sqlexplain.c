@@ -880,6 +880,9 @@ void get_one_explain_line(struct sqlclntstate *clnt, sqlite3 *hndl, strbuf *out,
         if (op->p5 == BTREE_UNORDERED) {
             strbuf_append(out, " [Hash table]");
         }
+        if (op->opcode == OP_OpenAutoindex && op->p3 > 0) {
+            strbuf_appendf(out, " [Hash join on %d columns]", op->p3);
+        }
         break;
     }
     case OP_OpenPseudo:
@@ -109,6 +109,8 @@
 #include <sqlwriter.h>
 
 #include "views.h"
+#include "zonemap.h"
+#include "sql_rcache.h"
 
 int gbl_delay_sql_lock_release_sec = 5;
 
@@ -171,7 +173,7 @@ static int ddguard_bdb_cursor_find(struct sql_thread *thd, BtCursor *pCur,
 static int ddguard_bdb_cursor_find_last_dup(BtCursor *, bdb_cursor_ifn_t *, void *key,
                                             int keylen, int keymax, bias_info *, int *bdberr);
 static int ddguard_bdb_cursor_move(BtCursor *pCur, int flags, int *bdberr, int how,
-                                   struct ireq *iq_do_prefault, int freshcursor);
+                                   int freshcursor);
 static int is_sql_update_mode(int mode);
 static int queryOverlapsCursors(struct sqlclntstate *clnt, BtCursor *pCur);
 
@@ -2673,6 +2675,91 @@ static int get_matching_genid(BtCursor *cur, int rrn, unsigned long long *genid)
     return 0;
 }
 
+/*
+ * Sequential scan detection: once a cursor moved gbl_sqlreadaheadthresh
+ * times in the same direction, ask a prefault helper to fault in the
+ * entries ahead of it.  The window starts small and doubles up to
+ * gbl_sqlreadahead; the next readahead is issued when half the window
+ * was consumed, so the helper stays ahead of the cursor.
+ */
+static void cursor_readahead(BtCursor *pCur, int how)
+{
+    struct ireq iq = {0};
+    int prev;
+
+    if (!gbl_prefaulthelper_sqlreadahead || gbl_sqlreadahead <= 0 ||
+        !prefault_check_enabled())
+        return;
+
+    if (how != CNEXT && how != CPREV) {
+        pCur->num_nexts = 0;
+        pCur->ra_dir = how;
+        pCur->ra_left = 0;
+        pCur->ra_window = 0;
+        return;
+    }
+
+    if (how != pCur->ra_dir) {
+        pCur->num_nexts = 0;
+        pCur->ra_dir = how;
+        pCur->ra_left = 0;
+        pCur->ra_window = 0;
+    }
+
+    if (++pCur->num_nexts < gbl_sqlreadaheadthresh)
+        return;
+
+    if (--pCur->ra_left > 0)
+        return;
+
+    if (pCur->ra_window == 0)
+        pCur->ra_window = 16;
+    else
+        pCur->ra_window *= 2;
+    if (pCur->ra_window > gbl_sqlreadahead)
+        pCur->ra_window = gbl_sqlreadahead;
+    pCur->ra_left = (pCur->ra_window + 1) / 2;
+
+    iq.dbenv = thedb;
+    iq.usedb = pCur->db;
+    prev = (how == CPREV);
+    gbl_sql_readaheads++;
+
+    if (pCur->ixnum >= 0)
+        readaheadpf(&iq, pCur->db, pCur->ixnum, pCur->lastkey,
+                    getkeysize(pCur->db, pCur->ixnum), pCur->genid,
+                    pCur->ra_window, prev);
+    else
+        readaheadpf(&iq, pCur->db, -1, NULL, 0, pCur->genid, pCur->ra_window,
+                    prev);
+}
+
+/* Moves a forward table scan past the zones which cannot hold a record
+ * matching the hinted WHERE terms. */
+static int cursor_move_table_zonemap(BtCursor *pCur, int rc, int *bdberr)
+{
+    unsigned long long genid, next;
+    int stripe;
+
+    while (rc == IX_FND || rc == IX_NOTFND) {
+        genid = pCur->bdbcur->genid(pCur->bdbcur);
+        if (!zonemap_scan_skip(pCur->db, pCur->zonemap, genid, &next))
+            break;
+        stripe = get_dtafile_from_genid(genid);
+        rc = ddguard_bdb_cursor_find(pCur->thd, pCur, pCur->bdbcur, &next,
+                                     sizeof(next), 0, OP_SeekGE, bdberr);
+        while (rc == IX_PASTEOF && *bdberr == 0 &&
+               ++stripe < pCur->db->dtastripe) {
+            next = bdb_seq_to_genid(0, stripe);
+            rc = ddguard_bdb_cursor_find(pCur->thd, pCur, pCur->bdbcur, &next,
+                                         sizeof(next), 0, OP_SeekGE, bdberr);
+        }
+        if (*bdberr)
+            break;
+    }
+    return rc;
+}
+
 static int cursor_move_table(BtCursor *pCur, int *pRes, int how)
 {
     struct sql_thread *thd = pCur->thd;
@@ -2708,7 +2795,10 @@ static int cursor_move_table(BtCursor *pCur, int *pRes, int how)
         thd->nmove++;
 
     bdberr = 0;
-    rc = ddguard_bdb_cursor_move(pCur, 0, &bdberr, how, NULL, 0);
+    rc = ddguard_bdb_cursor_move(pCur, 0, &bdberr, how, 0);
+    if (pCur->zonemap && bdberr == 0 && (how == CFIRST || how == CNEXT) &&
+        !pCur->is_btree_count && !pCur->is_recording && pCur->range == NULL)
+        rc = cursor_move_table_zonemap(pCur, rc, &bdberr);
     switch(bdberr) {
     case BDBERR_NOT_DURABLE: return SQLITE_CLIENT_CHANGENODE;
     case BDBERR_TRANTOOCOMPLEX: return SQLITE_TRANTOOCOMPLEX;
@@ -2750,6 +2840,7 @@ static int cursor_move_table(BtCursor *pCur, int *pRes, int how)
             } else {
                 pCur->dtabuf = buf;
             }
+            cursor_readahead(pCur, how);
         }
     }
 
@@ -2805,7 +2896,6 @@ static int cursor_move_table(BtCursor *pCur, int *pRes, int how)
 static int cursor_move_index(BtCursor *pCur, int *pRes, int how)
 {
     struct sql_thread *thd = pCur->thd;
-    struct ireq iq = {0};
     int bdberr = 0;
     int done = 0;
     int rc = SQLITE_OK;
@@ -2821,28 +2911,13 @@ static int cursor_move_index(BtCursor *pCur, int *pRes, int how)
         return rc;
     }
 
-    iq.dbenv = thedb;
-    iq.is_fake = 1;
-    iq.usedb = pCur->db;
-    iq.opcode = OP_FIND;
-
     outrc = SQLITE_OK;
     *pRes = 0;
     if (thd)
         thd->nmove++;
 
-    if (how == CNEXT) {
-        pCur->num_nexts++;
-
-        if (gbl_prefaulthelper_sqlreadahead && pCur->num_nexts == gbl_sqlreadaheadthresh) {
-            pCur->num_nexts = 0;
-            readaheadpf(&iq, pCur->db, pCur->ixnum, pCur->fndkey,
-                        getkeysize(pCur->db, pCur->ixnum), gbl_sqlreadahead);
-        }
-    }
-
     bdberr = 0;
-    rc = ddguard_bdb_cursor_move(pCur, 0, &bdberr, how, &iq, 0);
+    rc = ddguard_bdb_cursor_move(pCur, 0, &bdberr, how, 0);
     switch(bdberr) {
     case BDBERR_NOT_DURABLE: return SQLITE_CLIENT_CHANGENODE;
     case BDBERR_TRANTOOCOMPLEX: return SQLITE_TRANTOOCOMPLEX;
@@ -2893,6 +2968,7 @@ static int cursor_move_index(BtCursor *pCur, int *pRes, int how)
                  */
                 pCur->lastkey = buf;
             }
+            cursor_readahead(pCur, how);
         }
     }
 
@@ -2947,6 +3023,133 @@ static int cursor_move_index(BtCursor *pCur, int *pRes, int how)
     return outrc;
 }
 
+/* Integers up to this magnitude convert to doubles and back exactly */
+#define HASHJOIN_EXACT (((i64)1) << 53)
+
+/*
+** Hashes the first nField values of a row or a search key of a temp hash join
+** table.  Values sqlite compares equal must hash the same: an integer and a
+** real of the same value hash alike, and strings and blobs hash their bytes.
+** Returns -1 for values with no such hash: those under a collation other than
+** BINARY, and datetimes and intervals, which compare equal to strings.
+*/
+static int hashjoin_hash(KeyInfo *pKeyInfo, Mem *aMem, int nField,
+                         unsigned int *hash)
+{
+    unsigned int h = 0;
+
+    for (int i = 0; i < nField; ++i) {
+        Mem *m = &aMem[i];
+        CollSeq *coll = pKeyInfo->aColl[i];
+        unsigned int vh;
+        double r;
+        i64 n;
+
+        if (coll && sqlite3StrICmp(coll->zName, sqlite3StrBINARY) != 0)
+            return -1;
+        if (m->flags & MEM_Null) {
+            vh = 1;
+        } else if (m->flags & (MEM_Datetime | MEM_Interval | MEM_Small |
+                               MEM_Zero | MEM_Xor)) {
+            return -1;
+        } else if (m->flags & (MEM_Int | MEM_Real)) {
+            if (m->flags & MEM_Int) {
+                n = m->u.i;
+                r = (double)n;
+            } else {
+                r = m->u.r;
+                n = (r >= -HASHJOIN_EXACT && r <= HASHJOIN_EXACT) ? (i64)r : 0;
+            }
+            if (n >= -HASHJOIN_EXACT && n <= HASHJOIN_EXACT && (double)n == r)
+                vh = crc32c((uint8_t *)&n, sizeof(n));
+            else
+                vh = crc32c((uint8_t *)&r, sizeof(r));
+        } else if (m->flags & (MEM_Str | MEM_Blob)) {
+            vh = crc32c((uint8_t *)m->z, m->n);
+        } else {
+            return -1;
+        }
+        h = h * 0x9e3779b1 + vh;
+    }
+    *hash = h;
+    return 0;
+}
+
+static int hashjoin_put(BtCursor *pCur, UnpackedRecord *rec, void *key,
+                        int keylen, void *data, int dtalen, int *bdberr)
+{
+    struct temp_table *tbl = pCur->tmptable->tbl;
+    int nField = pCur->bt->hashjoin_nkey;
+    unsigned int hash;
+
+    if (rec->nField < nField ||
+        hashjoin_hash(pCur->pKeyInfo, rec->aMem, nField, &hash) != 0) {
+        if (bdb_temp_table_spill(thedb->bdb_env, tbl, bdberr))
+            return -1;
+        return pCur->cursor_put(thedb->bdb_env, tbl, key, keylen, data, dtalen,
+                                rec, bdberr, pCur);
+    }
+    return bdb_temp_table_put_hashed(thedb->bdb_env, tbl, hash, key, keylen,
+                                     data, dtalen, rec, bdberr);
+}
+
+static int hashjoin_match(BtCursor *pCur)
+{
+    return sqlite3VdbeRecordCompare(
+               bdb_temp_table_keysize(pCur->tmptable->cursor),
+               bdb_temp_table_key(pCur->tmptable->cursor), pCur->hj_probe) == 0;
+}
+
+/* Moves to the first row matching the first hashjoin_nkey values of pIdxKey,
+   which next then keeps matching.  Searches the table like any other once
+   it has been spilled, or if the key can't be hashed. */
+static int hashjoin_find(BtCursor *pCur, UnpackedRecord *pIdxKey, int *bdberr)
+{
+    struct temp_cursor *cur = pCur->tmptable->cursor;
+    int nField = pCur->bt->hashjoin_nkey;
+    unsigned int hash;
+    Mem mem = {{0}};
+    int rc;
+
+    pCur->hj_probing = 0;
+    if (pIdxKey->nField < nField ||
+        hashjoin_hash(pCur->pKeyInfo, pIdxKey->aMem, nField, &hash) != 0) {
+        if (bdb_temp_table_spill(thedb->bdb_env, pCur->tmptable->tbl, bdberr))
+            return -1;
+        return pCur->cursor_find(thedb->bdb_env, cur, NULL, 0, pIdxKey, bdberr,
+                                 pCur);
+    }
+
+    /* keep the key: it lives in vdbe registers */
+    if (pCur->hj_probe == NULL) {
+        pCur->hj_probe = calloc(1, ROUND8(sizeof(UnpackedRecord)) +
+                                       nField * sizeof(Mem));
+        if (pCur->hj_probe == NULL)
+            return -1;
+        pCur->hj_probe->aMem =
+            (Mem *)((char *)pCur->hj_probe + ROUND8(sizeof(UnpackedRecord)));
+        pCur->hj_probe->pKeyInfo = pCur->pKeyInfo;
+    }
+    sqlite3VdbeRecordPack(pIdxKey, &mem);
+    free(pCur->hj_probe_buf);
+    pCur->hj_probe_buf = malloc(mem.n);
+    if (pCur->hj_probe_buf == NULL) {
+        sqlite3VdbeMemRelease(&mem);
+        return -1;
+    }
+    memcpy(pCur->hj_probe_buf, mem.z, mem.n);
+    pCur->hj_probe->nField = nField;
+    sqlite3VdbeRecordUnpack(pCur->pKeyInfo, mem.n, pCur->hj_probe_buf,
+                            pCur->hj_probe);
+    sqlite3VdbeMemRelease(&mem);
+    pCur->hj_probing = 1;
+
+    rc = bdb_temp_table_find_hashed(thedb->bdb_env, cur, hash, bdberr);
+    while (rc == IX_FND && !hashjoin_match(pCur))
+        rc = bdb_temp_table_next_norewind(thedb->bdb_env, cur, bdberr);
+    return rc == IX_NOTFND ? IX_PASTEOF : rc;
+}
+
 static int tmptbl_cursor_move(BtCursor *pCur, int *pRes, int how)
 {
     int bdberr = 0;
@@ -2976,8 +3179,15 @@ static int tmptbl_cursor_move(BtCursor *pCur, int *pRes, int how)
     case CNEXT:
         rc = bdb_temp_table_next_norewind(thedb->bdb_env,
                                           pCur->tmptable->cursor, &bdberr);
+        /* only rows matching the last search of a temp hash join table */
+        while (rc == IX_FND && pCur->hj_probing &&
+               bdb_is_hashjoin(pCur->tmptable->tbl) && !hashjoin_match(pCur))
+            rc = bdb_temp_table_next_norewind(thedb->bdb_env,
+                                              pCur->tmptable->cursor, &bdberr);
         break;
     }
+    if (how != CNEXT)
+        pCur->hj_probing = 0;
 
     if (rc == IX_PASTEOF || rc == IX_EMPTY) {
         rc = SQLITE_OK;
@@ -3922,6 +4132,16 @@ static int check_readonly(BtCursor *pCur)
     return SQLITE_READONLY;
 }
 
+/* shards frozen by timepart_freeze_shards no longer take sql writes */
+static int check_frozen_shard(BtCursor *pCur)
+{
+    struct sqlclntstate *clnt = pCur->clnt;
+    if (!pCur->db || !pCur->db->timepartition_frozen) return 0;
+    errstat_set_strf(&clnt->osql.xerr, "shard %s of partition %s is frozen", pCur->db->tablename,
+                     pCur->db->timepartition_name);
+    return SQLITE_READONLY;
+}
+
 /*
  ** Delete the entry that the cursor is pointing to.  The cursor
  ** is left pointing at a random location.
@@ -3942,6 +4162,7 @@ int sqlite3BtreeDelete(BtCursor *pCur, int usage)
     }
 
     if ((rc = check_readonly(pCur)) != 0) goto done;
+    if ((rc = check_frozen_shard(pCur)) != 0) goto done;
 
     /* if this is part of an analyze skip the delete - we'll do
      * the entire update part in one shot later when the analyze is done */
@@ -5477,6 +5698,9 @@ int sqlite3BtreeCreateTable(Btree *pBt, int *piTable, int flags)
     if (pBt->is_hashtable) {
         pNewTbl->tbl = bdb_temp_hashtable_create(thedb->bdb_env, &bdberr);
         if (pNewTbl->tbl != NULL) ATOMIC_ADD32(gbl_sql_temptable_count, 1);
+    } else if (pBt->hashjoin_nkey && (flags & BTREE_BLOBKEY)) {
+        pNewTbl->tbl = bdb_temp_hashjoin_create(thedb->bdb_env, &bdberr);
+        if (pNewTbl->tbl != NULL) ATOMIC_ADD32(gbl_sql_temptable_count, 1);
     } else if (tmptbl_clone) {
         pNewTbl->sp_tmptbl = tmptbl_clone->sp_tmptbl;
         pNewTbl->tbl = tmptbl_clone->tbl;
@@ -5836,17 +6060,21 @@ int sqlite3BtreeMovetoUnpacked(BtCursor *pCur, /* The cursor to be moved */
 
     if (pCur->bt->is_temporary) {
         if (pIdxKey) {
+            pCur->hj_probing = 0;
             if (bdb_is_hashtable(pCur->tmptable->tbl)) {
                 Mem mem = {{0}};
                 sqlite3VdbeRecordPack(pIdxKey, &mem);
                 rc = bdb_temp_table_find(thedb->bdb_env, pCur->tmptable->cursor,
                                          mem.z, mem.n, NULL, &bdberr);
                 sqlite3VdbeMemRelease(&mem);
+            } else if (bdb_is_hashjoin(pCur->tmptable->tbl)) {
+                rc = hashjoin_find(pCur, pIdxKey, &bdberr);
             } else {
                 rc = pCur->cursor_find(thedb->bdb_env, pCur->tmptable->cursor,
                                        NULL, 0, pIdxKey, &bdberr, pCur);
             }
         } else {
+            pCur->hj_probing = 0;
             rc =
                 pCur->cursor_find(thedb->bdb_env, pCur->tmptable->cursor,
                                   &intKey, sizeof(intKey), NULL, &bdberr, pCur);
@@ -6496,6 +6724,9 @@ void addVdbeToThdCost(int type, int *data)
       case VDBESORTER_MOVE:
         thd->cost += CDB2_TEMP_MOVE_COST;
         break;
+      case VDBESORTER_TASK:
+        thd->cost += CDB2_TEMP_SORT_TASK_COST;
+        break;
     }
 
     ++(*data);
@@ -6567,11 +6798,20 @@ int sqlite3BtreeCloseCursor(BtCursor *pCur)
     if (pCur->blobs.numcblobs > 0)
         free_blob_status_data(&pCur->blobs);
 
+    free(pCur->hj_probe);
+    free(pCur->hj_probe_buf);
+    pCur->hj_probe = NULL;
+    pCur->hj_probe_buf = NULL;
+
+    zonemap_scan_free(pCur->zonemap);
+    pCur->zonemap = NULL;
+
     /* update cursor use counts.  don't lock for now.
      * analyze shouldnt' affect cursor stats */
     if (pCur->db && !clnt->is_analyze) {
         if (pCur->ixnum != -1) {
             pCur->db->sqlixuse[pCur->ixnum] += (pCur->nfind + pCur->nmove);
+            pCur->db->sqlixlookups[pCur->ixnum] += pCur->nlookups;
             pCur->db->index_used_count++;
         } else {
             pCur->db->read_count += (pCur->nfind + pCur->nmove);
@@ -8028,6 +8268,52 @@ int sqlite3LockStmtTablesRecover(sqlite3_stmt *pStmt)
     return sqlite3LockStmtTables_int(pStmt, 1);
 }
 
+static int rcache_tbl_cmp(const void *a, const void *b)
+{
+    return strcmp(((const struct sql_rcache_tbl *)a)->tablename,
+                  ((const struct sql_rcache_tbl *)b)->tablename);
+}
+
+int sql_stmt_table_versions(sqlite3_stmt *pStmt, struct sql_rcache_tbl *tbls,
+                            int max)
+{
+    Vdbe *p = (Vdbe *)pStmt;
+    struct sql_thread *thd = pthread_getspecific(query_info_key);
+    int n = 0;
+
+    if (thd == NULL)
+        return -1;
+
+    for (int i = 0; i < p->numTables; i++) {
+        Table *tab = p->tbls[i];
+        struct dbtable *db;
+        int j;
+
+        if (tab->tnum < RTPAGE_START)
+            return -1;
+        if ((db = get_sqlite_db(thd, tab->tnum, NULL)) == NULL)
+            return -1; /* remote */
+        if (db->dbtype != DBTYPE_TAGGED_TABLE || db->handle == NULL)
+            return -1;
+
+        for (j = 0; j < n; j++) {
+            if (strcmp(tbls[j].tablename, db->tablename) == 0)
+                break;
+        }
+        if (j < n)
+            continue;
+        if (n == max)
+            return -1;
+        strncpy0(tbls[n].tablename, db->tablename, sizeof(tbls[n].tablename));
+        tbls[n].version = db->tableversion;
+        tbls[n].chg_gen = bdb_table_chg_gen(db->handle);
+        n++;
+    }
+    /* the same query may see its tables in another order on another thread */
+    qsort(tbls, n, sizeof(*tbls), rcache_tbl_cmp);
+    return n;
+}
+
 void sql_remote_schema_changed(struct sqlclntstate *clnt, sqlite3_stmt *pStmt)
 {
     Vdbe *p = (Vdbe *)pStmt;
@@ -8476,6 +8762,15 @@ BtCursor *sqlite3BtreeFakeValidCursor(void){
   return 0;
 }
 
+/*
+** Index temp tables of pBt are hash join tables keyed on their first
+** nKeyField columns.
+*/
+void sqlite3BtreeSetHashJoin(Btree *pBt, int nKeyField)
+{
+    pBt->hashjoin_nkey = nKeyField;
+}
+
 int sqlite3BtreeCursor(
     Vdbe *vdbe,               /* Vdbe running the show */
     Btree *pBt,               /* BTree containing table to open */
@@ -8904,6 +9199,7 @@ int sqlite3BtreeInsert(
     assert(0 == pCur->is_sampled_idx);
 
     if ((rc = check_readonly(pCur)) != 0) goto done;
+    if ((rc = check_frozen_shard(pCur)) != 0) goto done;
 
     if (unlikely(pCur->cursor_class == CURSORCLASS_STAT24)) {
         rc = make_stat_record(thd, pCur, pData, nData, pblobs);
@@ -8941,6 +9237,9 @@ int sqlite3BtreeInsert(
             rc = pCur->cursor_put(thedb->bdb_env, pCur->tmptable->tbl,
                                   (void *)&nKey, sizeof(unsigned long long),
                                   (void *)pData, nData, rec, &bdberr, pCur);
+        } else if (rec && bdb_is_hashjoin(pCur->tmptable->tbl)) {
+            rc = hashjoin_put(pCur, rec, (void *)pKey, nKey, (void *)pData,
+                              nData, &bdberr);
         } else {
             /* key */
             rc = pCur->cursor_put(thedb->bdb_env, pCur->tmptable->tbl,
@@ -9448,6 +9747,12 @@ char *sqlite3BtreeGetTblName(BtCursor *pCur)
     return pCur->db->tablename;
 }
 
+/* The table row the index cursor points to had to be read. */
+void sqlite3BtreeCursorDataLookup(BtCursor *pCur)
+{
+    pCur->nlookups++;
+}
+
 int sqlite3MakeRecordForComdb2(BtCursor *pCur, Mem *head, int nf, int *optimized)
 {
     struct sql_thread *thd = pCur->thd;
@@ -10669,7 +10974,7 @@ static int ddguard_bdb_cursor_find_last_dup(BtCursor *pCur,
 }
 
 static int ddguard_bdb_cursor_move(BtCursor *pCur, int flags, int *bdberr, int how,
-                                   struct ireq *iq_do_prefault, int freshcursor)
+                                   int freshcursor)
 {
     bdb_cursor_ifn_t *cur = pCur->bdbcur;
     int nretries = 0;
@@ -10696,18 +11001,6 @@ static int ddguard_bdb_cursor_move(BtCursor *pCur, int flags, int *bdberr, int h
                 *bdberr = BDBERR_DEADLOCK;
             break;
         case CNEXT:
-            if (iq_do_prefault) {
-                pCur->num_nexts++;
-
-                if (gbl_prefaulthelper_sqlreadahead)
-                    if (pCur->num_nexts == gbl_sqlreadaheadthresh) {
-                        pCur->num_nexts = 0;
-                        readaheadpf(iq_do_prefault, pCur->db, pCur->ixnum,
-                                    pCur->ondisk_key,
-                                    getkeysize(pCur->db, pCur->ixnum),
-                                    gbl_sqlreadahead);
-                    }
-            }
             rc = cur->next(cur, bdberr);
             if (*bdberr == BDBERR_DEADLOCK_ON_LAST) {
                 *bdberr = BDBERR_DEADLOCK;
@@ -10937,6 +11230,9 @@ int sqlite3BtreeCursorRestore(BtCursor *pCur, int *pDifferentRow)
 }
 
 int gbl_direct_count = 1;
+int gbl_sql_vectorized_agg = 0;
+int gbl_sql_vectorized_agg_batch = 4096;
+int64_t gbl_sql_vectorized_agg_rows;
 
 /*
  ** The first argument, pCur, is a cursor opened on some b-tree. Count the
@@ -11269,6 +11565,16 @@ int is_comdb2_index_disableskipscan(const char *name)
     return 0;
 }
 
+int is_comdb2_table_zonemap(const char *name)
+{
+    struct dbtable *db;
+
+    if (!gbl_zonemap_scan)
+        return 0;
+    db = get_dbtable_by_name(name);
+    return db ? db->zonemap : 0;
+}
+
 int has_comdb2_index_for_sqlite(
   Table *pTab
 ){
@@ -11611,11 +11917,154 @@ const char *comdb2_get_sql(void)
     return NULL;
 }
 
+/* Returns the value of the hinted expression `pExpr' if it is known when the
+ * scan starts; *ppTmp is set if the caller has to free it. */
+static Mem *zonemap_hint_value(BtCursor *pCur, const Expr *pExpr, Mem *aMem,
+                               sqlite3_value **ppTmp)
+{
+    switch (pExpr->op) {
+    case TK_REGISTER:
+        return aMem ? &aMem[pExpr->iTable] : NULL;
+    case TK_VARIABLE:
+        if (pExpr->iColumn < 1 || pExpr->iColumn > pCur->vdbe->nVar)
+            return NULL;
+        return &pCur->vdbe->aVar[pExpr->iColumn - 1];
+    case TK_INTEGER:
+    case TK_FLOAT:
+    case TK_STRING:
+    case TK_UMINUS:
+        if (sqlite3ValueFromExpr(pCur->sqlite, (Expr *)pExpr, SQLITE_UTF8,
+                                 SQLITE_AFF_BLOB, ppTmp) != SQLITE_OK)
+            return NULL;
+        return *ppTmp;
+    }
+    return NULL;
+}
+
+/* Adds "pCol op pVal" to the zone map predicates of the cursor if the value
+ * converts exactly to the ondisk format of the column. */
+static void zonemap_hint_term(BtCursor *pCur, const Expr *pCol,
+                              enum zonemap_op op, const Expr *pVal, Mem *aMem)
+{
+    struct schema *sc = pCur->db->schema;
+    struct field *f;
+    sqlite3_value *tmp = NULL;
+    struct field_conv_opts_tz convopts = {.flags = 0};
+    struct convert_failure fail_reason;
+    struct mem_info info = {0};
+    Mem back = {{0}};
+    uint8_t *rec = NULL;
+    int nblobs = 0;
+    Mem *m;
+
+    if (pCol->op != TK_COLUMN || pCol->iColumn < 0 ||
+        pCol->iColumn >= sc->nmembers)
+        return;
+    f = &sc->member[pCol->iColumn];
+    if (!zonemap_column_eligible(f->type, f->len))
+        return;
+
+    m = zonemap_hint_value(pCur, pVal, aMem, &tmp);
+    if (m == NULL ||
+        !(m->flags & (MEM_Int | MEM_Real | MEM_Str | MEM_Blob | MEM_Datetime)))
+        goto done;
+    if ((rec = calloc(1, f->offset + f->len)) == NULL)
+        goto done;
+
+    info.s = sc;
+    info.m = m;
+    info.nblobs = &nblobs;
+    info.convopts = &convopts;
+    info.tzname = pCur->clnt->tzname;
+    info.fail_reason = &fail_reason;
+    info.fldidx = -1;
+    if (mem_to_ondisk(rec, f, &info, NULL))
+        goto done;
+
+    /* a rounded value cannot bound the column */
+    if (get_data(pCur, sc, rec, pCol->iColumn, &back, 0, pCur->clnt->tzname) ||
+        sqlite3MemCompare(m, &back, NULL) != 0)
+        goto done;
+
+    zonemap_scan_add_pred(pCur->zonemap, pCol->iColumn, op, rec + f->offset,
+                          f->len);
+done:
+    free(rec);
+    if (tmp)
+        sqlite3ValueFree(tmp);
+}
+
+static void zonemap_hint(BtCursor *pCur, const Expr *pExpr, Mem *aMem)
+{
+    static const enum zonemap_op flip[] = {
+        [ZONEMAP_EQ] = ZONEMAP_EQ, [ZONEMAP_LT] = ZONEMAP_GT,
+        [ZONEMAP_LE] = ZONEMAP_GE, [ZONEMAP_GT] = ZONEMAP_LT,
+        [ZONEMAP_GE] = ZONEMAP_LE,
+    };
+    enum zonemap_op op;
+
+    switch (pExpr->op) {
+    case TK_AND:
+        zonemap_hint(pCur, pExpr->pLeft, aMem);
+        zonemap_hint(pCur, pExpr->pRight, aMem);
+        return;
+    case TK_BETWEEN:
+        if (!ExprHasProperty(pExpr, EP_xIsSelect) && pExpr->x.pList &&
+            pExpr->x.pList->nExpr == 2) {
+            zonemap_hint_term(pCur, pExpr->pLeft, ZONEMAP_GE,
+                              pExpr->x.pList->a[0].pExpr, aMem);
+            zonemap_hint_term(pCur, pExpr->pLeft, ZONEMAP_LE,
+                              pExpr->x.pList->a[1].pExpr, aMem);
+        }
+        return;
+    case TK_EQ: op = ZONEMAP_EQ; break;
+    case TK_LT: op = ZONEMAP_LT; break;
+    case TK_LE: op = ZONEMAP_LE; break;
+    case TK_GT: op = ZONEMAP_GT; break;
+    case TK_GE: op = ZONEMAP_GE; break;
+    default:
+        return;
+    }
+    if (pExpr->pLeft->op == TK_COLUMN)
+        zonemap_hint_term(pCur, pExpr->pLeft, op, pExpr->pRight, aMem);
+    else if (pExpr->pRight->op == TK_COLUMN)
+        zonemap_hint_term(pCur, pExpr->pRight, flip[op], pExpr->pLeft, aMem);
+}
+
+/* Zone maps are only checked by plain read committed table scans; the scans
+ * of transactions and of statements which write see records which are not
+ * summarized yet. */
+static int zonemap_hint_ok(BtCursor *pCur)
+{
+    struct sqlclntstate *clnt = pCur->clnt;
+
+    return gbl_zonemap_scan && !gbl_rowlocks && pCur->db &&
+           pCur->db->zonemap && pCur->ixnum == -1 &&
+           pCur->rootpage >= RTPAGE_START && pCur->bdbcur &&
+           !(pCur->bt && (pCur->bt->is_remote || pCur->bt->is_temporary)) &&
+           (clnt->dbtran.mode == TRANLEVEL_SOSQL ||
+            clnt->dbtran.mode == TRANLEVEL_RECOM) &&
+           clnt->ctrl_sqlengine != SQLENG_INTRANS_STATE &&
+           !clnt->pageordertablescan && pCur->vdbe &&
+           sqlite3_stmt_readonly((sqlite3_stmt *)pCur->vdbe);
+}
+
 int gbl_fdb_track_hints = 0;
-static void sqlite3BtreeCursorHint_Range(BtCursor *pCur, const Expr *pExpr)
+static void sqlite3BtreeCursorHint_Range(BtCursor *pCur, const Expr *pExpr,
+                                         Mem *aMem)
 {
     char *expr = "?no vdbe engine?";
 
+    if (pCur && pCur->zonemap)
+        zonemap_scan_reset(pCur->zonemap);
+    if (pCur && pExpr && zonemap_hint_ok(pCur)) {
+        if (pCur->zonemap == NULL)
+            pCur->zonemap = calloc(1, sizeof(struct zonemap_scan));
+        if (pCur->zonemap)
+            zonemap_hint(pCur, pExpr, aMem);
+        return;
+    }
+
     if (pCur && pCur->bt && pCur->bt->is_remote) {
         expr = sqlite3ExprDescribeAtRuntime(pCur->vdbe, pExpr);
         if (!expr) /* failed hinting, calling sqlite engine will catch it */
@@ -11662,8 +12111,9 @@ void sqlite3BtreeCursorHint(BtCursor *pCur, int eHintType, ...)
 
     case BTREE_HINT_RANGE: {
         Expr *expr = va_arg(ap, Expr *);
+        Mem *aMem = va_arg(ap, Mem *);
 
-        sqlite3BtreeCursorHint_Range(pCur, expr);
+        sqlite3BtreeCursorHint_Range(pCur, expr, aMem);
 
         break;
     }
@@ -3975,6 +3975,33 @@ void _delay_sending_row(void)
     }
 }
 
+/* Write a cached result to the client, as if the query had run */
+static int run_stmt_cached(struct sqlthdstate *thd, struct sqlclntstate *clnt, struct sql_state *rec,
+                           struct sql_rcache_ent *ent, int *fast_error)
+{
+    int nrows = sql_rcache_ent_nrows(ent);
+
+    *fast_error = 1;
+    clnt->osql.sent_column_data = 1;
+    int rc = write_response(clnt, RESPONSE_CACHED_ROWS, ent, 0);
+    sql_rcache_put(ent);
+    if (rc)
+        return rc;
+
+    if (clnt->intrans == 0)
+        reset_query_effects(clnt, 0, clnt->ctrl_sqlengine == SQLENG_STRT_STATE);
+    clnt->effects.num_selected += nrows;
+    clnt->log_effects.num_selected += nrows;
+    clnt->nrows += nrows;
+    clnt->recno += nrows;
+    reqlog_set_rows(thd->logger, nrows);
+    if (clnt->rawnodestats)
+        clnt->rawnodestats->sql_rows += nrows;
+
+    post_query_get_cost(thd, clnt);
+    return post_sqlite_processing(thd, clnt, rec, 0, nrows);
+}
+
 /* The design choice here for communication is to send row data inside this
    function, and delegate the error sending to the caller (since we send
    multiple rows, but we send error only once and stop processing at that time)
@@ -3991,8 +4018,14 @@ static int run_stmt(struct sqlthdstate *thd, struct sqlclntstate *clnt,
 
     clnt->isselect = sqlite3_stmt_readonly(stmt);
     run_stmt_setup(clnt, stmt);
+
+    struct sql_rcache_ent *cached = NULL;
+    if (clnt->plugin.cache_results && clnt->plugin.cache_results(clnt) && !clnt->osql.sent_column_data &&
+        !skip_response(clnt))
+        cached = sql_rcache_get(clnt, stmt, &clnt->rcache_fill);
+
     if ((gbl_typessql || clnt->typessql) && clnt->isselect && !dohsql_is_parallel_shard() && !clnt->fdb_push &&
-        !v->hasVTables && !v->hasScalarFunc)
+        !v->hasVTables && !v->hasScalarFunc && !cached)
         typessql_initialize(clnt, stmt);
 
     /* this is a regular sql query, add it to history */
@@ -4000,6 +4033,9 @@ static int run_stmt(struct sqlthdstate *thd, struct sqlclntstate *clnt,
         logmsg(LOGMSG_ERROR,
                "Fail to add query to transaction replay session\n");
 
+    if (cached)
+        return run_stmt_cached(thd, clnt, rec, cached, fast_error);
+
     /* Get first row to figure out column structure */
     clnt->last_sent_row_sec = time(NULL);
     int steprc = next_row(clnt, stmt);
@@ -4301,6 +4337,11 @@ retry_legacy_remote:
 
         /* run the engine */
         rc = run_stmt(thd, clnt, &rec, &fast_error, &err);
+        if (clnt->rcache_fill) {
+            struct sql_rcache_fill *fill = clnt->rcache_fill;
+            clnt->rcache_fill = NULL;
+            sql_rcache_fill_done(fill, rec.stmt, rc == 0);
+        }
         if (rc) {
             int irc = errstat_get_rc(&err);
             switch(irc) {
@@ -4553,6 +4594,8 @@ void signal_clnt_as_done(struct sqlclntstate *clnt)
         Pthread_mutex_unlock(&gbl_sql_lock);
     }
 
+    sql_mem_query_done(clnt);
+
     if (clnt->done_cb) {
         clnt->done_cb(clnt); /* newsql_done_cb */
     } else {
@@ -4856,6 +4899,28 @@ static int can_execute_sql_query_now(
   return 1;
 }
 
+/* Wait until the query fits in sql_mem_budget_mb.  It is expected to use as
+ * much memory as it did the last time it ran. */
+static int sql_mem_admit_query(struct sqlclntstate *clnt)
+{
+    int wait = !(clnt->admin || clnt->is_analyze || in_client_trans(clnt) ||
+                 is_transaction_meta(clnt));
+    int64_t projected = -1;
+
+    if (gbl_sql_mem_budget_mb <= 0)
+        return 0;
+
+    if (gbl_fingerprint_queries && wait) {
+        preview_and_calc_fingerprint(clnt);
+        if (clnt->work.zOrigNormSql)
+            projected = fingerprint_mem_peak(clnt->work.aFingerprint);
+    }
+    if (projected < 0)
+        projected = (int64_t)gbl_sql_mem_default_estimate_kb * 1024;
+
+    return sql_mem_admit(clnt, projected, wait);
+}
+
 void sqlengine_work_appsock(struct sqlthdstate *thd, struct sqlclntstate *clnt)
 {
     struct sql_thread *sqlthd = thd->sqlthd;
@@ -4897,6 +4962,16 @@ void sqlengine_work_appsock(struct sqlthdstate *thd, struct sqlclntstate *clnt)
         goto done;
     }
 
+    if (sql_mem_admit_query(clnt)) {
+        send_run_error(clnt, "Rejected: not enough memory for the query", CDB2ERR_REJECTED);
+        clnt->query_rc = -1;
+        clnt->osql.timings.query_finished = osql_log_time();
+        osql_log_time_done(clnt);
+        clnt_change_state(clnt, CONNECTION_IDLE);
+        signal_clnt_as_done(clnt);
+        return;
+    }
+
     /* everything going in is cursor based */
     int rc = get_curtran(thedb->bdb_env, clnt);
     if (rc) {
@@ -4971,10 +5046,12 @@ static void sqlengine_work_appsock_pp(struct thdpool *pool, void *work,
 
     switch (op) {
     case THD_RUN:
+        sql_mem_query_start(clnt);
         if (clnt->exec_lua_thread)
             sqlengine_work_lua_thread(thddata, work);
         else
             sqlengine_work_appsock(thddata, work);
+        comdb2ma_acct_set(NULL);
         break;
     case THD_FREE:
         /* we just mark the client done here, with error */
@@ -6667,6 +6744,8 @@ static void gather_connection_int(struct connection_info *c, struct sqlclntstate
     snprintf(c->uuid, strlen(us) + 1, "%s", us);
     c->is_canceled = clnt->discard_this;
     c->pool_name = clnt->pPool ? thdpool_name(clnt->pPool) : NULL;
+    c->mem_used = ATOMIC_LOAD64(clnt->mem.acct.used);
+    c->mem_peak = ATOMIC_LOAD64(clnt->mem.acct.peak);
 }
 
 static void gather_connections_evbuffer(struct connection_info **info, int *num_connections)
@@ -6692,6 +6771,51 @@ int gather_connection_info(struct connection_info **info, int *num_connections)
     return 0;
 }
 
+/* Memory of the queries running on each sql pool, for comdb2_memstats */
+int gather_sql_mem_usages(comdb2ma_usage **pusages, int *n)
+{
+    struct sqlclntstate *clnt;
+    comdb2ma_usage *usages = NULL;
+    const char **pools = NULL;
+    int num = 0;
+
+    Pthread_mutex_lock(&lru_evbuffers_mtx);
+    TAILQ_FOREACH(clnt, &sql_evbuffers, sql_entry) {
+        if (clnt->state != CONNECTION_RUNNING && clnt->state != CONNECTION_QUEUED)
+            continue;
+        const char *pool = clnt->pPool ? thdpool_name(clnt->pPool) : "default";
+        int i;
+        for (i = 0; i < num && strcmp(pools[i], pool) != 0; ++i)
+            ;
+        if (i == num) {
+            ++num;
+            pools = realloc(pools, num * sizeof(pools[0]));
+            usages = realloc(usages, num * sizeof(usages[0]));
+            pools[i] = pool;
+            memset(&usages[i], 0, sizeof(usages[i]));
+            strncpy(usages[i].name_str, "sql_queries", sizeof(usages[i].name_str) - 1);
+            strncpy(usages[i].scope_str, pool, sizeof(usages[i].scope_str) - 1);
+        }
+        int64_t used = ATOMIC_LOAD64(clnt->mem.acct.used);
+        if (used > 0)
+            usages[i].used += used;
+        usages[i].peak += ATOMIC_LOAD64(clnt->mem.acct.peak);
+        usages[i].total += clnt->mem.reserved;
+    }
+    Pthread_mutex_unlock(&lru_evbuffers_mtx);
+
+    for (int i = 0; i < num; ++i) {
+        usages[i].name = usages[i].name_str;
+        usages[i].scope = usages[i].scope_str;
+        if (usages[i].total > usages[i].used)
+            usages[i].unused = usages[i].total - usages[i].used;
+    }
+    free(pools);
+    *pusages = usages;
+    *n = num;
+    return 0;
+}
+
 void free_connection_info(struct connection_info *info, int num_connections)
 {
     if (info == NULL) return;
@@ -0,0 +1,153 @@
+/*
+   Copyright 2026 Bloomberg Finance L.P.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+ */
+
+/*
+ * Sorter threads.
+ *
+ * sqlite is built single threaded, so its sorter never starts worker
+ * threads of its own.  Instead, a large in-memory sort is cut into runs
+ * (see vdbesort.c) which are sorted, and then merged pairwise, by the
+ * threads of this pool while the query thread works on one of them.  The
+ * tasks never allocate memory, as sqlite memory is per thread.  The pool
+ * does not queue: when it is busy, the query thread runs the task itself.
+ *
+ * Sorter threads have no sql_thread, so a comparison that needs the client
+ * timezone (datetime against a string) reads the one of the query they
+ * work for from sqlsorter_tz().
+ */
+
+#include "comdb2.h"
+#include "thdpool.h"
+#include "logmsg.h"
+
+const char *get_clnt_tz();
+
+/* Maximum number of sorter threads a single sort runs on, on top of the
+ * query thread */
+int gbl_sql_sorter_query_threads = 4;
+/* Minimum number of records given to each thread of a parallel sort */
+int gbl_sql_sorter_parallel_min_records = 65536;
+
+static struct thdpool *sorter_pool;
+
+/* timezone of the query this sorter thread is working for */
+static __thread const char *sorter_tz = NULL;
+
+struct sorter_batch {
+    pthread_mutex_t mtx;
+    pthread_cond_t cond;
+    int pending;
+};
+
+struct sorter_task {
+    struct sorter_batch *batch;
+    void (*xTask)(void *);
+    void *arg;
+    const char *tz;
+};
+
+static void sorter_work(struct thdpool *pool, void *work, void *thddata, int op)
+{
+    struct sorter_task *t = work;
+    struct sorter_batch *b = t->batch;
+
+    /* the query thread waits for every task, run it even if the pool is
+     * being stopped */
+    sorter_tz = t->tz;
+    t->xTask(t->arg);
+    sorter_tz = NULL;
+
+    Pthread_mutex_lock(&b->mtx);
+    if (--b->pending == 0)
+        Pthread_cond_signal(&b->cond);
+    Pthread_mutex_unlock(&b->mtx);
+}
+
+const char *sqlsorter_tz(void)
+{
+    return sorter_tz;
+}
+
+int sqlsorter_init(void)
+{
+    sorter_pool = thdpool_create("sqlsorterpool", 0);
+    if (sorter_pool == NULL)
+        return -1;
+    if (!gbl_exit_on_pthread_create_fail)
+        thdpool_unset_exit(sorter_pool);
+    thdpool_set_minthds(sorter_pool, 0);
+    thdpool_set_maxthds(sorter_pool, 8);
+    thdpool_set_maxqueue(sorter_pool, 0);
+    thdpool_set_linger(sorter_pool, 30);
+    return 0;
+}
+
+/* Runs xTask(apArg[i]) for the nTask arguments, spreading them over the
+ * query thread and the sorter threads, and returns once all of them are
+ * done.  Returns the number of tasks run by sorter threads. */
+int runVdbeSorterTasks(int nTask, void (*xTask)(void *), void **apArg)
+{
+    struct sorter_batch b;
+    struct sorter_task *tasks;
+    const char *tz;
+    int i, npool = 0;
+
+    if (nTask > 1 && sorter_pool)
+        tasks = malloc(nTask * sizeof(struct sorter_task));
+    else
+        tasks = NULL;
+    if (tasks == NULL) {
+        for (i = 0; i < nTask; i++)
+            xTask(apArg[i]);
+        return 0;
+    }
+
+    Pthread_mutex_init(&b.mtx, NULL);
+    Pthread_cond_init(&b.cond, NULL);
+    b.pending = 0;
+    tz = get_clnt_tz();
+
+    for (i = 1; i < nTask; i++) {
+        tasks[i].batch = &b;
+        tasks[i].xTask = xTask;
+        tasks[i].arg = apArg[i];
+        tasks[i].tz = tz;
+
+        Pthread_mutex_lock(&b.mtx);
+        b.pending++;
+        Pthread_mutex_unlock(&b.mtx);
+
+        if (thdpool_enqueue(sorter_pool, sorter_work, &tasks[i], 0, NULL, 0)) {
+            Pthread_mutex_lock(&b.mtx);
+            b.pending--;
+            Pthread_mutex_unlock(&b.mtx);
+            xTask(apArg[i]);
+        } else {
+            npool++;
+        }
+    }
+    xTask(apArg[0]);
+
+    Pthread_mutex_lock(&b.mtx);
+    while (b.pending > 0)
+        Pthread_cond_wait(&b.cond, &b.mtx);
+    Pthread_mutex_unlock(&b.mtx);
+
+    Pthread_cond_destroy(&b.cond);
+    Pthread_mutex_destroy(&b.mtx);
+    free(tasks);
+    return npool;
+}
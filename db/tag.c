@@ -6155,6 +6155,8 @@ void freedb_int(dbtable *db, dbtable *replace)
     int dbs_idx;
     char *sqlaliasname = db->sqlaliasname;
     const char *timepartition_name = db->timepartition_name;
+    int timepartition_frozen = db->timepartition_frozen;
+    int zonemap = db->zonemap;
     char **dbnames = alloca(sizeof(char*) * db->numdbs);
     for (i = 0; i < db->numdbs; i++)
         dbnames[i] = db->dbnames[i];
@@ -6217,6 +6219,7 @@ void freedb_int(dbtable *db, dbtable *replace)
 
     free(db->ixuse);
     free(db->sqlixuse);
+    free(db->sqlixlookups);
     free(db->csc2_schema);
     free(db->ixschema);
     if (db->sc_genids)
@@ -6242,6 +6245,8 @@ void freedb_int(dbtable *db, dbtable *replace)
         db->dbs_idx = dbs_idx;
         db->sqlaliasname = sqlaliasname;
         db->timepartition_name = timepartition_name;
+        db->timepartition_frozen = timepartition_frozen;
+        db->zonemap = zonemap;
         for (i = 0; i < db->numdbs; i++)
             db->dbnames[i] = dbnames[i];
         for (i = 0; i < db->numcols; i++)
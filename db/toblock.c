@@ -920,7 +920,7 @@ int dist_txn_abort_write_blkseq(void *in_bdb_state, void *bskey, int bskeylen)
 
 extern int gbl_debug_force_non_durable;
 
-static inline int durable_change_rcode(struct ireq *iq)
+int durable_change_rcode(struct ireq *iq)
 {
     if (iq->sorese && iq->sorese->dist_txnid) {
         return 1;
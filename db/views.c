@@ -50,12 +50,17 @@ int gbl_retro_tpt = 1;
 int gbl_legacy_tpt = 1;
 int gbl_retro_tpt_verbose = 0;
 int gbl_retro_tpt_start = 24; /* default 24 hours in the future */
+int gbl_timepart_freeze_shards = 0;
+int gbl_timepart_freeze_delay = 60; /* seconds after the shard is rolled */
+int gbl_timepart_freeze_compr = BDB_COMPRESS_ZLIB;
+int gbl_timepart_freeze_compr_blobs = BDB_COMPRESS_ZLIB;
 
 struct timepart_shard {
     char *tblname; /* name of the table covering the shard, can be an alias */
     int low;  /* lowest value in this shard, including limit  [low, high) */
     int high; /* excluding limit, values up to this can be stored in this shard
                  [low, high) */
+    int frozen; /* no longer current, read-only and rebuilt compressed */
 };
 typedef struct timepart_shard timepart_shard_t;
 
@@ -115,6 +120,7 @@ static void _remove_view_entry(timepart_views_t *views, int i);
 void *_view_cron_phase1(struct cron_event *event, struct errstat *err);
 void *_view_cron_phase2(struct cron_event *event, struct errstat *err);
 void *_view_cron_phase3(struct cron_event *event, struct errstat *err);
+void *_view_cron_freeze(struct cron_event *event, struct errstat *err);
 void *_view_cron_new_rollout(struct cron_event *event, struct errstat *err);
 static int _views_rollout_phase1(timepart_view_t *view, char **newShardName,
                                  struct errstat *err);
@@ -122,6 +128,11 @@ static int _views_rollout_phase2(timepart_view_t *view,
                                  const char *newShardName, int *timeNextRollout,
                                  char **removeShardName, struct errstat *err);
 static int _views_rollout_phase3(const char *oldShardName, struct errstat *err);
+static int _views_freeze_shard(timepart_view_t *view, const char *shardName,
+                               struct errstat *err);
+static int _schedule_freeze_shard(timepart_view_t *view, const char *shardName,
+                                  int freeze_time, struct errstat *err);
+static int _view_next_unfrozen_shard(timepart_view_t *view);
 
 static int _view_restart(timepart_view_t *view, struct errstat *err);
 static int _view_restart_new_rollout(timepart_view_t *view,
@@ -183,6 +194,8 @@ char *timepart_event_describe(sched_if_t *_, cron_event_t *event)
         name = "RollShards";
     else if (event->func == _view_cron_phase3)
         name = "DropShard";
+    else if (event->func == _view_cron_freeze)
+        name = "FreezeShard";
     else if (event->func == _view_cron_new_rollout)
         name = "Truncate";
     else
@@ -625,6 +638,7 @@ int views_handle_replicant_reload(void *tran, const char *name)
         }
         db->tableversion = table_version_select(db, tran);
         db->timepartition_name = view->name;
+        db->timepartition_frozen = view->shards[i].frozen;
     }
     if (view->rolltype == TIMEPART_ROLLOUT_TRUNCATE) {
         /* the order of the shards does not dictate current shard,
@@ -1058,6 +1072,12 @@ _view_cron_schedule_next_rollout(timepart_view_t *view, int timeCrtRollout,
         }
     }
 
+    /* the previous shard only gets late writes from now on */
+    if (gbl_timepart_freeze_shards && view->rolltype == TIMEPART_ROLLOUT_ADDDROP && view->nshards > 1 &&
+        !view->shards[1].frozen) {
+        _schedule_freeze_shard(view, view->shards[1].tblname, timeCrtRollout + gbl_timepart_freeze_delay, err);
+    }
+
     /* schedule the next rollout as well */
     tm = timeNextRollout - preemptive_rolltime;
     print_dbg_verbose(view->name, &view->source_id, "LLL",
@@ -1250,6 +1270,95 @@ done:
     return NULL;
 }
 
+/**
+ * Freeze a shard that is no longer current: mark it read-only and rebuild it
+ * with the freeze compression
+ *
+ */
+void *_view_cron_freeze(struct cron_event *event, struct errstat *err)
+{
+    bdb_state_type *bdb_state = thedb->bdb_env;
+    timepart_view_t *view;
+    char *arg1 = (char *)event->arg1;
+    char *arg2 = (char *)event->arg2;
+    char *name = arg1;
+    char *pShardName = arg2;
+    int run = 0;
+    int rc = VIEW_NOERR;
+    int bdberr;
+
+    if (!name || !pShardName) {
+        errstat_set_rc(err, VIEW_ERR_BUG);
+        errstat_set_strf(err, "%s no name or shardname?", __func__);
+        goto done;
+    }
+
+    run = (!gbl_exit && gbl_timepart_freeze_shards);
+    if (run && (thedb->master != gbl_myhostname || gbl_is_physical_replicant))
+        run = 0;
+
+    if (run) {
+        bdb_thread_event(thedb->bdb_env, BDBTHR_EVENT_START);
+        BDB_READLOCK(__func__);
+        rdlock_schema_lk();
+        Pthread_rwlock_wrlock(&views_lk);
+
+        view = _get_view(thedb->timepart_views, name);
+        if (!view) {
+            /* partition was dropped meanwhile */
+            rc = VIEW_ERR_EXIST;
+        } else if (_validate_view_id(view, event->source_id, "freeze", err)) {
+            rc = VIEW_ERR_BUG;
+        } else {
+            print_dbg_verbose(view->name, &view->source_id, "TTT",
+                              "Running freeze at %u for %s\n",
+                              comdb2_time_epoch(), pShardName);
+
+            rc = _views_freeze_shard(view, pShardName, err);
+            if (rc == VIEW_NOERR) {
+                rc = bdb_llog_views(thedb->bdb_env, view->name, 0, &bdberr);
+                if (rc != 0) {
+                    logmsg(LOGMSG_ERROR, "%s -- bdb_llog_views view %s rc:%d bdberr:%d\n", __func__, view->name, rc,
+                           bdberr);
+                    rc = VIEW_NOERR;
+                }
+                gbl_views_gen++;
+                view->version = gbl_views_gen;
+            }
+        }
+
+        Pthread_rwlock_unlock(&views_lk);
+        unlock_schema_lk();
+        BDB_RELLOCK();
+        bdb_thread_event(thedb->bdb_env, BDBTHR_EVENT_DONE);
+
+        /* the shard is read-only from now on; compress it outside the
+           partition locks */
+        if (rc == VIEW_NOERR) {
+            rc = sc_timepart_freeze_table(pShardName, gbl_timepart_freeze_compr,
+                                          gbl_timepart_freeze_compr_blobs, err);
+            if (rc != SC_VIEW_NOERR) {
+                logmsg(LOGMSG_ERROR, "%s: failed to rebuild frozen shard %s rc=%d errstr=%s\n", __func__, pShardName,
+                       err->errval, err->errstr);
+            }
+        } else if (rc != VIEW_ERR_EXIST) {
+            logmsg(LOGMSG_ERROR, "%s: failed to freeze shard %s rc=%d errstr=%s\n", __func__, pShardName, err->errval,
+                   err->errstr);
+        }
+
+        /* shards are frozen one at a time, so older shards do not all
+           get rebuilt at once */
+        if (view && (rc == VIEW_NOERR || rc == VIEW_ERR_EXIST)) {
+            int i = _view_next_unfrozen_shard(view);
+            if (i > 0)
+                _schedule_freeze_shard(view, view->shards[i].tblname,
+                                       comdb2_time_epoch() + gbl_timepart_freeze_delay, err);
+        }
+    }
+done:
+    return NULL;
+}
+
 static char* comdb2_partition_info_locked(const char *partition_name, 
                                           const char *option)
 {
@@ -1613,6 +1722,7 @@ static int _views_rollout_phase2(timepart_view_t *view,
     if (!view->shards[0].tblname) {
         goto oom;
     }
+    view->shards[0].frozen = 0;
     view->shards[0].low = view->roll_time;
     if (view->retention > 1)
         view->shards[1].high = view->roll_time;
@@ -1680,6 +1790,107 @@ static int _views_rollout_phase3(const char *oldestShardName,
     return err->errval = VIEW_NOERR;
 }
 
+/**
+ * Mark shard "shardName" frozen and persist it; the shard must not be the
+ * current one
+ *
+ */
+static int _views_freeze_shard(timepart_view_t *view, const char *shardName,
+                               struct errstat *err)
+{
+    struct dbtable *db;
+    tran_type *tran;
+    int bdberr = 0;
+    int rc;
+    int i;
+
+    for (i = 1; i < view->nshards; i++) {
+        if (strcasecmp(view->shards[i].tblname, shardName) == 0)
+            break;
+    }
+    if (i >= view->nshards) {
+        /* rolled out or still current, nothing to do */
+        return err->errval = VIEW_ERR_EXIST;
+    }
+    if (view->shards[i].frozen)
+        return err->errval = VIEW_ERR_EXIST;
+
+    db = get_dbtable_by_name(shardName);
+    if (!db) {
+        errstat_set_rcstrf(err, VIEW_ERR_BUG, "Shard %s missing", shardName);
+        return err->errval;
+    }
+
+    view->shards[i].frozen = 1;
+
+    tran = bdb_tran_begin(thedb->bdb_env, NULL, &bdberr);
+    if (!tran || bdberr) {
+        view->shards[i].frozen = 0;
+        errstat_set_rcstrf(err, VIEW_ERR_LLMETA, "Failed to start transaction");
+        return err->errval;
+    }
+
+    rc = partition_llmeta_write(tran, view, 1, err);
+    if (rc != VIEW_NOERR) {
+        bdb_tran_abort(thedb->bdb_env, tran, &bdberr);
+        view->shards[i].frozen = 0;
+        return err->errval;
+    }
+
+    rc = bdb_tran_commit(thedb->bdb_env, tran, &bdberr);
+    if (rc || bdberr) {
+        view->shards[i].frozen = 0;
+        return err->errval = VIEW_ERR_LLMETA;
+    }
+
+    db->timepartition_frozen = 1;
+
+    return err->errval = VIEW_NOERR;
+}
+
+static int _schedule_freeze_shard(timepart_view_t *view, const char *shardName,
+                                  int freeze_time, struct errstat *err)
+{
+    char *tmp_str1;
+    char *tmp_str2;
+
+    print_dbg_verbose(view->name, &view->source_id, "LLL",
+                      "Adding freeze at %d for %s\n", freeze_time, shardName);
+
+    if (cron_add_event(_get_sched_byname(view->period, view->name), NULL,
+                       freeze_time, _view_cron_freeze,
+                       tmp_str1 = strdup(view->name),
+                       tmp_str2 = strdup(shardName), NULL, NULL,
+                       &view->source_id, err, NULL) == NULL) {
+        logmsg(LOGMSG_ERROR, "%s: failed rc=%d errstr=%s\n", __func__,
+               err->errval, err->errstr);
+        free(tmp_str1);
+        free(tmp_str2);
+        return VIEW_ERR_GENERIC;
+    }
+
+    return VIEW_NOERR;
+}
+
+/**
+ * Return the newest shard that is no longer current and not yet frozen,
+ * or -1 if there is none
+ *
+ */
+static int _view_next_unfrozen_shard(timepart_view_t *view)
+{
+    int i;
+
+    if (view->rolltype != TIMEPART_ROLLOUT_ADDDROP)
+        return -1;
+
+    for (i = 1; i < view->nshards; i++) {
+        if (!view->shards[i].frozen)
+            return i;
+    }
+    return -1;
+}
+
 static int _schedule_drop_shard(timepart_view_t *view,
                                 const char *evicted_shard, int evict_time,
                                 struct errstat *err)
@@ -1912,6 +2123,20 @@ static int _view_restart(timepart_view_t *view, struct errstat *err)
         return rc;
     }
 
+    /* recover a freeze lost to a master swing, or enabled since the
+       rollout; only the newest unfrozen shard is scheduled, and each freeze
+       schedules the next one */
+    if (gbl_timepart_freeze_shards &&
+        (i = _view_next_unfrozen_shard(view)) > 0) {
+        tm = view->shards[i].high + gbl_timepart_freeze_delay;
+
+        Pthread_rwlock_unlock(&views_lk);
+
+        _schedule_freeze_shard(view, view->shards[i].tblname, tm, err);
+
+        Pthread_rwlock_wrlock(&views_lk);
+    }
+
     errstat_set_rc(err, rc = VIEW_NOERR);
 
     return rc;
@@ -2373,6 +2598,7 @@ static int _view_register_shards(timepart_views_t *views,
                 goto done;
             }
             db->timepartition_name = view->name;
+            db->timepartition_frozen = view->shards[i].frozen;
         }
     }
 
@@ -2397,6 +2623,7 @@ static void _view_unregister_shards_lkless(timepart_views_t *views,
         db = get_dbtable_by_name(view->shards[i].tblname);
         if (db) {
             db->timepartition_name = NULL;
+            db->timepartition_frozen = 0;
             /* here we also need to dealiase, if the alias
              * was created by alter partition
              */
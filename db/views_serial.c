@@ -44,6 +44,8 @@
  *             ]
  *       }
  *
+ * Shards frozen by timepart_freeze_shards carry an additional "FROZEN" : 1.
+ *
  */
 #include <stdio.h>
 #include <stdarg.h>
@@ -175,9 +177,10 @@ int timepart_serialize_view(timepart_view_t *view, int *plen, char **out,
         str = _concat(str, &len, "  {\n"
                                  "   \"TABLENAME\"    : \"%s\",\n"
                                  "   \"LOW\"          : %s,\n"
-                                 "   \"HIGH\"         : %s\n"
+                                 "   \"HIGH\"         : %s%s\n"
                                  "  }%s\n",
                       shard->tblname, lowstr, highstr,
+                      shard->frozen ? ",\n   \"FROZEN\"       : 1" : "",
                       (j == view->nshards - 1) ? "" : ",");
         if (!str)
             return VIEW_ERR_MALLOC;
@@ -1489,6 +1492,11 @@ static timepart_view_t *partition_deserialize_cson_value(cson_value *cson_view,
                 j);
             goto error;
         }
+
+        /* FROZEN is optional */
+        if (cson_object_get(obj_arr, "FROZEN")) {
+            view->shards[j].frozen = cson_extract_int(obj_arr, "FROZEN", err) > 0;
+        }
     }
 
 look_for_shard0:
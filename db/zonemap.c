@@ -0,0 +1,408 @@
+/*
+   Copyright 2026 Bloomberg Finance L.P.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+ */
+
+/*
+ * Zone maps (see bdb/zonemap.c for how they are stored and kept wide
+ * enough).
+ *
+ * The master summarizes the records of the tables with zone maps enabled
+ * (PUT ZONEMAP ENABLE) in runs of zonemap_rows records per data stripe, in
+ * genid order.  Only complete runs are summarized; the tail of a stripe is
+ * summarized once enough records were appended to it.  Zones summarized for
+ * an older table version are dropped and summarized again.
+ *
+ * Table scans go through the zones of the stripe they are in and jump over
+ * those which cannot hold a record matching the hinted WHERE terms.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "comdb2.h"
+#include "sql.h"
+#include "tag.h"
+#include "csctypes.h"
+#include "genid.h"
+#include "thrman.h"
+#include "thread_util.h"
+#include "logmsg.h"
+#include "str0.h"
+#include "zonemap.h"
+#include "comdb2_atomic.h"
+
+int gbl_zonemap_rows = 8192;
+int gbl_zonemap_summarize_interval = 10;
+int gbl_zonemap_max_column_size = 64;
+int gbl_zonemap_scan = 1;
+int64_t gbl_zonemap_zones_summarized;
+int64_t gbl_zonemap_zones_skipped;
+
+static int zonemap_thread_running;
+
+int zonemap_column_eligible(int type, int len)
+{
+    if (len > gbl_zonemap_max_column_size)
+        return 0;
+    switch (type) {
+    case SERVER_BINT:
+    case SERVER_UINT:
+    case SERVER_BREAL:
+    case SERVER_BCSTR:
+    case SERVER_BYTEARRAY:
+    case SERVER_DATETIME:
+    case SERVER_DATETIMEUS:
+        /* the ondisk formats of these sort like the values */
+        return 1;
+    default:
+        return 0;
+    }
+}
+
+/* Summarizes the next zone of `stripe'.  Returns 0 if a zone was added, 1 if
+ * there are not enough records past the last zone, 2 if the zones of an
+ * older table version were dropped, -1 on error and RC_INTERNAL_RETRY on
+ * deadlock. */
+static int summarize_zone(struct ireq *iq, tran_type *trans, struct dbtable *db,
+                          int stripe)
+{
+    unsigned long long genid_vector[MAXDTASTRIPE] = {0};
+    unsigned long long genid;
+    struct schema *sc = db->schema;
+    bdb_zone_t zone = {0};
+    uint8_t *dta = NULL, *minmax = NULL;
+    void *buf = NULL;
+    uint64_t lo = 0, last;
+    int len, bdberr, rc, ncols = 0, nrows = 0;
+    int dtalen = getdatsize(db);
+
+    rc = bdb_zonemap_find(trans, db->tablename, stripe, UINT64_MAX >> 16, &lo,
+                          &buf, &len, &bdberr);
+    if (rc < 0)
+        return bdberr == BDBERR_DEADLOCK ? RC_INTERNAL_RETRY : -1;
+    if (rc == 0) {
+        rc = bdb_zone_unpack(lo, buf, len, &zone);
+        if (rc == 0 && zone.version != db->tableversion)
+            rc = 1;
+        last = zone.hi;
+        bdb_zone_free(&zone);
+        free(buf);
+        if (rc) {
+            /* the schema changed; start over */
+            rc = bdb_zonemap_del_all(trans, db->tablename, &bdberr);
+            if (rc)
+                return bdberr == BDBERR_DEADLOCK ? RC_INTERNAL_RETRY : -1;
+            return 2;
+        }
+        lo = last + 1;
+        genid_vector[stripe] = bdb_seq_to_genid(last, stripe);
+    }
+
+    memset(&zone, 0, sizeof(zone));
+    zone.cols = calloc(sc->nmembers, sizeof(bdb_zone_col_t));
+    minmax = malloc(2 * sc->nmembers * gbl_zonemap_max_column_size);
+    dta = malloc(dtalen);
+    if (zone.cols == NULL || minmax == NULL || dta == NULL) {
+        rc = -1;
+        goto done;
+    }
+    for (int i = 0; i < sc->nmembers; i++) {
+        struct field *f = &sc->member[i];
+        if (!zonemap_column_eligible(f->type, f->len))
+            continue;
+        bdb_zone_col_t *c = &zone.cols[ncols];
+        c->fld = i;
+        c->off = f->offset;
+        c->len = f->len;
+        c->min = minmax + 2 * ncols * gbl_zonemap_max_column_size;
+        c->max = c->min + gbl_zonemap_max_column_size;
+        ncols++;
+    }
+    zone.ncols = ncols;
+
+    while (nrows < gbl_zonemap_rows) {
+        int reqdtalen, ver, s = stripe;
+        rc = dtas_next(iq, genid_vector, &genid, &s, 1, dta, trans, dtalen,
+                       &reqdtalen, &ver);
+        if (rc)
+            goto done;
+        genid_vector[stripe] = genid;
+        for (int i = 0; i < ncols; i++) {
+            bdb_zone_col_t *c = &zone.cols[i];
+            const uint8_t *v = dta + c->off;
+            if (nrows == 0 || memcmp(v, c->min, c->len) < 0)
+                memcpy(c->min, v, c->len);
+            if (nrows == 0 || memcmp(v, c->max, c->len) > 0)
+                memcpy(c->max, v, c->len);
+        }
+        nrows++;
+    }
+
+    zone.version = db->tableversion;
+    zone.lo = lo;
+    zone.hi = bdb_genid_seq(genid);
+    zone.nrows = nrows;
+
+    /* the records are read locked; writers which come after them must see
+     * the zone */
+    bdb_zonemap_raise_frontier(db->handle, stripe, zone.hi);
+
+    if (bdb_zone_pack(&zone, &buf, &len)) {
+        rc = -1;
+        goto done;
+    }
+    rc = bdb_zonemap_put(trans, db->tablename, stripe, zone.lo, buf, len,
+                         &bdberr);
+    free(buf);
+    if (rc)
+        rc = bdberr == BDBERR_DEADLOCK ? RC_INTERNAL_RETRY : -1;
+
+done:
+    free(dta);
+    free(minmax);
+    free(zone.cols);
+    return rc;
+}
+
+static int summarize_table(struct ireq *iq, const char *tablename)
+{
+    for (int stripe = 0; stripe < gbl_dtastripe && !db_is_exiting(); stripe++) {
+        int retries = 0, rc;
+        do {
+            tran_type *trans = NULL;
+            struct dbtable *db;
+
+            if (thedb->master != gbl_myhostname)
+                return -1;
+            if (trans_start(iq, NULL, &trans))
+                return -1;
+            /* keep schema changes out until the zone is committed */
+            bdb_lock_tablename_read(thedb->bdb_env, tablename, trans);
+            db = get_dbtable_by_name(tablename);
+            if (db == NULL || !db->zonemap || gbl_rowlocks ||
+                stripe >= db->dtastripe) {
+                trans_abort(iq, trans);
+                return 0;
+            }
+            iq->usedb = db;
+            rc = summarize_zone(iq, trans, db, stripe);
+            if (rc == 0 || rc == 2) {
+                int dropped = (rc == 2);
+                rc = trans_commit(iq, trans, gbl_myhostname);
+                if (rc == 0) {
+                    if (!dropped)
+                        ATOMIC_ADD64(gbl_zonemap_zones_summarized, 1);
+                    retries = 0;
+                }
+            } else {
+                trans_abort(iq, trans);
+            }
+            if (rc == RC_INTERNAL_RETRY && ++retries < 10)
+                rc = 0;
+        } while (rc == 0 && !db_is_exiting());
+        if (rc < 0)
+            logmsg(LOGMSG_ERROR, "%s: table %s stripe %d rc %d\n", __func__,
+                   tablename, stripe, rc);
+    }
+    return 0;
+}
+
+static void *zonemap_thread(void *arg)
+{
+    struct dbenv *dbenv = arg;
+    struct ireq iq;
+
+    thrman_register(THRTYPE_GENERIC);
+    thread_started("zonemap");
+    backend_thread_event(dbenv, COMDB2_THR_EVENT_START);
+
+    while (!db_is_exiting()) {
+        char (*names)[MAXTABLELEN + 1] = NULL;
+        int n = 0;
+
+        for (int i = 0; i < gbl_zonemap_summarize_interval && !db_is_exiting();
+             i++)
+            sleep(1);
+        if (dbenv->master != gbl_myhostname || dbenv->stopped ||
+            gbl_rowlocks)
+            continue;
+
+        rdlock_schema_lk();
+        for (int i = 0; i < dbenv->num_dbs; i++) {
+            if (!dbenv->dbs[i]->zonemap)
+                continue;
+            if (names == NULL &&
+                (names = calloc(dbenv->num_dbs, sizeof(*names))) == NULL)
+                break;
+            strncpy0(names[n++], dbenv->dbs[i]->tablename, MAXTABLELEN + 1);
+        }
+        unlock_schema_lk();
+
+        init_fake_ireq(dbenv, &iq);
+        for (int i = 0; i < n && !db_is_exiting(); i++)
+            summarize_table(&iq, names[i]);
+        free(names);
+    }
+
+    backend_thread_event(dbenv, COMDB2_THR_EVENT_DONE);
+    return NULL;
+}
+
+void create_zonemap_thread(struct dbenv *dbenv)
+{
+    pthread_t tid;
+
+    if (zonemap_thread_running || gbl_is_physical_replicant)
+        return;
+    zonemap_thread_running = 1;
+    Pthread_create(&tid, &gbl_pthread_attr_detached, zonemap_thread, dbenv);
+}
+
+int zonemap_scan_add_pred(struct zonemap_scan *zs, int fld, enum zonemap_op op,
+                          const void *val, int len)
+{
+    if (zs->npreds == zs->maxpreds) {
+        int max = zs->maxpreds ? 2 * zs->maxpreds : 4;
+        struct zonemap_pred *p = realloc(zs->preds, max * sizeof(*p));
+        if (p == NULL)
+            return -1;
+        zs->preds = p;
+        zs->maxpreds = max;
+    }
+    struct zonemap_pred *p = &zs->preds[zs->npreds];
+    if ((p->val = malloc(len)) == NULL)
+        return -1;
+    memcpy(p->val, val, len);
+    p->fld = fld;
+    p->op = op;
+    p->len = len;
+    zs->npreds++;
+    zs->cached = 0;
+    return 0;
+}
+
+void zonemap_scan_reset(struct zonemap_scan *zs)
+{
+    for (int i = 0; i < zs->npreds; i++)
+        free(zs->preds[i].val);
+    zs->npreds = 0;
+    zs->cached = 0;
+}
+
+void zonemap_scan_free(struct zonemap_scan *zs)
+{
+    if (zs == NULL)
+        return;
+    zonemap_scan_reset(zs);
+    free(zs->preds);
+    free(zs);
+}
+
+static int pred_excludes(const struct zonemap_pred *p, const bdb_zone_t *zone)
+{
+    for (int i = 0; i < zone->ncols; i++) {
+        const bdb_zone_col_t *c = &zone->cols[i];
+        if (c->fld != p->fld || c->len != p->len)
+            continue;
+        int lo = memcmp(p->val, c->min, c->len);
+        int hi = memcmp(p->val, c->max, c->len);
+        switch (p->op) {
+        case ZONEMAP_EQ: return lo < 0 || hi > 0;
+        case ZONEMAP_LT: return lo <= 0;
+        case ZONEMAP_LE: return lo < 0;
+        case ZONEMAP_GT: return hi >= 0;
+        case ZONEMAP_GE: return hi > 0;
+        }
+    }
+    return 0;
+}
+
+/* Caches the zone of `stripe' holding `seq', or the gap up to the next zone
+ * if no zone holds it. */
+static int load_zone(struct dbtable *db, struct zonemap_scan *zs, int stripe,
+                     uint64_t seq)
+{
+    tran_type *tran = curtran_gettran();
+    bdb_zone_t zone;
+    uint64_t lo;
+    void *buf = NULL;
+    int len, bdberr, rc;
+
+    /* read under the cursor's locker, so waits on writers are seen by the
+     * deadlock detector */
+    if (tran == NULL)
+        return -1;
+
+    rc = bdb_zonemap_find(tran, db->tablename, stripe, seq, &lo, &buf, &len,
+                          &bdberr);
+    if (rc < 0)
+        goto done;
+    if (rc == 0 && bdb_zone_unpack(lo, buf, len, &zone) == 0) {
+        if (seq <= zone.hi) {
+            zs->lo = lo;
+            zs->hi = zone.hi;
+            zs->excluded = 0;
+            for (int i = 0; zone.version == db->tableversion && i < zs->npreds;
+                 i++) {
+                if (pred_excludes(&zs->preds[i], &zone)) {
+                    zs->excluded = 1;
+                    break;
+                }
+            }
+            bdb_zone_free(&zone);
+            goto cache;
+        }
+        bdb_zone_free(&zone);
+    }
+
+    rc = bdb_zonemap_find_next(tran, db->tablename, stripe, seq, &lo, &bdberr);
+    if (rc < 0)
+        goto done;
+    zs->lo = seq;
+    zs->hi = rc == 0 ? lo - 1 : UINT64_MAX >> 16;
+    zs->excluded = 0;
+
+cache:
+    zs->stripe = stripe;
+    zs->cached = 1;
+    rc = 0;
+done:
+    free(buf);
+    curtran_puttran(tran);
+    return rc;
+}
+
+int zonemap_scan_skip(struct dbtable *db, struct zonemap_scan *zs,
+                      unsigned long long genid, unsigned long long *next)
+{
+    if (zs == NULL || zs->npreds == 0 || !gbl_zonemap_scan ||
+        is_genid_synthetic(genid))
+        return 0;
+
+    int stripe = get_dtafile_from_genid(genid);
+    uint64_t seq = bdb_genid_seq(genid);
+
+    if (!zs->cached || zs->stripe != stripe || seq < zs->lo || seq > zs->hi) {
+        if (load_zone(db, zs, stripe, seq))
+            return 0;
+    }
+    if (!zs->excluded)
+        return 0;
+
+    *next = bdb_seq_to_genid(zs->hi + 1, stripe);
+    ATOMIC_ADD64(gbl_zonemap_zones_skipped, 1);
+    return 1;
+}
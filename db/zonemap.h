@@ -0,0 +1,75 @@
+/*
+   Copyright 2026 Bloomberg Finance L.P.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+ */
+
+#ifndef INCLUDED_ZONEMAP_H
+#define INCLUDED_ZONEMAP_H
+
+#include <stdint.h>
+
+struct dbenv;
+struct dbtable;
+
+enum zonemap_op {
+    ZONEMAP_EQ,
+    ZONEMAP_LT,
+    ZONEMAP_LE,
+    ZONEMAP_GT,
+    ZONEMAP_GE,
+};
+
+/* "column op value", value in ondisk format */
+struct zonemap_pred {
+    int fld;
+    enum zonemap_op op;
+    int len;
+    uint8_t *val;
+};
+
+/* predicates of a table scan and the last zone (or gap between zones) its
+ * cursor landed in */
+struct zonemap_scan {
+    int npreds;
+    int maxpreds;
+    struct zonemap_pred *preds;
+
+    int cached;
+    int stripe;
+    uint64_t lo;
+    uint64_t hi;
+    int excluded;
+};
+
+extern int gbl_zonemap_rows;
+extern int gbl_zonemap_summarize_interval;
+extern int gbl_zonemap_max_column_size;
+extern int gbl_zonemap_scan;
+extern int64_t gbl_zonemap_zones_summarized;
+extern int64_t gbl_zonemap_zones_skipped;
+
+void create_zonemap_thread(struct dbenv *dbenv);
+
+int zonemap_column_eligible(int type, int len);
+int zonemap_scan_add_pred(struct zonemap_scan *zs, int fld, enum zonemap_op op,
+                          const void *val, int len);
+void zonemap_scan_reset(struct zonemap_scan *zs);
+void zonemap_scan_free(struct zonemap_scan *zs);
+
+/* Returns 1 if the zone holding `genid' has no record matching the
+ * predicates; `next' is set to the genid following the zone. */
+int zonemap_scan_skip(struct dbtable *db, struct zonemap_scan *zs,
+                      unsigned long long genid, unsigned long long *next);
+
+#endif
@@ -479,6 +479,7 @@ stack
       {line ROWLOCKS {or ENABLE DISABLE}}
       {line SCHEMACHANGE {or COMMITSLEEP CONVERTSLEEP} /numeric-literal}
       {line SKIPSCAN {or ENABLE DISABLE}}
+      {line ZONEMAP {or ENABLE DISABLE} /table-name}
       {line TUNABLE /string-literal {opt = } {or /string-literal /numeric-literal}}
       {line COUNTER /counter-name SET /numeric-literal}
       {line COUNTER /counter-name INCREMENT}
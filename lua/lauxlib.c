@@ -673,14 +673,17 @@ LUALIB_API int (luaL_loadstring) (lua_State *L, const char *s) {
 
 
 static void *l_alloc (void *ud, void *ptr, size_t osize, size_t nsize) {
+  void *p;
   (void)ud;
-  (void)osize;
   if (nsize == 0) {
     free(ptr);
+    comdb2ma_acct_charge(-(int64_t)osize);
     return NULL;
   }
-  else
-    return realloc(ptr, nsize);
+  p = realloc(ptr, nsize);
+  if (p != NULL)
+    comdb2ma_acct_charge((int64_t)nsize - (int64_t)osize);
+  return p;
 }
 
 
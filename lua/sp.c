@@ -5181,7 +5181,12 @@ static void init_dbconsumer_funcs(Lua L)
 static void *lua_alloc(void *ud, void *ptr, size_t osize, size_t nsize)
 {
     /* ensure that realloc(ptr, NULL, 0) does nothing for lua. see lua/lmem.c */
-    return (ptr == NULL && nsize == 0) ? NULL : comdb2_realloc(ud, ptr, nsize);
+    if (ptr == NULL && nsize == 0)
+        return NULL;
+    void *p = comdb2_realloc(ud, ptr, nsize);
+    if (p != NULL || nsize == 0)
+        comdb2ma_acct_charge((int64_t)nsize - (int64_t)osize);
+    return p;
 }
 
 static int create_sp_int(SP sp, char **err)
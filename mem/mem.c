@@ -43,6 +43,7 @@
 #include "mem.h"
 #include <logmsg.h>
 #include <sys_wrap.h>
+#include <comdb2_atomic.h>
 
 //^macros
 #define COMDB2MA_SUCCESS 0
@@ -165,6 +166,7 @@ struct comdb2mspace {
                              we do not write it to name because an allocator
                              may be reused by another type of thread later on */
     unsigned int debug : 1; /* Debugging flag. */
+    unsigned int tcache : 1; /* Blocks may be cached by threads. */
 
     size_t len;   /* length of name */
     char name[1]; /* name of the mspace */
@@ -268,6 +270,9 @@ static comdb2ma comdb2ma_create_int(void *base, size_t init_sz, size_t max_cap,
 /* internal comdb2ma deletion */
 static int comdb2ma_destroy_int(comdb2ma cm);
 
+/* free a list of `n' blocks linked through their first word */
+static void comdb2_free_list_int(comdb2ma cm, void **head, size_t n);
+
 #ifdef PER_THREAD_MALLOC
 __thread const char *thread_type_key;
 static __thread comdb2ma *t_zone;
@@ -379,6 +384,374 @@ static unsigned char debug_master_switch = 0;
 static unsigned char debug_switches[COMDB2MA_COUNT] = {0};
 // static variables and function prototypes$
 
+//^thread cache
+/*
+ * Small blocks freed to an allocator that allows it (the static allocators
+ * and the per-thread zones) are kept on free lists of the freeing thread, one
+ * per size class, and handed out again by the next comdb2_malloc() of the
+ * class on the same allocator without taking the allocator lock. A cached
+ * block is still allocated from its mspace and still counted in `refs', so a
+ * zone is never destroyed underneath a cache. Free lists are linked through
+ * the first word of the payload.
+ *
+ * A thread caches blocks of up to COMDB2MA_TC_NSLOTS allocators at a time,
+ * and returns them in batches: half a size class when the class is full, an
+ * allocator when the thread holds over `comdb2ma_tcache_size' bytes or needs
+ * the slot for another allocator, and everything every COMDB2MA_TC_FLUSH_SECS
+ * seconds, after comdb2ma_release() and when the thread exits. The clock is
+ * checked every COMDB2MA_TC_CHECK_OPS allocations and frees of the thread.
+ *
+ * Only the owning thread touches its cache. Every COMDB2MA_TC_CHECK_OPS
+ * operations and on a full flush it publishes its counters under
+ * `tcache_lock', which is where comdb2_memstats reads them.
+ */
+#define COMDB2MA_TC_NCLASSES 20
+#define COMDB2MA_TC_MAX_SIZE 1024
+/* blocks up to this usable size go to the largest class */
+#define COMDB2MA_TC_MAX_USABLE (COMDB2MA_TC_MAX_SIZE + 64)
+#define COMDB2MA_TC_NSLOTS 8
+#define COMDB2MA_TC_SLOT(cm) ((((uintptr_t)(cm)) >> 6) % COMDB2MA_TC_NSLOTS)
+#define COMDB2MA_TC_BIN_MAX(c)                                                 \
+    (tc_sizes[c] <= 128 ? 64 : (8192 / tc_sizes[c]))
+#define COMDB2MA_TC_FLUSH_SECS 10
+#define COMDB2MA_TC_CHECK_OPS 1024
+#define COMDB2MA_TC_DEAD ((struct tcache *)(uintptr_t)-1)
+
+static const unsigned short tc_sizes[COMDB2MA_TC_NCLASSES] = {
+    16,  32,  48,  64,  80,  96,  112, 128, 160, 192,
+    224, 256, 320, 384, 448, 512, 640, 768, 896, 1024};
+
+/* size class by size in 16-byte units: smallest class that fits (malloc), and
+   largest class that a block of the usable size can serve (free) */
+static unsigned char tc_class_up[COMDB2MA_TC_MAX_SIZE / 16 + 1];
+static signed char tc_class_down[COMDB2MA_TC_MAX_USABLE / 16 + 1];
+
+struct tcache_bin {
+    void **head;
+    unsigned int count;
+};
+
+struct tcache_slot {
+    comdb2ma cm;  /* allocator of the cached blocks */
+    size_t bytes; /* bytes cached */
+    struct tcache_bin bins[COMDB2MA_TC_NCLASSES];
+};
+
+/* counters of a cache as last published by its thread */
+struct tcache_stats {
+    comdb2ma cm[COMDB2MA_TC_NSLOTS];
+    size_t slot_bytes[COMDB2MA_TC_NSLOTS];
+    size_t bytes;
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t frees;
+    uint64_t flushes;
+};
+
+struct tcache {
+    LINKC_T(struct tcache) lnk;
+    pthread_t tid;
+    const char *thr_type;
+    unsigned int epoch; /* last seen tcache_epoch */
+    unsigned int ops;   /* operations since the last clock check */
+    time_t flushed;     /* time of the last full flush */
+    size_t bytes;       /* bytes cached in all slots */
+    uint64_t hits;      /* allocations served from the cache */
+    uint64_t misses;    /* cacheable allocations not served from the cache */
+    uint64_t frees;     /* frees kept in the cache */
+    uint64_t flushes;   /* batches returned to allocators */
+    struct tcache_slot slots[COMDB2MA_TC_NSLOTS];
+    struct tcache_stats pub; /* protected by tcache_lock */
+};
+
+int gbl_comdb2ma_tcache = 1;
+int gbl_comdb2ma_tcache_size = 256 * 1024;
+
+static pthread_once_t tcache_once = PTHREAD_ONCE_INIT;
+static pthread_key_t tcache_key;
+static pthread_mutex_t tcache_lock = PTHREAD_MUTEX_INITIALIZER;
+static LISTC_T(struct tcache) tcaches;
+static unsigned int tcache_epoch;
+static __thread struct tcache *t_tcache;
+/* set while this thread holds the root lock: returning blocks may destroy a
+   zone, which needs the root lock */
+static __thread int t_tcache_noflush;
+
+static void tcache_destroy(void *arg);
+
+static void tcache_init_once(void)
+{
+    int i, c;
+
+    for (i = 0, c = 0; i <= COMDB2MA_TC_MAX_SIZE / 16; ++i) {
+        while (tc_sizes[c] < i * 16)
+            ++c;
+        tc_class_up[i] = c;
+    }
+    for (i = 0, c = -1; i <= COMDB2MA_TC_MAX_USABLE / 16; ++i) {
+        while (c + 1 < COMDB2MA_TC_NCLASSES && tc_sizes[c + 1] <= i * 16)
+            ++c;
+        tc_class_down[i] = c;
+    }
+
+    listc_init(&tcaches, offsetof(struct tcache, lnk));
+    Pthread_key_create(&tcache_key, tcache_destroy);
+}
+
+/* return `n' blocks of class `c' of `slot' to the allocator */
+static void tcache_flush_bin(struct tcache *tc, struct tcache_slot *slot, int c,
+                             unsigned int n)
+{
+    struct tcache_bin *bin = &slot->bins[c];
+    void **head = bin->head, **tail = head;
+    unsigned int i;
+
+    if (n == 0)
+        return;
+    for (i = 1; i != n; ++i)
+        tail = (void **)tail[0];
+    bin->head = (void **)tail[0];
+    bin->count -= n;
+    tail[0] = NULL;
+    slot->bytes -= (size_t)n * tc_sizes[c];
+    tc->bytes -= (size_t)n * tc_sizes[c];
+    ++tc->flushes;
+    comdb2_free_list_int(slot->cm, head, n);
+}
+
+/* return all blocks of `slot' to the allocator in one batch */
+static void tcache_flush_slot(struct tcache *tc, struct tcache_slot *slot)
+{
+    void **head = NULL, **p;
+    size_t n = 0;
+    int c;
+
+    if (slot->bytes == 0)
+        return;
+    for (c = 0; c != COMDB2MA_TC_NCLASSES; ++c) {
+        while ((p = slot->bins[c].head) != NULL) {
+            slot->bins[c].head = (void **)p[0];
+            p[0] = head;
+            head = p;
+            ++n;
+        }
+        slot->bins[c].count = 0;
+    }
+    tc->bytes -= slot->bytes;
+    slot->bytes = 0;
+    ++tc->flushes;
+    comdb2_free_list_int(slot->cm, head, n);
+}
+
+static void tcache_publish(struct tcache *tc)
+{
+    Pthread_mutex_lock(&tcache_lock);
+    for (int i = 0; i != COMDB2MA_TC_NSLOTS; ++i) {
+        tc->pub.cm[i] = tc->slots[i].cm;
+        tc->pub.slot_bytes[i] = tc->slots[i].bytes;
+    }
+    tc->pub.bytes = tc->bytes;
+    tc->pub.hits = tc->hits;
+    tc->pub.misses = tc->misses;
+    tc->pub.frees = tc->frees;
+    tc->pub.flushes = tc->flushes;
+    Pthread_mutex_unlock(&tcache_lock);
+}
+
+static void tcache_flush(struct tcache *tc)
+{
+    for (int i = 0; i != COMDB2MA_TC_NSLOTS; ++i)
+        tcache_flush_slot(tc, &tc->slots[i]);
+    tc->flushed = time(NULL);
+    tcache_publish(tc);
+}
+
+static void tcache_destroy(void *arg)
+{
+    struct tcache *tc = arg;
+
+    t_tcache = COMDB2MA_TC_DEAD;
+    Pthread_mutex_lock(&tcache_lock);
+    listc_rfl(&tcaches, tc);
+    Pthread_mutex_unlock(&tcache_lock);
+    tcache_flush(tc);
+    free(tc);
+}
+
+/* return the cache of this thread, NULL if the thread can't cache. returns
+   the cached blocks first if asked to or if they have been held too long. */
+static struct tcache *tcache_get(void)
+{
+    struct tcache *tc = t_tcache;
+    unsigned int epoch;
+
+    if (tc == COMDB2MA_TC_DEAD)
+        return NULL;
+
+    if (tc == NULL) {
+        Pthread_once(&tcache_once, tcache_init_once);
+        if ((tc = calloc(1, sizeof(struct tcache))) == NULL)
+            return NULL;
+        tc->tid = pthread_self();
+        tc->thr_type = COMDB2MA_THR_UNKNOWN;
+        tc->epoch = ATOMIC_LOAD32(tcache_epoch);
+        tc->flushed = time(NULL);
+        Pthread_mutex_lock(&tcache_lock);
+        listc_abl(&tcaches, tc);
+        Pthread_mutex_unlock(&tcache_lock);
+        Pthread_setspecific(tcache_key, tc);
+        t_tcache = tc;
+    }
+
+    if (t_tcache_noflush)
+        return tc;
+
+    epoch = ATOMIC_LOAD32(tcache_epoch);
+    if (tc->epoch != epoch) {
+        tc->epoch = epoch;
+        tcache_flush(tc);
+    } else if (++tc->ops == COMDB2MA_TC_CHECK_OPS) {
+        tc->ops = 0;
+        if (tc->bytes != 0 &&
+            time(NULL) - tc->flushed >= COMDB2MA_TC_FLUSH_SECS)
+            tcache_flush(tc);
+        else
+            tcache_publish(tc);
+    }
+    return tc;
+}
+
+/* take a block of at least `*size' bytes of `cm' from the cache. `*size' is
+   rounded up to its class so that the block can be cached when freed. */
+static void **tcache_take(comdb2ma cm, size_t *size)
+{
+    struct tcache *tc;
+    struct tcache_slot *slot;
+    struct tcache_bin *bin;
+    void **out;
+    int c;
+
+    if ((tc = tcache_get()) == NULL)
+        return NULL;
+
+    c = tc_class_up[(*size + 15) >> 4];
+    *size = tc_sizes[c];
+    slot = &tc->slots[COMDB2MA_TC_SLOT(cm)];
+    bin = &slot->bins[c];
+    if (slot->cm != cm || (out = bin->head) == NULL) {
+        ++tc->misses;
+#ifdef PER_THREAD_MALLOC
+        if (thread_type_key != NULL)
+            tc->thr_type = thread_type_key;
+#endif
+        return NULL;
+    }
+
+    bin->head = (void **)out[0];
+    --bin->count;
+    slot->bytes -= tc_sizes[c];
+    tc->bytes -= tc_sizes[c];
+    ++tc->hits;
+    return out;
+}
+
+/* put `p' of `cm' in the cache. return 1 if cached. */
+static int tcache_put(comdb2ma cm, void **p)
+{
+    struct tcache *tc;
+    struct tcache_slot *slot;
+    struct tcache_bin *bin;
+    size_t sz;
+    int c;
+
+    if (!gbl_comdb2ma_tcache) {
+        /* turned off, drain what we have */
+        if ((tc = t_tcache) != NULL && tc != COMDB2MA_TC_DEAD && tc->bytes != 0)
+            tcache_flush(tc);
+        return 0;
+    }
+
+    if (COMDB2MA_ISDEBUG(p))
+        return 0;
+
+    sz = comdb2_malloc_usable_size(p);
+    if (sz > COMDB2MA_TC_MAX_USABLE || (tc = tcache_get()) == NULL ||
+        (c = tc_class_down[sz >> 4]) < 0)
+        return 0;
+
+    slot = &tc->slots[COMDB2MA_TC_SLOT(cm)];
+    if (slot->cm != cm) {
+        tcache_flush_slot(tc, slot);
+        slot->cm = cm;
+    }
+
+    bin = &slot->bins[c];
+    p[0] = bin->head;
+    bin->head = p;
+    ++bin->count;
+    slot->bytes += tc_sizes[c];
+    tc->bytes += tc_sizes[c];
+    ++tc->frees;
+
+    if (bin->count > COMDB2MA_TC_BIN_MAX(c))
+        tcache_flush_bin(tc, slot, c, bin->count / 2);
+    if (tc->bytes > (size_t)gbl_comdb2ma_tcache_size) {
+        tcache_flush_slot(tc, slot);
+        if (tc->bytes > (size_t)gbl_comdb2ma_tcache_size)
+            tcache_flush(tc);
+    }
+    return 1;
+}
+
+/* bytes of `cm' sitting in thread caches */
+static size_t tcache_cached_bytes(comdb2ma cm)
+{
+    struct tcache *tc;
+    size_t bytes = 0;
+    int i;
+
+    Pthread_mutex_lock(&tcache_lock);
+    LISTC_FOR_EACH(&tcaches, tc, lnk)
+    {
+        i = COMDB2MA_TC_SLOT(cm);
+        if (tc->pub.cm[i] == cm)
+            bytes += tc->pub.slot_bytes[i];
+    }
+    Pthread_mutex_unlock(&tcache_lock);
+    return bytes;
+}
+
+int comdb2ma_tcache_usages(comdb2ma_tcache_usage **pusages, int *n)
+{
+    struct tcache *tc;
+    comdb2ma_tcache_usage *usages;
+
+    Pthread_once(&tcache_once, tcache_init_once);
+    Pthread_mutex_lock(&tcache_lock);
+    *n = listc_size(&tcaches);
+    *pusages = usages = calloc(*n ? *n : 1, sizeof(comdb2ma_tcache_usage));
+    if (usages == NULL) {
+        Pthread_mutex_unlock(&tcache_lock);
+        *n = 0;
+        return ENOMEM;
+    }
+    LISTC_FOR_EACH(&tcaches, tc, lnk)
+    {
+        usages->tid = (uint64_t)(uintptr_t)tc->tid;
+        strncpy(usages->scope_str, tc->thr_type, sizeof(usages->scope_str) - 1);
+        usages->scope = usages->scope_str;
+        usages->cached = tc->pub.bytes;
+        usages->hits = tc->pub.hits;
+        usages->misses = tc->pub.misses;
+        usages->frees = tc->pub.frees;
+        usages->flushes = tc->pub.flushes;
+        ++usages;
+    }
+    Pthread_mutex_unlock(&tcache_lock);
+    return 0;
+}
+// thread cache$
+
 //^root
 int comdb2ma_init(size_t init_sz, size_t max_cap)
 {
@@ -447,7 +820,9 @@ int comdb2ma_init(size_t init_sz, size_t max_cap)
                     NULL, COMDB2MA_MT_SAFE, NULL, NULL, __FILE__, __func__,
                     __LINE__);
 
-                if (COMDB2_STATIC_MAS[i] == NULL) {
+                if (COMDB2_STATIC_MAS[i] != NULL)
+                    COMDB2_STATIC_MAS[i]->tcache = 1;
+                else {
                     /* oops. rollback all previous progress */
                     rc = errno;
                     for (--i; i != 0; --i) {
@@ -578,17 +953,22 @@ int comdb2ma_usages(comdb2ma_usage **pusages, int *n)
         rc = EPERM;
     else {
         *n = cnt = listc_size(&(root.list));
+        t_tcache_noflush = 1;
         *pusages = usages = comdb2_calloc_static(1, cnt, sizeof(comdb2ma_usage));
+        t_tcache_noflush = 0;
 
         LISTC_FOR_EACH(&(root.list), curr, lnk) {
             info = comdb2_mallinfo(curr);
+            usages->cached = curr->tcache ? tcache_cached_bytes(curr) : 0;
             strncpy(usages->name_str, curr->name, sizeof(usages->name_str) - 1);
             usages->name = usages->name_str;
             strncpy(usages->scope_str, curr->thr_type, sizeof(usages->scope_str) - 1);
             usages->scope = usages->scope_str;
             usages->peak = info.usmblks;
             usages->total = info.fordblks + info.uordblks;
-            usages->used = info.uordblks;
+            if (usages->cached > info.uordblks)
+                usages->cached = info.uordblks;
+            usages->used = info.uordblks - usages->cached;
             usages->unused = info.fordblks;
             ++usages;
         }
@@ -664,6 +1044,9 @@ int comdb2ma_release(void)
     if (root.m == NULL)
         rc = EPERM;
     else {
+        /* have threads return their cached blocks */
+        ATOMIC_ADD32(tcache_epoch, 1);
+
         /* release all lock-protected mspaces */
         LISTC_FOR_EACH(&(root.list), curpos, lnk)
         {
@@ -792,6 +1175,10 @@ void *comdb2_malloc(comdb2ma cm, size_t size)
     if (size > COMDB2MA_MAX_MEM) {
         // force failure if integer overflow
         errno = ENOMEM;
+    } else if (cm->tcache && gbl_comdb2ma_tcache &&
+               size <= COMDB2MA_TC_MAX_SIZE && !(d && cm->debug) &&
+               (out = tcache_take(cm, &size)) != NULL) {
+        /* served by the thread cache */
     } else if (COMDB2MA_LOCK(cm) == 0) {
         if (!COMDB2MA_FULL(cm))
             out = mspace_malloc(cm->m, size + COMDB2MA_OVERHEAD(d));
@@ -837,8 +1224,15 @@ void *comdb2_calloc(comdb2ma cm, size_t n, size_t size)
     if (n && size && COMDB2MA_MAX_MEM / n < size) {
         // force failure if integer overflow
         errno = ENOMEM;
+        return NULL;
+    }
+
+    nb = n * size;
+    if (cm->tcache && gbl_comdb2ma_tcache && nb <= COMDB2MA_TC_MAX_SIZE &&
+        !(d && cm->debug) && (out = tcache_take(cm, &nb)) != NULL) {
+        /* served by the thread cache */
+        memset(out, 0, nb);
     } else if (COMDB2MA_LOCK(cm) == 0) {
-        nb = n * size;
         if (!COMDB2MA_FULL(cm))
             out = mspace_calloc(cm->m, 1, nb + COMDB2MA_OVERHEAD(d));
 
@@ -974,14 +1368,17 @@ void *comdb2_resize(comdb2ma cm, void *ptr, size_t n)
     return (void *)out;
 }
 
-static void comdb2_free_int(comdb2ma cm, void *ptr)
+static void comdb2_free_list_int(comdb2ma cm, void **head, size_t n)
 {
-    void **p = (void **)ptr;
+    void **p;
 
     if (COMDB2MA_LOCK(cm) == 0) {
-        mspace_free(cm->m, p + COMDB2MA_SENTINEL_OFS);
+        while ((p = head) != NULL) {
+            head = (void **)p[0];
+            mspace_free(cm->m, p + COMDB2MA_SENTINEL_OFS);
+        }
 #ifdef PER_THREAD_MALLOC
-        --cm->refs;
+        cm->refs -= n;
 
         /*
          * We must use (cm->nthds == 0) instead of (cm->nthds == 1) because
@@ -1026,6 +1423,13 @@ static void comdb2_free_int(comdb2ma cm, void *ptr)
     }
 }
 
+static void comdb2_free_int(comdb2ma cm, void *ptr)
+{
+    void **p = (void **)ptr;
+    p[0] = NULL;
+    comdb2_free_list_int(cm, p, 1);
+}
+
 void comdb2_free(void *ptr)
 {
     comdb2ma cm;
@@ -1041,10 +1445,10 @@ void comdb2_free(void *ptr)
         } else {
             cm = COMDB2MA_ALLOCATOR(p);
 
-            if (cm->bm == NULL)
-                comdb2_free_int(cm, ptr);
-            else
+            if (cm->bm != NULL)
                 comdb2_bfree(cm->bm, ptr);
+            else if (!cm->tcache || !tcache_put(cm, p))
+                comdb2_free_int(cm, ptr);
         }
     }
 }
@@ -1257,6 +1661,7 @@ static comdb2ma comdb2ma_create_int(void *base, size_t init_sz, size_t max_cap,
     out->line = line;
 
     out->debug = (debug_master_switch | debug_switches[find_switch_index(name)]);
+    out->tcache = 0;
 
 #ifdef PER_THREAD_MALLOC
     out->refs = 0;
@@ -1355,6 +1760,7 @@ static comdb2ma get_area(int indx)
                         __FILE__, __func__, __LINE__);
                     zone[indx]->onfreelist = indx;
                     zone[indx]->debug = (debug_master_switch | debug_switches[indx]);
+                    zone[indx]->tcache = 1;
                     listc_abl(&root.busylist[indx], zone[indx]);
                 } else {
                     /* Reached the limit. Grab one from busylist. */
@@ -3008,3 +3414,37 @@ void comdb2ma_debug_show_config(void)
     logmsg(LOGMSG_USER, "\n");
 }
 #endif /* COMDB2MA_OMIT_DEBUG */
+
+/* Memory accounts */
+__thread comdb2ma_acct *comdb2ma_thd_acct;
+
+void comdb2ma_acct_add(comdb2ma_acct *acct, int64_t n)
+{
+    int64_t used, peak;
+
+    used = ATOMIC_ADD64(acct->used, n);
+    if (n <= 0) {
+        /* the rest was charged to an earlier account */
+        while (used < 0 && !CAS64(acct->used, used, 0))
+            used = ATOMIC_LOAD64(acct->used);
+        return;
+    }
+    do {
+        peak = ATOMIC_LOAD64(acct->peak);
+        if (used <= peak)
+            return;
+    } while (!CAS64(acct->peak, peak, used));
+
+    if (acct->notify != NULL && used >= ATOMIC_LOAD64(acct->notify_at))
+        acct->notify(acct);
+}
+
+uint32_t comdb2ma_acct_new_epoch(void)
+{
+    static uint32_t epoch;
+    uint32_t e;
+
+    while ((e = ATOMIC_ADD32(epoch, 1)) == 0)
+        ;
+    return e;
+}
@@ -21,6 +21,7 @@
 #define INCLUDED_MEM_H
 
 #include <stddef.h>
+#include <stdint.h>
 #include <pthread.h>
 
 #define COMDB2MA_UNLIMITED 0
@@ -189,6 +190,7 @@ typedef struct comdb2ma_usage {
     size_t used;
     size_t unused;
     size_t total;
+    size_t cached; /* freed, but held by thread caches. not in `used' */
 } comdb2ma_usage;
 
 /*
@@ -200,6 +202,27 @@ typedef struct comdb2ma_usage {
 */
 int comdb2ma_usages(comdb2ma_usage **usages, int *n);
 
+typedef struct comdb2ma_tcache_usage {
+    uint64_t tid;
+    char *scope;
+    char scope_str[16];
+    size_t cached;
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t frees;
+    uint64_t flushes;
+} comdb2ma_tcache_usage;
+
+/*
+** Retrieve statistics of the per-thread caches of small blocks.
+** The caller frees `usages' with free().
+**
+** PARAMETERS
+** usages - output
+** n      - number of threads
+*/
+int comdb2ma_tcache_usages(comdb2ma_tcache_usage **usages, int *n);
+
 /*
 ** Change allocator niceness.
 **
@@ -747,4 +770,51 @@ int comdb2ma_debug_off(const char *);
 void comdb2ma_debug_show_config(void);
 #endif /* COMDB2MA_OMIT_DEBUG */
 
+/*
+** Memory accounts.
+**
+** A thread may set an account with comdb2ma_acct_set(). Code which knows the
+** size of what it allocates and frees (the sqlite heap, lua states, in-memory
+** temp tables) then charges it with comdb2ma_acct_charge(). The sql threads
+** keep one account per query. An account may be charged by several threads.
+**
+** Memory may outlive the query which allocated it (the statement cache, lua
+** states) and be freed under a later one. Where it can, code remembers the
+** `epoch' of the account it charged, and gives the memory back with
+** comdb2ma_acct_uncharge(), which does nothing if the current account is a
+** different one. Other frees can't take `used' below 0. `notify' is called,
+** if set, whenever `peak' reaches `notify_at'; it may move `notify_at'
+** further.
+*/
+typedef struct comdb2ma_acct {
+    int64_t used;
+    int64_t peak;
+    int64_t notify_at;
+    uint32_t epoch; /* from comdb2ma_acct_new_epoch(), never 0 */
+    void (*notify)(struct comdb2ma_acct *);
+} comdb2ma_acct;
+
+extern __thread comdb2ma_acct *comdb2ma_thd_acct;
+
+void comdb2ma_acct_add(comdb2ma_acct *acct, int64_t n);
+uint32_t comdb2ma_acct_new_epoch(void);
+
+#define comdb2ma_acct_set(acct) (comdb2ma_thd_acct = (acct))
+
+#define comdb2ma_acct_charge(n)                                                \
+    do {                                                                       \
+        if (comdb2ma_thd_acct != NULL)                                         \
+            comdb2ma_acct_add(comdb2ma_thd_acct, (n));                         \
+    } while (0)
+
+/* Epoch of the current account, or 0 if there isn't one */
+#define comdb2ma_acct_epoch()                                                  \
+    (comdb2ma_thd_acct != NULL ? comdb2ma_thd_acct->epoch : 0)
+
+#define comdb2ma_acct_uncharge(epoch, n)                                       \
+    do {                                                                       \
+        if ((epoch) != 0 && comdb2ma_acct_epoch() == (epoch))                  \
+            comdb2ma_acct_add(comdb2ma_thd_acct, -(int64_t)(n));               \
+    } while (0)
+
 #endif /* INCLUDED_MEM_H */
@@ -1276,7 +1276,8 @@ void net_userfunc_iterate(netinfo_type *netinfo_ptr, UFUNCITERFP *uf_iter,
             uf_iter(netinfo_ptr, arg, netinfo_ptr->service,
                     netinfo_ptr->userfuncs[i].name,
                     netinfo_ptr->userfuncs[i].count,
-                    netinfo_ptr->userfuncs[i].totus);
+                    netinfo_ptr->userfuncs[i].totus,
+                    netinfo_ptr->userfuncs[i].bytes);
         }
     }
 }
@@ -1309,6 +1310,7 @@ int net_register_handler(netinfo_type *netinfo_ptr, int usertype,
     netinfo_ptr->userfuncs[usertype].name = name;
     netinfo_ptr->userfuncs[usertype].totus = 0;
     netinfo_ptr->userfuncs[usertype].count = 0;
+    netinfo_ptr->userfuncs[usertype].bytes = 0;
 
     return 0;
 }
@@ -3143,11 +3145,8 @@ int net_get_nodes_info(netinfo_type *netinfo_ptr, int max_nodes,
     return count;
 }
 
-int net_get_host_network_usage(netinfo_type *netinfo_ptr, const char *host,
-                               unsigned long long *written,
-                               unsigned long long *read,
-                               unsigned long long *throttle_waits,
-                               unsigned long long *reorders)
+static host_node_type *get_usage_host(netinfo_type *netinfo_ptr,
+                                      const char *host)
 {
     host_node_type *ptr;
 
@@ -3158,6 +3157,17 @@ int net_get_host_network_usage(netinfo_type *netinfo_ptr, const char *host,
     }
     Pthread_rwlock_unlock(&(netinfo_ptr->lock));
 
+    return ptr;
+}
+
+int net_get_host_network_usage(netinfo_type *netinfo_ptr, const char *host,
+                               unsigned long long *written,
+                               unsigned long long *read,
+                               unsigned long long *throttle_waits,
+                               unsigned long long *reorders)
+{
+    host_node_type *ptr = get_usage_host(netinfo_ptr, host);
+
     if (ptr == NULL)
         return -1;
 
@@ -3181,6 +3191,23 @@ int net_get_network_usage(netinfo_type *netinfo_ptr,
     return 0;
 }
 
+int net_get_host_message_usage(netinfo_type *netinfo_ptr, const char *host,
+                               unsigned long long *msgs_written,
+                               unsigned long long *msgs_read,
+                               unsigned long long *write_calls)
+{
+    host_node_type *ptr = get_usage_host(netinfo_ptr, host);
+
+    if (ptr == NULL)
+        return -1;
+
+    *msgs_written = ptr->stats.msgs_written;
+    *msgs_read = ptr->stats.msgs_read;
+    *write_calls = ptr->stats.write_calls;
+
+    return 0;
+}
+
 int get_host_port(netinfo_type *netinfo)
 {
     Pthread_rwlock_rdlock(&(netinfo->lock));
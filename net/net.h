@@ -80,7 +80,7 @@ typedef void QSTATDUMPFP(struct netinfo_struct *netinfo, void *netstat,
                          FILE *f);
 typedef void UFUNCITERFP(struct netinfo_struct *netinfo, void *arg,
                          char *service, char *userfunc, int64_t count,
-                         int64_t totus);
+                         int64_t totus, int64_t bytes);
 
 typedef int NETALLOWFP(struct netinfo_struct *netinfo, const char *hostname);
 
@@ -345,6 +345,17 @@ int net_get_network_usage(netinfo_type *netinfo_ptr,
                           unsigned long long *throttle_waits,
                           unsigned long long *reorders);
 
+int net_get_host_message_usage(netinfo_type *netinfo_ptr, const char *host,
+                               unsigned long long *msgs_written,
+                               unsigned long long *msgs_read,
+                               unsigned long long *write_calls);
+
+/* "net_reader_policy" / "net_writer_policy" tunables */
+void *net_reader_policy_value(void *);
+int net_reader_policy_update(void *, void *);
+void *net_writer_policy_value(void *);
+int net_writer_policy_update(void *, void *);
+
 int net_get_queue_size(netinfo_type *netinfo_type, const char *host, int *limit,
                        int *usage);
 
@@ -48,6 +48,7 @@
 #include <comdb2buf.h>
 #include <compat.h>
 #include <connectmsg.pb-c.h>
+#include <epochlib.h>
 #include <hostname_support.h>
 #include <intern_strings.h>
 #include <logmsg.h>
@@ -61,6 +62,7 @@
 #include <net_int.h>
 #include <plhash_glue.h>
 #include <portmuxapi.h>
+#include <segstr.h>
 #include <ssl_bend.h>
 #include <ssl_evbuffer.h>
 #include <ssl_glue.h>
@@ -157,6 +159,53 @@ static struct policy_info single;
 static pthread_t base_thd;
 static struct event_base *base;
 
+static const char *policy_names[] = {
+    [POLICY_NONE] = "none",
+    [POLICY_SINGLE] = "single",
+    [POLICY_PER_NET] = "per_net",
+    [POLICY_PER_HOST] = "per_host",
+    [POLICY_PER_EVENT] = "per_event",
+};
+
+static int policy_update(enum policy *policy, void *value)
+{
+    if (base) {
+        logmsg(LOGMSG_ERROR, "net policy can only be changed before net starts\n");
+        return 1;
+    }
+    int st = 0, ltok;
+    char *line = value;
+    char *tok = segtok(line, strlen(line), &st, &ltok);
+    for (int i = 0; i < sizeof(policy_names) / sizeof(policy_names[0]); ++i) {
+        if (tokcmp(tok, ltok, policy_names[i]) == 0) {
+            *policy = i;
+            return 0;
+        }
+    }
+    logmsg(LOGMSG_ERROR, "unknown net policy:%.*s (none, single, per_net, per_host, per_event)\n", ltok, tok);
+    return 1;
+}
+
+void *net_reader_policy_value(void *unused)
+{
+    return (void *)policy_names[reader_policy];
+}
+
+int net_reader_policy_update(void *unused, void *value)
+{
+    return policy_update(&reader_policy, value);
+}
+
+void *net_writer_policy_value(void *unused)
+{
+    return (void *)policy_names[writer_policy];
+}
+
+int net_writer_policy_update(void *unused, void *value)
+{
+    return policy_update(&writer_policy, value);
+}
+
 static pthread_t timer_thd;
 static struct event_base *timer_base;
 static struct timeval timer_tick;
@@ -174,23 +223,10 @@ static pthread_t appsock_thd[NUM_APPSOCK_RD];
 static struct event_base *appsock_base[NUM_APPSOCK_RD];
 static struct timeval appsock_tick[NUM_APPSOCK_RD];
 
-#define get_rd_policy()                                                        \
-    ({                                                                         \
-        struct policy_info *f = NULL;                                          \
-        switch (reader_policy) {                                               \
-        case POLICY_NONE:                                                      \
-        case POLICY_SINGLE: f = &single; break;                                \
-        case POLICY_PER_NET: f = &e->net_info->per_net; break;                 \
-        case POLICY_PER_HOST: f = &e->host_info->per_host; break;              \
-        case POLICY_PER_EVENT: f = &e->per_event; break;                       \
-        }                                                                      \
-        f;                                                                     \
-    })
-
-#define get_wr_policy()                                                        \
+#define get_policy(policy)                                                     \
     ({                                                                         \
         struct policy_info *f = NULL;                                          \
-        switch (writer_policy) {                                               \
+        switch (policy) {                                                      \
         case POLICY_NONE:                                                      \
         case POLICY_SINGLE: f = &single; break;                                \
         case POLICY_PER_NET: f = &e->net_info->per_net; break;                 \
@@ -200,11 +236,11 @@ static struct timeval appsock_tick[NUM_APPSOCK_RD];
         f;                                                                     \
     })
 
-#define rd_thd ({ get_rd_policy()->rdthd; })
-#define rd_base ({ get_rd_policy()->rdbase; })
+#define rd_thd ({ get_policy(reader_policy)->rdthd; })
+#define rd_base ({ get_policy(reader_policy)->rdbase; })
 
-#define wr_thd ({ get_wr_policy()->wrthd; })
-#define wr_base ({ get_wr_policy()->wrbase; })
+#define wr_thd ({ get_policy(writer_policy)->wrthd; })
+#define wr_base ({ get_policy(writer_policy)->wrbase; })
 
 #define check_base_thd() check_thd(base_thd)
 #define check_timer_thd() check_thd(timer_thd)
@@ -1181,6 +1217,10 @@ static void writecb(int fd, short what, void *data)
             return;
         }
         e->sent_at = time(NULL);
+        if (e->host_node_ptr) {
+            ++e->host_node_ptr->stats.write_calls;
+        }
+        ++e->net_info->netinfo_ptr->stats.write_calls;
         Pthread_mutex_lock(&e->wr_lk);
         evbuffer_add_buffer(e->wr_buf, e->flush_buf);
         len = evbuffer_get_length(e->wr_buf);
@@ -1255,7 +1295,16 @@ static int process_user_msg(struct event_info *e)
         .fromhost = host,
         .netinfo = netinfo_ptr,
     };
+    userfunc_t *uf = &netinfo_ptr->userfuncs[msg->usertype];
+    int64_t start = comdb2_time_epochus();
     func(&ack, usrptr, host, host_interned, msg->usertype, e->rd_buf, msg->datalen, 1);
+    ATOMIC_ADD64(uf->totus, comdb2_time_epochus() - start);
+    ATOMIC_ADD64(uf->count, 1);
+    ATOMIC_ADD64(uf->bytes, msg->datalen);
+    if (e->host_node_ptr) {
+        ++e->host_node_ptr->stats.msgs_read;
+    }
+    ++netinfo_ptr->stats.msgs_read;
     message_done(e);
     return 0;
 }
@@ -1946,6 +1995,10 @@ static void readcb(int fd, short what, void *data)
     if (n > 0) {
         check_rd_full(e);
         e->recv_at = time(NULL);
+        if (e->host_node_ptr) {
+            e->host_node_ptr->stats.bytes_read += n;
+        }
+        e->net_info->netinfo_ptr->stats.bytes_read += n;
         Pthread_cond_signal(&e->rd_cond); // -> rd_worker()
     } else {
         do_disable_read(e);
@@ -3972,7 +4025,9 @@ int write_list_evbuffer(host_node_type *host_node_ptr, int type, const struct io
     }
     if (rc==0) {
         e->net_info->netinfo_ptr->stats.bytes_written += total;
+        ++e->net_info->netinfo_ptr->stats.msgs_written;
         host_node_ptr->stats.bytes_written += total;
+        ++host_node_ptr->stats.msgs_written;
         update_host_net_queue_stats(host_node_ptr, 1, total);
     }
     Pthread_mutex_unlock(&e->wr_lk);
@@ -4026,9 +4081,11 @@ int net_send_all_evbuffer(netinfo_type *netinfo_ptr, int n, void **buf, int *len
         Pthread_mutex_unlock(&e->wr_lk);
         if (e->host_node_ptr) {
             e->host_node_ptr->stats.bytes_written += sz;
+            e->host_node_ptr->stats.msgs_written += n;
             update_host_net_queue_stats(e->host_node_ptr, 1, sz);
         }
         netinfo_ptr->stats.bytes_written += sz;
+        netinfo_ptr->stats.msgs_written += n;
     }
     if (msg) {
         for (int i = 0; i < n; ++i) {
@@ -135,6 +135,9 @@ typedef struct {
     unsigned long long bytes_read;
     unsigned long long throttle_waits;
     unsigned long long reorders;
+    unsigned long long msgs_written;
+    unsigned long long msgs_read;
+    unsigned long long write_calls; /* writev() batches flushed to socket */
 } stats_type;
 
 typedef struct net_send_message_header {
@@ -216,6 +219,7 @@ typedef struct userfunc_info {
     char *name;
     int64_t count;
     int64_t totus;
+    int64_t bytes;
 } userfunc_t;
 
 struct net_info;
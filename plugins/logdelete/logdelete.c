@@ -25,6 +25,7 @@ int gbl_debug_block_comdb2ar = 0;
 
 /* Forward declaration */
 comdb2_appsock_t logdelete3_plugin;
+comdb2_appsock_t logdelete4_plugin;
 
 static int handle_logdelete_request(comdb2_appsock_arg_t *arg)
 {
@@ -74,7 +75,9 @@ static int handle_logdelete_request(comdb2_appsock_arg_t *arg)
     cdb2buf_flush(sb);
 
     if (strncmp(logdelete3_plugin.name, arg->cmdline,
-                strlen(logdelete3_plugin.name)) == 0) {
+                strlen(logdelete3_plugin.name)) == 0 ||
+        strncmp(logdelete4_plugin.name, arg->cmdline,
+                strlen(logdelete4_plugin.name)) == 0) {
         rc = bdb_recovery_start_lsn(thedb->bdb_env, recovery_lsn,
                                     sizeof(recovery_lsn));
         if (rc) {
@@ -120,6 +123,31 @@ static int handle_logdelete_request(comdb2_appsock_arg_t *arg)
                    recovery_command);
             cdb2buf_printf(sb, "%s\n", recovery_command);
             cdb2buf_flush(sb);
+        } else if (strcmp(tok, "changed_pages") == 0) {
+            /* logdelete4: changed pages for incremental backups.  The
+             * snapshot names the chain of increments that acknowledged the
+             * last one, and an ack names its chain. */
+            char chain[65] = {0};
+            int valid = 0;
+            tok = strtok_r(NULL, delims, &lasts);
+            if (tok && strcmp(tok, "snapshot") == 0) {
+                rc = bdb_changed_pages_snapshot(thedb->bdb_env, &valid, chain,
+                                                sizeof(chain));
+                if (rc)
+                    logmsg(LOGMSG_ERROR, "changed pages snapshot rc %d\n", rc);
+                cdb2buf_printf(sb, "changed pages %s%s%s\n",
+                               rc ? "unavailable" : valid ? "valid" : "invalid",
+                               chain[0] ? " " : "", chain);
+                cdb2buf_flush(sb);
+            } else if (tok && strcmp(tok, "ack") == 0) {
+                tok = strtok_r(NULL, delims, &lasts);
+                rc = bdb_changed_pages_ack(thedb->bdb_env, tok);
+                if (rc)
+                    logmsg(LOGMSG_ERROR, "changed pages ack rc %d\n", rc);
+            } else {
+                logmsg(LOGMSG_ERROR, "logdelete thread got bad changed_pages <%s>\n",
+                       tok ? tok : "");
+            }
         } else {
             logmsg(LOGMSG_ERROR, "logdelete2 thread got unknown token <%s>\n",
                    tok);
@@ -185,4 +213,12 @@ comdb2_appsock_t logdelete3_plugin = {
     handle_logdelete_request /* Handler function */
 };
 
+comdb2_appsock_t logdelete4_plugin = {
+    "logdelete4",            /* Name */
+    "",                      /* Usage info */
+    0,                       /* Execution count */
+    0,                       /* Flags */
+    handle_logdelete_request /* Handler function */
+};
+
 #include "plugin.h"
@@ -386,10 +386,30 @@ static inline int newsql_to_client_type(int newsql_type)
         return -1;
     }
 }
+/* Record the column names and rows of a result for the result cache */
+static void newsql_cache_response(struct sqlclntstate *clnt, const CDB2SQLRESPONSE *r, int h)
+{
+    if (h != RESPONSE_HEADER__SQL_RESPONSE ||
+        (r->response_type != RESPONSE_TYPE__COLUMN_NAMES && r->response_type != RESPONSE_TYPE__COLUMN_VALUES))
+        return;
+    size_t len = cdb2__sqlresponse__get_packed_size(r);
+    uint8_t *out = sql_rcache_fill_append(clnt->rcache_fill, sizeof(struct newsqlheader) + len,
+                                          r->response_type == RESPONSE_TYPE__COLUMN_VALUES);
+    if (out == NULL)
+        return;
+    struct newsqlheader hdr = {0};
+    hdr.type = htonl(h);
+    hdr.length = htonl(len);
+    memcpy(out, &hdr, sizeof(hdr));
+    cdb2__sqlresponse__pack(r, out + sizeof(hdr));
+}
+
 static int newsql_response_int(struct sqlclntstate *clnt, const CDB2SQLRESPONSE *r, int h, int flush)
 {
     struct newsql_appdata *appdata = clnt->appdata;
     clnt->lastresptype = r->response_type;
+    if (clnt->rcache_fill)
+        newsql_cache_response(clnt, r, h);
     return appdata->write(clnt, h, 0, r, flush); /* newsql_write_evbuffer */
 }
 
@@ -1152,6 +1172,15 @@ static int newsql_raw_payload(struct sqlclntstate *c, void *a) {
     return newsql_response_int(c, &r, RESPONSE_HEADER__SQL_RESPONSE_RAW, 0);
 }
 
+static int newsql_cached_rows(struct sqlclntstate *clnt, struct sql_rcache_ent *ent)
+{
+    struct newsql_appdata *appdata = clnt->appdata;
+    size_t len;
+    const void *data = sql_rcache_ent_data(ent, &len);
+    clnt->lastresptype = sql_rcache_ent_nrows(ent) ? RESPONSE_TYPE__COLUMN_VALUES : RESPONSE_TYPE__COLUMN_NAMES;
+    return appdata->write_raw(clnt, data, len); /* newsql_write_raw_evbuffer */
+}
+
 static int newsql_write_response(struct sqlclntstate *c, int t, void *a, int i)
 {
     switch (t) {
@@ -1188,6 +1217,7 @@ static int newsql_write_response(struct sqlclntstate *c, int t, void *a, int i)
         return 0;
     case RESPONSE_ROW_REMTRAN: return newsql_row_remtran(c, a, i);
     case RESPONSE_RAW_PAYLOAD: return newsql_raw_payload(c, a);
+    case RESPONSE_CACHED_ROWS: return newsql_cached_rows(c, a);
     default:
         abort();
     }
@@ -1485,6 +1515,14 @@ static int newsql_has_parallel_sql(struct sqlclntstate *clnt)
     return !gbl_dohsql_disable;
 }
 
+/* Can results be replayed to this client byte for byte? */
+static int newsql_cache_results(struct sqlclntstate *clnt)
+{
+    struct newsql_appdata *appdata = clnt->appdata;
+    return !appdata->sqlquery->n_types && appdata->protocol_version != NEWSQL_PROTOCOL_COMPAT &&
+           !endianness_mismatch(clnt) && !is_pingpong(clnt);
+}
+
 static void newsql_add_steps(struct sqlclntstate *clnt, double steps)
 {
     gbl_nnewsql_steps += steps;
@@ -2604,6 +2642,7 @@ void newsql_setup_clnt(struct sqlclntstate *clnt)
     appdata->send_intrans_response = 1;
     update_col_info(&appdata->col_info, 32);
     plugin_set_callbacks(clnt, newsql);
+    clnt->plugin.cache_results = newsql_cache_results;
 }
 
 void newsql_effects(CDB2SQLRESPONSE *r, CDB2EFFECTS *e, struct sqlclntstate *clnt)
@@ -61,6 +61,7 @@ typedef enum {
     int (*write_dbinfo)(struct sqlclntstate *);                                \
     int (*write_hdr)(struct sqlclntstate *, int type, int state);              \
     int (*write_postponed)(struct sqlclntstate *);                             \
+    int (*write_raw)(struct sqlclntstate *, const void *, size_t);             \
     CDB2QUERY *query;                                                          \
     CDB2SQLQUERY *sqlquery;                                                    \
     int8_t send_intrans_response;                                              \
@@ -91,6 +92,11 @@ void newsql_set_client_info(struct sqlclntstate *, CDB2SQLQUERY *, int initial);
 int newsql_is_newsql(struct sqlclntstate *clnt);
 void *newsql_get_identity(struct sqlclntstate *clnt);
 
+struct appsock_handler_arg;
+/* Set up a newsql connection which has already sent its appsock line */
+void newsql_accept_evbuffer(struct appsock_handler_arg *);
+void newsql_mux_init(void);
+
 #define plugin_set_callbacks_newsql(name)                                      \
     clnt->plugin.close = newsql_close##_##name;                                \
     clnt->plugin.destroy_stmt = newsql_destroy_stmt##_##name;                  \
@@ -106,7 +112,8 @@ void *newsql_get_identity(struct sqlclntstate *clnt);
     appdata->write = newsql_write##_##name;                                    \
     appdata->write_dbinfo = newsql_write_dbinfo##_##name;                      \
     appdata->write_hdr = newsql_write_hdr##_##name;                            \
-    appdata->write_postponed = newsql_write_postponed##_##name;
+    appdata->write_postponed = newsql_write_postponed##_##name;                \
+    appdata->write_raw = newsql_write_raw##_##name;
 
 int leader_is_new(void);
 #endif /* INCLUDED_NEWSQL_H */
@@ -1239,6 +1239,8 @@ struct newsql_pack_arg {
     int resp_len;
     const CDB2SQLRESPONSE *resp;
     struct newsqlheader *hdr;
+    const void *raw; /* responses already packed */
+    size_t raw_len;
 };
 
 static int newsql_pack_small(struct sqlwriter *writer, struct newsql_pack_arg *arg)
@@ -1285,6 +1287,10 @@ static int newsql_pack(struct sqlwriter *sqlwriter, void *data)
         return newsql_pack_small(sqlwriter, arg);
     }
     struct pb_evbuffer_appender appender = PB_EVBUFFER_APPENDER_INIT(sqlwriter);
+    if (arg->raw) {
+        pb_evbuffer_append(&appender.vbuf, arg->raw_len, arg->raw);
+        return appender.rc ? -1 : 0;
+    }
     if (arg->hdr) {
         pb_evbuffer_append(&appender.vbuf, sizeof(struct newsqlheader), (const uint8_t *)arg->hdr);
         if (appender.rc != 0)
@@ -1357,6 +1363,15 @@ static int newsql_write_postponed_evbuffer(struct sqlclntstate *clnt)
     return sql_writev(appdata->writer, v, 2);
 }
 
+static int newsql_write_raw_evbuffer(struct sqlclntstate *clnt, const void *data, size_t len)
+{
+    struct newsql_pack_arg arg = {0};
+    arg.appdata = clnt->appdata;
+    arg.raw = data;
+    arg.raw_len = len;
+    return sql_write(arg.appdata->writer, &arg, 0);
+}
+
 static int newsql_write_dbinfo_evbuffer(struct sqlclntstate *clnt)
 {
     struct newsql_appdata_evbuffer *appdata = clnt->appdata;
@@ -1495,12 +1510,18 @@ static void gethostname_enqueue(int fd, short what, void *data)
     Pthread_mutex_unlock(&gethostname_lk);
 }
 
+void newsql_accept_evbuffer(struct appsock_handler_arg *arg)
+{
+    gethostname_enqueue(-1, 0, arg);
+}
+
 static int newsql_init(void *arg)
 {
     dispatch_base = get_dispatch_event_base();
     Pthread_create(&gethostname_thd, NULL, gethostname_fn, NULL);
     add_appsock_handler("newsql\n", gethostname_enqueue);
     add_appsock_handler("@newsql\n", gethostname_enqueue);
+    newsql_mux_init();
     return 0;
 }
 
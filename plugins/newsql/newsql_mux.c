@@ -0,0 +1,347 @@
+/*
+   Copyright 2026 Bloomberg Finance L.P.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+/*
+ * Multiplexed newsql connections (see newsql_mux.h).
+ *
+ * Each session of a multiplexed connection is given one end of a socket
+ * pair, which is set up as a newsql connection of its own: it has its own
+ * sqlclntstate, and takes an appsock slot like any other connection, on top
+ * of the one the multiplexed connection itself holds.  The multiplexed connection relays bytes between its frames
+ * and the other ends of the socket pairs.  Everything runs on the appsock
+ * base the connection was accepted on.
+ *
+ * A session whose replies can't be sent because the connection is backed up
+ * is not read until the connection drains.  Likewise, the connection is not
+ * read while a session is slow to take the requests relayed to it.
+ */
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+
+#include <event2/buffer.h>
+#include <event2/event.h>
+#include <event2/util.h>
+
+#include <comdb2_atomic.h>
+#include <logmsg.h>
+#include <net_appsock.h>
+#include <newsql_mux.h>
+#include <plhash_glue.h>
+#include <sql.h>
+#include <sys_wrap.h>
+
+#include <newsql.h>
+
+int gbl_newsql_mux = 1;
+int32_t gbl_newsql_mux_conns;
+int32_t gbl_newsql_mux_sessions;
+
+/* Stop reading sessions while this much is waiting to be sent, and the
+ * connection while this much is waiting for one session */
+#define NEWSQL_MUX_HIGH_WATER (4 * 1024 * 1024)
+
+#define would_block() (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)
+
+struct mux_conn;
+
+struct mux_session {
+    uint32_t id; /* hash key, must be first */
+    int fd;
+    int closing; /* close once wr_buf is written */
+    struct mux_conn *mux;
+    struct evbuffer *wr_buf;
+    struct event *rd_ev;
+    struct event *wr_ev;
+    TAILQ_ENTRY(mux_session) entry;
+};
+
+struct mux_conn {
+    int fd;
+    int secure;
+    int paused; /* sessions are not read */
+    struct mux_session *rd_blocked; /* not read until its wr_buf drains */
+    pthread_t thd;
+    struct sockaddr_in addr;
+    struct event_base *base;
+    struct evbuffer *rd_buf;
+    struct evbuffer *wr_buf;
+    struct event *rd_ev;
+    struct event *wr_ev;
+    hash_t *sessions;
+    TAILQ_HEAD(, mux_session) session_list;
+};
+
+static void mux_send(struct mux_conn *mux, uint32_t type, uint32_t id, struct evbuffer *data)
+{
+    struct newsql_mux_hdr hdr;
+    hdr.type = htonl(type);
+    hdr.session = htonl(id);
+    hdr.length = htonl(data ? evbuffer_get_length(data) : 0);
+    evbuffer_add(mux->wr_buf, &hdr, sizeof(hdr));
+    if (data) evbuffer_add_buffer(mux->wr_buf, data);
+    event_add(mux->wr_ev, NULL);
+}
+
+/* Read the connection again, starting with the frames already read */
+static void mux_resume_rd(struct mux_conn *mux)
+{
+    mux->rd_blocked = NULL;
+    event_add(mux->rd_ev, NULL);
+    event_active(mux->rd_ev, EV_READ, 0);
+}
+
+static void session_free(struct mux_session *s)
+{
+    struct mux_conn *mux = s->mux;
+    if (mux->rd_blocked == s) mux_resume_rd(mux);
+    hash_del(mux->sessions, s);
+    TAILQ_REMOVE(&mux->session_list, s, entry);
+    event_free(s->rd_ev);
+    event_free(s->wr_ev);
+    evbuffer_free(s->wr_buf);
+    shutdown(s->fd, SHUT_RDWR);
+    Close(s->fd);
+    free(s);
+    ATOMIC_ADD32(gbl_newsql_mux_sessions, -1);
+}
+
+static void mux_free(struct mux_conn *mux)
+{
+    check_thd(mux->thd);
+    struct mux_session *s, *tmp;
+    TAILQ_FOREACH_SAFE(s, &mux->session_list, entry, tmp) {
+        session_free(s);
+    }
+    hash_free(mux->sessions);
+    event_free(mux->rd_ev);
+    event_free(mux->wr_ev);
+    evbuffer_free(mux->rd_buf);
+    evbuffer_free(mux->wr_buf);
+    shutdown(mux->fd, SHUT_RDWR);
+    Close(mux->fd);
+    free(mux);
+    rem_appsock_connection_evbuffer();
+    ATOMIC_ADD32(gbl_newsql_mux_conns, -1);
+}
+
+/* The session went away on our side: tell the client */
+static void session_gone(struct mux_session *s)
+{
+    mux_send(s->mux, NEWSQL_MUX_CLOSE, s->id, NULL);
+    session_free(s);
+}
+
+static void session_rd(int fd, short what, void *arg)
+{
+    struct mux_session *s = arg;
+    struct mux_conn *mux = s->mux;
+    if (evbuffer_get_length(mux->wr_buf) > NEWSQL_MUX_HIGH_WATER) {
+        mux->paused = 1;
+        event_del(s->rd_ev);
+        return;
+    }
+    struct evbuffer *buf = evbuffer_new();
+    int n = evbuffer_read(buf, fd, NEWSQL_MUX_MAX_FRAME);
+    if (n > 0) {
+        mux_send(mux, NEWSQL_MUX_DATA, s->id, buf);
+    } else if (n == 0 || !would_block()) {
+        session_gone(s);
+    }
+    evbuffer_free(buf);
+}
+
+static void session_wr(int fd, short what, void *arg)
+{
+    struct mux_session *s = arg;
+    if (evbuffer_write(s->wr_buf, fd) < 0 && !would_block()) {
+        session_gone(s);
+        return;
+    }
+    size_t len = evbuffer_get_length(s->wr_buf);
+    if (s->mux->rd_blocked == s && len < NEWSQL_MUX_HIGH_WATER / 2) mux_resume_rd(s->mux);
+    if (len == 0) {
+        event_del(s->wr_ev);
+        if (s->closing) session_free(s);
+    }
+}
+
+static int session_open(struct mux_conn *mux, uint32_t id)
+{
+    int sv[2];
+
+    if (hash_find_readonly(mux->sessions, &id)) {
+        logmsg(LOGMSG_ERROR, "%s: session %u is already open\n", __func__, id);
+        return -1;
+    }
+    if (check_appsock_limit(0) != 0) {
+        mux_send(mux, NEWSQL_MUX_CLOSE, id, NULL);
+        return 0;
+    }
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, sv) != 0) {
+        logmsgperror("newsql_mux socketpair");
+        rem_appsock_connection_evbuffer();
+        mux_send(mux, NEWSQL_MUX_CLOSE, id, NULL);
+        return 0;
+    }
+    evutil_make_socket_nonblocking(sv[0]);
+    evutil_make_socket_nonblocking(sv[1]);
+
+    struct mux_session *s = calloc(1, sizeof(*s));
+    s->id = id;
+    s->fd = sv[1];
+    s->mux = mux;
+    s->wr_buf = evbuffer_new();
+    s->rd_ev = event_new(mux->base, s->fd, EV_READ | EV_PERSIST, session_rd, s);
+    s->wr_ev = event_new(mux->base, s->fd, EV_WRITE | EV_PERSIST, session_wr, s);
+    hash_add(mux->sessions, s);
+    TAILQ_INSERT_TAIL(&mux->session_list, s, entry);
+    if (!mux->paused) event_add(s->rd_ev, NULL);
+    ATOMIC_ADD32(gbl_newsql_mux_sessions, 1);
+
+    /* The other end is a newsql connection past its appsock line */
+    struct appsock_handler_arg *arg = calloc(1, sizeof(*arg));
+    arg->fd = sv[0];
+    arg->addr = mux->addr;
+    arg->secure = mux->secure;
+    arg->rd_buf = evbuffer_new();
+    arg->base = mux->base;
+    newsql_accept_evbuffer(arg);
+    return 0;
+}
+
+/* Process the frames read so far; returns -1 to drop the connection */
+static int mux_process(struct mux_conn *mux)
+{
+    struct newsql_mux_hdr hdr;
+    while (evbuffer_get_length(mux->rd_buf) >= sizeof(hdr)) {
+        evbuffer_copyout(mux->rd_buf, &hdr, sizeof(hdr));
+        uint32_t type = ntohl(hdr.type);
+        uint32_t id = ntohl(hdr.session);
+        uint32_t len = ntohl(hdr.length);
+        if (len > NEWSQL_MUX_MAX_FRAME) {
+            logmsg(LOGMSG_ERROR, "%s: bad frame length %u\n", __func__, len);
+            return -1;
+        }
+        if (evbuffer_get_length(mux->rd_buf) < sizeof(hdr) + len) break;
+
+        struct mux_session *s = hash_find_readonly(mux->sessions, &id);
+        if (type == NEWSQL_MUX_DATA && s && !s->closing &&
+            evbuffer_get_length(s->wr_buf) > NEWSQL_MUX_HIGH_WATER) {
+            /* leave the frame, and what follows, until the session catches up */
+            mux->rd_blocked = s;
+            event_del(mux->rd_ev);
+            break;
+        }
+        evbuffer_drain(mux->rd_buf, sizeof(hdr));
+        switch (type) {
+        case NEWSQL_MUX_OPEN:
+            if (session_open(mux, id) != 0) return -1;
+            break;
+        case NEWSQL_MUX_DATA:
+            if (s == NULL || s->closing) { /* closed on our side */
+                evbuffer_drain(mux->rd_buf, len);
+                break;
+            }
+            evbuffer_remove_buffer(mux->rd_buf, s->wr_buf, len);
+            event_add(s->wr_ev, NULL);
+            break;
+        case NEWSQL_MUX_CLOSE:
+            if (s == NULL) break;
+            if (evbuffer_get_length(s->wr_buf) == 0) {
+                session_free(s);
+            } else {
+                s->closing = 1;
+                event_del(s->rd_ev);
+            }
+            break;
+        default:
+            logmsg(LOGMSG_ERROR, "%s: bad frame type %u\n", __func__, type);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static void mux_rd(int fd, short what, void *arg)
+{
+    struct mux_conn *mux = arg;
+    int n = evbuffer_read(mux->rd_buf, fd, -1);
+    if (n == 0 || (n < 0 && !would_block())) {
+        mux_free(mux);
+        return;
+    }
+    if (mux_process(mux) != 0) mux_free(mux);
+}
+
+static void mux_wr(int fd, short what, void *arg)
+{
+    struct mux_conn *mux = arg;
+    if (evbuffer_write(mux->wr_buf, fd) < 0 && !would_block()) {
+        mux_free(mux);
+        return;
+    }
+    size_t len = evbuffer_get_length(mux->wr_buf);
+    if (len == 0) event_del(mux->wr_ev);
+    if (mux->paused && len < NEWSQL_MUX_HIGH_WATER / 2) {
+        struct mux_session *s;
+        mux->paused = 0;
+        TAILQ_FOREACH(s, &mux->session_list, entry) {
+            if (!s->closing) event_add(s->rd_ev, NULL);
+        }
+    }
+}
+
+/* Appsock handler for NEWSQL_MUX_APPSOCK */
+static void newsql_mux_accept(int dummyfd, short what, void *data)
+{
+    struct appsock_handler_arg *arg = data;
+    if (!gbl_newsql_mux) {
+        rem_appsock_connection_evbuffer();
+        evbuffer_free(arg->rd_buf);
+        shutdown(arg->fd, SHUT_RDWR);
+        Close(arg->fd);
+        free_appsock_handler_arg(arg);
+        return;
+    }
+
+    struct mux_conn *mux = calloc(1, sizeof(*mux));
+    mux->fd = arg->fd;
+    mux->secure = arg->secure;
+    mux->addr = arg->addr;
+    mux->thd = pthread_self();
+    mux->base = arg->base;
+    mux->rd_buf = arg->rd_buf;
+    mux->wr_buf = evbuffer_new();
+    mux->sessions = hash_init(sizeof(uint32_t));
+    TAILQ_INIT(&mux->session_list);
+    mux->rd_ev = event_new(mux->base, mux->fd, EV_READ | EV_PERSIST, mux_rd, mux);
+    mux->wr_ev = event_new(mux->base, mux->fd, EV_WRITE | EV_PERSIST, mux_wr, mux);
+    free_appsock_handler_arg(arg);
+    ATOMIC_ADD32(gbl_newsql_mux_conns, 1);
+
+    mux_send(mux, NEWSQL_MUX_HELLO, 0, NULL);
+    event_add(mux->rd_ev, NULL);
+    if (mux_process(mux) != 0) mux_free(mux);
+}
+
+void newsql_mux_init(void)
+{
+    add_appsock_handler(NEWSQL_MUX_APPSOCK, newsql_mux_accept);
+}
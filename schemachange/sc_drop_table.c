@@ -126,6 +126,11 @@ int finalize_drop_table(struct ireq *iq, struct schema_change_type *s,
         return rc;
     }
 
+    if ((rc = bdb_zonemap_del_all(tran, db->tablename, &bdberr)) != 0) {
+        sc_errf(s, "Failed to delete zone maps\n");
+        return rc;
+    }
+
 
     /* if this is a shard, remove the llmeta partition entry */
     if (s->partition.type == PARTITION_REMOVE && s->publish) {
@@ -3559,6 +3559,7 @@ void *live_sc_logical_redo_thd(struct convert_record_data *data)
         s->iq->sc_should_abort = 1;
         goto cleanup;
     }
+    hash_set_open_addressing(data->blob_hash);
 
     data->redo_genids = hash_init(sizeof(unsigned long long));
     if (!data->redo_genids) {
@@ -3566,6 +3567,7 @@ void *live_sc_logical_redo_thd(struct convert_record_data *data)
         s->iq->sc_should_abort = 1;
         goto cleanup;
     }
+    hash_set_open_addressing(data->redo_genids);
 
     listc_init(&data->redo_lsns, offsetof(struct redo_genid_lsns, linkv));
     data->dta_buf = malloc(data->from->lrl + ODH_SIZE);
@@ -149,6 +149,13 @@ int finalize_rename_table(struct ireq *iq, struct schema_change_type *s,
         goto tran_error;
     }
 
+    /* zones are summarized again under the new name */
+    rc = bdb_zonemap_del_all(tran, db->tablename, &bdberr);
+    if (rc) {
+        sc_errf(s, "Failed to delete zone maps for %s\n", db->tablename);
+        goto tran_error;
+    }
+
     /* fragile, handle with care */
     char *oldname = db->tablename;
     rc = rename_db(db, newname);
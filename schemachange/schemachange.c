@@ -1295,6 +1295,63 @@ int sc_timepart_truncate_table(const char *tableName, struct errstat *xerr,
     return 0;
 }
 
+/* rebuild a frozen shard with the given compression; the rebuild runs in
+   its own schema change thread, so the partition locks are not held while
+   the shard is converted */
+int sc_timepart_freeze_table(const char *tableName, int compress,
+                             int compress_blobs, struct errstat *xerr)
+{
+    struct schema_change_type *sc;
+    struct dbtable *db;
+    int rc;
+
+    if (thedb->master != gbl_myhostname) {
+        errstat_set_rcstrf(xerr, SC_VIEW_ERR_EXIST, "I am not master; master is %s", thedb->master);
+        return xerr->errval;
+    }
+
+    db = get_dbtable_by_name(tableName);
+    if (!db) {
+        errstat_set_rcstrf(xerr, SC_VIEW_ERR_BUG, "table '%s' not found", tableName);
+        return xerr->errval;
+    }
+
+    sc = new_schemachange_type();
+    if (!sc) {
+        errstat_set_rcstrf(xerr, SC_VIEW_ERR_BUG, "out of memory");
+        return xerr->errval;
+    }
+
+    strncpy0(sc->tablename, db->tablename, sizeof(sc->tablename));
+    if (get_csc2_file(sc->tablename, -1 /*highest csc2_version*/, &sc->newcsc2, NULL /*csc2len*/)) {
+        errstat_set_rcstrf(xerr, SC_VIEW_ERR_BUG, "could not get schema for table '%s'", tableName);
+        free_schema_change_type(sc);
+        return xerr->errval;
+    }
+
+    sc->kind = SC_REBUILDTABLE;
+    sc->same_schema = 1;
+    sc->force_rebuild = 1;
+    sc->force_dta_rebuild = 1;
+    sc->force_blob_rebuild = 1;
+    sc->live = 1;
+    sc->finalize = 1;
+    sc->scanmode = gbl_default_sc_scanmode;
+    /* compression needs on disk headers */
+    sc->headers = 1;
+    sc->compress = compress;
+    sc->compress_blobs = compress_blobs;
+
+    rc = start_schema_change(sc);
+    if (rc != SC_OK && rc != SC_ASYNC) {
+        errstat_set_rcstrf(xerr, SC_VIEW_ERR_SC, "failed to start rebuild rc %d", rc);
+        return xerr->errval;
+    }
+
+    bzero(xerr, sizeof(*xerr));
+    return 0;
+}
+
 /* shortcut for running table upgrade in a schemachange shell */
 int start_table_upgrade(struct dbenv *dbenv, const char *tbl,
                         unsigned long long genid, int full, int partial,
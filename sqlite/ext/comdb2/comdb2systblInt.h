@@ -44,6 +44,7 @@ extern const sqlite3_module systblTimepartEventsModule;
 extern const sqlite3_module systblCronSchedsModule;
 extern const sqlite3_module systblCronEventsModule;
 extern const sqlite3_module systblTransactionLogsModule;
+extern const sqlite3_module systblTransactionLogBatchesModule;
 extern const sqlite3_module systblMetricsModule;
 extern const sqlite3_module systblTimeseriesModule;
 extern const sqlite3_module systblReplStatsModule;
@@ -101,6 +102,7 @@ int systblFdbInfoInit(sqlite3 *db);
 int systblTranCommitInit(sqlite3 *db);
 int systblTransactionStateInit(sqlite3 *db);
 int systblMemstatsInit(sqlite3 *db);
+int systblMemstatsThreadsInit(sqlite3 *db);
 int systblStacks(sqlite3 *db);
 int systblPreparedInit(sqlite3 *db);
 int systblSchemaVersionsInit(sqlite3 *db);
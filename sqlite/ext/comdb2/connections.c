@@ -101,5 +101,7 @@ int systblConnectionsInit(sqlite3 *db) {
             CDB2_CSTRING, "uuid", -1, offsetof(struct connection_info, uuid),
             CDB2_CSTRING, "identity", -1, offsetof(struct connection_info, identity),
             CDB2_CSTRING, "pool", -1, offsetof(struct connection_info, pool_name),
+            CDB2_INTEGER, "mem_used", -1, offsetof(struct connection_info, mem_used),
+            CDB2_INTEGER, "mem_peak", -1, offsetof(struct connection_info, mem_peak),
             SYSTABLE_END_OF_FIELDS);
 }
@@ -37,6 +37,7 @@ struct fingerprint_track_systbl {
     char *excluded;    /* 'Y' if excluded from longreqs */
     int64_t total_pagein_read;    /* Cumulative bufferpool page-ins (hit+miss) */
     int64_t total_pagein_read_io; /* Subset of the above that required disk I/O */
+    int64_t mem_peak; /* Peak memory of the last execution */
 
     char fp[FINGERPRINTSZ*2+1];
 };
@@ -81,6 +82,7 @@ static int fingerprints_callback(void **data, int *npoints)
                     pFp[copied].time = pEntry->time;
                     pFp[copied].prepTime = pEntry->prepTime;
                     pFp[copied].rows = pEntry->rows;
+                    pFp[copied].mem_peak = pEntry->mem_peak;
                     if (reqlog_fingerprint_is_excluded((char *)pEntry->fingerprint)) {
                         pFp[copied].excluded = "Y";
                     } else {
@@ -147,5 +149,7 @@ int systblFingerprintsInit(sqlite3 *db)
         offsetof(struct fingerprint_track_systbl, zNormSql),
         CDB2_CSTRING, "excluded_from_longreqs", -1,
         offsetof(struct fingerprint_track_systbl, excluded),
+        CDB2_INTEGER, "mem_peak", -1,
+        offsetof(struct fingerprint_track_systbl, mem_peak),
         SYSTABLE_END_OF_FIELDS);
 }
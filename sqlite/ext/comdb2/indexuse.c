@@ -40,6 +40,7 @@ struct index_usage {
     char *sqlname;
     int64_t steps;
     int64_t non_sql_steps;
+    int64_t data_lookups;
 };
 typedef struct index_usage index_usage;
 
@@ -82,6 +83,7 @@ static int get_index_usage(void **recsp, int *nrecs) {
             ix->sqlname =  strdup(db->schema->ix[ixnum]->sqlitetag);
             ix->steps = db->sqlixuse[ixnum];
             ix->non_sql_steps = db->ixuse[ixnum];
+            ix->data_lookups = db->sqlixlookups ? db->sqlixlookups[ixnum] : 0;
 
             nix++;
         }
@@ -100,6 +102,7 @@ int systblSQLIndexStatsInit(sqlite3 *db) {
             CDB2_CSTRING, "sql_name", -1, offsetof(index_usage, sqlname),
             CDB2_INTEGER, "steps", -1, offsetof(index_usage, steps),
             CDB2_INTEGER, "non_sql_steps", -1, offsetof(index_usage, non_sql_steps),
+            CDB2_INTEGER, "data_lookups", -1, offsetof(index_usage, data_lookups),
             SYSTABLE_END_OF_FIELDS);
     return rc;
 }
@@ -29,12 +29,29 @@ sqlite3_module systblMemstatsModule = {
 };
 
 int get_usages(void **data, int *num_points) {
-#ifdef USE_SYS_ALLOC
-    (*num_points) = 0;
-    return 0;
-#else
-    return comdb2ma_usages((comdb2ma_usage **)data, num_points);
+    comdb2ma_usage *usages = NULL, *queries = NULL;
+    int nusages = 0, nqueries = 0;
+#ifndef USE_SYS_ALLOC
+    int rc = comdb2ma_usages(&usages, &nusages);
+    if (rc)
+        return rc;
 #endif
+    /* add the memory of the queries running on each sql pool */
+    gather_sql_mem_usages(&queries, &nqueries);
+    comdb2ma_usage *all = calloc(nusages + nqueries + 1, sizeof(comdb2ma_usage));
+    if (nusages)
+        memcpy(all, usages, nusages * sizeof(comdb2ma_usage));
+    if (nqueries)
+        memcpy(all + nusages, queries, nqueries * sizeof(comdb2ma_usage));
+    for (int i = 0; i < nusages + nqueries; ++i) {
+        all[i].name = all[i].name_str;
+        all[i].scope = all[i].scope_str;
+    }
+    free(usages);
+    free(queries);
+    *data = all;
+    *num_points = nusages + nqueries;
+    return 0;
 }
 
 void free_usages(void *data, int num_points) {
@@ -50,5 +67,33 @@ int systblMemstatsInit(sqlite3 *db) {
             CDB2_INTEGER, "used", -1, offsetof(comdb2ma_usage, used),
             CDB2_INTEGER, "free", -1, offsetof(comdb2ma_usage, unused),
             CDB2_INTEGER, "peak", -1, offsetof(comdb2ma_usage, peak),
+            CDB2_INTEGER, "cached", -1, offsetof(comdb2ma_usage, cached),
+            SYSTABLE_END_OF_FIELDS);
+}
+
+sqlite3_module systblMemstatsThreadsModule = {
+    .access_flag = CDB2_ALLOW_USER,
+};
+
+int get_tcache_usages(void **data, int *num_points) {
+#ifdef USE_SYS_ALLOC
+    (*num_points) = 0;
+    return 0;
+#else
+    return comdb2ma_tcache_usages((comdb2ma_tcache_usage **)data, num_points);
+#endif
+}
+
+int systblMemstatsThreadsInit(sqlite3 *db) {
+    return create_system_table(db, "comdb2_memstats_threads",
+            &systblMemstatsThreadsModule, get_tcache_usages, free_usages,
+            sizeof(comdb2ma_tcache_usage),
+            CDB2_INTEGER, "thread", -1, offsetof(comdb2ma_tcache_usage, tid),
+            CDB2_CSTRING, "scope", -1, offsetof(comdb2ma_tcache_usage, scope),
+            CDB2_INTEGER, "cached", -1, offsetof(comdb2ma_tcache_usage, cached),
+            CDB2_INTEGER, "hits", -1, offsetof(comdb2ma_tcache_usage, hits),
+            CDB2_INTEGER, "misses", -1, offsetof(comdb2ma_tcache_usage, misses),
+            CDB2_INTEGER, "frees", -1, offsetof(comdb2ma_tcache_usage, frees),
+            CDB2_INTEGER, "flushes", -1, offsetof(comdb2ma_tcache_usage, flushes),
             SYSTABLE_END_OF_FIELDS);
 }
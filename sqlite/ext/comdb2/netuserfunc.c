@@ -31,6 +31,7 @@ typedef struct systable_net_userfunc {
     char                    *userfunc;
     int64_t                 count;
     int64_t                 totus;
+    int64_t                 bytes;
 } systable_net_userfunc_t;
 
 typedef struct net_get_userfunc {
@@ -40,7 +41,8 @@ typedef struct net_get_userfunc {
 } net_get_userfunc_t;
 
 static void userfunc_to_systable(struct netinfo_struct *netinfo_ptr, void *arg,
-        char *service, char *userfunc, int64_t count, int64_t totus)
+        char *service, char *userfunc, int64_t count, int64_t totus,
+        int64_t bytes)
 {
     net_get_userfunc_t *uf = (net_get_userfunc_t *)arg;
     uf->count++;
@@ -58,6 +60,7 @@ static void userfunc_to_systable(struct netinfo_struct *netinfo_ptr, void *arg,
     u->userfunc = userfunc;
     u->count = count;
     u->totus = totus;
+    u->bytes = bytes;
 }
 
 static int get_net_userfuncs(void **data, int *records)
@@ -90,5 +93,6 @@ int systblNetUserfuncsInit(sqlite3 *db) {
             CDB2_CSTRING, "userfunc", -1, offsetof(systable_net_userfunc_t, userfunc),
             CDB2_INTEGER, "count", -1, offsetof(systable_net_userfunc_t, count),
             CDB2_INTEGER, "totalus", -1, offsetof(systable_net_userfunc_t, totus),
+            CDB2_INTEGER, "bytes", -1, offsetof(systable_net_userfunc_t, bytes),
             SYSTABLE_END_OF_FIELDS);
 }
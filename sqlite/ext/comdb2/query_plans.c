@@ -39,6 +39,8 @@ typedef struct systable_query_plans {
     double total_cost_per_row;
     int nexecutions;
     double avg_cost_per_row;
+    double est_cost;
+    int planner_steps;
 } systable_query_plans_t;
 
 int query_plans_systable_collect(void **data, int *nrecords)
@@ -89,6 +91,8 @@ int query_plans_systable_collect(void **data, int *nrecords)
             arr[idx].total_cost_per_row = q->total_cost_per_row;
             arr[idx].nexecutions = q->nexecutions;
             arr[idx].avg_cost_per_row = q->avg_cost_per_row;
+            arr[idx].est_cost = q->est_cost;
+            arr[idx].planner_steps = q->planner_steps;
             idx++;
         }
     }
@@ -125,5 +129,7 @@ int systblQueryPlansInit(sqlite3*db)
         CDB2_REAL, "total_cost_per_row", -1, offsetof(systable_query_plans_t, total_cost_per_row),
         CDB2_INTEGER, "num_executions", -1, offsetof(systable_query_plans_t, nexecutions),
         CDB2_REAL, "avg_cost_per_row", -1, offsetof(systable_query_plans_t, avg_cost_per_row),
+        CDB2_REAL, "est_cost", -1, offsetof(systable_query_plans_t, est_cost),
+        CDB2_INTEGER, "planner_steps", -1, offsetof(systable_query_plans_t, planner_steps),
         SYSTABLE_END_OF_FIELDS);
 }
@@ -51,7 +51,10 @@ enum {
     COLUMN_AVG_WAIT_OVER_1MIN,
     COLUMN_MAX_WAIT_OVER_1MIN,
     COLUMN_LSN,
-    COLUMN_LSN_BYTES_BEHIND_MASTER
+    COLUMN_LSN_BYTES_BEHIND_MASTER,
+    COLUMN_MSGS_WRITTEN,
+    COLUMN_MSGS_READ,
+    COLUMN_WRITE_CALLS
 };
 
 static int systblReplStatsConnect(sqlite3 *db, void *pAux, int argc,
@@ -65,7 +68,8 @@ static int systblReplStatsConnect(sqlite3 *db, void *pAux, int argc,
             "\"bytes_written\", \"bytes_read\", \"throttle_waits\", "
             "\"reorders\", \"avg_wait_over_10secs\", \"max_wait_over_10secs\", "
             "\"avg_wait_over_1min\", \"max_wait_over_1min\", "
-            "\"lsn\", \"lsn_bytes_behind_master\")");
+            "\"lsn\", \"lsn_bytes_behind_master\", "
+            "\"msgs_written\", \"msgs_read\", \"write_calls\")");
 
     if (rc == SQLITE_OK) {
         if ((*ppVtab = sqlite3_malloc(sizeof(sqlite3_vtab))) == 0) {
@@ -183,6 +187,15 @@ static int systblReplStatsColumn(sqlite3_vtab_cursor *cur, sqlite3_context *ctx,
     case COLUMN_LSN_BYTES_BEHIND_MASTER:
         sqlite3_result_int64(ctx, stats->lsn_bytes_behind);
         break;
+    case COLUMN_MSGS_WRITTEN:
+        sqlite3_result_int64(ctx, stats->msgs_written);
+        break;
+    case COLUMN_MSGS_READ:
+        sqlite3_result_int64(ctx, stats->msgs_read);
+        break;
+    case COLUMN_WRITE_CALLS:
+        sqlite3_result_int64(ctx, stats->write_calls);
+        break;
     default:
         assert(0);
     };
@@ -153,6 +153,8 @@ int comdb2SystblInit(
     rc = sqlite3_create_module(db, "comdb2_clientstats", &systblClientStatsModule, 0);
   if (rc == SQLITE_OK)
     rc = sqlite3_create_module(db, "comdb2_transaction_logs", &systblTransactionLogsModule, 0);
+  if (rc == SQLITE_OK)
+    rc = sqlite3_create_module(db, "comdb2_transaction_log_batches", &systblTransactionLogBatchesModule, 0);
   if (rc == SQLITE_OK)
     rc = sqlite3_create_module(db, "comdb2_metrics", &systblMetricsModule, 0);
   if (rc == SQLITE_OK)
@@ -227,6 +229,8 @@ int comdb2SystblInit(
     rc = sqlite3_carray_init(db, 0, 0);
   if (rc == SQLITE_OK)
     rc = systblMemstatsInit(db);
+  if (rc == SQLITE_OK)
+    rc = systblMemstatsThreadsInit(db);
   if (rc == SQLITE_OK)
     rc = systblTransactionStateInit(db);
   if (rc == SQLITE_OK)
@@ -28,6 +28,8 @@
 #include "parse_lsn.h"
 #include "epochlib.h"
 #include "logrecord.h"
+#include "phys_rep_batch.h"
+#include <bdb/log_info.h>
 
 /* Column numbers */
 #define TRANLOG_COLUMN_START        0
@@ -378,6 +380,48 @@ static inline int parse_lsn(const unsigned char *lsnstr, DB_LSN *lsn)
     return 0;
 }
 
+static u_int32_t tranlog_record_generation(void *data)
+{
+    return logrecord_generation(data);
+}
+
+static int64_t tranlog_record_timestamp(void *data)
+{
+    u_int32_t rectype = 0;
+    int64_t timestamp = 0;
+
+    if (data)
+        LOGCOPY_32(&rectype, data); 
+
+    if (rectype == DB___txn_regop_gen || (rectype == DB___txn_regop_gen+2000) ||
+        rectype == DB___txn_regop_gen_endianize || (rectype == DB___txn_regop_gen_endianize+2000)) {
+        timestamp = logrecord_timestamp_regop_gen(data);
+    }
+
+    if (rectype == DB___txn_dist_commit || (rectype == DB___txn_dist_commit+2000)){
+        timestamp = logrecord_timestamp_dist_commit(data);
+    }
+
+    if (rectype == DB___txn_dist_abort || (rectype == DB___txn_dist_abort+2000)){
+        timestamp = logrecord_timestamp_dist_abort(data);
+    }
+
+    if (rectype == DB___txn_regop_rowlocks || (rectype == DB___txn_regop_rowlocks+2000) ||
+        rectype == DB___txn_regop_rowlocks_endianize || (rectype == DB___txn_regop_rowlocks_endianize+2000)) {
+        timestamp = logrecord_timestamp_regop_rowlocks(data);
+    }
+
+    if (rectype == DB___txn_regop || (rectype == DB___txn_regop+2000)) {
+        timestamp = logrecord_timestamp_regop(data);
+    }
+
+    if (rectype == DB___txn_ckp || (rectype == DB___txn_ckp+2000) ||
+        rectype == DB___txn_ckp_recovery || (rectype == DB___txn_ckp_recovery+2000)) {
+        timestamp = logrecord_timestamp_ckp(data);
+    }
+    return timestamp;
+}
+
 /*
 ** Return values of columns for the row at which the series_cursor
 ** is currently pointing.
@@ -451,31 +495,7 @@ static int tranlogColumn(
         sqlite3_result_int64(ctx, rectype);
         break;
     case TRANLOG_COLUMN_GENERATION:
-        if (pCur->data.data)
-            LOGCOPY_32(&rectype, pCur->data.data); 
-
-        normalize_rectype(&rectype);
-
-        if (rectype == DB___txn_regop_gen || rectype == DB___txn_regop_gen_endianize){
-            generation = logrecord_generation_regop_gen(pCur->data.data);
-        }
-
-        if (rectype == DB___txn_dist_commit){
-            generation = logrecord_generation_dist_commit(pCur->data.data);
-        }
-
-        if (rectype == DB___txn_dist_abort){
-            generation = logrecord_generation_dist_abort(pCur->data.data);
-        }
-
-        if (rectype == DB___txn_regop_rowlocks || rectype == DB___txn_regop_rowlocks_endianize) {
-            generation = logrecord_generation_regop_rowlocks(pCur->data.data);
-        }
-
-        if (rectype == DB___txn_ckp || rectype == DB___txn_ckp_recovery) {
-            generation = logrecord_generation_ckp(pCur->data.data);
-        }
-
+        generation = tranlog_record_generation(pCur->data.data);
         if (generation > 0) {
             sqlite3_result_int64(ctx, generation);
         } else {
@@ -506,36 +526,7 @@ static int tranlogColumn(
         sqlite3_result_int64(ctx, logcgen);
         break;
     case TRANLOG_COLUMN_TIMESTAMP:
-        if (pCur->data.data)
-            LOGCOPY_32(&rectype, pCur->data.data); 
-
-        if (rectype == DB___txn_regop_gen || (rectype == DB___txn_regop_gen+2000) ||
-            rectype == DB___txn_regop_gen_endianize || (rectype == DB___txn_regop_gen_endianize+2000)) {
-            timestamp = logrecord_timestamp_regop_gen(pCur->data.data);
-        }
-
-        if (rectype == DB___txn_dist_commit || (rectype == DB___txn_dist_commit+2000)){
-            timestamp = logrecord_timestamp_dist_commit(pCur->data.data);
-        }
-
-        if (rectype == DB___txn_dist_abort || (rectype == DB___txn_dist_abort+2000)){
-            timestamp = logrecord_timestamp_dist_abort(pCur->data.data);
-        }
-
-        if (rectype == DB___txn_regop_rowlocks || (rectype == DB___txn_regop_rowlocks+2000) ||
-            rectype == DB___txn_regop_rowlocks_endianize || (rectype == DB___txn_regop_rowlocks_endianize+2000)) {
-            timestamp = logrecord_timestamp_regop_rowlocks(pCur->data.data);
-        }
-
-        if (rectype == DB___txn_regop || (rectype == DB___txn_regop+2000)) {
-            timestamp = logrecord_timestamp_regop(pCur->data.data);
-        }
-
-		if (rectype == DB___txn_ckp || (rectype == DB___txn_ckp+2000) ||
-			rectype == DB___txn_ckp_recovery || (rectype == DB___txn_ckp_recovery+2000)) {
-			timestamp = logrecord_timestamp_ckp(pCur->data.data);
-		}
-
+        timestamp = tranlog_record_timestamp(pCur->data.data);
         if (timestamp > 0) {
             sqlite3_result_int64(ctx, timestamp);
         } else {
@@ -760,3 +751,344 @@ sqlite3_module systblTransactionLogsModule = {
 };
 
 
+
+/*
+** comdb2_transaction_log_batches: the records of comdb2_transaction_logs,
+** many per row.  A row is a batch of consecutive records, packed, compressed
+** and checksummed as described in phys_rep_batch.h, so that physical
+** replicants do not pay for a row per record.  A batch blocks for its first
+** record only, and ends when maxbytes of records are packed or when it
+** caught up with the log.
+*/
+#define TRANLOG_BATCH_COLUMN_START        0
+#define TRANLOG_BATCH_COLUMN_FLAGS        1
+#define TRANLOG_BATCH_COLUMN_MAXBYTES     2
+#define TRANLOG_BATCH_COLUMN_TIMEOUT      3
+#define TRANLOG_BATCH_COLUMN_LSN          4
+#define TRANLOG_BATCH_COLUMN_LASTLSN      5
+#define TRANLOG_BATCH_COLUMN_NRECS        6
+#define TRANLOG_BATCH_COLUMN_GENERATION   7
+#define TRANLOG_BATCH_COLUMN_LOGCGEN      8
+#define TRANLOG_BATCH_COLUMN_LAGBYTES     9
+#define TRANLOG_BATCH_COLUMN_SIZE         10
+#define TRANLOG_BATCH_COLUMN_CHECKSUM     11
+#define TRANLOG_BATCH_COLUMN_PAYLOAD      12
+
+enum {
+    TRANLOG_BATCH_DEFAULT_BYTES = 1024 * 1024,
+    TRANLOG_BATCH_MAX_BYTES = 64 * 1024 * 1024
+};
+
+typedef struct tranlog_batch_cursor tranlog_batch_cursor;
+struct tranlog_batch_cursor {
+  sqlite3_vtab_cursor base;  /* Base class - must be first */
+  sqlite3_int64 iRowid;
+  tranlog_cursor *pLog;      /* Cursor over the records */
+  int maxBytes;
+  int eof;
+  DB_LSN firstLsn;
+  DB_LSN lastLsn;
+  u_int32_t generation;      /* Highest generation of the batch */
+  int64_t logcgen;
+  int64_t lagBytes;          /* Log written past the batch */
+  char lsnStr[32];
+  struct physrep_batch batch;
+};
+
+static int tranlogBatchConnect(
+  sqlite3 *db,
+  void *pAux,
+  int argc, const char *const*argv,
+  sqlite3_vtab **ppVtab,
+  char **pzErr
+){
+  sqlite3_vtab *pNew;
+  int rc;
+
+  rc = sqlite3_declare_vtab(db,
+     "CREATE TABLE x(minlsn hidden,flags hidden,maxbytes hidden,timeout hidden,lsn,lastlsn,nrecs integer,generation integer,logcgen integer,lagbytes integer,size integer,checksum integer,payload)");
+  if( rc==SQLITE_OK ){
+    pNew = *ppVtab = sqlite3_malloc( sizeof(*pNew) );
+    if( pNew==0 ) return SQLITE_NOMEM;
+    memset(pNew, 0, sizeof(*pNew));
+  }
+  return rc;
+}
+
+static int tranlogBatchOpen(sqlite3_vtab *p, sqlite3_vtab_cursor **ppCursor){
+  tranlog_batch_cursor *pCur;
+  sqlite3_vtab_cursor *pLog;
+  int rc;
+
+  pCur = sqlite3_malloc( sizeof(*pCur) );
+  if( pCur==0 ) return SQLITE_NOMEM;
+  memset(pCur, 0, sizeof(*pCur));
+  if ((rc = tranlogOpen(p, &pLog)) != SQLITE_OK) {
+    sqlite3_free(pCur);
+    return rc;
+  }
+  pCur->pLog = (tranlog_cursor *)pLog;
+  *ppCursor = &pCur->base;
+  return SQLITE_OK;
+}
+
+static int tranlogBatchClose(sqlite3_vtab_cursor *cur){
+  tranlog_batch_cursor *pCur = (tranlog_batch_cursor*)cur;
+  tranlogClose(&pCur->pLog->base);
+  physrep_batch_free(&pCur->batch);
+  sqlite3_free(pCur);
+  return SQLITE_OK;
+}
+
+static int tranlogBatchNext(sqlite3_vtab_cursor *cur)
+{
+  tranlog_batch_cursor *pCur = (tranlog_batch_cursor*)cur;
+  tranlog_cursor *pLog = pCur->pLog;
+  bdb_state_type *bdb_state = thedb->bdb_env;
+  int flags = pLog->flags;
+  int rc = SQLITE_OK;
+
+  physrep_batch_reset(&pCur->batch);
+  pCur->generation = 0;
+  if (pCur->eof)
+    return SQLITE_OK;
+
+  while (pCur->batch.len < pCur->maxBytes) {
+    if (pCur->batch.nrecs > 0) {
+      /* Don't wait with records in hand */
+      if (flags & TRANLOG_FLAGS_DURABLE) {
+        DB_LSN durable_lsn;
+        uint32_t durable_gen;
+        bdb_state->dbenv->get_durable_lsn(bdb_state->dbenv, &durable_lsn,
+                                          &durable_gen);
+        if (log_compare(&durable_lsn, &pLog->curLsn) < 0)
+          break;
+      }
+      pLog->flags &= ~TRANLOG_FLAGS_BLOCK;
+    }
+    rc = tranlogNext(&pLog->base);
+    pLog->flags = flags;
+    if (rc != SQLITE_OK)
+      return rc;
+
+    if (pLog->invalidRecord) {
+      /* Sentinel: a row of its own, with no records */
+      pCur->firstLsn = pCur->lastLsn = pLog->curLsn;
+      break;
+    }
+    if (pLog->hitLast || pLog->notDurable) {
+      if (pCur->batch.nrecs == 0) {
+        pCur->eof = 1;
+        return SQLITE_OK;
+      }
+      /* Caught up: the next batch waits for more */
+      pLog->hitLast = pLog->notDurable = 0;
+      break;
+    }
+
+    u_int32_t rectype = 0, generation;
+    LOGCOPY_32(&rectype, pLog->data.data);
+    if (physrep_batch_add(&pCur->batch, pLog->curLsn.file,
+                          pLog->curLsn.offset, rectype,
+                          tranlog_record_timestamp(pLog->data.data),
+                          pLog->data.data, pLog->data.size))
+      return SQLITE_NOMEM;
+    generation = tranlog_record_generation(pLog->data.data);
+    if (generation > pCur->generation)
+      pCur->generation = generation;
+    if (pCur->batch.nrecs == 1)
+      pCur->firstLsn = pLog->curLsn;
+    pCur->lastLsn = pLog->curLsn;
+  }
+
+  if (pCur->batch.nrecs > 0) {
+    if (physrep_batch_seal(&pCur->batch))
+      return SQLITE_NOMEM;
+    LOG_INFO last = get_last_lsn(bdb_state);
+    pCur->lagBytes = physrep_log_distance(bdb_state->dbenv,
+        pCur->lastLsn.file, pCur->lastLsn.offset, last.file, last.offset);
+  } else {
+    pCur->lagBytes = 0;
+  }
+  pCur->logcgen = pLog->openCursor ? pLog->logc->log_cursor_gen : -1;
+  pCur->iRowid++;
+  return SQLITE_OK;
+}
+
+static int tranlogBatchColumn(
+  sqlite3_vtab_cursor *cur,
+  sqlite3_context *ctx,
+  int i
+){
+  tranlog_batch_cursor *pCur = (tranlog_batch_cursor*)cur;
+  tranlog_cursor *pLog = pCur->pLog;
+
+  switch( i ){
+    case TRANLOG_BATCH_COLUMN_START:
+      tranlog_lsn_to_str(pCur->lsnStr, &pLog->minLsn);
+      sqlite3_result_text(ctx, pCur->lsnStr, -1, SQLITE_TRANSIENT);
+      break;
+    case TRANLOG_BATCH_COLUMN_FLAGS:
+      sqlite3_result_int64(ctx, pLog->flags);
+      break;
+    case TRANLOG_BATCH_COLUMN_MAXBYTES:
+      sqlite3_result_int64(ctx, pCur->maxBytes);
+      break;
+    case TRANLOG_BATCH_COLUMN_TIMEOUT:
+      sqlite3_result_int64(ctx, pLog->timeout);
+      break;
+    case TRANLOG_BATCH_COLUMN_LSN:
+      tranlog_lsn_to_str(pCur->lsnStr, &pCur->firstLsn);
+      sqlite3_result_text(ctx, pCur->lsnStr, -1, SQLITE_TRANSIENT);
+      break;
+    case TRANLOG_BATCH_COLUMN_LASTLSN:
+      tranlog_lsn_to_str(pCur->lsnStr, &pCur->lastLsn);
+      sqlite3_result_text(ctx, pCur->lsnStr, -1, SQLITE_TRANSIENT);
+      break;
+    case TRANLOG_BATCH_COLUMN_NRECS:
+      sqlite3_result_int64(ctx, pCur->batch.nrecs);
+      break;
+    case TRANLOG_BATCH_COLUMN_GENERATION:
+      if (pCur->generation > 0) {
+        sqlite3_result_int64(ctx, pCur->generation);
+      } else {
+        sqlite3_result_null(ctx);
+      }
+      break;
+    case TRANLOG_BATCH_COLUMN_LOGCGEN:
+      sqlite3_result_int64(ctx, pCur->logcgen);
+      break;
+    case TRANLOG_BATCH_COLUMN_LAGBYTES:
+      sqlite3_result_int64(ctx, pCur->lagBytes);
+      break;
+    case TRANLOG_BATCH_COLUMN_SIZE:
+      sqlite3_result_int64(ctx, pCur->batch.len);
+      break;
+    case TRANLOG_BATCH_COLUMN_CHECKSUM:
+      sqlite3_result_int64(ctx, pCur->batch.checksum);
+      break;
+    case TRANLOG_BATCH_COLUMN_PAYLOAD:
+      if (pCur->batch.nrecs > 0) {
+        sqlite3_result_blob(ctx, pCur->batch.out, pCur->batch.outlen, NULL);
+      } else {
+        sqlite3_result_null(ctx);
+      }
+      break;
+  }
+  return SQLITE_OK;
+}
+
+static int tranlogBatchRowid(sqlite3_vtab_cursor *cur, sqlite_int64 *pRowid){
+  tranlog_batch_cursor *pCur = (tranlog_batch_cursor*)cur;
+  *pRowid = pCur->iRowid;
+  return SQLITE_OK;
+}
+
+static int tranlogBatchEof(sqlite3_vtab_cursor *cur){
+  tranlog_batch_cursor *pCur = (tranlog_batch_cursor*)cur;
+  return pCur->eof;
+}
+
+static int tranlogBatchFilter(
+  sqlite3_vtab_cursor *pVtabCursor,
+  int idxNum, const char *idxStr,
+  int argc, sqlite3_value **argv
+){
+  tranlog_batch_cursor *pCur = (tranlog_batch_cursor *)pVtabCursor;
+  tranlog_cursor *pLog = pCur->pLog;
+  int i = 0;
+
+  bzero(&pLog->minLsn, sizeof(pLog->minLsn));
+  if( idxNum & 1 ){
+    const unsigned char *minLsn = sqlite3_value_text(argv[i++]);
+    if (minLsn && parse_lsn(minLsn, &pLog->minLsn)) {
+        return SQLITE_CONV_ERROR;
+    }
+  }
+  pLog->flags = 0;
+  if( idxNum & 2 ){
+    int64_t flags = sqlite3_value_int64(argv[i++]);
+    pLog->flags = flags;
+    if (flags & TRANLOG_FLAGS_BLOCK) {
+      struct sql_thread *thd = pthread_getspecific(query_info_key);
+      thd->clnt->blocking_tranlog = 1;
+    }
+  }
+  pCur->maxBytes = TRANLOG_BATCH_DEFAULT_BYTES;
+  if( idxNum & 4 ){
+    int64_t maxBytes = sqlite3_value_int64(argv[i++]);
+    if (maxBytes > 0 && maxBytes <= TRANLOG_BATCH_MAX_BYTES)
+      pCur->maxBytes = maxBytes;
+  }
+  pLog->timeout = gbl_tranlog_default_timeout;
+  if( idxNum & 8 ){
+    pLog->timeout = sqlite3_value_int64(argv[i++]);
+  }
+  pLog->iRowid = 1;
+  pCur->iRowid = 0;
+  pCur->eof = 0;
+  return tranlogBatchNext(pVtabCursor);
+}
+
+static int tranlogBatchBestIndex(
+  sqlite3_vtab *tab,
+  sqlite3_index_info *pIdxInfo
+){
+  int aIdx[4] = {-1, -1, -1, -1};
+  int idxNum = 0;
+  int nArg = 0;
+  int i;
+
+  const struct sqlite3_index_constraint *pConstraint;
+  pConstraint = pIdxInfo->aConstraint;
+  for(i=0; i<pIdxInfo->nConstraint; i++, pConstraint++){
+    if( pConstraint->usable==0 ) continue;
+    if( pConstraint->op!=SQLITE_INDEX_CONSTRAINT_EQ ) continue;
+    if( pConstraint->iColumn>=TRANLOG_BATCH_COLUMN_START &&
+        pConstraint->iColumn<=TRANLOG_BATCH_COLUMN_TIMEOUT ){
+      aIdx[pConstraint->iColumn] = i;
+      idxNum |= (1 << pConstraint->iColumn);
+    }
+  }
+  for(i=0; i<4; i++){
+    if( aIdx[i]>=0 ){
+      pIdxInfo->aConstraintUsage[aIdx[i]].argvIndex = ++nArg;
+      pIdxInfo->aConstraintUsage[aIdx[i]].omit = 1;
+    }
+  }
+  if( idxNum & 1 ){
+    pIdxInfo->estimatedCost = (double)1;
+  }else{
+    pIdxInfo->estimatedCost = (double)2000000000;
+  }
+  pIdxInfo->idxNum = idxNum;
+  return SQLITE_OK;
+}
+
+sqlite3_module systblTransactionLogBatchesModule = {
+  0,                      /* iVersion */
+  0,                      /* xCreate */
+  tranlogBatchConnect,    /* xConnect */
+  tranlogBatchBestIndex,  /* xBestIndex */
+  tranlogDisconnect,      /* xDisconnect */
+  0,                      /* xDestroy */
+  tranlogBatchOpen,       /* xOpen - open a cursor */
+  tranlogBatchClose,      /* xClose - close a cursor */
+  tranlogBatchFilter,     /* xFilter - configure scan constraints */
+  tranlogBatchNext,       /* xNext - advance a cursor */
+  tranlogBatchEof,        /* xEof - check for end of scan */
+  tranlogBatchColumn,     /* xColumn - read data */
+  tranlogBatchRowid,      /* xRowid - read data */
+  0,                      /* xUpdate */
+  0,                      /* xBegin */
+  0,                      /* xSync */
+  0,                      /* xCommit */
+  0,                      /* xRollback */
+  0,                      /* xFindMethod */
+  0,                      /* xRename */
+  0,                      /* xSavepoint */
+  0,                      /* xRelease */
+  0,                      /* xRollbackTo */
+  0,                      /* xShadowName */
+  .access_flag = CDB2_ALLOW_USER | CDB2_STRICT
+};
@@ -5721,6 +5721,50 @@ char *sqlite3DescribeIndexOrder(
   return ret2;
 }
 
+/*
+** Describe the columns of table zName used by a remote cursor: used
+** columns are named, unused ones are replaced by NULL so that the row
+** image keeps its layout.  Returns NULL if all columns are needed.
+*/
+char *sqlite3DescribeTableColumns(
+  sqlite3 *db,
+  const char *zName,
+  const char *zDb,
+  unsigned long long colMask)
+{
+  Table *pTbl;
+  char *ret = NULL, *ret2;
+  int i, nUsed = 0;
+
+  if( colMask==0 || colMask==ALLBITS ) return NULL;
+
+  pTbl = sqlite3FindTable(db, zName, zDb);
+  if( !pTbl ) return NULL;
+
+  for(i=0; i<pTbl->nCol; i++){
+    int used = (colMask & MASKBIT(i<63 ? i : 63))!=0;
+    if( IsHiddenColumn(&pTbl->aCol[i]) ){
+      sqlite3_free(ret);
+      return NULL;
+    }
+    nUsed += used;
+    if( used ){
+      ret2 = sqlite3_mprintf("%s%s\"%w\"", ret ? ret : "", ret ? ", " : "",
+                             pTbl->aCol[i].zName);
+    }else{
+      ret2 = sqlite3_mprintf("%s%sNULL", ret ? ret : "", ret ? ", " : "");
+    }
+    sqlite3_free(ret);
+    ret = ret2;
+    if( !ret ) return NULL;
+  }
+  if( nUsed==pTbl->nCol ){
+    sqlite3_free(ret);
+    return NULL;
+  }
+  return ret;
+}
+
 /*
 ** Reset the schema for all remote dbs from an engine.
 */
@@ -2053,6 +2053,60 @@ clean_arg:
 }
 
 
+void comdb2setZonemap(Parse* pParse, Token* nm, Token* lnm, int enable)
+{
+    if (comdb2IsPrepareOnly(pParse))
+        return;
+
+#ifndef SQLITE_OMIT_AUTHORIZATION
+    {
+        if( sqlite3AuthCheck(pParse, SQLITE_PUT_TUNABLE, 0, 0, 0) ){
+            setError(pParse, SQLITE_AUTH, COMDB2_NOT_AUTHORIZED_ERRMSG);
+            return;
+        }
+    }
+#endif
+
+    if (comdb2AuthenticateUserOp(pParse))
+        return;
+
+    Vdbe *v  = sqlite3GetVdbe(pParse);
+
+    if (enable != 0 && enable != 1) {
+        setError(pParse, SQLITE_ERROR, "Can only enable or disable zonemap");
+        return;
+    }
+
+    BpfuncArg *arg = (BpfuncArg*) malloc(sizeof(BpfuncArg));
+    if (!arg) goto err;
+    bpfunc_arg__init(arg);
+
+    BpfuncAnalyzeCoverage *ancov_f = (BpfuncAnalyzeCoverage*) malloc(sizeof(BpfuncAnalyzeCoverage));
+    if (!ancov_f) goto err;
+    bpfunc_analyze_coverage__init(ancov_f);
+
+    arg->an_cov = ancov_f;
+    arg->type = BPFUNC_SET_ZONEMAP;
+    ancov_f->tablename = (char*) malloc(MAXTABLELEN);
+    if (!ancov_f->tablename) goto err;
+
+    if (chkAndCopyTableTokens(pParse, ancov_f->tablename, nm, lnm,
+                              ERROR_ON_TBL_NOT_FOUND, 1, 0, NULL, /* check_for_illegal_chars */ 0))
+        goto clean_arg;
+
+    ancov_f->newvalue = enable;
+    comdb2prepareNoRows(v, pParse, 0, arg, &comdb2SendBpfunc, 
+                        (vdbeFuncArgFree) &free_bpfunc_arg);
+    return;
+
+err:
+    logmsg(LOGMSG_ERROR, "%s error!\n", __func__);
+    setError(pParse, SQLITE_INTERNAL, "Internal Error");
+clean_arg:
+    if (arg) free_bpfunc_arg(arg);
+}
+
+
 void comdb2enableGenid48(Parse* pParse, int enable)
 {
     if (comdb2IsPrepareOnly(pParse))
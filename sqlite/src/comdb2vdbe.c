@@ -389,3 +389,232 @@ int comdb2GenerateRstMsg(OpFunc *f)
 }
 
 
+
+/*
+** Vectorized aggregation batch.  The values of each row handed to
+** OP_VecAggStep are stored column-major: value j of row r is at
+** aType[j*nCap+r] and aVal[j*nCap+r].
+*/
+typedef struct VecAggState VecAggState;
+struct VecAggState
+{
+    VecAgg *pVec;    /* Values, filters and aggregates of the batch */
+    int nRow;        /* Rows in the batch */
+    int nCap;        /* Capacity of the batch in rows */
+    int bRowPath;    /* A filter constant is not a number: no batching */
+    VecVal *aVal;    /* Values */
+    int *aIdx;       /* Rows that passed the filters */
+    u8 *aType;       /* VECVAL_* type of each value */
+    u8 *aTypes;      /* Per column, (1<<VECVAL_*) of the types seen */
+};
+
+extern int gbl_sql_vectorized_agg_batch;
+extern int64_t gbl_sql_vectorized_agg_rows;
+
+static void vecAggStateFree(void *p)
+{
+    sqlite3_free(p);
+}
+
+/* Return the VECVAL_* type of pMem, or -1 if it cannot be batched. */
+static int vecValType(const Mem *pMem)
+{
+    switch (pMem->flags & MEM_AffMask) {
+    case MEM_Null:
+        return VECVAL_NULL;
+    case MEM_Int:
+        return VECVAL_INT;
+    case MEM_Real:
+        return VECVAL_REAL;
+    }
+    return -1;
+}
+
+static VecAggState *vecAggStateNew(Vdbe *p, VecAgg *pVec)
+{
+    VecAggState *s;
+    int nCap = gbl_sql_vectorized_agg_batch;
+    int nVal = pVec->nVal;
+    int i;
+
+    if (nCap < 64)
+        nCap = 64;
+    else if (nCap > 65536)
+        nCap = 65536;
+    s = sqlite3_malloc64(sizeof(*s) + (i64)nVal * nCap * sizeof(VecVal) +
+                         (i64)nCap * sizeof(int) + (i64)nVal * nCap + nVal);
+    if (s == NULL)
+        return NULL;
+    s->pVec = pVec;
+    s->nRow = 0;
+    s->nCap = nCap;
+    s->bRowPath = 0;
+    s->aVal = (VecVal *)&s[1];
+    s->aIdx = (int *)&s->aVal[nVal * nCap];
+    s->aType = (u8 *)&s->aIdx[nCap];
+    s->aTypes = &s->aType[nVal * nCap];
+    memset(s->aTypes, 0, nVal);
+    for (i = 0; i < pVec->nFilter; i++) {
+        if (vecValType(&p->aMem[pVec->aFilter[i].regConst]) < 0)
+            s->bRowPath = 1;
+    }
+    return s;
+}
+
+#define VEC_SELECT(COND)                                                       \
+    for (k = 0; k < n; k++) {                                                  \
+        int r = aIdx[k];                                                       \
+        aIdx[m] = r;                                                           \
+        m += (COND);                                                           \
+    }                                                                          \
+    break
+
+/*
+** Keep in aIdx[0..n-1] the rows whose value satisfies "value op pConst".
+** Return the number of rows kept.  NULL never satisfies a comparison.
+*/
+static int vecAggFilter(int op, const Mem *pConst, u8 mTypes,
+                        const u8 *aType, const VecVal *aVal, int *aIdx, int n)
+{
+    int t = vecValType(pConst);
+    int m = 0;
+    int k;
+
+    if (t == VECVAL_NULL)
+        return 0;
+    if (t == VECVAL_INT && mTypes == (1 << VECVAL_INT)) {
+        i64 c = pConst->u.i;
+        switch (op) {
+        case TK_LT: VEC_SELECT(aVal[r].i < c);
+        case TK_LE: VEC_SELECT(aVal[r].i <= c);
+        case TK_GT: VEC_SELECT(aVal[r].i > c);
+        case TK_GE: VEC_SELECT(aVal[r].i >= c);
+        case TK_EQ: VEC_SELECT(aVal[r].i == c);
+        default: VEC_SELECT(aVal[r].i != c);
+        }
+    } else if (t == VECVAL_REAL && mTypes == (1 << VECVAL_REAL)) {
+        double c = pConst->u.r;
+        switch (op) {
+        case TK_LT: VEC_SELECT(aVal[r].r < c);
+        case TK_LE: VEC_SELECT(aVal[r].r <= c);
+        case TK_GT: VEC_SELECT(aVal[r].r > c);
+        case TK_GE: VEC_SELECT(aVal[r].r >= c);
+        case TK_EQ: VEC_SELECT(aVal[r].r == c);
+        default: VEC_SELECT(aVal[r].r != c);
+        }
+    } else {
+        VecVal c;
+        if (t == VECVAL_INT)
+            c.i = pConst->u.i;
+        else
+            c.r = pConst->u.r;
+        for (k = 0; k < n; k++) {
+            int r = aIdx[k];
+            int cmp;
+            if (aType[r] == VECVAL_NULL)
+                continue;
+            cmp = sqlite3VecValCompare(aType[r], aVal[r], t, c);
+            switch (op) {
+            case TK_LT: cmp = cmp < 0; break;
+            case TK_LE: cmp = cmp <= 0; break;
+            case TK_GT: cmp = cmp > 0; break;
+            case TK_GE: cmp = cmp >= 0; break;
+            case TK_EQ: cmp = cmp == 0; break;
+            default: cmp = cmp != 0; break;
+            }
+            if (cmp)
+                aIdx[m++] = r;
+        }
+    }
+    return m;
+}
+#undef VEC_SELECT
+
+/* Filter the pending rows and fold them into the accumulators. */
+static int vecAggFold(Vdbe *p, VecAggState *s)
+{
+    VecAgg *pVec = s->pVec;
+    int n = s->nRow;
+    int rc = SQLITE_OK;
+    int i;
+
+    if (n == 0)
+        return SQLITE_OK;
+    gbl_sql_vectorized_agg_rows += n;
+    for (i = 0; i < n; i++)
+        s->aIdx[i] = i;
+    for (i = 0; i < pVec->nFilter && n > 0; i++) {
+        struct VecAggFilter *pF = &pVec->aFilter[i];
+        int off = pF->iVal * s->nCap;
+        n = vecAggFilter(pF->op, &p->aMem[pF->regConst], s->aTypes[pF->iVal],
+                         &s->aType[off], &s->aVal[off], s->aIdx, n);
+    }
+    for (i = 0; i < pVec->nFunc && rc == SQLITE_OK; i++) {
+        struct VecAggFunc *pF = &pVec->aFunc[i];
+        if (pF->iVal < 0) {
+            rc = sqlite3VecAggMerge(&p->aMem[pF->iMem], pF, 0, NULL, NULL,
+                                    s->aIdx, n);
+        } else {
+            int off = pF->iVal * s->nCap;
+            rc = sqlite3VecAggMerge(&p->aMem[pF->iMem], pF,
+                                    s->aTypes[pF->iVal], &s->aType[off],
+                                    &s->aVal[off], s->aIdx, n);
+        }
+    }
+    s->nRow = 0;
+    memset(s->aTypes, 0, pVec->nVal);
+    return rc;
+}
+
+int comdb2VecAggStep(Vdbe *p, Mem *pState, VecAgg *pVec, Mem *aVal,
+                     int *pbRowPath)
+{
+    VecAggState *s;
+    int r, j;
+
+    *pbRowPath = 0;
+    if ((pState->flags & MEM_Dyn) == 0 || pState->xDel != vecAggStateFree) {
+        s = vecAggStateNew(p, pVec);
+        if (s == NULL)
+            return SQLITE_NOMEM_BKPT;
+        sqlite3VdbeMemSetNull(pState);
+        sqlite3VdbeMemSetPointer(pState, s, "vecagg", vecAggStateFree);
+    }
+    s = (VecAggState *)pState->z;
+    if (s->bRowPath) {
+        *pbRowPath = 1;
+        return SQLITE_OK;
+    }
+
+    r = s->nRow;
+    for (j = 0; j < pVec->nVal; j++) {
+        int t = vecValType(&aVal[j]);
+        int off = j * s->nCap + r;
+        if (t < 0) {
+            /* fold the earlier rows first, the accumulators see the rows
+             * in scan order */
+            *pbRowPath = 1;
+            return vecAggFold(p, s);
+        }
+        s->aType[off] = t;
+        if (t == VECVAL_INT)
+            s->aVal[off].i = aVal[j].u.i;
+        else if (t == VECVAL_REAL)
+            s->aVal[off].r = aVal[j].u.r;
+        s->aTypes[j] |= (1 << t);
+    }
+    if (++s->nRow == s->nCap)
+        return vecAggFold(p, s);
+    return SQLITE_OK;
+}
+
+int comdb2VecAggFlush(Vdbe *p, Mem *pState)
+{
+    int rc = SQLITE_OK;
+
+    if ((pState->flags & MEM_Dyn) && pState->xDel == vecAggStateFree) {
+        rc = vecAggFold(p, (VecAggState *)pState->z);
+        sqlite3VdbeMemSetNull(pState);
+    }
+    return rc;
+}
@@ -49,6 +49,10 @@ struct rstMsg
 int comdb2GenerateRstMsg(OpFunc *f);
 void free_rstMsg(struct rstMsg* rec);
 
+int comdb2VecAggStep(Vdbe *p, Mem *pState, VecAgg *pVec, Mem *aVal,
+    int *pbRowPath);
+int comdb2VecAggFlush(Vdbe *p, Mem *pState);
+
 int resolveTableName(sqlite3 *db, struct SrcList_item *p, const char *zDb,
                      char *tablename, size_t len);
 
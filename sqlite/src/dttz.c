@@ -90,6 +90,29 @@ void func_needs_vdbe(sqlite3_context *context, FuncDef *pFunc, Vdbe *pVdbe)
         context->pVdbe = pVdbe;
 }
 
+/* Built-ins which sqlite takes for constant, but whose results depend on the
+ * session, the previous query or the state of the database */
+static const char *session_funcs[] = {
+    "comdb2_user",         "comdb2_last_cost", "comdb2_prevquerycost",
+    "comdb2_snapshot_lsn", "comdb2_ctxinfo",   "comdb2_sysinfo",
+    "table_version",       "partition_info"};
+
+/* Can two calls with the same arguments return different results? */
+int func_is_volatile(FuncDef *pFunc)
+{
+    if (!(pFunc->funcFlags & SQLITE_FUNC_CONSTANT) ||
+        (pFunc->funcFlags & SQLITE_FUNC_SLOCHNG))
+        return 1;
+    if (pFunc->xSFunc == currentTS || pFunc->xSFunc == nowFunc ||
+        pFunc->xSFunc == nextSequence)
+        return 1;
+    for (int i = 0; i < sizeof(session_funcs) / sizeof(session_funcs[0]); i++) {
+        if (sqlite3StrICmp(pFunc->zName, session_funcs[i]) == 0)
+            return 1;
+    }
+    return 0;
+}
+
 static int _convMem2ClientDatetime(Mem *pMem, void *out, int outlen,
         int *outdtsz, int isstring)
 {
@@ -416,5 +439,6 @@ static void monthsFunc(sqlite3_context *context, int argc, sqlite3_value **argv)
 const char *get_clnt_tz()
 {
   struct sql_thread *thd = pthread_getspecific(query_info_key);
-  return ( thd && thd->clnt ) ? thd->clnt->tzname : NULL;
+  /* sorter threads compare records for a query running on another thread */
+  return ( thd && thd->clnt ) ? thd->clnt->tzname : sqlsorter_tz();
 }
@@ -4042,6 +4042,9 @@ expr_code_doover:
       {
 #if defined(SQLITE_BUILDING_FOR_COMDB2)
         stmt_set_has_scalar_func((sqlite3_stmt *)v, 1);
+        if( func_is_volatile(pDef) ){
+          stmt_set_has_volatile_func((sqlite3_stmt *)v, 1);
+        }
 #endif /* defined(SQLITE_BUILDING_FOR_COMDB2) */
         sqlite3VdbeAddOp4(v, pParse->iSelfTab ? OP_PureFunc0 : OP_Function0,
                           constMask, r1, target, (char*)pDef, P4_FUNCDEF);
@@ -5299,6 +5302,44 @@ int sqlite3ExprCoveredByIndex(
   return !w.eCode;
 }
 
+#if defined(SQLITE_BUILDING_FOR_COMDB2)
+/*
+** Return true if pE is a comparison between a column of the table with
+** cursor iCur that has INTEGER or REAL affinity and a numeric literal or
+** a parameter.  Such terms can be evaluated by OP_VecAggStep on batches
+** of rows.  The test does not depend on which side the column is, as
+** the WHERE clause analysis may commute the comparison.
+*/
+int sqlite3ExprIsVecFilter(Expr *pE, int iCur){
+  Expr *pCol;
+  Expr *pVal;
+  char aff;
+
+  switch( pE->op ){
+    case TK_LT: case TK_LE: case TK_GT: case TK_GE: case TK_EQ: case TK_NE:
+      break;
+    default:
+      return 0;
+  }
+  if( ExprHasProperty(pE, EP_FromJoin) ) return 0;
+  pCol = pE->pLeft;
+  pVal = pE->pRight;
+  if( pCol->op!=TK_COLUMN ){
+    pCol = pE->pRight;
+    pVal = pE->pLeft;
+  }
+  if( pCol->op!=TK_COLUMN || pCol->iTable!=iCur || pCol->iColumn<0 ){
+    return 0;
+  }
+  if( pVal->op==TK_UMINUS ) pVal = pVal->pLeft;
+  if( pVal->op!=TK_INTEGER && pVal->op!=TK_FLOAT && pVal->op!=TK_VARIABLE ){
+    return 0;
+  }
+  aff = sqlite3ExprAffinity(pCol);
+  return aff==SQLITE_AFF_INTEGER || aff==SQLITE_AFF_REAL;
+}
+#endif /* defined(SQLITE_BUILDING_FOR_COMDB2) */
+
 
 /*
 ** An instance of the following structure is used by the tree walker
@@ -2670,6 +2670,183 @@ static void minMaxFinalize(sqlite3_context *context){
   minMaxValueFinalize(context, 0);
 }
 
+#if defined(SQLITE_BUILDING_FOR_COMDB2)
+/*
+** Return the VECAGG_* kind of aggregate pFunc called with nArg arguments,
+** or 0 if the vectorized aggregation cannot compute it.
+*/
+int sqlite3VecAggKind(FuncDef *pFunc, int nArg){
+  if( pFunc->xSFunc==countStep ) return VECAGG_COUNT;
+  if( nArg!=1 ) return 0;
+  if( pFunc->xSFunc==sumStep ) return VECAGG_SUM;
+  if( pFunc->xSFunc==minmaxStep ){
+    return pFunc->pUserData ? VECAGG_MAX : VECAGG_MIN;
+  }
+  return 0;
+}
+
+/*
+** Compare two non-NULL vectorized aggregation values of type t1 and t2
+** (VECVAL_INT or VECVAL_REAL) the way sqlite3MemCompare() compares
+** numbers.
+*/
+int sqlite3VecValCompare(u8 t1, VecVal v1, u8 t2, VecVal v2){
+  if( t1==VECVAL_INT ){
+    if( t2==VECVAL_INT ) return v1.i<v2.i ? -1 : v1.i>v2.i;
+    return sqlite3IntFloatCompare(v1.i, v2.r);
+  }
+  if( t2==VECVAL_INT ) return -sqlite3IntFloatCompare(v2.i, v1.r);
+  if( v1.r<v2.r ) return -1;
+  return v1.r>v2.r;
+}
+
+/*
+** Return the aggregate context of accumulator pAcc, creating it the way
+** sqlite3_aggregate_context() does on the first call.
+*/
+static void *vecAggContext(Mem *pAcc, FuncDef *pFunc, int nByte){
+  if( (pAcc->flags & MEM_Agg)==0 ){
+    if( sqlite3VdbeMemClearAndResize(pAcc, nByte) ) return 0;
+    pAcc->flags = MEM_Agg;
+    pAcc->u.pDef = pFunc;
+    memset(pAcc->z, 0, nByte);
+  }
+  return (void*)pAcc->z;
+}
+
+/*
+** Fold the rows aIdx[0..n-1] of the value vector aType[]/aVal[] into the
+** accumulator pAcc of aggregate pF.  mTypes has bit (1<<VECVAL_*) set for
+** each type present in the vector.  Rows are folded in order, so the
+** result is the same as n calls to the xStep function of pF.
+*/
+int sqlite3VecAggMerge(
+  Mem *pAcc,
+  const struct VecAggFunc *pF,
+  u8 mTypes,
+  const u8 *aType,
+  const VecVal *aVal,
+  const int *aIdx,
+  int n
+){
+  int k;
+
+  if( n==0 ) return SQLITE_OK;
+  pAcc->n += n;
+  switch( pF->eKind ){
+    case VECAGG_COUNT: {
+      CountCtx *p = vecAggContext(pAcc, pF->pFunc, sizeof(*p));
+      if( p==0 ) return SQLITE_NOMEM_BKPT;
+      if( pF->iVal<0 || (mTypes & (1<<VECVAL_NULL))==0 ){
+        p->n += n;
+      }else{
+        for(k=0; k<n; k++) p->n += (aType[aIdx[k]]!=VECVAL_NULL);
+      }
+      break;
+    }
+    case VECAGG_SUM: {
+      SumCtx *p = vecAggContext(pAcc, pF->pFunc, sizeof(*p));
+      if( p==0 ) return SQLITE_NOMEM_BKPT;
+      if( mTypes==(1<<VECVAL_INT) ){
+        for(k=0; k<n; k++){
+          i64 v = aVal[aIdx[k]].i;
+          p->rSum += v;
+          if( (p->approx|p->overflow)==0 && sqlite3AddInt64(&p->iSum, v) ){
+            p->approx = p->overflow = 1;
+          }
+        }
+        p->cnt += n;
+      }else if( mTypes==(1<<VECVAL_REAL) ){
+        double r = p->rSum;
+        for(k=0; k<n; k++) r += aVal[aIdx[k]].r;
+        p->rSum = r;
+        p->cnt += n;
+        p->approx = 1;
+      }else{
+        for(k=0; k<n; k++){
+          int i = aIdx[k];
+          if( aType[i]==VECVAL_INT ){
+            i64 v = aVal[i].i;
+            p->cnt++;
+            p->rSum += v;
+            if( (p->approx|p->overflow)==0 && sqlite3AddInt64(&p->iSum, v) ){
+              p->approx = p->overflow = 1;
+            }
+          }else if( aType[i]==VECVAL_REAL ){
+            p->cnt++;
+            p->rSum += aVal[i].r;
+            p->approx = 1;
+          }
+        }
+      }
+      break;
+    }
+    case VECAGG_MIN:
+    case VECAGG_MAX: {
+      int bMax = pF->eKind==VECAGG_MAX;
+      u8 tBest = VECVAL_NULL;
+      VecVal vBest;
+      Mem *pBest;
+      Mem x;
+
+      /* Find the best value of the batch.  As in minmaxStep(), the first
+      ** of several equal values wins. */
+      vBest.i = 0;
+      if( mTypes==(1<<VECVAL_INT) ){
+        i64 b = aVal[aIdx[0]].i;
+        for(k=1; k<n; k++){
+          i64 v = aVal[aIdx[k]].i;
+          if( bMax ? v>b : v<b ) b = v;
+        }
+        tBest = VECVAL_INT;
+        vBest.i = b;
+      }else if( mTypes==(1<<VECVAL_REAL) ){
+        double b = aVal[aIdx[0]].r;
+        for(k=1; k<n; k++){
+          double v = aVal[aIdx[k]].r;
+          if( bMax ? v>b : v<b ) b = v;
+        }
+        tBest = VECVAL_REAL;
+        vBest.r = b;
+      }else{
+        for(k=0; k<n; k++){
+          int i = aIdx[k];
+          int c;
+          if( aType[i]==VECVAL_NULL ) continue;
+          if( tBest!=VECVAL_NULL ){
+            c = sqlite3VecValCompare(tBest, vBest, aType[i], aVal[i]);
+            if( bMax ? c>=0 : c<=0 ) continue;
+          }
+          tBest = aType[i];
+          vBest = aVal[i];
+        }
+        if( tBest==VECVAL_NULL ) break;
+      }
+
+      pBest = vecAggContext(pAcc, pF->pFunc, sizeof(*pBest));
+      if( pBest==0 ) return SQLITE_NOMEM_BKPT;
+      sqlite3VdbeMemInit(&x, pAcc->db, tBest==VECVAL_INT ? MEM_Int : MEM_Real);
+      if( tBest==VECVAL_INT ){
+        x.u.i = vBest.i;
+      }else{
+        x.u.r = vBest.r;
+      }
+      if( pBest->flags ){
+        int c = sqlite3MemCompare(pBest, &x, 0);
+        if( (bMax && c<0) || (!bMax && c>0) ){
+          sqlite3VdbeMemCopy(pBest, &x);
+        }
+      }else{
+        pBest->db = pAcc->db;
+        sqlite3VdbeMemCopy(pBest, &x);
+      }
+      break;
+    }
+  }
+  return SQLITE_OK;
+}
+#endif /* defined(SQLITE_BUILDING_FOR_COMDB2) */
+
 /*
 ** group_concat(EXPR, ?SEPARATOR?)
 */
@@ -117,6 +117,15 @@ static malloc_zone_t* _sqliteZone_;
 
 #endif /* __APPLE__ or not __APPLE__ */
 
+/*
+** The word in front of each allocation holds its size, and for comdb2 the
+** epoch of the memory account it was charged to in the upper 32 bits.
+*/
+#define MEM1_SIZE(w)       ((w) & 0xffffffff)
+#define MEM1_EPOCH(w)      ((u32)((sqlite3_uint64)(w) >> 32))
+#define MEM1_TAG(n, epoch) \
+  ((sqlite3_int64)((sqlite3_uint64)(n) | ((sqlite3_uint64)(epoch) << 32)))
+
 /*
 ** Like malloc(), but remember the size of the allocation
 ** so that we can find it later using sqlite3MemSize().
@@ -165,7 +174,14 @@ static void *sqlite3MemMalloc(size_t nByte){
   p = SQLITE_MALLOC( nByte+8 );
 #endif /* defined(SQLITE_BUILDING_FOR_COMDB2) */
   if( p ){
+#if defined(SQLITE_BUILDING_FOR_COMDB2)
+    /* the upper half of the size word holds the epoch of the account which
+    ** is charged, so that a later query doesn't get the free */
+    p[0] = MEM1_TAG(nByte, comdb2ma_acct_epoch());
+    comdb2ma_acct_charge(nByte);
+#else /* defined(SQLITE_BUILDING_FOR_COMDB2) */
     p[0] = nByte;
+#endif /* defined(SQLITE_BUILDING_FOR_COMDB2) */
     p++;
   }else{
     testcase( sqlite3GlobalConfig.xLog!=0 );
@@ -190,6 +206,9 @@ static void sqlite3MemFree(void *pPrior){
   sqlite3_int64 *p = (sqlite3_int64*)pPrior;
   assert( pPrior!=0 );
   p--;
+#if defined(SQLITE_BUILDING_FOR_COMDB2)
+  comdb2ma_acct_uncharge(MEM1_EPOCH(p[0]), MEM1_SIZE(p[0]));
+#endif /* defined(SQLITE_BUILDING_FOR_COMDB2) */
   SQLITE_FREE(p);
 #endif
 }
@@ -207,7 +226,7 @@ static int sqlite3MemSize(void *pPrior){
   assert( pPrior!=0 );
   p = (sqlite3_int64*)pPrior;
   p--;
-  return (int)p[0];
+  return (int)MEM1_SIZE(p[0]);
 #endif
 }
 
@@ -233,12 +252,30 @@ static void *sqlite3MemRealloc(void *pPrior, int nByte){
   return p;
 #else
   sqlite3_int64 *p = (sqlite3_int64*)pPrior;
+#if defined(SQLITE_BUILDING_FOR_COMDB2)
+  sqlite3_int64 nOld;
+  u32 epoch;
+#endif /* defined(SQLITE_BUILDING_FOR_COMDB2) */
   assert( pPrior!=0 && nByte>0 );
   assert( nByte==ROUND8(nByte) ); /* EV: R-46199-30249 */
   p--;
+#if defined(SQLITE_BUILDING_FOR_COMDB2)
+  nOld = MEM1_SIZE(p[0]);
+  epoch = MEM1_EPOCH(p[0]);
+#endif /* defined(SQLITE_BUILDING_FOR_COMDB2) */
   p = SQLITE_REALLOC(p, nByte+8 );
   if( p ){
+#if defined(SQLITE_BUILDING_FOR_COMDB2)
+    /* memory charged to an earlier account moves to this one */
+    if( epoch!=0 && epoch==comdb2ma_acct_epoch() ){
+      comdb2ma_acct_charge(nByte - nOld);
+    }else{
+      comdb2ma_acct_charge(nByte);
+    }
+    p[0] = MEM1_TAG(nByte, comdb2ma_acct_epoch());
+#else /* defined(SQLITE_BUILDING_FOR_COMDB2) */
     p[0] = nByte;
+#endif /* defined(SQLITE_BUILDING_FOR_COMDB2) */
     p++;
   }else{
     testcase( sqlite3GlobalConfig.xLog!=0 );
@@ -392,7 +392,7 @@ columnname(A) ::= nm(A) typetoken(Y). {sqlite3AddColumn(pParse,&A,&Y);}
   REBUILD READ READONLY REC RESERVED RESUME RETENTION RETROACTIVELY REVOKE RLE ROWLOCKS
   SCALAR SCHEMACHANGE SKIPSCAN START SUMMARIZE
   TESTDEFAULT TESTGENSHARD THREADS THRESHOLD TIME TRUNCATE TRUNCOPLOG TUNABLE TYPE
-  VERSION WRITE DDL USERSCHEMA ZLIB
+  VERSION WRITE DDL USERSCHEMA ZLIB ZONEMAP
 %endif SQLITE_BUILDING_FOR_COMDB2
   .
 %wildcard ANY.
@@ -2293,6 +2293,14 @@ putcmd ::= SKIPSCAN DISABLE nm(Y) dbnm(Z). {
     comdb2setSkipscan(pParse,&Y, &Z, 0);
 }
 
+putcmd ::= ZONEMAP ENABLE nm(Y) dbnm(Z). {
+    comdb2setZonemap(pParse,&Y, &Z, 1);
+}
+
+putcmd ::= ZONEMAP DISABLE nm(Y) dbnm(Z). {
+    comdb2setZonemap(pParse,&Y, &Z, 0);
+}
+
 putcmd ::= DEFAULT PROCEDURE nm(N) INTEGER(V). {
     comdb2DefaultProcedure(pParse,&N,&V,0);
 }
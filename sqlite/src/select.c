@@ -5532,6 +5532,165 @@ static void explainSimpleCount(
 # define explainSimpleCount(a,b,c)
 #endif
 
+#if defined(SQLITE_BUILDING_FOR_COMDB2)
+#define VECAGG_MAX_VALUES 32    /* Most values collected per row */
+
+/*
+** Return true if the aggregate query p without GROUP BY can be computed
+** by OP_VecAggStep: a scan of a single table feeding count(), sum(),
+** total(), avg(), min() and max() over numeric columns of that table.
+*/
+static int vecAggIsEligible(
+  Parse *pParse,                  /* Parse context */
+  Select *p,                      /* The aggregate query */
+  AggInfo *pAggInfo,              /* Aggregates of p */
+  int minMaxFlag                  /* Min/max optimization flag */
+){
+  extern int gbl_sql_vectorized_agg;
+  SrcList *pTabList = p->pSrc;
+  Table *pTab;
+  int iCur;
+  int i;
+
+  if( !gbl_sql_vectorized_agg ) return 0;
+  if( !ConstFactorOk(pParse) || minMaxFlag!=WHERE_ORDERBY_NORMAL ) return 0;
+  if( pTabList->nSrc!=1 || pAggInfo->nAccumulator>0 ) return 0;
+  if( pAggInfo->nFunc==0 || pAggInfo->nFunc>VECAGG_MAX_VALUES ) return 0;
+#ifndef SQLITE_OMIT_WINDOWFUNC
+  if( p->pWin ) return 0;
+#endif
+  pTab = pTabList->a[0].pTab;
+  if( pTab==0 || IsVirtual(pTab) || pTab->pSelect || pTabList->a[0].pSelect ){
+    return 0;
+  }
+  iCur = pTabList->a[0].iCursor;
+  for(i=0; i<pAggInfo->nFunc; i++){
+    struct AggInfo_func *pF = &pAggInfo->aFunc[i];
+    ExprList *pList = pF->pExpr->x.pList;
+    Expr *pArg;
+    char aff;
+    if( pF->iDistinct>=0 || ExprHasProperty(pF->pExpr, EP_WinFunc) ) return 0;
+    if( sqlite3VecAggKind(pF->pFunc, pList ? pList->nExpr : 0)==0 ) return 0;
+    if( pList==0 || pList->nExpr==0 ) continue;
+    if( pList->nExpr!=1 ) return 0;
+    pArg = pList->a[0].pExpr;
+    if( pArg->op!=TK_AGG_COLUMN && pArg->op!=TK_COLUMN ) return 0;
+    if( pArg->iTable!=iCur || pArg->iColumn<0 ) return 0;
+    aff = sqlite3ExprAffinity(pArg);
+    if( aff!=SQLITE_AFF_INTEGER && aff!=SQLITE_AFF_REAL ) return 0;
+  }
+  return 1;
+}
+
+/*
+** Add the AND-connected terms of pWhere accepted by sqlite3ExprIsVecFilter()
+** to apFilter[], which already holds nFilter terms.  Return the new number
+** of terms, or -1 if there are more than VECAGG_MAX_VALUES of them.
+*/
+static int vecAggFilters(Expr *pWhere, int iCur, Expr **apFilter, int nFilter){
+  if( pWhere==0 || nFilter<0 ) return nFilter;
+  if( pWhere->op==TK_AND ){
+    nFilter = vecAggFilters(pWhere->pLeft, iCur, apFilter, nFilter);
+    return vecAggFilters(pWhere->pRight, iCur, apFilter, nFilter);
+  }
+  if( sqlite3ExprIsVecFilter(pWhere, iCur) ){
+    if( nFilter==VECAGG_MAX_VALUES ) return -1;
+    apFilter[nFilter++] = pWhere;
+  }
+  return nFilter;
+}
+
+/*
+** Generate the body of the aggregate loop for the vectorized aggregation.
+** The filter columns and the aggregate arguments of the current row are
+** handed to OP_VecAggStep.  Rows it cannot batch fall through to the
+** regular filter and accumulator code.  The WHERE clause loop was begun
+** with WHERE_VECFILTER, so the apFilter[] terms have not been tested yet.
+*/
+static void vecAggCodeStep(
+  Parse *pParse,                  /* Parse context */
+  AggInfo *pAggInfo,              /* Aggregates to compute */
+  Expr **apFilter,                /* Filters left to OP_VecAggStep */
+  int nFilter,                    /* Number of entries in apFilter[] */
+  int regState                    /* Register holding the batch */
+){
+  Vdbe *v = pParse->pVdbe;
+  VecAgg *pVec;
+  Expr *aArg[VECAGG_MAX_VALUES];  /* Distinct aggregate arguments */
+  int nArg = 0;
+  int regVal;
+  int addrRow;
+  int addrCont;
+  int i, j;
+
+  pVec = sqlite3DbMallocZero(pParse->db, sizeof(VecAgg)
+                             + pAggInfo->nFunc*sizeof(struct VecAggFunc)
+                             + nFilter*sizeof(struct VecAggFilter));
+  addrCont = sqlite3VdbeMakeLabel(pParse);
+  if( pVec ){
+    pVec->aFunc = (struct VecAggFunc*)&pVec[1];
+    pVec->aFilter = (struct VecAggFilter*)&pVec->aFunc[pAggInfo->nFunc];
+    pVec->nFunc = pAggInfo->nFunc;
+    pVec->nFilter = nFilter;
+    for(i=0; i<pAggInfo->nFunc; i++){
+      struct AggInfo_func *pF = &pAggInfo->aFunc[i];
+      ExprList *pList = pF->pExpr->x.pList;
+      struct VecAggFunc *pV = &pVec->aFunc[i];
+      pV->pFunc = pF->pFunc;
+      pV->iMem = pF->iMem;
+      pV->eKind = sqlite3VecAggKind(pF->pFunc, pList ? pList->nExpr : 0);
+      pV->iVal = -1;
+      if( pList && pList->nExpr ){
+        Expr *pArg = pList->a[0].pExpr;
+        for(j=0; j<nArg && sqlite3ExprCompare(0, aArg[j], pArg, -1); j++){}
+        if( j==nArg ) aArg[nArg++] = pArg;
+        pV->iVal = nFilter + j;
+      }
+    }
+    pVec->nVal = nFilter + nArg;
+    regVal = pParse->nMem+1;
+    pParse->nMem += pVec->nVal;
+
+    pAggInfo->directMode = 1;
+    for(i=0; i<nFilter; i++){
+      Expr *pE = apFilter[i];
+      Expr *pCol = pE->pLeft;
+      Expr *pConst = pE->pRight;
+      int op = pE->op;
+      if( pCol->op!=TK_COLUMN ){
+        pCol = pE->pRight;
+        pConst = pE->pLeft;
+        switch( op ){
+          case TK_LT: op = TK_GT; break;
+          case TK_LE: op = TK_GE; break;
+          case TK_GT: op = TK_LT; break;
+          case TK_GE: op = TK_LE; break;
+        }
+      }
+      pVec->aFilter[i].op = op;
+      pVec->aFilter[i].iVal = i;
+      pVec->aFilter[i].regConst = sqlite3ExprCodeAtInit(pParse, pConst, -1);
+      sqlite3ExprCode(pParse, pCol, regVal+i);
+    }
+    for(j=0; j<nArg; j++){
+      sqlite3ExprCode(pParse, aArg[j], regVal+nFilter+j);
+    }
+    pAggInfo->directMode = 0;
+
+    addrRow = sqlite3VdbeMakeLabel(pParse);
+    sqlite3VdbeAddOp4(v, OP_VecAggStep, regState, addrRow, regVal,
+                      (char*)pVec, P4_DYNBLOB);
+    sqlite3VdbeGoto(v, addrCont);
+    sqlite3VdbeResolveLabel(v, addrRow);
+  }
+  for(i=0; i<nFilter; i++){
+    sqlite3ExprIfFalse(pParse, apFilter[i], addrCont, SQLITE_JUMPIFNULL);
+  }
+  updateAccumulator(pParse, 0, pAggInfo);
+  sqlite3VdbeResolveLabel(v, addrCont);
+}
+#endif /* defined(SQLITE_BUILDING_FOR_COMDB2) */
+
 #if defined(SQLITE_BUILDING_FOR_COMDB2)
 /*
 **
@@ -6294,6 +6453,9 @@ int sqlite3Select(
 
     /* Begin the database scan. */
     SELECTTRACE(1,pParse,p,("WhereBegin\n"));
+#if defined(SQLITE_BUILDING_FOR_COMDB2)
+    pParse->pWhereSelect = p;
+#endif /* defined(SQLITE_BUILDING_FOR_COMDB2) */
     pWInfo = sqlite3WhereBegin(pParse, pTabList, pWhere, sSort.pOrderBy,
                                p->pEList, wctrlFlags, p->nSelectRow);
     if( pWInfo==0 ) goto select_end;
@@ -6506,6 +6668,9 @@ int sqlite3Select(
       */
       sqlite3VdbeAddOp2(v, OP_Gosub, regReset, addrReset);
       SELECTTRACE(1,pParse,p,("WhereBegin\n"));
+#if defined(SQLITE_BUILDING_FOR_COMDB2)
+      pParse->pWhereSelect = p;
+#endif /* defined(SQLITE_BUILDING_FOR_COMDB2) */
       pWInfo = sqlite3WhereBegin(pParse, pTabList, pWhere, pGroupBy, 0,
           WHERE_GROUPBY | (orderByGrp ? WHERE_SORTBYGROUP : 0), 0
       );
@@ -6799,12 +6964,45 @@ int sqlite3Select(
         assert( minMaxFlag==WHERE_ORDERBY_NORMAL || pMinMaxOrderBy!=0 );
         assert( pMinMaxOrderBy==0 || pMinMaxOrderBy->nExpr==1 );
 
+#if defined(SQLITE_BUILDING_FOR_COMDB2)
+        /* With vectorized aggregation the loop body batches the rows and
+        ** OP_VecAggStep evaluates the simple numeric filters, so they are
+        ** left out of the WHERE clause loop.  */
+        Expr *apVecFilter[VECAGG_MAX_VALUES];
+        int nVecFilter = -1;
+        int regVecState = 0;
+        if( vecAggIsEligible(pParse, p, &sAggInfo, minMaxFlag) ){
+          nVecFilter = vecAggFilters(pWhere, pTabList->a[0].iCursor,
+                                     apVecFilter, 0);
+          if( nVecFilter>=0
+           && nVecFilter+sAggInfo.nFunc>VECAGG_MAX_VALUES ){
+            nVecFilter = -1;
+          }
+        }
+        if( nVecFilter>=0 ){
+          regVecState = ++pParse->nMem;
+          sqlite3VdbeAddOp2(v, OP_Null, 0, regVecState);
+          ExplainQueryPlan((pParse, 0, "USE VECTORIZED AGGREGATE"));
+        }
+#endif /* defined(SQLITE_BUILDING_FOR_COMDB2) */
         SELECTTRACE(1,pParse,p,("WhereBegin\n"));
+#if defined(SQLITE_BUILDING_FOR_COMDB2)
+        pParse->pWhereSelect = p;
+        pWInfo = sqlite3WhereBegin(pParse, pTabList, pWhere, pMinMaxOrderBy, 0,
+                      minMaxFlag | (regVecState ? WHERE_VECFILTER : 0), 0);
+#else
         pWInfo = sqlite3WhereBegin(pParse, pTabList, pWhere, pMinMaxOrderBy,
                                    0, minMaxFlag, 0);
+#endif /* defined(SQLITE_BUILDING_FOR_COMDB2) */
         if( pWInfo==0 ){
           goto select_end;
         }
+#if defined(SQLITE_BUILDING_FOR_COMDB2)
+        if( regVecState ){
+          vecAggCodeStep(pParse, &sAggInfo, apVecFilter, nVecFilter,
+                         regVecState);
+        }else
+#endif /* defined(SQLITE_BUILDING_FOR_COMDB2) */
         updateAccumulator(pParse, regAcc, &sAggInfo);
         if( regAcc ) sqlite3VdbeAddOp2(v, OP_Integer, 1, regAcc);
         if( sqlite3WhereIsOrdered(pWInfo)>0 ){
@@ -6813,6 +7011,11 @@ int sqlite3Select(
                 (minMaxFlag==WHERE_ORDERBY_MIN?"min":"max")));
         }
         sqlite3WhereEnd(pWInfo);
+#if defined(SQLITE_BUILDING_FOR_COMDB2)
+        if( regVecState ){
+          sqlite3VdbeAddOp1(v, OP_VecAggFlush, regVecState);
+        }
+#endif /* defined(SQLITE_BUILDING_FOR_COMDB2) */
         finalizeAggFunctions(pParse, &sAggInfo);
       }
 
@@ -4860,6 +4860,8 @@ char *stmt_cached_column_decltype(sqlite3_stmt *pStmt, int index);
 void stmt_set_cached_columns(sqlite3_stmt *, char **, char **, int);
 void stmt_set_vlock_tables(sqlite3_stmt *, char **, int, int, int);
 void stmt_set_has_scalar_func(sqlite3_stmt *, int);
+void stmt_set_has_volatile_func(sqlite3_stmt *, int);
+int stmt_has_volatile_func(sqlite3_stmt *);
 int stmt_do_column_names_match(sqlite3_stmt *);
 int stmt_do_column_decltypes_match(sqlite3_stmt *pStmt);
 #endif /* defined(SQLITE_BUILDING_FOR_COMDB2) */
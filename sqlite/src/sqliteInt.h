@@ -2880,7 +2880,7 @@ struct SrcList {
 #define WHERE_SORTBYGROUP      0x0200 /* Support sqlite3WhereIsSorted() */
                         /*     0x0400    not currently used */
 #define WHERE_ORDERBY_LIMIT    0x0800 /* ORDERBY+LIMIT on the inner loop */
-                        /*     0x1000    not currently used */
+#define WHERE_VECFILTER        0x1000 /* Leave vector filters uncoded */
                         /*     0x2000    not currently used */
 #define WHERE_USE_LIMIT        0x4000 /* Use the LIMIT in cost estimates */
                         /*     0x8000    not currently used */
@@ -3391,6 +3391,7 @@ struct Parse {
                              * enabled, this will contain the table names
                              * which were discovered in the SELECT query. */
   u8 isDryrun;              /* Is a dryrun command */
+  Select *pWhereSelect;     /* SELECT planned by the next sqlite3WhereBegin() */
 #endif /* defined(SQLITE_BUILDING_FOR_COMDB2) */
 };
 
@@ -3755,6 +3756,9 @@ struct Walker {
     struct WindowRewrite *pRewrite;           /* Window rewrite context */
     struct WhereConst *pConst;                /* WHERE clause constants */
     struct RenameCtx *pRename;                /* RENAME COLUMN context */
+#if defined(SQLITE_BUILDING_FOR_COMDB2)
+    struct CoveringIndexCheck *pCovIdxCk;     /* Check for covering index */
+#endif /* defined(SQLITE_BUILDING_FOR_COMDB2) */
   } u;
 };
 
@@ -5062,6 +5066,59 @@ char *sqlite3DescribeIndexOrder(sqlite3 *db,
       int op,
       int is_equality,
       unsigned long long colMask);
+char *sqlite3DescribeTableColumns(sqlite3 *db,
+      const char *zName, const char *zDb,
+      unsigned long long colMask);
+
+/*
+** Vectorized aggregation.  For "SELECT agg(x),... FROM t WHERE <filters>"
+** with count/sum/total/avg/min/max over numeric columns, OP_VecAggStep
+** copies the filter columns and the aggregate arguments of each row into
+** column vectors, and the batch is filtered and aggregated by type
+** specialized loops instead of one OP_AggStep per row and function.
+** The filters are comparisons of a numeric column with a numeric
+** literal or a parameter.  Rows with values the loops do not handle run
+** through the regular row at a time code.
+*/
+#define VECAGG_COUNT    1   /* count(*) and count(x) */
+#define VECAGG_SUM      2   /* sum(x), total(x) and avg(x) */
+#define VECAGG_MIN      3
+#define VECAGG_MAX      4
+
+#define VECVAL_NULL     0
+#define VECVAL_INT      1
+#define VECVAL_REAL     2
+
+typedef union VecVal VecVal;
+union VecVal {
+  i64 i;
+  double r;
+};
+
+typedef struct VecAgg VecAgg;
+struct VecAgg {
+  int nVal;                 /* Values collected per row */
+  int nFilter;              /* Number of entries in aFilter[] */
+  int nFunc;                /* Number of entries in aFunc[] */
+  struct VecAggFunc {
+    FuncDef *pFunc;         /* The aggregate function */
+    int eKind;              /* VECAGG_* */
+    int iVal;               /* Argument value, -1 for count(*) */
+    int iMem;               /* Accumulator register */
+  } *aFunc;
+  struct VecAggFilter {
+    int op;                 /* TK_LT, TK_LE, TK_GT, TK_GE, TK_EQ or TK_NE */
+    int iVal;               /* Column value, compared as "column op const" */
+    int regConst;           /* Register holding the constant */
+  } *aFilter;
+};
+
+int sqlite3ExprIsVecFilter(Expr *pE, int iCur);
+int sqlite3VecAggKind(FuncDef *pFunc, int nArg);
+int func_is_volatile(FuncDef *pFunc);
+int sqlite3VecAggMerge(Mem *pAcc, const struct VecAggFunc *pF, u8 mTypes,
+      const u8 *aType, const VecVal *aVal, const int *aIdx, int n);
+int sqlite3VecValCompare(u8 t1, VecVal v1, u8 t2, VecVal v2);
 
 #if defined(SQLITE_ENABLE_DBSTAT_VTAB) || defined(SQLITE_TEST)
 int sqlite3DbstatRegister(sqlite3*);
@@ -246,6 +246,7 @@ int sqlite3BtreeCursor(
 );
 
 BtCursor *sqlite3BtreeFakeValidCursor(void);
+void sqlite3BtreeSetHashJoin(Btree*, int nKeyField);
 int sqlite3BtreeCursorSize(void);
 void sqlite3BtreeCursorZero(BtCursor*);
 
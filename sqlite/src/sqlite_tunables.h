@@ -8,5 +8,9 @@ DEF_ATTR(DISABLE_IN_MULTIPLIER_PENALTY, disable_in_multiplier_pentalty, BOOLEAN,
 DEF_ATTR(STAT4_SAMPLES_MULTIPLIER, stat4_samples_multiplier, QUANTITY, 0)
 /* stat4 number of samples more than the default 24 */
 DEF_ATTR(STAT4_EXTRA_SAMPLES, stat4_extra_samples, QUANTITY, 0)
+/* cost every join order of joins with up to this many tables (at most 12) */
+DEF_ATTR(EXHAUSTIVE_JOIN_LIMIT, exhaustive_join_limit, QUANTITY, 0)
+/* build automatic indexes of equi-joins as hash tables */
+DEF_ATTR(HASH_JOIN, hash_join, BOOLEAN, 0)
 /* build sqlite_stat1 table entries for empty tables */
 DEF_ATTR(ANALYZE_EMPTY_TABLES, analyze_empty_tables, BOOLEAN, 0)
@@ -4396,13 +4396,16 @@ case OP_OpenDup: {
 ** the btree.  The BTREE_OMIT_JOURNAL and BTREE_SINGLE flags are
 ** added automatically.
 */
-/* Opcode: OpenAutoindex P1 P2 * P4 *
+/* Opcode: OpenAutoindex P1 P2 P3 P4 *
 ** Synopsis: nColumn=P2
 **
 ** This opcode works the same as OP_OpenEphemeral.  It has a
 ** different name to distinguish its use.  Tables created using
 ** by this opcode will be used for automatically created transient
 ** indices in joins.
+**
+** If P3 is not zero, the index is only ever searched for keys equal
+** on their first P3 columns, and may be a hash table.
 */
 case OP_OpenAutoindex: 
 case OP_OpenEphemeral: {
@@ -4449,6 +4452,11 @@ case OP_OpenEphemeral: {
       */
       if( (pCx->pKeyInfo = pKeyInfo = pOp->p4.pKeyInfo)!=0 ){
         assert( pOp->p4type==P4_KEYINFO );
+#if defined(SQLITE_BUILDING_FOR_COMDB2)
+        if( pOp->opcode==OP_OpenAutoindex && pOp->p3>0 ){
+          sqlite3BtreeSetHashJoin(pCx->pBtx, pOp->p3);
+        }
+#endif /* defined(SQLITE_BUILDING_FOR_COMDB2) */
         rc = sqlite3BtreeCreateTable(pCx->pBtx, (int*)&pCx->pgnoRoot,
                                      BTREE_BLOBKEY | pOp->p5); 
         if( rc==SQLITE_OK ){
@@ -8809,6 +8817,38 @@ case OP_OpFuncNext: {            /* jump */
   if( more ) goto jump_to_p2;
   break;
 }
+
+/* Opcode: VecAggStep P1 P2 P3 P4 *
+** Synopsis: batch r[P1] add r[P3]
+**
+** Add the values in registers P3 and following, as described by the
+** VecAgg in P4, to the batch of the vectorized aggregation held in
+** register P1.  Full batches are filtered and folded into the
+** accumulators.  If a value cannot be batched, the pending rows are
+** folded and the jump to P2 processes the current row one at a time.
+*/
+case OP_VecAggStep: {            /* jump */
+  int bRowPath;
+  assert( pOp->p4type==P4_DYNBLOB );
+  rc = comdb2VecAggStep(p, &aMem[pOp->p1], (VecAgg*)pOp->p4.z,
+                        &aMem[pOp->p3], &bRowPath);
+  if( rc ) goto abort_due_to_error;
+  VdbeBranchTaken(bRowPath, 2);
+  if( bRowPath ) goto jump_to_p2;
+  break;
+}
+
+/* Opcode: VecAggFlush P1 * * * *
+** Synopsis: fold batch r[P1]
+**
+** Fold the rows pending in the vectorized aggregation batch in register
+** P1 into the accumulators and release the batch.
+*/
+case OP_VecAggFlush: {
+  rc = comdb2VecAggFlush(p, &aMem[pOp->p1]);
+  if( rc ) goto abort_due_to_error;
+  break;
+}
 #endif /* defined(SQLITE_BUILDING_FOR_COMDB2) */
 
 /* Opcode: Noop * * * * *
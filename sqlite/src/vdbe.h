@@ -448,6 +448,7 @@ void sqlite3VdbePrintOp(FILE*, int, VdbeOp*);
 
 #if defined(SQLITE_BUILDING_FOR_COMDB2)
 void comdb2SetRecording(Vdbe *);
+void comdb2AddPlanEstimate(Vdbe *, LogEst, int);
 #endif /* defined(SQLITE_BUILDING_FOR_COMDB2) */
 
 #endif /* SQLITE_VDBE_H */
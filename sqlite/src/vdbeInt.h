@@ -56,7 +56,7 @@ typedef struct VdbeOp Op;
 typedef unsigned Bool;
 
 #if defined(SQLITE_BUILDING_FOR_COMDB2)
-enum { VDBESORTER_FIND, VDBESORTER_MOVE, VDBESORTER_WRITE };
+enum { VDBESORTER_FIND, VDBESORTER_MOVE, VDBESORTER_WRITE, VDBESORTER_TASK };
 /* moved vdbesorter here because is needed in sqlglue.c */
 /* Opaque type used by code in vdbesort.c */
 typedef struct PmaReader PmaReader;
@@ -74,6 +74,7 @@ typedef struct SorterFile SorterFile;
 
 void addVdbeSorterCost(const VdbeSorter *);
 void addVdbeToThdCost(int type, int *data);
+int runVdbeSorterTasks(int nTask, void (*xTask)(void *), void **apArg);
 
 struct SorterFile {
   sqlite3_file *pFd;              /* File handle */
@@ -131,6 +132,7 @@ struct VdbeSorter {
   int nfind;
   int nmove;
   int nwrite;
+  int ntask;                      /* Sorts and merges run by sorter threads */
 };
 #endif /* defined(SQLITE_BUILDING_FOR_COMDB2) */
 
@@ -597,6 +599,7 @@ struct Vdbe {
   char **vTableLocks;
   u16 hasVTables;
   u8 hasScalarFunc;
+  u8 hasVolatileFunc;    /* result may differ between runs on the same data */
   char tzname[TZNAME_MAX];/* timezone info for datetime support */
   int dtprec;             /* datetime precision - make it u32 to silence compiler */
   struct timespec tspec;  /* time of prepare, used for stable now() */
@@ -610,6 +613,8 @@ struct Vdbe {
   int oldColCount;        /* Column count (refer: sqlitex)*/
   u8 fingerprint_added;   /* Whether fingerprint was added? Only used in SP code */
   int fdb_warn_this_op;   /* Warn about this opcode which is ineligible for cursor hint */
+  u64 nPlanCost;          /* Planner estimate for all WHERE loops of the statement */
+  int nPlanSteps;         /* Loops the planner tried on partial join orders */
 #endif /* defined(SQLITE_BUILDING_FOR_COMDB2) */
 };
 
@@ -248,6 +248,16 @@ void stmt_set_has_scalar_func(sqlite3_stmt *pStmt, int hasScalarFunc) {
   vdbe->hasScalarFunc = hasScalarFunc;
 }
 
+void stmt_set_has_volatile_func(sqlite3_stmt *pStmt, int hasVolatileFunc) {
+  Vdbe *vdbe = (Vdbe *)pStmt;
+  vdbe->hasVolatileFunc = hasVolatileFunc;
+}
+
+int stmt_has_volatile_func(sqlite3_stmt *pStmt) {
+  Vdbe *vdbe = (Vdbe *)pStmt;
+  return vdbe->hasVolatileFunc;
+}
+
 #endif /* defined(SQLITE_BUILDING_FOR_COMDB2) */
 
 /*
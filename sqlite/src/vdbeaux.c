@@ -3560,6 +3560,7 @@ void sqlite3VdbeDelete(Vdbe *p){
 
 #if defined(SQLITE_BUILDING_FOR_COMDB2)
 char *sqlite3BtreeGetTblName(BtCursor *pCur);
+void sqlite3BtreeCursorDataLookup(BtCursor *pCur);
 int sqlite3BtreeCursorRestore(BtCursor*, int*);
 unsigned long long bdb_genid_to_host_order(unsigned long long genid);
 #endif /* defined(SQLITE_BUILDING_FOR_COMDB2) */
@@ -3627,6 +3628,11 @@ int SQLITE_NOINLINE sqlite3VdbeFinishMoveto(VdbeCursor *p){
 #ifdef SQLITE_TEST
   sqlite3_search_count++;
 #endif
+#if defined(SQLITE_BUILDING_FOR_COMDB2)
+  if( p->pAltCursor && p->pAltCursor->eCurType==CURTYPE_BTREE ){
+    sqlite3BtreeCursorDataLookup(p->pAltCursor->uc.pCursor);
+  }
+#endif /* defined(SQLITE_BUILDING_FOR_COMDB2) */
   p->deferredMoveto = 0;
   p->cacheStatus = CACHE_STALE;
   return SQLITE_OK;
@@ -6067,6 +6073,10 @@ void sqlite3VdbePreUpdateHook(
 
 #if defined(SQLITE_BUILDING_FOR_COMDB2)
 void comdb2SetRecording(Vdbe *v){ v->recording = 1; }
+void comdb2AddPlanEstimate(Vdbe *v, LogEst rCost, int nSteps){
+  v->nPlanCost += sqlite3LogEstToInt(rCost);
+  v->nPlanSteps += nSteps;
+}
 void comdb2SetReplace(Vdbe *v){ v->oeFlag |= Cdb2_OE_Replace; }
 void comdb2SetUpdate(Vdbe *v) { v->oeFlag |= Cdb2_OE_Update; }
 void comdb2SetIgnore(Vdbe *v) { v->oeFlag |= Cdb2_OE_Ignore; }
@@ -1008,6 +1008,7 @@ int sqlite3VdbeSorterInit(
     pSorter->nfind = 0;
     pSorter->nmove = 0;
     pSorter->nwrite = 0;
+    pSorter->ntask = 0;
 #endif /* defined(SQLITE_BUILDING_FOR_COMDB2) */
 
     pSorter->pKeyInfo = pKeyInfo = (KeyInfo*)((u8*)pSorter + sz);
@@ -1436,6 +1437,170 @@ static SorterCompare vdbeSorterGetCompare(VdbeSorter *p){
   return vdbeSorterCompare;
 }
 
+#if defined(SQLITE_BUILDING_FOR_COMDB2)
+extern int gbl_sql_sorter_query_threads;
+extern int gbl_sql_sorter_parallel_min_records;
+
+/*
+** One run of a parallel sort.  Sorter threads share the VdbeSorter, so
+** each run has its own comparison context.  A run is either sorted, or
+** merged with the run at pOther.
+*/
+typedef struct SorterRun SorterRun;
+struct SorterRun {
+  SortSubtask task;               /* Comparison context of this run */
+  SorterRecord *pList;            /* Records of the run */
+  SorterRecord *pOther;           /* Run merged into this one, or NULL */
+};
+
+/*
+** Sort the pointer linked list p, the same way vdbeSorterSort() does but
+** without allocating memory, so that it can run on a sorter thread.
+*/
+static SorterRecord *vdbeSorterSortRun(SortSubtask *pTask, SorterRecord *p){
+  SorterRecord *aSlot[64];
+  int i;
+
+  memset(aSlot, 0, sizeof(aSlot));
+  while( p ){
+    SorterRecord *pNext = p->u.pNext;
+    p->u.pNext = 0;
+    for(i=0; aSlot[i]; i++){
+      p = vdbeSorterMerge(pTask, p, aSlot[i]);
+      aSlot[i] = 0;
+    }
+    aSlot[i] = p;
+    p = pNext;
+  }
+  p = 0;
+  for(i=0; i<64; i++){
+    if( aSlot[i]==0 ) continue;
+    p = p ? vdbeSorterMerge(pTask, p, aSlot[i]) : aSlot[i];
+  }
+  return p;
+}
+
+static void vdbeSorterRunTask(void *pCtx){
+  SorterRun *pRun = (SorterRun*)pCtx;
+  if( pRun->pOther ){
+    pRun->pList = vdbeSorterMerge(&pRun->task, pRun->pList, pRun->pOther);
+  }else{
+    pRun->pList = vdbeSorterSortRun(&pRun->task, pRun->pList);
+  }
+}
+
+/*
+** Sort pList on up to gbl_sql_sorter_query_threads sorter threads plus the
+** calling thread: the list is cut into runs which are sorted in parallel,
+** then merged pairwise, in parallel, until a single run is left.  Like
+** vdbeSorterSort(), equal records keep the order they were written in.
+**
+** Returns SQLITE_DONE, without touching the list, if it is too small to be
+** worth it.
+*/
+static int vdbeSorterSortParallel(SortSubtask *pTask, SorterList *pList){
+  VdbeSorter *pSorter = pTask->pSorter;
+  SorterRun *aRun;
+  SorterRecord **apList;
+  void **apArg;
+  SorterRecord *p, *pNext;
+  int nRec, nRun, nAll, nPer, nTask, i, rc;
+
+  if( gbl_sql_sorter_parallel_min_records<=0 ) return SQLITE_DONE;
+
+  nRec = 0;
+  for(p=pList->pList; p; ){
+    nRec++;
+    if( pList->aMemory ){
+      p = (u8*)p==pList->aMemory ? 0 : (SorterRecord*)&pList->aMemory[p->u.iNext];
+    }else{
+      p = p->u.pNext;
+    }
+  }
+  nRun = MIN(gbl_sql_sorter_query_threads + 1, 64);
+  nRun = MIN(nRun, nRec / gbl_sql_sorter_parallel_min_records);
+  if( nRun<2 ) return SQLITE_DONE;
+  nAll = nRun;
+
+  aRun = (SorterRun*)sqlite3MallocZero(nRun * (sizeof(SorterRun) +
+                                               sizeof(SorterRecord*) +
+                                               sizeof(void*)));
+  if( aRun==0 ) return SQLITE_NOMEM_BKPT;
+  apList = (SorterRecord**)&aRun[nRun];
+  apArg = (void**)&apList[nRun];
+  rc = SQLITE_OK;
+  for(i=0; i<nRun; i++){
+    aRun[i].task.pSorter = pSorter;
+    aRun[i].task.xCompare = vdbeSorterGetCompare(pSorter);
+    if( rc==SQLITE_OK ) rc = vdbeSortAllocUnpacked(&aRun[i].task);
+    apArg[i] = &aRun[i];
+  }
+  if( rc!=SQLITE_OK ) goto done;
+
+  /* link the records with pointers, cutting the list into runs of nPer
+  ** records; the last run takes the rest of the list */
+  nPer = nRec / nRun;
+  p = pList->pList;
+  for(i=0; i<nRun; i++){
+    int n = 0;
+    aRun[i].pList = p;
+    while( p ){
+      if( pList->aMemory ){
+        pNext = (u8*)p==pList->aMemory ? 0 : (SorterRecord*)&pList->aMemory[p->u.iNext];
+      }else{
+        pNext = p->u.pNext;
+      }
+      if( ++n==nPer && i<nRun-1 ){
+        p->u.pNext = 0;
+        p = pNext;
+        break;
+      }
+      p->u.pNext = pNext;
+      p = pNext;
+    }
+  }
+
+  nTask = runVdbeSorterTasks(nRun, vdbeSorterRunTask, apArg);
+  for(i=0; i<nRun; i++){
+    apList[i] = aRun[i].pList;
+  }
+
+  /* apList[i+1] holds records written before those of apList[i]: merge
+  ** it first so that equal records stay in order */
+  while( nRun>1 ){
+    int nMerge = nRun / 2;
+    for(i=0; i<nMerge; i++){
+      aRun[i].pList = apList[2*i+1];
+      aRun[i].pOther = apList[2*i];
+    }
+    nTask += runVdbeSorterTasks(nMerge, vdbeSorterRunTask, apArg);
+    for(i=0; i<nMerge; i++){
+      apList[i] = aRun[i].pList;
+    }
+    if( nRun & 1 ){
+      apList[nMerge] = apList[nRun-1];
+    }
+    nRun = (nRun + 1) / 2;
+  }
+  pList->pList = apList[0];
+
+  while( nTask-- > 0 ){
+    addVdbeToThdCost(VDBESORTER_TASK, &pSorter->ntask);
+  }
+
+  for(i=0; i<nAll; i++){
+    if( rc==SQLITE_OK ) rc = aRun[i].task.pUnpacked->errCode;
+  }
+
+done:
+  for(i=0; i<nAll; i++){
+    sqlite3DbFree(pSorter->db, aRun[i].task.pUnpacked);
+  }
+  sqlite3_free(aRun);
+  return rc;
+}
+#endif /* defined(SQLITE_BUILDING_FOR_COMDB2) */
+
 /*
 ** Sort the linked list of records headed at pTask->pList. Return 
 ** SQLITE_OK if successful, or an SQLite error code (i.e. SQLITE_NOMEM) if 
@@ -1453,6 +1618,13 @@ static int vdbeSorterSort(SortSubtask *pTask, SorterList *pList){
   p = pList->pList;
   pTask->xCompare = vdbeSorterGetCompare(pTask->pSorter);
 
+#if defined(SQLITE_BUILDING_FOR_COMDB2)
+  if( gbl_sql_sorter_query_threads>0 ){
+    rc = vdbeSorterSortParallel(pTask, pList);
+    if( rc!=SQLITE_DONE ) return rc;
+  }
+#endif /* defined(SQLITE_BUILDING_FOR_COMDB2) */
+
   aSlot = (SorterRecord **)sqlite3MallocZero(64 * sizeof(SorterRecord *));
   if( !aSlot ){
     return SQLITE_NOMEM_BKPT;
@@ -45,6 +45,7 @@ static int whereLoopResize(sqlite3*, WhereLoop*, int);
 #if defined(SQLITE_BUILDING_FOR_COMDB2)
 int gbl_disable_seekscan_optimization = 1;
 int gbl_sqlite_stat4_scan = 0;
+int gbl_sql_exact_index_coverage = 1;
 
 int shard_check_parallelism(int iTable);
 int comdb2_shard_table_constraints(Parse *pParse, 
@@ -715,6 +716,54 @@ static int termCanDriveIndex(
   testcase( pTerm->pExpr->op==TK_IS );
   return 1;
 }
+
+#if defined(SQLITE_BUILDING_FOR_COMDB2)
+/*
+** Return true if an automatic index on column iCol of pTab, compared
+** under collation zColl, may be built as a hash table.  Hashed keys match
+** only if their bytes or numeric values do, which rules out collations
+** other than BINARY and the datetimes and intervals that compare equal to
+** strings.  The hash table still turns into an ordered index if it meets
+** values it can't hash.
+*/
+static int autoIndexCanHash(Table *pTab, int iCol, const char *zColl){
+  char aff;
+  if( !sqlite3_gbl_tunables.hash_join ) return 0;
+  if( zColl && sqlite3StrICmp(zColl, sqlite3StrBINARY)!=0 ) return 0;
+  aff = pTab->aCol[iCol].affinity;
+  if( aff>=SQLITE_AFF_DATETIME && aff<=SQLITE_AFF_INTV_SE ) return 0;
+  return aff!=SQLITE_AFF_DECIMAL && aff!=SQLITE_AFF_SMALL;
+}
+
+/*
+** Return true if the automatic index on pSrc will be built as a hash table.
+** constructAutomaticIndex() keys the index on every term which can drive it
+** once the outer loops are known, which may be more terms than the one
+** being costed, so every term which might drive it has to hash.
+*/
+static int autoIndexWillHash(
+  Parse *pParse,              /* The parsing context */
+  WhereClause *pWC,           /* The WHERE clause */
+  struct SrcList_item *pSrc,  /* The FROM clause term to be indexed */
+  Bitmask maskSelf            /* Cursor of pSrc */
+){
+  WhereTerm *pTerm;
+  WhereTerm *pWCEnd = pWC->a + pWC->nTerm;
+  if( !sqlite3_gbl_tunables.hash_join ) return 0;
+  for(pTerm=pWC->a; pTerm<pWCEnd; pTerm++){
+    CollSeq *pColl;
+    if( pTerm->prereqRight & maskSelf ) continue;
+    if( !termCanDriveIndex(pTerm, pSrc, 0) ) continue;
+    pColl = sqlite3BinaryCompareCollSeq(pParse,
+                pTerm->pExpr->pLeft, pTerm->pExpr->pRight);
+    if( !autoIndexCanHash(pSrc->pTab, pTerm->u.leftColumn,
+                          pColl ? pColl->zName : 0) ){
+      return 0;
+    }
+  }
+  return 1;
+}
+#endif /* defined(SQLITE_BUILDING_FOR_COMDB2) */
 #endif
 
 
@@ -754,6 +803,9 @@ static void constructAutomaticIndex(
   struct SrcList_item *pTabItem;  /* FROM clause term being indexed */
   int addrCounter = 0;        /* Address where integer counter is initialized */
   int regBase;                /* Array of registers where record is assembled */
+#if defined(SQLITE_BUILDING_FOR_COMDB2)
+  int canHash = 1;            /* True to build the index as a hash table */
+#endif /* defined(SQLITE_BUILDING_FOR_COMDB2) */
 
   /* Generate code to skip over the creation and initialization of the
   ** transient index on 2nd and subsequent iterations of the loop. */
@@ -844,6 +896,11 @@ static void constructAutomaticIndex(
         pIdx->aiColumn[n] = pTerm->u.leftColumn;
         pColl = sqlite3BinaryCompareCollSeq(pParse, pX->pLeft, pX->pRight);
         pIdx->azColl[n] = pColl ? pColl->zName : sqlite3StrBINARY;
+#if defined(SQLITE_BUILDING_FOR_COMDB2)
+        if( !autoIndexCanHash(pTable, pIdx->aiColumn[n], pIdx->azColl[n]) ){
+          canHash = 0;
+        }
+#endif /* defined(SQLITE_BUILDING_FOR_COMDB2) */
         n++;
       }
     }
@@ -873,6 +930,14 @@ static void constructAutomaticIndex(
   /* Create the automatic index */
   assert( pLevel->iIdxCur>=0 );
   pLevel->iIdxCur = pParse->nTab++;
+#if defined(SQLITE_BUILDING_FOR_COMDB2)
+  /* A hash table is probed on its first nEq columns, given as P3 */
+  if( canHash ){
+    pLoop->wsFlags |= WHERE_AUTO_HASH;
+    sqlite3VdbeAddOp3(v, OP_OpenAutoindex, pLevel->iIdxCur, nKeyCol+1,
+                      pLoop->u.btree.nEq);
+  }else
+#endif /* defined(SQLITE_BUILDING_FOR_COMDB2) */
   sqlite3VdbeAddOp2(v, OP_OpenAutoindex, pLevel->iIdxCur, nKeyCol+1);
   sqlite3VdbeSetP4KeyInfo(pParse, pIdx);
   VdbeComment((v, "for %s", pTable->zName));
@@ -2742,7 +2807,11 @@ static int whereLoopAddBtreeIndex(
     ** visiting the rows in the main table.  */
     rCostIdx = pNew->nOut + 1 + (15*pProbe->szIdxRow)/pSrc->pTab->szTabRow;
     pNew->rRun = sqlite3LogEstAdd(rLogSize, rCostIdx);
+#if defined(SQLITE_BUILDING_FOR_COMDB2)
+    if( (pNew->wsFlags & (WHERE_IDX_ONLY|WHERE_IPK|WHERE_EXPRIDX))==0 ){
+#else /* defined(SQLITE_BUILDING_FOR_COMDB2) */
     if( (pNew->wsFlags & (WHERE_IDX_ONLY|WHERE_IPK))==0 ){
+#endif /* defined(SQLITE_BUILDING_FOR_COMDB2) */
       pNew->rRun = sqlite3LogEstAdd(pNew->rRun, pNew->nOut + 16);
     }
     ApplyCostMultiplier(pNew->rRun, pProbe->pTable->costMult);
@@ -2879,6 +2948,95 @@ static int whereUsablePartialIndex(int iTab, WhereClause *pWC, Expr *pWhere){
   return 0;
 }
 
+#if defined(SQLITE_BUILDING_FOR_COMDB2)
+/*
+** Information passed down to whereIsCoveringIndexWalkCallback()
+*/
+struct CoveringIndexCheck {
+  Index *pIdx;       /* The index */
+  int iTabCur;       /* Cursor number for the corresponding table */
+  u8 bExpr;          /* Uses an indexed expression */
+  u8 bUnidx;         /* Uses an unindexed column not within an indexed expr */
+};
+
+/*
+** Return true if pExpr is one of the expressions of index pIdx.
+*/
+static int exprIsCoveredByIndex(Expr *pExpr, Index *pIdx, int iTabCur){
+  int i;
+  for(i=0; i<pIdx->nColumn; i++){
+    if( pIdx->aiColumn[i]==XN_EXPR
+     && sqlite3ExprCompare(0, pExpr, pIdx->aColExpr->a[i].pExpr, iTabCur)==0
+    ){
+      return 1;
+    }
+  }
+  return 0;
+}
+
+/*
+** Callback for whereIsCoveringIndex().  Flags the references to columns of
+** the table which are neither in the index nor inside one of the indexed
+** expressions.
+*/
+static int whereIsCoveringIndexWalkCallback(Walker *pWalk, Expr *pExpr){
+  struct CoveringIndexCheck *pCk = pWalk->u.pCovIdxCk;
+  Index *pIdx = pCk->pIdx;
+  int i;
+
+  if( pExpr->op==TK_COLUMN || pExpr->op==TK_AGG_COLUMN ){
+    if( pExpr->iTable!=pCk->iTabCur ) return WRC_Continue;
+    for(i=0; i<pIdx->nColumn; i++){
+      if( pIdx->aiColumn[i]==pExpr->iColumn ) return WRC_Continue;
+    }
+    pCk->bUnidx = 1;
+    return WRC_Abort;
+  }else if( pIdx->bHasExpr && exprIsCoveredByIndex(pExpr, pIdx, pCk->iTabCur) ){
+    pCk->bExpr = 1;
+    return WRC_Prune;
+  }
+  return WRC_Continue;
+}
+
+/*
+** The column mask of a table cannot tell apart the columns past the 63rd,
+** nor does it know about the columns which are only read as part of an
+** indexed expression.  Both make an index which has all the data a query
+** needs (typically a datacopy index) look like it needs table lookups.
+** Walk the statement to see what it really reads from table iTabCur.
+**
+** Returns 0 if pIdx does not cover the statement, WHERE_IDX_ONLY if every
+** column read is in the index, and WHERE_EXPRIDX if some columns are only
+** read through indexed expressions.  For the latter the table cursor is
+** kept, but is never moved unless an expression could not be replaced by
+** its index column.
+*/
+static u32 whereIsCoveringIndex(WhereInfo *pWInfo, Index *pIdx, int iTabCur){
+  struct CoveringIndexCheck ck;
+  Walker w;
+
+  if( pWInfo->pSelect==0 ){
+    /* no access to the full statement, assume the worst */
+    return 0;
+  }
+  ck.pIdx = pIdx;
+  ck.iTabCur = iTabCur;
+  ck.bExpr = 0;
+  ck.bUnidx = 0;
+  memset(&w, 0, sizeof(w));
+  w.xExprCallback = whereIsCoveringIndexWalkCallback;
+  w.xSelectCallback = sqlite3SelectWalkNoop;
+  w.u.pCovIdxCk = &ck;
+  sqlite3WalkSelect(&w, pWInfo->pSelect);
+  if( !ck.bUnidx ){
+    /* the WHERE clause may have gained terms since it was parsed */
+    sqlite3WalkExpr(&w, pWInfo->pWhere);
+  }
+  if( ck.bUnidx ) return 0;
+  return ck.bExpr ? WHERE_EXPRIDX : WHERE_IDX_ONLY;
+}
+#endif /* defined(SQLITE_BUILDING_FOR_COMDB2) */
+
 /*
 ** Add all WhereLoop objects for a single table of the join where the table
 ** is identified by pBuilder->pNew->iTab.  That table is guaranteed to be
@@ -2934,6 +3092,9 @@ static int whereLoopAddBtree(
   LogEst rLogSize;            /* Logarithm of the number of rows in the table */
   WhereClause *pWC;           /* The parsed WHERE clause */
   Table *pTab;                /* Table being queried */
+#if defined(SQLITE_BUILDING_FOR_COMDB2)
+  int isHash;                 /* True if the automatic index is hashed */
+#endif /* defined(SQLITE_BUILDING_FOR_COMDB2) */
   
   pNew = pBuilder->pNew;
   pWInfo = pBuilder->pWInfo;
@@ -2990,6 +3151,9 @@ static int whereLoopAddBtree(
     /* Generate auto-index WhereLoops */
     WhereTerm *pTerm;
     WhereTerm *pWCEnd = pWC->a + pWC->nTerm;
+#if defined(SQLITE_BUILDING_FOR_COMDB2)
+    isHash = autoIndexWillHash(pWInfo->pParse, pWC, pSrc, pNew->maskSelf);
+#endif /* defined(SQLITE_BUILDING_FOR_COMDB2) */
     for(pTerm=pWC->a; rc==SQLITE_OK && pTerm<pWCEnd; pTerm++){
       if( pTerm->prereqRight & pNew->maskSelf ) continue;
       if( termCanDriveIndex(pTerm, pSrc, 0) ){
@@ -3007,6 +3171,11 @@ static int whereLoopAddBtree(
         ** those objects, since there is no opportunity to add schema
         ** indexes on subqueries and views. */
         pNew->rSetup = rLogSize + rSize;
+#if defined(SQLITE_BUILDING_FOR_COMDB2)
+        /* TUNING: A hash table is built with one insert per row, and a
+        ** lookup costs no more than the rows it returns. */
+        if( isHash ) pNew->rSetup = rSize;
+#endif /* defined(SQLITE_BUILDING_FOR_COMDB2) */
         if( pTab->pSelect==0 && (pTab->tabFlags & TF_Ephemeral)==0 ){
           pNew->rSetup += 28;
         }else{
@@ -3020,6 +3189,9 @@ static int whereLoopAddBtree(
         ** not be unreasonable to make this value much larger. */
         pNew->nOut = 43;  assert( 43==sqlite3LogEst(20) );
         pNew->rRun = sqlite3LogEstAdd(rLogSize,pNew->nOut);
+#if defined(SQLITE_BUILDING_FOR_COMDB2)
+        if( isHash ) pNew->rRun = sqlite3LogEstAdd(0,pNew->nOut);
+#endif /* defined(SQLITE_BUILDING_FOR_COMDB2) */
         pNew->wsFlags = WHERE_AUTO_INDEX;
         pNew->prereq = mPrereq | pTerm->prereqRight;
         rc = whereLoopInsert(pBuilder, pNew);
@@ -3109,6 +3281,16 @@ static int whereLoopAddBtree(
       }else{
         m = pSrc->colUsed & pProbe->colNotIdxed;
         pNew->wsFlags = (m==0) ? (WHERE_IDX_ONLY|WHERE_INDEXED) : WHERE_INDEXED;
+#if defined(SQLITE_BUILDING_FOR_COMDB2)
+        if( m!=0 && (m==MASKBIT(BMS-1) || pProbe->bHasExpr)
+         && gbl_sql_exact_index_coverage ){
+          u32 isCov = whereIsCoveringIndex(pWInfo, pProbe, pSrc->iCursor);
+          if( isCov ){
+            m = 0;
+            pNew->wsFlags |= isCov;
+          }
+        }
+#endif /* defined(SQLITE_BUILDING_FOR_COMDB2) */
       }
 
       /* Full scan via index */
@@ -4156,6 +4338,18 @@ static int wherePathSolver(WhereInfo *pWInfo, LogEst nRowEst){
       }
     }
   }
+  if( nLoop>2 && nLoop<=MIN(sqlite3_gbl_tunables.exhaustive_join_limit, 12) ){
+    /* Make room for the best path over every subset of the join, ordered
+    ** and unordered.  A path is then only dropped when a cheaper path over
+    ** the same tables is found, and the solver below costs every join
+    ** order that is not beaten by another order of the same tables. */
+    int nSubset = 1;
+    for(ii=0; ii<nLoop/2; ii++){
+      nSubset = nSubset * (nLoop-ii) / (ii+1);
+    }
+    if( mxChoice<nSubset*2 ) mxChoice = nSubset*2;
+    WHERETRACE(0x002, ("Exhaustive join search, %d paths\n", mxChoice));
+  }
 #endif /* defined(SQLITE_BUILDING_FOR_COMDB2) */
   assert( nLoop<=pWInfo->pTabList->nSrc );
   WHERETRACE(0x002, ("---- begin solver.  (nRowEst=%d)\n", nRowEst));
@@ -4241,6 +4435,9 @@ static int wherePathSolver(WhereInfo *pWInfo, LogEst nRowEst){
 
         /* At this point, pWLoop is a candidate to be the next loop. 
         ** Compute its cost */
+#if defined(SQLITE_BUILDING_FOR_COMDB2)
+        pWInfo->nPlanSteps++;
+#endif /* defined(SQLITE_BUILDING_FOR_COMDB2) */
         rUnsorted = sqlite3LogEstAdd(pWLoop->rSetup,pWLoop->rRun + pFrom->nRow);
         rUnsorted = sqlite3LogEstAdd(rUnsorted, pFrom->rUnsorted);
         nOut = pFrom->nRow + pWLoop->nOut;
@@ -4438,6 +4635,9 @@ static int wherePathSolver(WhereInfo *pWInfo, LogEst nRowEst){
     if( pFrom->rCost>aFrom[ii].rCost ) pFrom = &aFrom[ii];
   }
   assert( pWInfo->nLevel==nLoop );
+#if defined(SQLITE_BUILDING_FOR_COMDB2)
+  pWInfo->rPlanCost = pFrom->rCost;
+#endif /* defined(SQLITE_BUILDING_FOR_COMDB2) */
   /* Load the lowest cost path into pWInfo */
   for(iLoop=0; iLoop<nLoop; iLoop++){
     WhereLevel *pLevel = pWInfo->a + iLoop;
@@ -4859,7 +5059,9 @@ WhereInfo *sqlite3WhereBegin(
   u8 bFordelete = 0;         /* OPFLAG_FORDELETE or zero, as appropriate */
 
 #if defined(SQLITE_BUILDING_FOR_COMDB2)
+  Select *pSelect = pParse->pWhereSelect;
   Expr *pNewExpr = pWhere;
+  pParse->pWhereSelect = 0;
   if( pTabList->nSrc>0 &&
       comdb2_shard_table_constraints(pParse, pTabList->a[0].zName,
                                      pTabList->a[0].zDatabase, &pNewExpr) ){
@@ -4925,6 +5127,11 @@ WhereInfo *sqlite3WhereBegin(
   pWInfo->pOrderBy = pOrderBy;
   pWInfo->pWhere = pWhere;
   pWInfo->pResultSet = pResultSet;
+#if defined(SQLITE_BUILDING_FOR_COMDB2)
+  pWInfo->pSelect = pSelect;
+  pWInfo->rPlanCost = 0;
+  pWInfo->nPlanSteps = 0;
+#endif /* defined(SQLITE_BUILDING_FOR_COMDB2) */
   pWInfo->aiCurOnePass[0] = pWInfo->aiCurOnePass[1] = -1;
   pWInfo->nLevel = nTabList;
   pWInfo->iBreak = pWInfo->iContinue = sqlite3VdbeMakeLabel(pParse);
@@ -5065,6 +5272,9 @@ WhereInfo *sqlite3WhereBegin(
        wherePathSolver(pWInfo, pWInfo->nRowOut+1);
        if( db->mallocFailed ) goto whereBeginError;
     }
+#if defined(SQLITE_BUILDING_FOR_COMDB2)
+    comdb2AddPlanEstimate(v, pWInfo->rPlanCost, pWInfo->nPlanSteps);
+#endif /* defined(SQLITE_BUILDING_FOR_COMDB2) */
   }
   if( pWInfo->pOrderBy==0 && (db->flags & SQLITE_ReverseOrder)!=0 ){
      pWInfo->revMask = ALLBITS;
@@ -472,6 +472,11 @@ struct WhereInfo {
   LogEst nRowOut;           /* Estimated number of output rows */
   WhereClause sWC;          /* Decomposition of the WHERE clause */
   WhereMaskSet sMaskSet;    /* Map cursor numbers to bitmasks */
+#if defined(SQLITE_BUILDING_FOR_COMDB2)
+  Select *pSelect;          /* The entire SELECT statement, if known */
+  LogEst rPlanCost;         /* Estimated cost of the chosen join order */
+  int nPlanSteps;           /* Loops costed by wherePathSolver(), all passes */
+#endif /* defined(SQLITE_BUILDING_FOR_COMDB2) */
   WhereLevel a[1];          /* Information about each nest loop in WHERE */
 };
 
@@ -593,3 +598,7 @@ void sqlite3WhereTabFuncArgs(Parse*, struct SrcList_item*, WhereClause*);
 #define WHERE_PARTIALIDX   0x00020000  /* The automatic index is partial */
 #define WHERE_IN_EARLYOUT  0x00040000  /* Perhaps quit IN loops early */
 #define WHERE_IN_SEEKSCAN  0x00100000  /* Seek-scan optimization for IN */
+#if defined(SQLITE_BUILDING_FOR_COMDB2)
+#define WHERE_EXPRIDX      0x04000000  /* Uses an index-on-expressions */
+#define WHERE_AUTO_HASH    0x08000000  /* The automatic index is hashed */
+#endif /* defined(SQLITE_BUILDING_FOR_COMDB2) */
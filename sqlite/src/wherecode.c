@@ -169,6 +169,13 @@ int sqlite3WhereExplainOneScan(
         if( isSearch ){
           zFmt = "PRIMARY KEY";
         }
+#if defined(SQLITE_BUILDING_FOR_COMDB2)
+      }else if( (flags & (WHERE_PARTIALIDX|WHERE_AUTO_HASH))
+                      ==(WHERE_PARTIALIDX|WHERE_AUTO_HASH) ){
+        zFmt = "AUTOMATIC PARTIAL COVERING HASH INDEX";
+      }else if( flags & WHERE_AUTO_HASH ){
+        zFmt = "AUTOMATIC COVERING HASH INDEX";
+#endif /* defined(SQLITE_BUILDING_FOR_COMDB2) */
       }else if( flags & WHERE_PARTIALIDX ){
         zFmt = "AUTOMATIC PARTIAL COVERING INDEX";
       }else if( flags & WHERE_AUTO_INDEX ){
@@ -927,6 +934,9 @@ static int codeCursorHintFixExpr(Walker *pWalker, Expr *pExpr){
 /*
 ** Insert an OP_CursorHint instruction if it is appropriate to do so.
 */
+#if defined(SQLITE_BUILDING_FOR_COMDB2)
+int is_comdb2_table_zonemap(const char *);
+#endif /* defined(SQLITE_BUILDING_FOR_COMDB2) */
 static void codeCursorHint(
   struct SrcList_item *pTabItem,  /* FROM clause item */
   WhereInfo *pWInfo,    /* The where clause */
@@ -973,7 +983,10 @@ static void codeCursorHint(
 #if defined(SQLITE_BUILDING_FOR_COMDB2)
   /* Really need to run this only for remote cursors */
   /* hack, at this point only remcurs have it */
-  if( pWInfo->pTabList->a[iLevel].zDatabase==NULL )
+  /* and the table scans of tables with zone maps */
+  if( pWInfo->pTabList->a[iLevel].zDatabase==NULL
+   && (pLoop->u.btree.pIndex!=0
+    || !is_comdb2_table_zonemap(pTabItem->pTab->zName)) )
     return;
 
   /* Need this Mask since the code lower ignores TERM_CODED !!!!*/
@@ -2327,6 +2340,13 @@ Bitmask sqlite3WhereCodeOneLoopStart(
       }
       pE = pTerm->pExpr;
       assert( pE!=0 );
+#if defined(SQLITE_BUILDING_FOR_COMDB2)
+      if( (pWInfo->wctrlFlags & WHERE_VECFILTER)!=0
+       && sqlite3ExprIsVecFilter(pE, pLevel->iTabCur) ){
+        /* Evaluated by OP_VecAggStep on batches of rows */
+        continue;
+      }
+#endif /* defined(SQLITE_BUILDING_FOR_COMDB2) */
       if( (pTabItem->fg.jointype&JT_LEFT) && !ExprHasProperty(pE,EP_FromJoin) ){
         continue;
       }
@@ -415,6 +415,7 @@ static Keyword aKeywordTable[] = {
   { "VERSION",           "TK_VERSION",           ALWAYS           },
   { "WRITE",             "TK_WRITE",             ALWAYS           },
   { "ZLIB",              "TK_ZLIB",              ALWAYS           },
+  { "ZONEMAP",           "TK_ZONEMAP",           ALWAYS           },
 #endif /* defined(SQLITE_BUILDING_FOR_COMDB2) */
 };
 
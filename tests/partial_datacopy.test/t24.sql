@@ -0,0 +1,11 @@
+CREATE TABLE t(c1 INT, c2 INT, c3 INT, c4 INT, c5 INT, c6 INT, c7 INT, c8 INT, c9 INT, c10 INT, c11 INT, c12 INT, c13 INT, c14 INT, c15 INT, c16 INT, c17 INT, c18 INT, c19 INT, c20 INT, c21 INT, c22 INT, c23 INT, c24 INT, c25 INT, c26 INT, c27 INT, c28 INT, c29 INT, c30 INT, c31 INT, c32 INT, c33 INT, c34 INT, c35 INT, c36 INT, c37 INT, c38 INT, c39 INT, c40 INT, c41 INT, c42 INT, c43 INT, c44 INT, c45 INT, c46 INT, c47 INT, c48 INT, c49 INT, c50 INT, c51 INT, c52 INT, c53 INT, c54 INT, c55 INT, c56 INT, c57 INT, c58 INT, c59 INT, c60 INT, c61 INT, c62 INT, c63 INT, c64 INT, c65 INT, c66 INT, c67 INT, c68 INT, c69 INT, c70 INT); $$
+CREATE INDEX a ON t(c1) INCLUDE (c70);
+
+insert into t with recursive r(n) as (select 1 union all select n + 1 from r where n < 5) select n, n * 100 + 2, n * 100 + 3, n * 100 + 4, n * 100 + 5, n * 100 + 6, n * 100 + 7, n * 100 + 8, n * 100 + 9, n * 100 + 10, n * 100 + 11, n * 100 + 12, n * 100 + 13, n * 100 + 14, n * 100 + 15, n * 100 + 16, n * 100 + 17, n * 100 + 18, n * 100 + 19, n * 100 + 20, n * 100 + 21, n * 100 + 22, n * 100 + 23, n * 100 + 24, n * 100 + 25, n * 100 + 26, n * 100 + 27, n * 100 + 28, n * 100 + 29, n * 100 + 30, n * 100 + 31, n * 100 + 32, n * 100 + 33, n * 100 + 34, n * 100 + 35, n * 100 + 36, n * 100 + 37, n * 100 + 38, n * 100 + 39, n * 100 + 40, n * 100 + 41, n * 100 + 42, n * 100 + 43, n * 100 + 44, n * 100 + 45, n * 100 + 46, n * 100 + 47, n * 100 + 48, n * 100 + 49, n * 100 + 50, n * 100 + 51, n * 100 + 52, n * 100 + 53, n * 100 + 54, n * 100 + 55, n * 100 + 56, n * 100 + 57, n * 100 + 58, n * 100 + 59, n * 100 + 60, n * 100 + 61, n * 100 + 62, n * 100 + 63, n * 100 + 64, n * 100 + 65, n * 100 + 66, n * 100 + 67, n * 100 + 68, n * 100 + 69, n * 100 + 70 from r;
+
+select c1, c70 from t where c1 < 3;
+select data_lookups from comdb2_index_usage where table_name='t';
+select c2 from t where c1 = 1;
+select data_lookups from comdb2_index_usage where table_name='t';
+
+drop table t;
@@ -0,0 +1,95 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <unistd.h>
+
+#include "cdb2api.h"
+#include "cdb2api_test.h"
+
+static const char *dbname;
+
+static cdb2_hndl_tp *open_db()
+{
+    cdb2_hndl_tp *db;
+    int rc = cdb2_open(&db, dbname, "default", 0);
+    if (rc) {
+        fprintf(stderr, "open %d %s\n", rc, cdb2_errstr(db));
+        exit(1);
+    }
+    return db;
+}
+
+/* Run a query; return the first column of its last row as an integer */
+static long long run(cdb2_hndl_tp *db, const char *query)
+{
+    long long val = 0;
+    int rc = cdb2_run_statement(db, query);
+    if (rc) {
+        fprintf(stderr, "run '%s' %d %s\n", query, rc, cdb2_errstr(db));
+        exit(1);
+    }
+    while ((rc = cdb2_next_record(db)) == CDB2_OK) {
+        if (cdb2_column_type(db, 0) == CDB2_INTEGER)
+            val = *(long long *)cdb2_column_value(db, 0);
+    }
+    if (rc != CDB2_OK_DONE) {
+        fprintf(stderr, "next '%s' %d %s\n", query, rc, cdb2_errstr(db));
+        exit(1);
+    }
+    return val;
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc != 3) {
+        fprintf(stderr, "usage: %s <dbname> <sockpool-socket>\n", argv[0]);
+        return 1;
+    }
+    dbname = argv[1];
+
+    /* Donate every connection to the sockpool under test */
+    setenv("COMDB2_CONFIG_MAX_LOCAL_CONNECTION_CACHE_ENTRIES", "0", 1);
+    test_process_env_vars();
+    signal(SIGPIPE, SIG_IGN);
+    char *conf = getenv("CDB2_CONFIG");
+    if (conf)
+        cdb2_set_comdb2db_config(conf);
+    cdb2_set_sockpool(argv[2]);
+
+    /* Teach the sockpool where the database is */
+    cdb2_hndl_tp *db = open_db();
+    run(db, "create table if not exists t (i int)");
+    run(db, "delete from t where 1");
+    cdb2_close(db);
+    sleep(1);
+
+    /* Sessions opened together get separate transactions ... */
+    cdb2_hndl_tp *a = open_db();
+    cdb2_hndl_tp *b = open_db();
+    run(a, "begin");
+    run(a, "insert into t values (1)");
+    if (run(b, "select count(*) from t") != 0) {
+        fprintf(stderr, "saw an uncommitted insert of another session\n");
+        return 1;
+    }
+    run(a, "commit");
+    if (run(b, "select count(*) from t") != 1) {
+        fprintf(stderr, "missed a committed insert of another session\n");
+        return 1;
+    }
+
+    /* ... and separate SET options */
+    run(a, "set timezone UTC");
+    run(b, "set timezone Asia/Tokyo");
+    if (run(a, "select cast(now() as text) like '%UTC'") != 1 ||
+        run(b, "select cast(now() as text) like '%Asia/Tokyo'") != 1) {
+        fprintf(stderr, "saw the timezone of another session\n");
+        return 1;
+    }
+
+    cdb2_close(a);
+    cdb2_close(b);
+    printf("ok\n");
+    return 0;
+}
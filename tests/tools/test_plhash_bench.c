@@ -0,0 +1,261 @@
+/*
+   Copyright 2026 Bloomberg Finance L.P.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+ */
+
+/* Checks that open addressing plhash tables behave like chained ones, then
+ * times both on the operations the server does most: add, find (hit and
+ * miss) and delete, on genid-like 8 byte keys and 16 byte keys. */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <plhash_glue.h>
+#include "mem.h"
+
+struct obj {
+    uint64_t genid;
+    uint8_t key16[16];
+    int alive;
+};
+
+static uint64_t rng = 0x2545f4914f6cdd1dULL;
+static uint64_t next_rand(void)
+{
+    rng ^= rng << 13;
+    rng ^= rng >> 7;
+    rng ^= rng << 17;
+    return rng;
+}
+
+static void make_keys(struct obj *objs, int n)
+{
+    for (int i = 0; i < n; ++i) {
+        /* genids are mostly increasing, with random low bits */
+        objs[i].genid = ((uint64_t)(i + 1) << 20) | (next_rand() & 0xfffff);
+        uint64_t a = next_rand(), b = next_rand();
+        memcpy(objs[i].key16, &a, 8);
+        memcpy(objs[i].key16 + 8, &b, 8);
+        objs[i].alive = 0;
+    }
+}
+
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static hash_t *new_hash(int open, int keyoff, int keylen)
+{
+    hash_t *h = hash_init_o(keyoff, keylen);
+    if (h == NULL || (open && hash_set_open_addressing(h) != 0)) {
+        fprintf(stderr, "failed to create hash table\n");
+        exit(1);
+    }
+    return h;
+}
+
+#define CHECK(cond)                                                            \
+    do {                                                                       \
+        if (!(cond)) {                                                         \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__,  \
+                    #cond);                                                    \
+            exit(1);                                                           \
+        }                                                                      \
+    } while (0)
+
+static int count_alive(void *obj, void *arg)
+{
+    CHECK(((struct obj *)obj)->alive);
+    ++*(int *)arg;
+    return 0;
+}
+
+static int del_odd(void *obj, void *arg)
+{
+    struct obj *o = obj;
+    if (o->genid & 1) {
+        CHECK(hash_del((hash_t *)arg, o) == 0);
+        o->alive = 0;
+    }
+    return 0;
+}
+
+/* random adds, finds and deletes against both schemes */
+static void check(int n)
+{
+    struct obj *objs = calloc(n, sizeof(struct obj));
+    hash_t *chained = new_hash(0, offsetof(struct obj, genid), sizeof(uint64_t));
+    hash_t *open = new_hash(1, offsetof(struct obj, genid), sizeof(uint64_t));
+    int nalive = 0, cnt;
+    void *ent;
+    unsigned int bkt;
+
+    make_keys(objs, n);
+    CHECK(hash_find(open, &objs[0].genid) == NULL);
+
+    for (int round = 0; round < 8 * n; ++round) {
+        struct obj *o = &objs[next_rand() % n];
+        switch (next_rand() % 3) {
+        case 0:
+            if (!o->alive) {
+                CHECK(hash_add(chained, o) == 0);
+                CHECK(hash_add(open, o) == 0);
+                o->alive = 1;
+                ++nalive;
+            }
+            break;
+        case 1:
+            CHECK(hash_find(chained, &o->genid) == (o->alive ? o : NULL));
+            CHECK(hash_find_readonly(open, &o->genid) == (o->alive ? o : NULL));
+            CHECK(hash_find(open, &o->genid) == (o->alive ? o : NULL));
+            break;
+        case 2:
+            CHECK(hash_del(chained, o) == (o->alive ? 0 : -1));
+            CHECK(hash_del(open, o) == (o->alive ? 0 : -1));
+            if (o->alive) {
+                o->alive = 0;
+                --nalive;
+            }
+            break;
+        }
+    }
+    CHECK(hash_get_num_entries(open) == nalive);
+    CHECK(hash_get_num_entries(chained) == nalive);
+
+    cnt = 0;
+    hash_for(open, count_alive, &cnt);
+    CHECK(cnt == nalive);
+    cnt = 0;
+    for (void *o = hash_first(open, &ent, &bkt); o; o = hash_next(open, &ent, &bkt)) {
+        CHECK(((struct obj *)o)->alive);
+        ++cnt;
+    }
+    CHECK(cnt == nalive);
+
+    /* deleting from a hash_for() callback */
+    hash_for(open, del_odd, open);
+    for (int i = 0; i < n; ++i)
+        CHECK(hash_find(open, &objs[i].genid) == (objs[i].alive ? &objs[i] : NULL));
+
+    /* duplicate keys are allowed, as with chaining */
+    struct obj dup = objs[0];
+    CHECK(hash_add(open, &objs[0]) == 0 && hash_add(open, &dup) == 0);
+    CHECK(hash_del(open, &dup) == 0 && hash_find(open, &dup.genid) != NULL);
+    CHECK(hash_del(open, &dup) == 0);
+
+    hash_clear(open);
+    CHECK(hash_get_num_entries(open) == 0);
+    CHECK(hash_first(open, &ent, &bkt) == NULL);
+    CHECK(hash_add(open, &objs[1]) == 0 && hash_find(open, &objs[1].genid) == &objs[1]);
+
+    hash_free(open);
+    hash_free(chained);
+
+    /* presized */
+    open = new_hash(1, offsetof(struct obj, genid), sizeof(uint64_t));
+    CHECK(hash_initsize(open, n) == 0);
+    for (int i = 0; i < n; ++i)
+        CHECK(hash_add(open, &objs[i]) == 0);
+    int ntbl;
+    hash_info(open, NULL, NULL, NULL, &ntbl, NULL, NULL, NULL);
+    CHECK(ntbl >= n && ntbl < 4 * n + 16);
+    hash_free(open);
+    free(objs);
+    printf("check: ok (%d keys)\n", n);
+}
+
+static void bench(const char *name, int keyoff, int keylen, int n, int open,
+                  struct obj *objs, struct obj *misses)
+{
+    hash_t *h = new_hash(open, keyoff, keylen);
+    double t0, t1, t2, t3, t4;
+    size_t found = 0;
+
+    t0 = now();
+    for (int i = 0; i < n; ++i)
+        hash_add(h, &objs[i]);
+    t1 = now();
+    for (int r = 0; r < 4; ++r)
+        for (int i = 0; i < n; ++i)
+            found += hash_find(h, (uint8_t *)&objs[((size_t)i * 7919 + r) % n] + keyoff) != NULL;
+    t2 = now();
+    for (int i = 0; i < n; ++i)
+        found += hash_find(h, (uint8_t *)&misses[i] + keyoff) != NULL;
+    t3 = now();
+    for (int i = 0; i < n; ++i)
+        hash_del(h, &objs[i]);
+    t4 = now();
+
+    if (found != (size_t)4 * n) {
+        fprintf(stderr, "%s: found %zu, expected %d\n", name, found, 4 * n);
+        exit(1);
+    }
+    printf("%-8s %-8s add %6.1f  hit %6.1f  miss %6.1f  del %6.1f ns/op\n",
+           name, open ? "open" : "chained", (t1 - t0) * 1e9 / n,
+           (t2 - t1) * 1e9 / (4.0 * n), (t3 - t2) * 1e9 / n,
+           (t4 - t3) * 1e9 / n);
+    hash_free(h);
+}
+
+static void usage(const char *argv0)
+{
+    fprintf(stderr, "Usage: %s [-n keys] [-r rounds]\n", argv0);
+    exit(1);
+}
+
+int main(int argc, char *argv[])
+{
+    int n = 1000000, rounds = 3, c;
+
+    while ((c = getopt(argc, argv, "n:r:")) != -1) {
+        switch (c) {
+        case 'n': n = atoi(optarg); break;
+        case 'r': rounds = atoi(optarg); break;
+        default: usage(argv[0]);
+        }
+    }
+    if (n <= 0 || rounds <= 0)
+        usage(argv[0]);
+
+    comdb2ma_init(0, 0);
+
+    check(n < 100000 ? n : 100000);
+
+    struct obj *objs = calloc(n, sizeof(struct obj));
+    struct obj *misses = calloc(n, sizeof(struct obj));
+    make_keys(objs, n);
+    make_keys(misses, n);
+    for (int i = 0; i < n; ++i)
+        misses[i].genid |= 1ULL << 63;
+
+    for (int r = 0; r < rounds; ++r) {
+        for (int open = 0; open <= 1; ++open) {
+            bench("genid", offsetof(struct obj, genid), sizeof(uint64_t), n,
+                  open, objs, misses);
+            bench("key16", offsetof(struct obj, key16), 16, n, open, objs,
+                  misses);
+        }
+    }
+    free(objs);
+    free(misses);
+    return 0;
+}
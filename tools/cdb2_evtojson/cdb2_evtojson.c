@@ -0,0 +1,246 @@
+/*
+   Copyright 2026 Bloomberg Finance L.P.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+ */
+
+/*
+ * Converts binary event logs (eventlog_binary) to the JSON event log
+ * format, one event per line, as read by cdb2_sqlreplay.  Files that are
+ * already JSON are copied unchanged.
+ *
+ *   cdb2_evtojson [file ...] | cdb2_sqlreplay dbname
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <zlib.h>
+
+#include <cson.h>
+#include <eventlog_bin.h>
+
+struct reader {
+    gzFile in;
+    const char *name;
+    uint8_t *buf;
+    size_t cap;
+};
+
+/* Reads the next event into r->buf; returns its length, 0 at the end of
+ * the file, -1 on error. */
+static ssize_t read_event(struct reader *r)
+{
+    uint8_t v[EVB_VARINT_MAX];
+    uint64_t len = 0;
+    size_t n;
+
+    for (n = 0; n < sizeof(v); ++n) {
+        int c = gzgetc(r->in);
+        if (c == -1) {
+            if (n == 0)
+                return 0;
+            fprintf(stderr, "%s: truncated event length\n", r->name);
+            return -1;
+        }
+        v[n] = c;
+        if ((c & 0x80) == 0)
+            break;
+    }
+    if (evb_get_varint(v, n + 1, &len) == 0 || len == 0) {
+        fprintf(stderr, "%s: bad event length\n", r->name);
+        return -1;
+    }
+    if (len > r->cap) {
+        r->buf = realloc(r->buf, len);
+        if (r->buf == NULL) {
+            fprintf(stderr, "%s: can't allocate %llu bytes\n", r->name, (unsigned long long)len);
+            return -1;
+        }
+        r->cap = len;
+    }
+    if (gzread(r->in, r->buf, len) != len) {
+        fprintf(stderr, "%s: truncated event\n", r->name);
+        return -1;
+    }
+    return len;
+}
+
+struct decoder {
+    const uint8_t *p;
+    const uint8_t *end;
+};
+
+static int get_varint(struct decoder *d, uint64_t *v)
+{
+    size_t n = evb_get_varint(d->p, d->end - d->p, v);
+    d->p += n;
+    return n == 0;
+}
+
+static int get_bytes(struct decoder *d, const char **s, uint64_t *len)
+{
+    if (get_varint(d, len) || *len > d->end - d->p)
+        return 1;
+    *s = (const char *)d->p;
+    d->p += *len;
+    return 0;
+}
+
+static cson_value *decode_value(struct decoder *d)
+{
+    const char *s;
+    uint64_t u, len;
+    cson_value *v, *member;
+
+    if (d->p >= d->end)
+        return NULL;
+    switch (*d->p++) {
+    case EVB_NULL:
+        return cson_value_null();
+    case EVB_TRUE:
+        return cson_value_new_bool(1);
+    case EVB_FALSE:
+        return cson_value_new_bool(0);
+    case EVB_INT:
+        if (get_varint(d, &u))
+            return NULL;
+        return cson_value_new_integer(evb_unzigzag(u));
+    case EVB_DOUBLE: {
+        double dbl;
+        if (d->end - d->p < 8)
+            return NULL;
+        u = 0;
+        for (int i = 0; i < 8; ++i)
+            u |= (uint64_t)d->p[i] << (8 * i);
+        d->p += 8;
+        memcpy(&dbl, &u, sizeof(dbl));
+        return cson_new_double(dbl, 1);
+    }
+    case EVB_STRING:
+        if (get_bytes(d, &s, &len))
+            return NULL;
+        return cson_value_new_string(s, len);
+    case EVB_JSON:
+        if (get_bytes(d, &s, &len) || cson_parse_string(&v, s, len))
+            return NULL;
+        return v;
+    case EVB_OBJECT:
+        v = cson_value_new_object();
+        while (1) {
+            if (get_varint(d, &len))
+                goto err;
+            if (len == 0)
+                return v;
+            if (len > d->end - d->p)
+                goto err;
+            char key[len + 1];
+            memcpy(key, d->p, len);
+            key[len] = 0;
+            d->p += len;
+            if ((member = decode_value(d)) == NULL)
+                goto err;
+            cson_object_set(cson_value_get_object(v), key, member);
+        }
+    case EVB_ARRAY:
+        v = cson_value_new_array();
+        while (1) {
+            if (d->p >= d->end)
+                goto err;
+            if (*d->p == EVB_ARRAY_END) {
+                d->p++;
+                return v;
+            }
+            if ((member = decode_value(d)) == NULL)
+                goto err;
+            cson_array_append(cson_value_get_array(v), member);
+        }
+    default:
+        return NULL;
+    }
+err:
+    cson_value_free(v);
+    return NULL;
+}
+
+static int write_stdout(void *state, const void *src, unsigned int n)
+{
+    return fwrite(src, 1, n, stdout) != n;
+}
+
+static int convert(struct reader *r)
+{
+    char magic[EVENTLOG_BIN_MAGIC_LEN];
+    int n = gzread(r->in, magic, sizeof(magic));
+    if (n != sizeof(magic) || memcmp(magic, EVENTLOG_BIN_MAGIC, sizeof(magic)) != 0) {
+        /* a json event log */
+        char buf[64 * 1024];
+        if (n > 0)
+            fwrite(magic, 1, n, stdout);
+        while ((n = gzread(r->in, buf, sizeof(buf))) > 0)
+            fwrite(buf, 1, n, stdout);
+        return n < 0;
+    }
+
+    ssize_t len;
+    while ((len = read_event(r)) > 0) {
+        struct decoder d = {.p = r->buf, .end = r->buf + len};
+        if (*d.p == EVB_JSON) {
+            const char *s;
+            uint64_t slen;
+            d.p++;
+            if (get_bytes(&d, &s, &slen)) {
+                fprintf(stderr, "%s: malformed event\n", r->name);
+                return 1;
+            }
+            fwrite(s, 1, slen, stdout);
+            fputc('\n', stdout);
+            continue;
+        }
+        cson_value *v = decode_value(&d);
+        if (v == NULL) {
+            fprintf(stderr, "%s: malformed event\n", r->name);
+            return 1;
+        }
+        cson_output(v, write_stdout, NULL);
+        cson_value_free(v);
+    }
+    return len < 0;
+}
+
+int main(int argc, char *argv[])
+{
+    struct reader r = {0};
+    int rc = 0;
+
+    if (argc > 1 && (strcmp(argv[1], "-h") == 0 || strcmp(argv[1], "--help") == 0)) {
+        fprintf(stderr, "Usage: %s [eventlog ...]\n"
+                        "Converts binary event logs to JSON on stdout; reads stdin "
+                        "if no files are given.\n", argv[0]);
+        return 0;
+    }
+
+    for (int i = 1; i < argc || (i == 1 && argc == 1); ++i) {
+        r.name = argc == 1 ? "stdin" : argv[i];
+        r.in = argc == 1 ? gzdopen(0, "rb") : gzopen(argv[i], "rb");
+        if (r.in == NULL) {
+            fprintf(stderr, "%s: can't open\n", r.name);
+            rc = 1;
+            continue;
+        }
+        rc |= convert(&r);
+        gzclose(r.in);
+    }
+    free(r.buf);
+    return rc;
+}
@@ -38,6 +38,11 @@
 #include <cinttypes>
 #include <cassert>
 #include <limits.h>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
 
 #include "cdb2api.h"
 #include "cson.h"
@@ -68,6 +73,14 @@ static const char *usage_text =
     "  --replay-externalauth  Replay 'PUT TUNABLE externalauth' statements\n"
     "                         (skipped by default)\n"
     "\n"
+    "Parallel replay options:\n"
+    "  --parallel             Replay every captured connection on its own\n"
+    "                         connection and thread, at the captured times,\n"
+    "                         and report latency percentiles per fingerprint\n"
+    "  --speed X              Replay X times faster than captured (default 1);\n"
+    "                         0 replays without waiting between statements\n"
+    "  --max-connections N    Open at most N connections (default 512)\n"
+    "\n"
     ;
 
 /* Start of functions */
@@ -309,12 +322,12 @@ bool do_bindings(cdb2_hndl_tp *db, cson_value *event_val, std::vector<uint8_t *>
             blobs_vect.push_back((uint8_t *)varaddr);
             if (name[0] == '?') {
                 int idx = atoi(name + 1);
-                if ((ret = cdb2_bind_array_index(cdb2h, idx, cdb2_type, varaddr, count, length)) != 0) {
+                if ((ret = cdb2_bind_array_index(db, idx, cdb2_type, varaddr, count, length)) != 0) {
                     std::cerr << "cdb2_bind_array_index failed for parameter index:" << idx
                               << " type:" << type << " count:" << count << " ret:" << ret << std::endl;
                     return false;
                 }
-            } else if ((ret = cdb2_bind_array(cdb2h, name, cdb2_type, varaddr, count, length)) != 0) {
+            } else if ((ret = cdb2_bind_array(db, name, cdb2_type, varaddr, count, length)) != 0) {
                 std::cerr << "cdb2_bind_array failed for parameter name:" << name
                           << " type:" << type << " count:" << count << " ret:" << ret << std::endl;
                 return false;
@@ -399,13 +412,13 @@ bool do_bindings(cdb2_hndl_tp *db, cson_value *event_val, std::vector<uint8_t *>
 
         if (name[0] == '?') {
             int idx = atoi(name + 1);
-            if ((ret = cdb2_bind_index(cdb2h, idx, cdb2_type, varaddr, length)) != 0) {
+            if ((ret = cdb2_bind_index(db, idx, cdb2_type, varaddr, length)) != 0) {
                 std::cerr << "Error from cdb2_bind_index() column " << name << ", ret=" << ret << std::endl;
                 return false;
             }
         }
         else {
-            if ((ret = cdb2_bind_param(cdb2h, name, cdb2_type, varaddr, length)) != 0) {
+            if ((ret = cdb2_bind_param(db, name, cdb2_type, varaddr, length)) != 0) {
                 std::cerr << "Error from cdb2_bind_param column " << name << ", ret=" << ret << std::endl;
                 return false;
             }
@@ -1129,6 +1142,415 @@ void process_events(cdb2_hndl_tp *db, event_queue &queue) {
         std::cout << "got " << linenum  << " lines" << std::endl;
 }
 
+/* Parallel replay (--parallel).  Every client connection of the captured
+   log (host, pid and connid of its events) gets its own handle and thread,
+   so transactions run on the connection they were captured on, with the
+   original concurrency.  Statements start at their captured offset from
+   the first event, divided by --speed; --speed 0 runs them back to back.
+   Past --max-connections, captured connections share handles, one
+   transaction at a time.  At the end, replay latencies per fingerprint are reported next to the
+   captured ones. */
+
+bool parallel = false;
+double speed = 1.0;
+int max_connections = 512;
+int max_pending = 100000;
+
+typedef std::chrono::steady_clock replay_clock;
+
+static int open_db(cdb2_hndl_tp **db)
+{
+    char *conf = getenv("CDB2_CONFIG");
+    if (conf) {
+        cdb2_set_comdb2db_config(conf);
+        return cdb2_open(db, dbname, "default", 0);
+    }
+    return cdb2_open(db, dbname, "local", 0);
+}
+
+static int64_t captured_time(cson_value *event_val)
+{
+    cson_object *obj;
+    cson_value_fetch_object(event_val, &obj);
+    cson_value *perf = cson_object_get(obj, "perf");
+    if (perf == nullptr || !cson_value_is_object(perf))
+        return -1;
+    int64_t tottime;
+    if (!get_intprop(perf, "tottime", &tottime))
+        return -1;
+    return tottime;
+}
+
+static int64_t percentile(std::vector<int64_t> &v, double p)
+{
+    if (v.empty())
+        return 0;
+    size_t ix = (size_t)(p * v.size());
+    if (ix >= v.size())
+        ix = v.size() - 1;
+    return v[ix];
+}
+
+class replay_stats {
+public:
+    void add(const std::string &fingerprint, const char *sql, int64_t replay_us,
+             int64_t captured_us, int64_t lag_us, bool error)
+    {
+        std::lock_guard<std::mutex> l(lk);
+        auto &fp = fingerprints[fingerprint];
+        if (fp.sql.empty())
+            fp.sql = sql;
+        if (error) {
+            fp.errors++;
+            nerrors++;
+            return;
+        }
+        fp.replay_us.push_back(replay_us);
+        if (captured_us >= 0)
+            fp.captured_us.push_back(captured_us);
+        lag.push_back(lag_us);
+        nstatements++;
+    }
+
+    void report(double wall_sec, double captured_sec, size_t nconnections, int64_t nskipped)
+    {
+        std::lock_guard<std::mutex> l(lk);
+        printf("replayed %" PRId64 " statements on %zu connections in %.2fs: %.1f/s "
+               "(captured %.1f/s over %.2fs), %" PRId64 " errors, %" PRId64 " skipped\n",
+               nstatements, nconnections, wall_sec, wall_sec > 0 ? nstatements / wall_sec : 0.0,
+               captured_sec > 0 ? (nstatements + nerrors) / captured_sec : 0.0, captured_sec,
+               nerrors, nskipped);
+        std::sort(lag.begin(), lag.end());
+        printf("start lag us: p50 %" PRId64 " p99 %" PRId64 " max %" PRId64 "\n",
+               percentile(lag, 0.5), percentile(lag, 0.99), percentile(lag, 1));
+
+        std::vector<std::pair<int64_t, std::string>> order;
+        for (auto &i : fingerprints) {
+            int64_t total = 0;
+            for (auto t : i.second.replay_us)
+                total += t;
+            order.push_back(std::make_pair(total, i.first));
+        }
+        std::sort(order.rbegin(), order.rend());
+
+        /* '*' marks fingerprints whose replay p99 is more than --threshold
+           percent slower than captured */
+        printf("%-32s %8s %6s | %-36s | %-36s | sql\n", "fingerprint", "count", "errors",
+               "replay us p50/p90/p99/max", "captured us p50/p90/p99/max");
+        for (auto &o : order) {
+            auto &fp = fingerprints[o.second];
+            std::sort(fp.replay_us.begin(), fp.replay_us.end());
+            std::sort(fp.captured_us.begin(), fp.captured_us.end());
+            int64_t r99 = percentile(fp.replay_us, 0.99);
+            int64_t c99 = percentile(fp.captured_us, 0.99);
+            bool slower = !fp.captured_us.empty() && r99 > c99 &&
+                          !within_threshold(r99, c99, threshold_percent);
+            std::string sql = fp.sql.substr(0, 60);
+            std::replace(sql.begin(), sql.end(), '\n', ' ');
+            printf("%-32s %8zu %6" PRId64 " | %8" PRId64 " %8" PRId64 " %8" PRId64 " %9" PRId64
+                   " | %8" PRId64 " %8" PRId64 " %8" PRId64 " %9" PRId64 " |%c%s\n",
+                   o.second.c_str(), fp.replay_us.size(), fp.errors,
+                   percentile(fp.replay_us, 0.5), percentile(fp.replay_us, 0.9), r99,
+                   percentile(fp.replay_us, 1), percentile(fp.captured_us, 0.5),
+                   percentile(fp.captured_us, 0.9), c99, percentile(fp.captured_us, 1),
+                   slower ? '*' : ' ', sql.c_str());
+        }
+    }
+
+private:
+    struct fingerprint_stats {
+        std::string sql;
+        std::vector<int64_t> replay_us;
+        std::vector<int64_t> captured_us;
+        int64_t errors = 0;
+    };
+    std::mutex lk;
+    std::map<std::string, fingerprint_stats> fingerprints;
+    std::vector<int64_t> lag;
+    int64_t nstatements = 0;
+    int64_t nerrors = 0;
+};
+
+static replay_stats stats;
+
+/* events queued to the connections and not run yet */
+static std::mutex pending_lk;
+static std::condition_variable pending_cv;
+static int pending = 0;
+
+static void pending_done()
+{
+    std::lock_guard<std::mutex> l(pending_lk);
+    pending--;
+    pending_cv.notify_one();
+}
+
+/* Runs the statement of an event, reading and dropping its rows */
+static bool run_event(cdb2_hndl_tp *db, const char *sql, cson_value *event_val)
+{
+    std::vector<uint8_t *> blobs_vect;
+    bool ok = do_bindings(db, event_val, blobs_vect);
+    if (!ok) {
+        cdb2_clearbindings(db);
+        free_blobs(blobs_vect);
+        return false;
+    }
+    int rc = cdb2_run_statement(db, sql);
+    cdb2_clearbindings(db);
+    free_blobs(blobs_vect);
+    if (rc == CDB2_OK) {
+        while ((rc = cdb2_next_record(db)) == CDB2_OK)
+            ;
+    }
+    if (rc != CDB2_OK && rc != CDB2_OK_DONE) {
+        if (verbose)
+            std::cerr << "Error: " << sql << " rc " << rc << ": " << cdb2_errstr(db) << std::endl;
+        return false;
+    }
+    return true;
+}
+
+struct replay_event {
+    cson_value *val;
+    std::string sql; /* from the event, or from its fingerprint */
+    replay_clock::time_point due;
+};
+
+class replay_connection {
+public:
+    replay_connection() : thd(&replay_connection::run, this) {}
+
+    void push(const replay_event &ev)
+    {
+        std::lock_guard<std::mutex> l(lk);
+        events.push_back(ev);
+        cv.notify_one();
+    }
+
+    void finish()
+    {
+        {
+            std::lock_guard<std::mutex> l(lk);
+            done = true;
+            cv.notify_one();
+        }
+        thd.join();
+    }
+
+private:
+    void run()
+    {
+        cdb2_hndl_tp *db = nullptr;
+        if (open_db(&db) != 0) {
+            std::cerr << "Error: cdb2_open() failed: " << cdb2_errstr(db) << std::endl;
+            cdb2_close(db);
+            db = nullptr;
+        }
+        for (;;) {
+            replay_event ev;
+            {
+                std::unique_lock<std::mutex> l(lk);
+                cv.wait(l, [this] { return done || !events.empty(); });
+                if (events.empty())
+                    break;
+                ev = events.front();
+                events.pop_front();
+            }
+            std::this_thread::sleep_until(ev.due);
+
+            cson_value *event_val = ev.val;
+            const char *sql = ev.sql.c_str();
+            const char *fp = get_strprop(event_val, "fingerprint");
+            auto start = replay_clock::now();
+            bool ok = db != nullptr && run_event(db, sql, event_val);
+            auto end = replay_clock::now();
+            stats.add(fp ? fp : sql, sql,
+                      std::chrono::duration_cast<std::chrono::microseconds>(end - start).count(),
+                      captured_time(event_val),
+                      std::chrono::duration_cast<std::chrono::microseconds>(start - ev.due).count(),
+                      !ok);
+            cson_free_value(event_val);
+            pending_done();
+        }
+        if (db)
+            cdb2_close(db);
+    }
+
+    std::mutex lk;
+    std::condition_variable cv;
+    std::deque<replay_event> events;
+    bool done = false;
+    std::thread thd;
+};
+
+/* A handle shared by several captured connections (past --max-connections)
+   runs the statements of one captured transaction at a time: while one of
+   them has a transaction open, the statements of the others are held back
+   until it commits or rolls back.  Only the reading thread uses these. */
+struct replay_handle {
+    replay_connection *conn;
+    std::string txn_owner; /* captured connection with a transaction open */
+    std::deque<std::pair<std::string, replay_event>> held;
+    std::map<std::string, int> nheld; /* held statements per captured connection */
+};
+
+static std::string first_word(const std::string &sql)
+{
+    std::istringstream iss(sql);
+    std::string tok;
+    iss >> tok;
+    std::transform(tok.begin(), tok.end(), tok.begin(), ::tolower);
+    return tok;
+}
+
+static void handle_run(replay_handle *h, const std::string &key, const replay_event &ev)
+{
+    std::string verb = first_word(ev.sql);
+    if (verb == "begin")
+        h->txn_owner = key;
+    else if ((verb == "commit" || verb == "rollback") && h->txn_owner == key)
+        h->txn_owner.clear();
+
+    {
+        std::unique_lock<std::mutex> l(pending_lk);
+        pending_cv.wait(l, [] { return pending < max_pending; });
+        pending++;
+    }
+    h->conn->push(ev);
+}
+
+/* Run the held statements which can run now, keeping the order of each
+   captured connection; with force, run them all (their transactions never
+   ended in the log) */
+static void handle_release(replay_handle *h, bool force)
+{
+    bool progress = true;
+    while (progress && !h->held.empty()) {
+        progress = false;
+        std::map<std::string, bool> blocked;
+        for (auto it = h->held.begin(); it != h->held.end();) {
+            const std::string &key = it->first;
+            if (!force && (blocked.count(key) || (!h->txn_owner.empty() && h->txn_owner != key))) {
+                blocked[key] = true;
+                ++it;
+                continue;
+            }
+            std::pair<std::string, replay_event> held = *it;
+            it = h->held.erase(it);
+            h->nheld[held.first]--;
+            handle_run(h, held.first, held.second);
+            progress = true;
+        }
+    }
+}
+
+static void handle_push(replay_handle *h, const std::string &key, const replay_event &ev)
+{
+    if (h->nheld[key] > 0 || (!h->txn_owner.empty() && h->txn_owner != key)) {
+        h->held.push_back(std::make_pair(key, ev));
+        h->nheld[key]++;
+        return;
+    }
+    handle_run(h, key, ev);
+    if (h->txn_owner.empty())
+        handle_release(h, false);
+}
+
+static std::string connection_key(cson_value *event_val)
+{
+    const char *host = get_strprop(event_val, "host");
+    int64_t pid = 0, connid = 0;
+    get_intprop(event_val, "pid", &pid);
+    get_intprop(event_val, "connid", &connid);
+    std::ostringstream key;
+    key << (host ? host : "") << ':' << pid << ':' << connid;
+    return key.str();
+}
+
+void process_events_parallel(event_queue &queue)
+{
+    std::map<std::string, replay_handle *> connections;
+    std::vector<replay_handle *> all;
+    int64_t numevents = 0, nskipped = 0;
+    int64_t first_time = -1, last_time = 0;
+    replay_clock::time_point start = replay_clock::now();
+
+    while (!queue.empty()) {
+        cson_value *event_val = queue.get();
+        if (event_val == nullptr)
+            continue;
+        const char *type = get_strprop(event_val, "type");
+        if (type != nullptr && strcmp(type, "newsql") == 0) {
+            /* first sighting of a fingerprint: not a statement of its own */
+            handle_newsql(nullptr, event_val);
+            cson_free_value(event_val);
+            continue;
+        }
+        if (type == nullptr || !event_is_sql(event_val)) {
+            cson_free_value(event_val);
+            continue;
+        }
+        const char *sql = get_strprop(event_val, "sql");
+        if (sql == nullptr) {
+            /* not a detailed log: the sql came with its fingerprint */
+            const char *fp = get_strprop(event_val, "fingerprint");
+            auto s = fp ? sqltrack.find(fp) : sqltrack.end();
+            if (s != sqltrack.end())
+                sql = s->second.c_str();
+        }
+        int64_t time = 0;
+        get_intprop(event_val, "time", &time);
+        if (!is_replayable(event_val) || sql == nullptr ||
+            (!replay_externalauth && is_put_tunable_externalauth(sql))) {
+            cson_free_value(event_val);
+            nskipped++;
+            continue;
+        }
+
+        if (first_time == -1)
+            first_time = time;
+        last_time = time;
+        replay_clock::time_point due = start;
+        if (speed > 0)
+            due += std::chrono::microseconds((int64_t)((time - first_time) / speed));
+
+        std::string key = connection_key(event_val);
+        auto it = connections.find(key);
+        replay_handle *h;
+        if (it != connections.end()) {
+            h = it->second;
+        } else if (all.size() < (size_t)max_connections) {
+            h = new replay_handle();
+            h->conn = new replay_connection();
+            all.push_back(h);
+            connections[key] = h;
+        } else {
+            /* share a handle: keeps the order, loses some concurrency */
+            h = all[std::hash<std::string>()(key) % all.size()];
+            connections[key] = h;
+        }
+        handle_push(h, key, replay_event{event_val, sql, due});
+
+        numevents++;
+        if (maxevents && numevents >= maxevents)
+            break;
+    }
+
+    for (auto h : all) {
+        if (!h->held.empty())
+            std::cerr << "Warning: " << h->held.size()
+                      << " statements held behind a transaction which never ended" << std::endl;
+        handle_release(h, true);
+        h->conn->finish();
+        delete h->conn;
+        delete h;
+    }
+    double wall_sec =
+        std::chrono::duration_cast<std::chrono::microseconds>(replay_clock::now() - start).count() / 1e6;
+    double captured_sec = first_time == -1 ? 0 : (last_time - first_time) / 1e6;
+    stats.report(wall_sec, captured_sec, all.size(), nskipped);
+}
+
 int main(int argc, char **argv) {
     char *filename = nullptr;
 
@@ -1157,6 +1579,28 @@ int main(int argc, char **argv) {
         }
         else if (strcmp(argv[0], "--replay-externalauth") == 0)
             replay_externalauth = true;
+        else if (strcmp(argv[0], "--parallel") == 0)
+            parallel = true;
+        else if (strcmp(argv[0], "--speed") == 0) {
+            argc--;
+            argv++;
+            if (argc == 0) {
+                fprintf(stderr, "--speed expected an argument");
+                return 1;
+            }
+            speed = strtod(argv[0], nullptr);
+        }
+        else if (strcmp(argv[0], "--max-connections") == 0) {
+            argc--;
+            argv++;
+            if (argc == 0) {
+                fprintf(stderr, "--max-connections expected an argument");
+                return 1;
+            }
+            max_connections = (int) strtol(argv[0], nullptr, 10);
+            if (max_connections < 1)
+                max_connections = 1;
+        }
         else if (strcmp(argv[0], "--stopat") == 0) {
             argc--;
             argv++;
@@ -1176,6 +1620,17 @@ int main(int argc, char **argv) {
     argc--;
     argv++;
 
+    if (parallel) {
+        event_queue events;
+        while (argc) {
+            events.add_source(argv[0]);
+            argc--;
+            argv++;
+        }
+        process_events_parallel(events);
+        return 0;
+    }
+
     /* TODO: tier should be an option */
     int rc;
     char *conf = getenv("CDB2_CONFIG");
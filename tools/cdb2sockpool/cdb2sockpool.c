@@ -278,6 +278,8 @@ static int cache_port(char *typestr, int fd, char *prefix)
                __LINE__, rc, errno);
         return -1;
     }
+    if (in.sin_family != AF_INET) /* a multiplexed session */
+        return 0;
 
     portnum = ntohs(in.sin_port);
 
@@ -527,6 +529,18 @@ void *client_thd(void *voidarg)
                 continue;
             }
 
+            /* Sessions on the multiplexed connections replace it */
+            if (MUX_ENABLED && mux_donated(typestr, newfd)) {
+                clnt.stats.fds_donated++;
+                gbl_stats.fds_donated++;
+                close(newfd);
+                if (VERBOSE) {
+                    syslog(LOG_DEBUG, "%s: closed donated fd %d for %s\n",
+                           prefix, newfd, typestr);
+                }
+                continue;
+            }
+
             /* If there's an associated database number then increment our
              * count of sockets pooled for this dbnum.  If later on we can't
              * pool it our destructor (fd_destructor) will be called and will
@@ -584,6 +598,8 @@ void *client_thd(void *voidarg)
             }
 
             newfd = socket_pool_get(typestr);
+            if (newfd == -1 && MUX_ENABLED)
+                newfd = mux_session_open(typestr);
 
             request = SOCKPOOL_DONATE;
 
@@ -768,6 +784,7 @@ static const char *help_menu[] = {
     "stat clnt          - Detailed client stats",
     "stat pool          - Details socket_pool.c stats",
     "stat port          - Details cached ports",
+    "stat mux           - Details multiplexed connections",
     "set <name> <value> - Change tunable",
     "closeall           - Close all pooled sockets",
     "purgeports         - Removes all the port hints",
@@ -915,6 +932,8 @@ static void message_trap(int ntoks, char *toks[])
                 do_stat_pool();
             } else if (strcasecmp(toks[1], "port") == 0) {
                 do_stat_port();
+            } else if (strcasecmp(toks[1], "mux") == 0) {
+                mux_stat();
             } else {
                 syslog(LOG_INFO, "Unknown stat tail '%s'\n", toks[1]);
             }
@@ -1117,7 +1136,7 @@ int main(int argc, char *argv[])
 
     optind = 1;
 
-    while ((c = getopt(argc, argv, "p:f")) != EOF) {
+    while ((c = getopt(argc, argv, "p:fm")) != EOF) {
         switch (c) {
         case 'p':
             /* Of the two limits sizeof(sun_addr.sun_path) is smaller */
@@ -1132,6 +1151,10 @@ int main(int argc, char *argv[])
             foreground_mode = 1;
             break;
 
+        case 'm':
+            MUX_ENABLED = 1;
+            break;
+
         case '?':
             syslog(LOG_ERR, "Unrecognised option: -%c\n", optopt);
             exit(2);
@@ -1161,6 +1184,7 @@ int main(int argc, char *argv[])
     listc_init(&active_list, offsetof(struct db_number_info, linkv));
     listc_init(&client_list, offsetof(struct client, linkv));
     port_hints = hash_init_str(offsetof(struct port_hint, typestr));
+    mux_init();
 
     syslog(LOG_INFO, "Will listen on local domain socket %s\n", unix_bind_path);
 
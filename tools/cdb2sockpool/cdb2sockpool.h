@@ -54,4 +54,10 @@ void setting_changed(unsigned *setting);
 
 void *local_accept_thd(void *voidarg);
 
+/* Multiplexed connections (mux.c) */
+void mux_init(void);
+int mux_donated(const char *typestr, int fd);
+int mux_session_open(const char *typestr);
+void mux_stat(void);
+
 #endif /* INC__SQLPROXY_H */
@@ -0,0 +1,577 @@
+/*
+   Copyright 2026 Bloomberg Finance L.P.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+ */
+
+/*
+ * Multiplexed connections.
+ *
+ * With MUX_ENABLED, a request for a comdb2 socket which can't be served from
+ * the pool is served with a session on one of a few connections we keep to
+ * the database (see newsql_mux.h).  The client is handed one end of a socket
+ * pair and talks newsql on it as if it were a pooled connection; a thread per
+ * connection relays between the socket pairs and the frames of the
+ * connection.  Session fds are donated back and pooled like any other.
+ *
+ * We learn where a database is from the fds clients donate to us.  Once
+ * there is a connection to it, donated tcp fds are closed rather than
+ * pooled.  A database which does not answer the multiplexing handshake is
+ * left alone for MUX_RETRY_SECS.
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <syslog.h>
+#include <time.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+
+#include <list.h>
+#include <plhash_glue.h>
+#include <newsql_mux.h>
+
+#include "cdb2sockpool.h"
+#include <sys_wrap.h>
+
+struct mux_buf {
+    uint8_t *data;
+    size_t off;
+    size_t len;
+    size_t cap;
+};
+
+struct mux_session {
+    uint32_t id; /* hash key, must be first */
+    int fd;      /* our end of the client's socket pair */
+    int remote_closed;
+    int gone;
+    struct mux_buf out; /* to the client */
+    LINKC_T(struct mux_session) lnk;
+};
+
+struct mux_conn {
+    int fd;
+    int wake[2];
+    uint32_t next_id;
+    int nsessions; /* including pending */
+    struct mux_buf in, out; /* from and to the database */
+    hash_t *by_id;
+    LISTC_T(struct mux_session) sessions;
+    LISTC_T(struct mux_session) pending; /* not opened yet */
+    struct mux_target *target;
+    LINKC_T(struct mux_conn) lnk;
+};
+
+struct mux_target {
+    struct sockaddr_in addr;
+    time_t refused; /* when the database refused to multiplex */
+    LISTC_T(struct mux_conn) conns;
+    char typestr[1];
+};
+
+/* Protects the targets, their connections' lists, session counts and
+ * pending sessions */
+static pthread_mutex_t mux_lk = PTHREAD_MUTEX_INITIALIZER;
+static hash_t *mux_targets;
+
+static unsigned mux_sessions_opened;
+
+void mux_init(void)
+{
+    mux_targets = hash_init_str(offsetof(struct mux_target, typestr));
+}
+
+static size_t buf_pending(struct mux_buf *b)
+{
+    return b->len - b->off;
+}
+
+static void buf_reserve(struct mux_buf *b, size_t n)
+{
+    if (b->off && b->len + n > b->cap) {
+        memmove(b->data, b->data + b->off, b->len - b->off);
+        b->len -= b->off;
+        b->off = 0;
+    }
+    if (b->len + n > b->cap) {
+        size_t cap = b->cap ? b->cap : 4096;
+        while (cap < b->len + n)
+            cap *= 2;
+        b->data = realloc(b->data, cap);
+        b->cap = cap;
+    }
+}
+
+static void buf_append(struct mux_buf *b, const void *data, size_t n)
+{
+    buf_reserve(b, n);
+    memcpy(b->data + b->len, data, n);
+    b->len += n;
+}
+
+static void buf_consume(struct mux_buf *b, size_t n)
+{
+    b->off += n;
+    if (b->off == b->len)
+        b->off = b->len = 0;
+}
+
+/* Returns -1 on error, else what was written */
+static ssize_t buf_write(struct mux_buf *b, int fd)
+{
+    ssize_t n = write(fd, b->data + b->off, b->len - b->off);
+    if (n < 0)
+        return (errno == EAGAIN || errno == EINTR) ? 0 : -1;
+    buf_consume(b, n);
+    return n;
+}
+
+/* Returns -1 on error or eof, else what was read */
+static ssize_t buf_read(struct mux_buf *b, int fd, size_t max)
+{
+    buf_reserve(b, max);
+    ssize_t n = read(fd, b->data + b->len, max);
+    if (n < 0)
+        return (errno == EAGAIN || errno == EINTR) ? 0 : -1;
+    if (n == 0)
+        return -1;
+    b->len += n;
+    return n;
+}
+
+static void mux_frame(struct mux_conn *conn, uint32_t type, uint32_t id,
+                      const void *data, size_t len)
+{
+    struct newsql_mux_hdr hdr;
+    hdr.type = htonl(type);
+    hdr.session = htonl(id);
+    hdr.length = htonl(len);
+    buf_append(&conn->out, &hdr, sizeof(hdr));
+    if (len)
+        buf_append(&conn->out, data, len);
+}
+
+static void session_free(struct mux_session *s)
+{
+    close(s->fd);
+    free(s->out.data);
+    free(s);
+}
+
+static void set_nonblocking(int fd)
+{
+    int flags = fcntl(fd, F_GETFL);
+    fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+}
+
+static int wait_fd(int fd, short events, int timeoutms)
+{
+    struct pollfd pfd = {.fd = fd, .events = events};
+    int rc;
+    while ((rc = poll(&pfd, 1, timeoutms)) == -1 && errno == EINTR)
+        ;
+    return rc == 1 ? 0 : -1;
+}
+
+/* Process the frames read so far; returns -1 to drop the connection */
+static int mux_process(struct mux_conn *conn)
+{
+    struct newsql_mux_hdr hdr;
+    while (buf_pending(&conn->in) >= sizeof(hdr)) {
+        memcpy(&hdr, conn->in.data + conn->in.off, sizeof(hdr));
+        uint32_t type = ntohl(hdr.type);
+        uint32_t id = ntohl(hdr.session);
+        uint32_t len = ntohl(hdr.length);
+        if (len > NEWSQL_MUX_MAX_FRAME) {
+            syslog(LOG_NOTICE, "%s: bad frame length %u\n", __func__, len);
+            return -1;
+        }
+        if (buf_pending(&conn->in) < sizeof(hdr) + len)
+            break;
+        uint8_t *data = conn->in.data + conn->in.off + sizeof(hdr);
+        struct mux_session *s = hash_find(conn->by_id, &id);
+        switch (type) {
+        case NEWSQL_MUX_DATA:
+            if (s && !s->gone)
+                buf_append(&s->out, data, len);
+            break;
+        case NEWSQL_MUX_CLOSE:
+            if (s)
+                s->remote_closed = 1;
+            break;
+        default:
+            syslog(LOG_NOTICE, "%s: bad frame type %u\n", __func__, type);
+            return -1;
+        }
+        buf_consume(&conn->in, sizeof(hdr) + len);
+    }
+    return 0;
+}
+
+static void *mux_thd(void *arg)
+{
+    struct mux_conn *conn = arg;
+    struct mux_session *s, *tmp;
+    struct pollfd *pfds = NULL;
+    struct mux_session **pss = NULL;
+    int alloc = 0;
+    char junk[64];
+
+    while (1) {
+        Pthread_mutex_lock(&mux_lk);
+        while ((s = listc_rtl(&conn->pending)) != NULL) {
+            listc_abl(&conn->sessions, s);
+            hash_add(conn->by_id, s);
+            mux_frame(conn, NEWSQL_MUX_OPEN, s->id, NULL, 0);
+        }
+        Pthread_mutex_unlock(&mux_lk);
+
+        int n = listc_size(&conn->sessions) + 2;
+        if (n > alloc) {
+            alloc = n * 2;
+            pfds = realloc(pfds, alloc * sizeof(struct pollfd));
+            pss = realloc(pss, alloc * sizeof(struct mux_session *));
+        }
+
+        /* Stop reading from clients while the connection is backed up, and
+         * from the connection while a client is */
+        int full = 0;
+        int out_full = buf_pending(&conn->out) >= MUX_SESSION_BUF;
+        n = 2;
+        LISTC_FOR_EACH(&conn->sessions, s, lnk)
+        {
+            short events = 0;
+            if (!s->remote_closed && !out_full)
+                events |= POLLIN;
+            if (buf_pending(&s->out))
+                events |= POLLOUT;
+            if (buf_pending(&s->out) >= MUX_SESSION_BUF)
+                full = 1;
+            pfds[n].fd = s->fd;
+            pfds[n].events = events;
+            pfds[n].revents = 0;
+            pss[n++] = s;
+        }
+        pfds[0].fd = conn->wake[0];
+        pfds[0].events = POLLIN;
+        pfds[0].revents = 0;
+        pfds[1].fd = conn->fd;
+        pfds[1].events = (full ? 0 : POLLIN) |
+                         (buf_pending(&conn->out) ? POLLOUT : 0);
+        pfds[1].revents = 0;
+
+        if (poll(pfds, n, -1) == -1) {
+            if (errno == EINTR)
+                continue;
+            syslog(LOG_ERR, "%s: poll %d %s\n", __func__, errno,
+                   strerror(errno));
+            break;
+        }
+        if (pfds[0].revents) {
+            while (read(conn->wake[0], junk, sizeof(junk)) > 0)
+                ;
+        }
+        if ((pfds[1].revents & POLLOUT) && buf_write(&conn->out, conn->fd) < 0)
+            break;
+        if ((pfds[1].revents & (POLLIN | POLLHUP | POLLERR)) &&
+            (buf_read(&conn->in, conn->fd,
+                      sizeof(struct newsql_mux_hdr) + NEWSQL_MUX_MAX_FRAME) < 0 ||
+             mux_process(conn) != 0))
+            break;
+
+        for (int i = 2; i < n; i++) {
+            s = pss[i];
+            short revents = pfds[i].revents;
+            if ((revents & POLLOUT) && buf_write(&s->out, s->fd) < 0)
+                s->gone = 1;
+            if (s->gone)
+                continue;
+            if (revents & POLLIN) {
+                uint8_t data[NEWSQL_MUX_MAX_FRAME];
+                ssize_t nread = read(s->fd, data, sizeof(data));
+                if (nread > 0)
+                    mux_frame(conn, NEWSQL_MUX_DATA, s->id, data, nread);
+                else if (nread == 0 || (errno != EAGAIN && errno != EINTR))
+                    s->gone = 1;
+            } else if (revents & (POLLHUP | POLLERR)) {
+                s->gone = 1;
+            }
+        }
+
+        LISTC_FOR_EACH_SAFE(&conn->sessions, s, tmp, lnk)
+        {
+            if (s->remote_closed && buf_pending(&s->out) == 0)
+                s->gone = 1;
+            if (!s->gone)
+                continue;
+            if (!s->remote_closed)
+                mux_frame(conn, NEWSQL_MUX_CLOSE, s->id, NULL, 0);
+            listc_rfl(&conn->sessions, s);
+            hash_del(conn->by_id, s);
+            session_free(s);
+            Pthread_mutex_lock(&mux_lk);
+            conn->nsessions--;
+            Pthread_mutex_unlock(&mux_lk);
+        }
+    }
+
+    if (VERBOSE) {
+        syslog(LOG_DEBUG, "%s: closing connection for %s with %d sessions\n",
+               __func__, conn->target->typestr, listc_size(&conn->sessions));
+    }
+
+    /* No one can hand us sessions once we are off the list */
+    Pthread_mutex_lock(&mux_lk);
+    listc_rfl(&conn->target->conns, conn);
+    Pthread_mutex_unlock(&mux_lk);
+
+    while ((s = listc_rtl(&conn->pending)) != NULL)
+        session_free(s);
+    while ((s = listc_rtl(&conn->sessions)) != NULL)
+        session_free(s);
+    hash_free(conn->by_id);
+    close(conn->fd);
+    close(conn->wake[0]);
+    close(conn->wake[1]);
+    free(conn->in.data);
+    free(conn->out.data);
+    free(conn);
+    free(pfds);
+    free(pss);
+    return NULL;
+}
+
+/* Connect and handshake; returns the fd, -1 if we could not connect, or -2
+ * if the database does not multiplex */
+static int mux_connect(const struct sockaddr_in *addr)
+{
+    struct newsql_mux_hdr hdr;
+    const char *appsock = NEWSQL_MUX_APPSOCK;
+    size_t len = strlen(appsock);
+    socklen_t errlen = sizeof(int);
+    int fd, err = 0, flag = 1;
+
+    if ((fd = socket(AF_INET, SOCK_STREAM, 0)) == -1)
+        return -1;
+    set_nonblocking(fd);
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &flag, sizeof(flag));
+    if (connect(fd, (const struct sockaddr *)addr, sizeof(*addr)) == -1 &&
+        errno != EINPROGRESS)
+        goto err;
+    if (wait_fd(fd, POLLOUT, MUX_CONNECT_TIMEOUT) != 0 ||
+        getsockopt(fd, SOL_SOCKET, SO_ERROR, &err, &errlen) != 0 || err != 0)
+        goto err;
+    if (write(fd, appsock, len) != len)
+        goto err;
+
+    /* From here on, failing means the database doesn't speak the protocol */
+    size_t got = 0;
+    while (got < sizeof(hdr)) {
+        if (wait_fd(fd, POLLIN, MUX_CONNECT_TIMEOUT) != 0)
+            goto refused;
+        ssize_t n = read(fd, (uint8_t *)&hdr + got, sizeof(hdr) - got);
+        if (n <= 0 && !(n < 0 && (errno == EAGAIN || errno == EINTR)))
+            goto refused;
+        if (n > 0)
+            got += n;
+    }
+    if (ntohl(hdr.type) != NEWSQL_MUX_HELLO || hdr.length != 0)
+        goto refused;
+    return fd;
+
+refused:
+    close(fd);
+    return -2;
+err:
+    close(fd);
+    return -1;
+}
+
+static struct mux_conn *mux_conn_new(int fd)
+{
+    struct mux_conn *conn = calloc(1, sizeof(struct mux_conn));
+    if (conn == NULL)
+        return NULL;
+    if (pipe(conn->wake) != 0) {
+        free(conn);
+        return NULL;
+    }
+    set_nonblocking(conn->wake[0]);
+    set_nonblocking(conn->wake[1]);
+    conn->fd = fd;
+    conn->next_id = 1;
+    conn->by_id = hash_init(sizeof(uint32_t));
+    listc_init(&conn->sessions, offsetof(struct mux_session, lnk));
+    listc_init(&conn->pending, offsetof(struct mux_session, lnk));
+    return conn;
+}
+
+static void mux_start(struct mux_conn *conn)
+{
+    pthread_attr_t attr;
+    pthread_t tid;
+    Pthread_attr_init(&attr);
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+    Pthread_create(&tid, &attr, mux_thd, conn);
+    Pthread_attr_destroy(&attr);
+}
+
+int mux_donated(const char *typestr, int fd)
+{
+    struct sockaddr_in addr;
+    socklen_t len = sizeof(addr);
+    struct mux_target *t;
+    int live;
+
+    if (strncmp(typestr, "comdb2/", 7) != 0)
+        return 0;
+    /* Sessions we handed out come back as unix domain sockets */
+    if (getpeername(fd, (struct sockaddr *)&addr, &len) != 0 ||
+        addr.sin_family != AF_INET)
+        return 0;
+
+    Pthread_mutex_lock(&mux_lk);
+    t = hash_find(mux_targets, typestr);
+    if (t == NULL) {
+        t = calloc(1, offsetof(struct mux_target, typestr) + strlen(typestr) + 1);
+        strcpy(t->typestr, typestr);
+        listc_init(&t->conns, offsetof(struct mux_conn, lnk));
+        hash_add(mux_targets, t);
+    }
+    t->addr = addr;
+    live = listc_size(&t->conns) > 0;
+    Pthread_mutex_unlock(&mux_lk);
+    return live;
+}
+
+int mux_session_open(const char *typestr)
+{
+    struct mux_target *t;
+    struct mux_conn *conn = NULL, *c;
+    struct sockaddr_in addr;
+    int sv[2];
+
+    Pthread_mutex_lock(&mux_lk);
+    t = hash_find(mux_targets, typestr);
+    if (t == NULL ||
+        (t->refused && time(NULL) - t->refused < MUX_RETRY_SECS)) {
+        Pthread_mutex_unlock(&mux_lk);
+        return -1;
+    }
+    LISTC_FOR_EACH(&t->conns, c, lnk)
+    {
+        if (conn == NULL || c->nsessions < conn->nsessions)
+            conn = c;
+    }
+    /* Add a connection until there are MUX_CONNS_PER_DB of them */
+    if (conn && conn->nsessions > 0 && listc_size(&t->conns) < MUX_CONNS_PER_DB)
+        conn = NULL;
+    addr = t->addr;
+    Pthread_mutex_unlock(&mux_lk);
+
+    if (conn == NULL) {
+        int fd = mux_connect(&addr);
+        if (fd < 0) {
+            if (fd == -2) {
+                syslog(LOG_NOTICE, "%s: %s does not multiplex\n", __func__,
+                       typestr);
+                Pthread_mutex_lock(&mux_lk);
+                t->refused = time(NULL);
+                Pthread_mutex_unlock(&mux_lk);
+            }
+            return -1;
+        }
+        if ((conn = mux_conn_new(fd)) == NULL) {
+            close(fd);
+            return -1;
+        }
+        conn->target = t;
+        Pthread_mutex_lock(&mux_lk);
+        t->refused = 0;
+        listc_abl(&t->conns, conn);
+        Pthread_mutex_unlock(&mux_lk);
+        mux_start(conn);
+        if (VERBOSE) {
+            syslog(LOG_DEBUG, "%s: new connection for %s\n", __func__, typestr);
+        }
+    }
+
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, sv) != 0) {
+        syslog(LOG_ERR, "%s: socketpair %d %s\n", __func__, errno,
+               strerror(errno));
+        return -1;
+    }
+    set_nonblocking(sv[0]);
+
+    struct mux_session *s = calloc(1, sizeof(struct mux_session));
+    s->fd = sv[0];
+
+    Pthread_mutex_lock(&mux_lk);
+    /* The connection may have dropped since we picked it */
+    LISTC_FOR_EACH(&t->conns, c, lnk)
+    {
+        if (c == conn)
+            break;
+    }
+    if (c == NULL) {
+        Pthread_mutex_unlock(&mux_lk);
+        free(s);
+        close(sv[0]);
+        close(sv[1]);
+        return -1;
+    }
+    s->id = conn->next_id++;
+    conn->nsessions++;
+    mux_sessions_opened++;
+    listc_abl(&conn->pending, s);
+    if (write(conn->wake[1], "", 1) == -1 && errno != EAGAIN) {
+        syslog(LOG_NOTICE, "%s: wake %d %s\n", __func__, errno,
+               strerror(errno));
+    }
+    Pthread_mutex_unlock(&mux_lk);
+    return sv[1];
+}
+
+static int mux_stat_target(void *obj, void *arg)
+{
+    struct mux_target *t = obj;
+    struct mux_conn *c;
+    char ip[INET_ADDRSTRLEN];
+    inet_ntop(AF_INET, &t->addr.sin_addr, ip, sizeof(ip));
+    syslog(LOG_INFO, "%-40s %s:%d%s\n", t->typestr, ip,
+           ntohs(t->addr.sin_port), t->refused ? " (refused)" : "");
+    LISTC_FOR_EACH(&t->conns, c, lnk)
+    {
+        syslog(LOG_INFO, "    connection fd %d: %d sessions\n", c->fd,
+               c->nsessions);
+    }
+    return 0;
+}
+
+void mux_stat(void)
+{
+    Pthread_mutex_lock(&mux_lk);
+    syslog(LOG_INFO, "=== Multiplexing %s, %u sessions opened ===\n",
+           MUX_ENABLED ? "on" : "off", mux_sessions_opened);
+    hash_for(mux_targets, mux_stat_target, NULL);
+    syslog(LOG_INFO, "=== Done ===\n");
+    Pthread_mutex_unlock(&mux_lk);
+}
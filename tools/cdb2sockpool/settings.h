@@ -44,3 +44,17 @@ BOOL_SETTING(EXIT_ON_PIPE_ERROR, 1,
              "exit and turn off paul bit if our pipe is deleted")
 
 BOOL_SETTING(UTIME_ON_PIPE, 1, "periodically update last access time on pipe")
+
+BOOL_SETTING(MUX_ENABLED, 0,
+             "serve requests with sessions on shared database connections")
+
+VALUE_SETTING(MUX_CONNS_PER_DB, 2, "shared connections per database")
+
+BYTES_SETTING(MUX_SESSION_BUF, 1024 * 1024,
+              "bytes buffered for a session before reading less")
+
+MSECS_SETTING(MUX_CONNECT_TIMEOUT, 1000,
+              "timeout connecting a shared connection")
+
+SECS_SETTING(MUX_RETRY_SECS, 60,
+             "wait before retrying a database which did not multiplex")
@@ -0,0 +1,206 @@
+/*
+   Copyright 2026 Bloomberg Finance L.P.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+ */
+
+#include "chunk.h"
+
+#include <cstring>
+#include <sstream>
+
+#include <arpa/inet.h>
+#include <lz4.h>
+#include <crc32c.h>
+
+#if LZ4_VERSION_NUMBER < 10701
+#define LZ4_compress_default LZ4_compress_limitedOutput
+#endif
+
+static const char chunk_magic[8] = {'c', 'd', 'b', '2', 'c', 'h', 'n', 'k'};
+
+static void put32(uint8_t *p, uint32_t v)
+{
+    v = htonl(v);
+    memcpy(p, &v, 4);
+}
+
+static uint32_t get32(const uint8_t *p)
+{
+    uint32_t v;
+    memcpy(&v, p, 4);
+    return ntohl(v);
+}
+
+void write_chunk_header(const ChunkHeader& ch, uint8_t *buf)
+{
+    memcpy(buf, chunk_magic, sizeof(chunk_magic));
+    put32(buf + 8, (uint32_t)(ch.offset >> 32));
+    put32(buf + 12, (uint32_t)ch.offset);
+    put32(buf + 16, ch.rawlen);
+    put32(buf + 20, ch.datalen);
+    put32(buf + 24, ch.crc);
+    put32(buf + 28, ch.flags);
+    put32(buf + 32, (uint32_t)(ch.filesize >> 32));
+    put32(buf + 36, (uint32_t)ch.filesize);
+}
+
+bool read_chunk_header(const uint8_t *buf, ChunkHeader& ch)
+{
+    if(memcmp(buf, chunk_magic, sizeof(chunk_magic)) != 0) {
+        return false;
+    }
+    ch.offset = ((uint64_t)get32(buf + 8) << 32) | get32(buf + 12);
+    ch.rawlen = get32(buf + 16);
+    ch.datalen = get32(buf + 20);
+    ch.crc = get32(buf + 24);
+    ch.flags = get32(buf + 28);
+    ch.filesize = ((uint64_t)get32(buf + 32) << 32) | get32(buf + 36);
+    if(!(ch.flags & CHUNK_COMPRESSED) && ch.datalen != ch.rawlen) {
+        return false;
+    }
+    return true;
+}
+
+std::string chunk_member_name(const std::string& filename, unsigned index)
+{
+    std::ostringstream ss;
+    ss << filename << '.' << index << CHUNK_SUFFIX;
+    return ss.str();
+}
+
+bool is_chunk_member(const std::string& name, std::string& filename)
+{
+    size_t len = sizeof(CHUNK_SUFFIX) - 1;
+    if(name.length() <= len ||
+            name.compare(name.length() - len, len, CHUNK_SUFFIX) != 0) {
+        return false;
+    }
+    // strip the chunk index
+    size_t end = name.length() - len;
+    size_t dot = name.find_last_of('.', end - 1);
+    if(dot == std::string::npos || dot == 0 || dot + 1 == end ||
+            name.find_first_not_of("0123456789", dot + 1) != end) {
+        return false;
+    }
+    filename = name.substr(0, dot);
+    return true;
+}
+
+size_t chunk_bound(size_t rawlen)
+{
+    size_t bound = LZ4_compressBound(rawlen);
+    return bound > rawlen ? bound : rawlen;
+}
+
+void pack_chunk(const uint8_t *raw, size_t rawlen, uint8_t *out,
+                ChunkHeader& ch)
+{
+    ch.rawlen = rawlen;
+    ch.crc = crc32c(raw, rawlen);
+    ch.flags &= ~CHUNK_COMPRESSED;
+
+    int rc = 0;
+    if(rawlen > 0) {
+        rc = LZ4_compress_default((const char *)raw, (char *)out, rawlen,
+                                  LZ4_compressBound(rawlen));
+    }
+    if(rc > 0 && (size_t)rc < rawlen) {
+        ch.datalen = rc;
+        ch.flags |= CHUNK_COMPRESSED;
+    } else {
+        // Doesn't compress: store it as it is
+        memcpy(out, raw, rawlen);
+        ch.datalen = rawlen;
+    }
+}
+
+bool unpack_chunk(const uint8_t *data, const ChunkHeader& ch, uint8_t *raw)
+{
+    if(ch.flags & CHUNK_COMPRESSED) {
+        int rc = LZ4_decompress_safe((const char *)data, (char *)raw,
+                                     ch.datalen, ch.rawlen);
+        if(rc < 0 || (uint32_t)rc != ch.rawlen) {
+            return false;
+        }
+    } else {
+        memcpy(raw, data, ch.rawlen);
+    }
+    return crc32c(raw, ch.rawlen) == ch.crc;
+}
+
+WorkPool::WorkPool(unsigned nthreads) : m_pending(0), m_stop(false)
+{
+    if(nthreads == 0) {
+        nthreads = 1;
+    }
+    for(unsigned ii = 0; ii < nthreads; ii++) {
+        m_threads.emplace_back(&WorkPool::run, this);
+    }
+}
+
+WorkPool::~WorkPool()
+{
+    {
+        std::lock_guard<std::mutex> l(m_lk);
+        m_stop = true;
+    }
+    m_work_cv.notify_all();
+    for(auto& t : m_threads) {
+        t.join();
+    }
+}
+
+void WorkPool::run()
+{
+    while(true) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> l(m_lk);
+            m_work_cv.wait(l, [this] { return m_stop || !m_tasks.empty(); });
+            if(m_tasks.empty()) {
+                return;
+            }
+            task = std::move(m_tasks.front());
+            m_tasks.pop_front();
+        }
+        task();
+        {
+            std::lock_guard<std::mutex> l(m_lk);
+            m_pending--;
+        }
+        m_done_cv.notify_all();
+    }
+}
+
+void WorkPool::submit(std::function<void()> task)
+{
+    {
+        std::lock_guard<std::mutex> l(m_lk);
+        m_tasks.push_back(std::move(task));
+        m_pending++;
+    }
+    m_work_cv.notify_one();
+}
+
+void WorkPool::throttle(size_t max_pending)
+{
+    std::unique_lock<std::mutex> l(m_lk);
+    m_done_cv.wait(l, [this, max_pending] { return m_pending < max_pending; });
+}
+
+void WorkPool::wait_until(const std::function<bool()>& pred)
+{
+    std::unique_lock<std::mutex> l(m_lk);
+    m_done_cv.wait(l, pred);
+}
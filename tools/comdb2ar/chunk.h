@@ -0,0 +1,116 @@
+/*
+   Copyright 2026 Bloomberg Finance L.P.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+ */
+
+#ifndef INCLUDED_CHUNK
+#define INCLUDED_CHUNK
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Chunked archive members.
+//
+// With comdb2ar c -z, data and log files are cut into chunks which are read,
+// verified, compressed and checksummed on several threads.  Each chunk is a
+// tar member of its own, named after its file, its index in the file and
+// CHUNK_SUFFIX ("file.3.chunk"), holding a chunk header followed by the chunk
+// data, LZ4 compressed unless that does not make it smaller.  The archive is
+// a valid tar with no duplicate members, but only comdb2ar puts the files
+// back together.  The chunks of a file follow each other in the
+// archive, in order, and the last one is flagged CHUNK_LAST so that empty
+// files still have one.  Chunks say where they go in their file, so a
+// restore can write them on several threads too.
+
+const char CHUNK_SUFFIX[] = ".chunk";
+
+const size_t CHUNK_HEADER_SIZE = 40;
+
+enum {
+    CHUNK_COMPRESSED = 1,
+    CHUNK_LAST = 2
+};
+
+struct ChunkHeader {
+    uint64_t offset;  // where the chunk goes in its file
+    uint64_t filesize; // size of the whole file
+    uint32_t rawlen;  // length of the chunk
+    uint32_t datalen; // length of the data which follows the header
+    uint32_t crc;     // crc32c of the chunk
+    uint32_t flags;
+};
+
+void write_chunk_header(const ChunkHeader& ch, uint8_t *buf);
+// Pack a chunk header into CHUNK_HEADER_SIZE bytes, in network byte order
+
+bool read_chunk_header(const uint8_t *buf, ChunkHeader& ch);
+// Unpack a chunk header.  Returns false if buf doesn't hold one.
+
+std::string chunk_member_name(const std::string& filename, unsigned index);
+// Name of the chunk member for chunk number index of filename
+
+bool is_chunk_member(const std::string& name, std::string& filename);
+// Returns true if name is the name of a chunk member, and sets filename to
+// the name of the file it belongs to.
+
+size_t chunk_bound(size_t rawlen);
+// Size of a buffer large enough for the data of a chunk of rawlen bytes
+
+void pack_chunk(const uint8_t *raw, size_t rawlen, uint8_t *out,
+                ChunkHeader& ch);
+// Checksum and compress a chunk into out, which must hold chunk_bound(rawlen)
+// bytes.  Sets the rawlen, datalen, crc and compressed flag of ch.
+
+bool unpack_chunk(const uint8_t *data, const ChunkHeader& ch, uint8_t *raw);
+// Decompress the data of a chunk into raw, which must hold ch.rawlen bytes,
+// and verify its checksum.  Returns false if the chunk is corrupt.
+
+class WorkPool {
+// A fixed set of threads running tasks in the order they are submitted.
+// Tasks must not throw.
+
+    std::mutex m_lk;
+    std::condition_variable m_work_cv;
+    std::condition_variable m_done_cv;
+    std::deque<std::function<void()> > m_tasks;
+    size_t m_pending;
+    bool m_stop;
+    std::vector<std::thread> m_threads;
+
+    void run();
+
+public:
+    WorkPool(unsigned nthreads);
+    ~WorkPool();
+
+    void submit(std::function<void()> task);
+
+    void throttle(size_t max_pending);
+    // Wait until fewer than max_pending tasks are queued or running
+
+    void wait_until(const std::function<bool()>& pred);
+    // Wait until pred() is true.  pred is checked whenever a task completes.
+
+    unsigned size() const { return m_threads.size(); }
+};
+
+#endif // INCLUDED_CHUNK
@@ -37,6 +37,7 @@ const char *help_text[] = {
 "  Database mydb is serialised into tape archive format on to stdout.",
 "  -s   serialise support files only (lrl, csc2 etc, no data or log files)",
 "  -L   do not disable log file deletion (dangerous)",
+"  -z   archive data and log files as compressed, checksummed chunks",
 "",
 "To deserialise a db: comdb2ar.tsk [opts] x [/bb/bin /bb/data/mydb] < input",
 "To deserialise a db incrementally:",
@@ -62,6 +63,9 @@ const char *help_text[] = {
 "  -D           turn off directio",
 "  -E dbname    create replicant with dbname",
 "  -T type      override physrep type",
+"",
+"  -j <n>       threads reading and compressing (c -z) or writing (x)",
+"               chunks (default 4)",
 NULL
 };
 
@@ -113,6 +117,8 @@ int main(int argc, char *argv[])
     bool incr_path_specified = false;
     bool dryrun = false;
     bool copy_physical = false;
+    bool compress = false;
+    unsigned nthreads = 4;
 
     std::string new_db_name = "";
     std::string new_type = "default";
@@ -129,7 +135,7 @@ int main(int argc, char *argv[])
     ss << root << "/bin/comdb2";
     std::string comdb2_task(ss.str());
 
-    while((c = getopt(argc, argv, "hsSLC:I:b:x:u:rRSkKfODE:T:A")) != EOF) {
+    while((c = getopt(argc, argv, "hsSLC:I:b:x:u:rRSkKfODE:T:Azj:")) != EOF) {
         switch(c) {
             case 'O':
                 legacy_mode = true;
@@ -237,6 +243,19 @@ int main(int argc, char *argv[])
                 new_type = std::string(optarg);
                 break;
 
+            case 'z':
+                compress = true;
+                break;
+
+            case 'j':
+                nthreads = std::atoi(optarg);
+                if(nthreads == 0) {
+                    std::cerr << "Bad parameter to -j: " << optarg
+                        << std::endl;
+                    std::exit(2);
+                }
+                break;
+
             case '?':
                 std::cerr << "Unrecognised option: -" << (char)c << std::endl;
                 usage();
@@ -258,6 +277,11 @@ int main(int argc, char *argv[])
         std::exit(2);
     }
 
+    if(compress && (incr_gen || incr_create)){
+        std::cerr << "Incremental backups cannot be compressed" << std::endl;
+        std::exit(2);
+    }
+
     for(const char *cp = argv[0]; *cp; ++cp) {
         switch(*cp) {
             case 'c':
@@ -315,7 +339,8 @@ int main(int argc, char *argv[])
                 incr_gen,
                 copy_physical,
                 add_latency,
-                incr_path
+                incr_path,
+                compress ? nthreads : 0
             );
         } catch(std::exception& e) {
             std::cerr << e.what() << std::endl;
@@ -357,7 +382,8 @@ int main(int argc, char *argv[])
              is_disk_full,
              run_with_done_file,
              incr_ex,
-             dryrun
+             dryrun,
+             nthreads
            );
         } catch(std::exception& e) {
             std::cerr << e.what() << std::endl;
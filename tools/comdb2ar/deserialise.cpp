@@ -1,6 +1,7 @@
 #include <cstring>
 
 #include "comdb2ar.h"
+#include "chunk.h"
 #include "error.h"
 #include "file_info.h"
 #include "fdostream.h"
@@ -12,8 +13,10 @@
 #include "ar_wrap.h"
 #include "cdb2_constants.h"
 
+#include <atomic>
 #include <cstdlib>
 #include <map>
+#include <mutex>
 #include <set>
 #include <string>
 #include <sstream>
@@ -365,6 +368,164 @@ static bool check_dest_dir(const std::string& dir)
 
 #define write_size (1000*1024)
 
+static void check_disk_space(const std::string& datadestdir,
+        const std::string& filename, unsigned long long bytes,
+        unsigned percent_full, bool& is_disk_full)
+// Throw if writing bytes more of filename would fill the file system past
+// percent_full
+{
+    struct statvfs stfs;
+    int rc = statvfs(datadestdir.c_str(), &stfs);
+    if(rc == -1) {
+        std::ostringstream ss;
+        ss << "Error running statvfs on " << datadestdir
+            << ": " << strerror(errno);
+        throw Error(ss);
+    }
+
+    fsblkcnt_t fsblocks = bytes / stfs.f_bsize;
+    double percent_free = 100.00 * ((double)(stfs.f_bavail - fsblocks) / (double)stfs.f_blocks);
+    if(100.00 - percent_free >= percent_full) {
+        is_disk_full = true;
+        std::ostringstream ss;
+        ss << "Not enough space to deserialise " << filename
+            << " (" << bytes << " bytes) - would leave only "
+            << percent_free << "% free space";
+        throw Error(ss);
+    }
+}
+
+struct ChunkedFile {
+// A file being restored from chunk members
+
+    std::string filename;
+    std::string outfilename;
+    std::unique_ptr<fdostream> out;
+    size_t pagesize;
+    bool sparse;
+    uid_t uid;
+    gid_t gid;
+    mode_t modes;
+
+    int nchunks;
+    bool last_seen;
+    unsigned long long size;
+
+    // Chunks handed to the pool and not written yet
+    std::atomic<unsigned> pending;
+    std::mutex lk;
+    std::string error;
+
+    ChunkedFile() : pagesize(0), sparse(false), nchunks(0), last_seen(false),
+                    size(0), pending(0) {}
+};
+
+static std::string write_chunk(int fd, const uint8_t *raw, size_t len,
+                               unsigned long long offset)
+{
+    size_t n = 0;
+    while(n < len) {
+        ssize_t nwritten = pwrite(fd, raw + n, len - n, offset + n);
+        if(nwritten <= 0) {
+            std::ostringstream ss;
+            ss << "error writing at offset " << offset + n << ": "
+                << strerror(errno);
+            return ss.str();
+        }
+        n += nwritten;
+    }
+    return "";
+}
+
+static void restore_chunk(ChunkedFile& f, const std::vector<uint8_t>& data,
+                          const ChunkHeader& ch)
+// Unpack a chunk and write it where it goes.  This runs on the restore pool.
+{
+    std::string error;
+    uint8_t *raw;
+
+    if(posix_memalign((void**) &raw, 512, std::max((size_t)ch.rawlen, (size_t)512))) {
+        error = "failed to allocate chunk buffer";
+    } else if(!unpack_chunk(&data[CHUNK_HEADER_SIZE], ch, raw)) {
+        std::ostringstream ss;
+        ss << "chunk at offset " << ch.offset << " failed checksum verification";
+        error = ss.str();
+    } else if(!f.sparse) {
+        error = write_chunk(f.out->getfd(), raw, ch.rawlen, ch.offset);
+    } else {
+        // Leave holes for the empty pages; the file is sized at the end
+        size_t run = 0, off;
+        for(off = 0; off + f.pagesize <= ch.rawlen && error.empty(); off += f.pagesize) {
+            bool empty = true;
+            for(size_t ii = 0; ii < f.pagesize && empty; ii++) {
+                empty = (raw[off + ii] == 0);
+            }
+            if(empty) {
+                if(off > run) {
+                    error = write_chunk(f.out->getfd(), raw + run, off - run,
+                                        ch.offset + run);
+                }
+                run = off + f.pagesize;
+            }
+        }
+        if(error.empty() && ch.rawlen > run) {
+            error = write_chunk(f.out->getfd(), raw + run, ch.rawlen - run,
+                                ch.offset + run);
+        }
+    }
+    free(raw);
+
+    if(!error.empty()) {
+        std::lock_guard<std::mutex> l(f.lk);
+        if(f.error.empty()) {
+            f.error = error;
+        }
+    }
+}
+
+static void finish_chunked_file(WorkPool& pool, ChunkedFile& f,
+                                bool force_mode)
+// Wait for the chunks of a file to be written, then size it and restore its
+// permissions
+{
+    pool.wait_until([&f] { return f.pending == 0; });
+
+    std::clog << "x " << f.filename << " size=" << f.size
+              << " pagesize=" << f.pagesize << " chunks=" << f.nchunks;
+    if (f.sparse)
+        std::clog << " SPARSE ";
+    else
+        std::clog << " not sparse ";
+    std::clog << std::endl;
+
+    if(!f.last_seen) {
+        std::lock_guard<std::mutex> l(f.lk);
+        if(f.error.empty()) {
+            f.error = "archive ends before its last chunk";
+        }
+    }
+    if(!f.error.empty()) {
+        std::ostringstream ss;
+        ss << "Error restoring " << f.filename << ": " << f.error;
+        if(!force_mode) {
+            throw Error(ss);
+        }
+        std::cerr << ss.str() << std::endl;
+    }
+
+    if(f.last_seen && ftruncate(f.out->getfd(), f.size) == -1) {
+        std::ostringstream ss;
+        ss << "Error sizing " << f.outfilename << ": " << strerror(errno);
+        throw Error(ss);
+    }
+    f.out.reset();
+
+    if (chown(f.outfilename.c_str(), f.uid, f.gid)==-1)
+        perror(f.outfilename.c_str());
+    if (chmod(f.outfilename.c_str(), f.modes)==-1)
+        perror(f.outfilename.c_str());
+}
+
 void deserialise_database(
         const std::string *p_lrldestdir,
         const std::string *p_datadestdir,
@@ -379,7 +540,8 @@ void deserialise_database(
         bool& is_disk_full,
         bool run_with_done_file,
         bool incr_mode,
-        bool dryrun
+        bool dryrun,
+        unsigned restore_threads
 )
 // Deserialise a database from serialised from received on stdin.
 // If lrldestdir and datadestdir are not NULL then the lrl and data files
@@ -445,6 +607,11 @@ void deserialise_database(
     // The manifest map
     std::map<std::string, FileInfo> manifest_map;
 
+    // Chunk members are written out on restore_pool, and chunked_file is
+    // the file they are for
+    std::unique_ptr<WorkPool> restore_pool;
+    std::shared_ptr<ChunkedFile> chunked_file;
+
     if (run_with_done_file)
     {
        /* remove the DONE file before we start copying */
@@ -521,6 +688,10 @@ void deserialise_database(
         // Alternativelyh, if we're running in incremental mode, then
         // we know we are moving on the the incremental backups
         if(std::memcmp(head.c, zero_head, 512) == 0) {
+            if(chunked_file) {
+                finish_chunked_file(*restore_pool, *chunked_file, force_mode);
+                chunked_file.reset();
+            }
             if(incr_mode){
                 std::clog << "Done with base backup, moving on to increments"
                           << std::endl << std::endl;
@@ -547,7 +718,14 @@ void deserialise_database(
         if(head.h.filename[sizeof(head.h.filename) - 1] != '\0') {
             throw Error("Bad block: filename is not null terminated");
         }
-        const std::string filename(head.h.filename);
+        std::string filename(head.h.filename);
+
+        // Chunks are named after their file
+        bool is_chunk = is_chunk_member(head.h.filename, filename);
+        if(chunked_file && (!is_chunk || filename != chunked_file->filename)) {
+            finish_chunked_file(*restore_pool, *chunked_file, force_mode);
+            chunked_file.reset();
+        }
 
         // Try to find this file in our manifest
         std::map<std::string, FileInfo>::const_iterator manifest_it = manifest_map.find(filename);
@@ -559,6 +737,86 @@ void deserialise_database(
         }
         unsigned long long nblocks = (filesize + 511ULL) >> 9;
 
+        if(is_chunk) {
+            if(datadestdir.empty()) {
+                throw Error("Stream contains files for data directory before data dir is known");
+            }
+
+            std::shared_ptr<std::vector<uint8_t> > data(
+                    new std::vector<uint8_t>(nblocks << 9));
+            if(filesize < CHUNK_HEADER_SIZE ||
+               readall(0, data->data(), data->size()) != data->size()) {
+                std::ostringstream ss;
+                ss << "Error reading chunk of " << filename << ": "
+                    << errno << " " << strerror(errno);
+                throw Error(ss);
+            }
+            ChunkHeader ch;
+            if(!read_chunk_header(data->data(), ch) ||
+               CHUNK_HEADER_SIZE + ch.datalen != filesize) {
+                throw Error("Bad chunk header for " + filename);
+            }
+
+            if(!chunked_file) {
+                check_disk_space(datadestdir, filename, ch.filesize,
+                                 percent_full, is_disk_full);
+
+                if(filename.find_first_of('/') == std::string::npos) {
+                    uint8_t is_data_file = 0;
+                    uint8_t is_queue_file = 0;
+                    uint8_t is_queuedb_file = 0;
+                    char *table_name = (char *)alloca(MAXTABLELEN);
+
+                    if(recognize_data_file(filename.c_str(), &is_data_file,
+                                           &is_queue_file, &is_queuedb_file,
+                                           &table_name)) {
+                        if(table_set.insert(table_name).second) {
+                            std::clog << "Discovered table " << table_name
+                                << " from data file " << filename << std::endl;
+                        }
+                    }
+                }
+
+                chunked_file.reset(new ChunkedFile());
+                chunked_file->filename = filename;
+                chunked_file->outfilename = datadestdir + "/" + filename;
+                if(manifest_it != manifest_map.end()) {
+                    chunked_file->pagesize = manifest_it->second.get_pagesize();
+                    chunked_file->sparse = manifest_it->second.get_sparse();
+                }
+                if(chunked_file->pagesize == 0) {
+                    chunked_file->pagesize = 4096;
+                }
+                chunked_file->uid = (uid_t)strtol(head.h.uid, NULL, 8);
+                chunked_file->gid = (gid_t)strtol(head.h.gid, NULL, 8);
+                chunked_file->modes = (mode_t)strtol(head.h.mode, NULL, 8);
+                // Chunks are written at their offsets, which O_DIRECT
+                // doesn't allow for the last one of a log file
+                chunked_file->out = output_file(chunked_file->outfilename, false, false);
+                extracted_files.insert(chunked_file->outfilename);
+
+                if(!restore_pool) {
+                    restore_pool.reset(new WorkPool(restore_threads));
+                }
+            }
+
+            if(ch.flags & CHUNK_LAST) {
+                chunked_file->last_seen = true;
+                chunked_file->size = ch.offset + ch.rawlen;
+            }
+            chunked_file->nchunks++;
+
+            // Don't read too far ahead of the writers
+            restore_pool->throttle(2 * restore_pool->size());
+            chunked_file->pending++;
+            std::shared_ptr<ChunkedFile> f(chunked_file);
+            restore_pool->submit([f, data, ch] {
+                restore_chunk(*f, *data, ch);
+                f->pending--;
+            });
+            continue;
+        }
+
 
         // If this is an .lrl file then we have to read it into memory and
         // then rewrite it to disk.  In getting the extension it is important
@@ -43,6 +43,7 @@ class fdostream : public std::ostream {
 public:
     fdostream(int fd);
     int skip(unsigned long long size);
+    int getfd() { return buf.getfd(); }
 };
 
 #endif // INCLUDED_FDOSTREAM
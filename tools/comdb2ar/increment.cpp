@@ -15,12 +15,14 @@
 #include <iostream>
 #include <cassert>
 
+#include <algorithm>
 #include <vector>
 #include <set>
 #include <map>
 #include <utility>
 #include <fcntl.h>
 #include <unistd.h>
+#include <arpa/inet.h>
 
 bool is_not_incr_file(std::string filename){
     return((filename.substr(filename.length() - 5) != ".incr") &&
@@ -34,10 +36,11 @@ std::string get_sha_fingerprint(std::string filename, std::string incr_path) {
 
     char sha_buffer[40];
     ifs.read(&sha_buffer[0], 40);
+    std::string sha(sha_buffer, ifs.gcount());
 
-    std::clog << "Found previous fingerprint as " << std::string(sha_buffer) << std::endl;
+    std::clog << "Found previous fingerprint as " << sha << std::endl;
 
-    return std::string(sha_buffer);
+    return sha;
 }
 
 // Read from STDIN a serialised text file with the SHA fingerprint
@@ -98,16 +101,74 @@ bool assert_cksum_lsn(FileInfo &file, uint8_t *new_pagep, uint8_t *old_pagep, si
     return (memcmp(cmp_arr, old_pagep, 12) != 0);
 }
 
+// Read the bitmap of the pages the database wrote to a file since the last
+// increment.  A file which has no bitmap has had no pages written.
+static void read_changed_pages(
+    const std::string& changed_pages_dir,
+    const std::string& filename,
+    std::vector<uint8_t>& changed
+) {
+    size_t slash = filename.find_last_of('/');
+    std::string path = changed_pages_dir + "/" +
+        (slash == std::string::npos ? filename : filename.substr(slash + 1));
+
+    changed.clear();
+    std::ifstream ifs(path, std::ifstream::in | std::ifstream::binary);
+    if(!ifs) {
+        return;
+    }
+
+    char hdr[16];
+    uint32_t len;
+    ifs.read(hdr, sizeof(hdr));
+    memcpy(&len, hdr + 12, 4);
+    len = ntohl(len);
+    if(ifs.gcount() != sizeof(hdr) || memcmp(hdr, "cdb2chpg", 8) != 0) {
+        throw SerialiseError(filename, "bad changed pages file " + path);
+    }
+    changed.resize(len);
+    ifs.read((char *)changed.data(), len);
+    if(ifs.gcount() != len) {
+        throw SerialiseError(filename, "short changed pages file " + path);
+    }
+}
+
+// The first page from pgno which is marked in changed, or limit
+static int64_t next_changed_page(
+    const std::vector<uint8_t>& changed,
+    int64_t pgno,
+    int64_t limit
+) {
+    while(pgno < limit) {
+        size_t byte = pgno / 8;
+        if(byte >= changed.size()) {
+            return limit;
+        }
+        if(changed[byte] == 0) {
+            pgno = (byte + 1) * 8;
+            continue;
+        }
+        if(changed[byte] & (1 << (pgno % 8))) {
+            return pgno;
+        }
+        pgno++;
+    }
+    return limit;
+}
+
 // Compare the page with the diff file to determine whether it has changed - driver
 // For each file, populate pages with the page numbers fo the changed pages
 // populate data_size with the total amount of data that needs to be serialised
 // Returns true if any part of the file needs to be serialised
+// If changed_pages_dir is not empty then only the pages the database says it
+// wrote since the last increment are compared.
 bool compare_checksum(
     FileInfo &file,
     const std::string& incr_path,
     std::vector<uint32_t>& pages,
     ssize_t *data_size,
-    std::set<std::string>& incr_files
+    std::set<std::string>& incr_files,
+    const std::string& changed_pages_dir
 ) {
     std::string filename = file.get_filename();
     std::string incr_file_name = incr_path + "/" + filename + ".incr";
@@ -177,7 +238,34 @@ bool compare_checksum(
         int64_t filesize = 0;
         int64_t pgno = -1;
 
+        // Pages past the end of the diff file are compared regardless
+        std::vector<uint8_t> changed;
+        int64_t tracked_pages = 0;
+        if(!changed_pages_dir.empty()) {
+            read_changed_pages(changed_pages_dir, filename, changed);
+            tracked_pages = std::min(sb.st_size / 12, new_st.st_size / (off_t)pagesize);
+        }
+
         while(bytesleft >= pagesize) {
+            if(!changed_pages_dir.empty() && !file_expanded) {
+                // Skip the pages which weren't written since the last increment
+                int64_t next = next_changed_page(changed, pgno + 1, tracked_pages);
+                int64_t skip = next - (pgno + 1);
+                if(skip > 0) {
+                    if(lseek(new_fd, skip * pagesize, SEEK_CUR) == -1 ||
+                       lseek(old_fd, skip * 12, SEEK_CUR) == -1) {
+                        std::ostringstream ss;
+                        ss << "seek error: " << std::strerror(errno);
+                        throw SerialiseError(filename, ss.str());
+                    }
+                    pgno += skip;
+                    bytesleft -= skip * pagesize;
+                    if(bytesleft < pagesize) {
+                        break;
+                    }
+                }
+            }
+
             ssize_t new_bytesread = read(new_fd, &new_pagebuf[0], pagesize);
 
             filesize += new_bytesread;
@@ -24,10 +24,12 @@ bool compare_checksum(
     const std::string& incr_path,
     std::vector<uint32_t>& pages,
     ssize_t *data_size,
-    std::set<std::string>& incr_files
+    std::set<std::string>& incr_files,
+    const std::string& changed_pages_dir
 );
 // Compare a file's checksum and LSN with it's diff file to determine whether pages
-// have been changed
+// have been changed.  If changed_pages_dir is not empty then only the pages in
+// the database's bitmaps there are compared.
 
 void write_incr_manifest_entry(
     std::ostream& os,
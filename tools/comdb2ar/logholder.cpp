@@ -45,14 +45,23 @@ void LogHolder_impl::reset(const std::string& dbname, const std::string& request
     }
 }
 
-LogHolder::LogHolder(const std::string& dbname) : impl(new LogHolder_impl(dbname, "logdelete3\n"))
+LogHolder::LogHolder(const std::string& dbname) : impl(new LogHolder_impl(dbname, "logdelete4\n"))
 {
     
-    m_version = 3;
+    m_version = 4;
     if(impl->mp_appsock.get()
             && !impl->mp_appsock->response("log file deletion disabled\n")) {
         close();
 
+        std::clog << "Doesn't support logdelete4" << std::endl;
+
+        impl->reset(dbname, "logdelete3\n");
+        m_version = 3;
+    }
+    if(impl->mp_appsock.get() && m_version == 3
+            && !impl->mp_appsock->response("log file deletion disabled\n")) {
+        close();
+
         std::clog << "Doesn't support logdelete3" << std::endl;
 
         impl->reset(dbname, "logdelete2\n");
@@ -87,6 +96,24 @@ void LogHolder::release_log(long long logno)
     }
 }
 
+bool LogHolder::snapshot_changed_pages(const std::string& chain)
+{
+    if(impl->mp_appsock.get() && m_version >= 4) {
+        impl->mp_appsock->request("changed_pages snapshot\n");
+        std::string response = impl->mp_appsock->read_response();
+        std::clog << response << std::endl;
+        return !chain.empty() && response == "changed pages valid " + chain;
+    }
+    return false;
+}
+
+void LogHolder::ack_changed_pages(const std::string& chain)
+{
+    if(impl->mp_appsock.get() && m_version >= 4) {
+        impl->mp_appsock->request("changed_pages ack " + chain + "\n");
+    }
+}
+
 std::string LogHolder::recovery_options()
 {
     if(impl->mp_appsock.get() && m_version >= 3) {
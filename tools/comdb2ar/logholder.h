@@ -52,6 +52,17 @@ public:
 
     std::string recovery_options();
 
+    bool snapshot_changed_pages(const std::string& chain);
+    // Ask the database for the pages written since the last snapshot, which
+    // it writes to changed_pages in its data directory.  Returns true if
+    // they are all the pages written since the last acknowledged snapshot,
+    // and that was acknowledged by the increment with fingerprint chain,
+    // which is to say they are all the pages written since it.
+
+    void ack_changed_pages(const std::string& chain);
+    // Tell the database that the pages of the last snapshot are backed up,
+    // by the increment with fingerprint chain.
+
     int version() { return m_version; };
 };
 
@@ -1,6 +1,7 @@
 #include "comdb2ar.h"
 
 #include "ar_wrap.h"
+#include "chunk.h"
 #include "error.h"
 #include "file_info.h"
 #include "logholder.h"
@@ -14,8 +15,10 @@
 #include "ssl_support.h"
 #include "cdb2_constants.h"
 
+#include <atomic>
 #include <cassert>
 #include <cstring>
+#include <deque>
 #include <fstream>
 #include <iostream>
 #include <memory>
@@ -119,6 +122,195 @@ static void serialise_string(const std::string& filename,
  * that defines this properly */
 void *memalign(size_t boundary, size_t size);
 
+// Threads which read and compress the chunks of data and log files, when
+// serialising into chunks
+static std::unique_ptr<WorkPool> chunk_pool;
+
+struct SerialiseChunk {
+    ChunkHeader ch;
+    size_t len;
+    uint8_t *raw;
+    std::vector<uint8_t> data;
+    std::string error;
+    std::atomic<bool> done;
+
+    SerialiseChunk() : raw(NULL), done(false) {}
+    ~SerialiseChunk() { free(raw); }
+};
+
+static void read_chunk(int fd, const FileInfo& file, size_t pagesize,
+                       SerialiseChunk *c)
+// Read, verify and pack a chunk of a file.  This runs on the chunk pool.
+{
+    std::ostringstream ss;
+    size_t n = 0;
+    while(n < c->len) {
+        ssize_t nread = pread(fd, c->raw + n, c->len - n, c->ch.offset + n);
+        if(nread < 0) {
+            ss << "read error at offset " << c->ch.offset + n << ": "
+                << std::strerror(errno);
+            c->error = ss.str();
+            return;
+        }
+        if(nread == 0) {
+            c->error = "file shrank while being archived!";
+            return;
+        }
+        n += nread;
+    }
+
+    for(size_t pg = 0; file.get_checksums() && pg + pagesize <= c->len;
+            pg += pagesize) {
+        uint32_t verify_cksum;
+        int retry = 5;
+        while(verify_checksum(c->raw + pg, pagesize, file.get_crypto(),
+                              file.get_swapped(), &verify_cksum) != 1) {
+            // Partial page read. Read the page again to see if it passes
+            // checksum verification.
+            if(--retry == 0) {
+                ss << "page at offset " << c->ch.offset + pg
+                    << " failed checksum verification";
+                c->error = ss.str();
+                return;
+            }
+            poll(0, 0, 500);
+            for(n = 0; n < pagesize; ) {
+                ssize_t nread = pread(fd, c->raw + pg + n, pagesize - n,
+                                      c->ch.offset + pg + n);
+                if(nread <= 0) {
+                    ss << "read error at offset " << c->ch.offset + pg + n
+                        << ": " << std::strerror(errno);
+                    c->error = ss.str();
+                    return;
+                }
+                n += nread;
+            }
+        }
+    }
+
+    c->data.resize(chunk_bound(c->len));
+    pack_chunk(c->raw, c->len, c->data.data(), c->ch);
+    free(c->raw);
+    c->raw = NULL;
+}
+
+static void write_chunk_member(TarHeader& head, const SerialiseChunk& c)
+{
+    uint8_t chunk_head[CHUNK_HEADER_SIZE];
+    write_chunk_header(c.ch, chunk_head);
+
+    size_t size = CHUNK_HEADER_SIZE + c.ch.datalen;
+    head.set_size(size);
+    head.set_checksum();
+
+    if(writeall(1, head.get().c, sizeof(tar_block_header))
+            != sizeof(tar_block_header) ||
+       writeall(1, chunk_head, CHUNK_HEADER_SIZE) != CHUNK_HEADER_SIZE ||
+       writeall(1, c.data.data(), c.ch.datalen) != c.ch.datalen) {
+        std::ostringstream ss;
+        ss << "error writing chunk: " << std::strerror(errno);
+        throw Error(ss);
+    }
+
+    size_t bytesleft = size & (512 - 1);
+    if(bytesleft > 0) {
+        writepadding(512 - bytesleft);
+    }
+}
+
+static void serialise_chunks(FileInfo& file, int fd, const struct stat& st,
+                             volatile iomap *iomap)
+// Serialise an open file as chunk members, which are read and packed on the
+// chunk pool while we write out the ones before them.
+{
+    const std::string& filename = file.get_filename();
+    bool skip_iomap = false;
+    int num_waits = 0;
+
+    size_t pagesize = file.get_pagesize();
+    if(pagesize == 0) {
+        pagesize = 4096;
+    }
+    size_t bufsize = pagesize;
+    while((bufsize << 1) <= MAX_BUF_SIZE) {
+        bufsize <<= 1;
+    }
+
+    TarHeader head;
+    head.set_attrs(st);
+
+    std::deque<std::shared_ptr<SerialiseChunk> > inflight;
+    const size_t max_inflight = 2 * chunk_pool->size();
+    off_t offset = 0;
+    int nchunks = 0;
+    unsigned long long datasize = 0;
+
+    try {
+        do {
+            while (!skip_iomap && iomap != NULL && iomap->memptrickle_time) {
+                int now = time(NULL);
+                if ((now - iomap->memptrickle_time) > 5*60) {
+                    std::clog << "long memptrickle (" << now - iomap->memptrickle_time << " seconds), continuing" << std::endl;
+                    skip_iomap = true;
+                    break;
+                }
+                num_waits++;
+                poll(0, 0, 100);
+            }
+
+            std::shared_ptr<SerialiseChunk> c(new SerialiseChunk());
+            c->len = std::min((off_t)bufsize, st.st_size - offset);
+            c->ch.offset = offset;
+            c->ch.filesize = st.st_size;
+            c->ch.flags = (offset + (off_t)c->len >= st.st_size) ? CHUNK_LAST : 0;
+            if(posix_memalign((void**) &c->raw, 512, std::max(c->len, (size_t)512)))
+                throw Error("Failed to allocate chunk buffer");
+
+            chunk_pool->submit([c, fd, &file, pagesize] {
+                try {
+                    read_chunk(fd, file, pagesize, c.get());
+                } catch(std::exception& e) {
+                    c->error = e.what();
+                }
+                c->done = true;
+            });
+            inflight.push_back(c);
+            offset += c->len;
+
+            // Write out what's ready, in order, and all of it at the end
+            while(!inflight.empty() &&
+                    (inflight.size() >= max_inflight || inflight.front()->done ||
+                     offset >= st.st_size)) {
+                std::shared_ptr<SerialiseChunk> front = inflight.front();
+                chunk_pool->wait_until([&front] { return front->done.load(); });
+                if(!front->error.empty()) {
+                    throw SerialiseError(filename, front->error);
+                }
+                head.set_filename(chunk_member_name(filename, nchunks));
+                write_chunk_member(head, *front);
+                datasize += front->ch.datalen;
+                nchunks++;
+                inflight.pop_front();
+            }
+        } while(offset < st.st_size);
+    } catch(...) {
+        // The pool must be done with fd before we let it be closed
+        for(auto& c : inflight) {
+            chunk_pool->wait_until([&c] { return c->done.load(); });
+        }
+        throw;
+    }
+
+    file.set_filesize(st.st_size);
+
+    if (num_waits)
+        std::clog <<  "paused " << num_waits << " times because db is busy writing." << std::endl;
+
+    std::clog << "a " << filename << " size=" << st.st_size
+              << " pagesize=" << pagesize << " chunks=" << nchunks
+              << " packed=" << datasize << std::endl;
+}
+
 static void serialise_file(FileInfo& file, volatile iomap *iomap=NULL, const std::string altpath="",
                             const std::string incr_path="", bool incr_create = false)
 // Serialise a single file, in tape archive format, onto stdout.  The input
@@ -192,6 +384,13 @@ reopen:
         throw SerialiseError(filename, "not a regular file");
     }
 
+    if(chunk_pool && altpath.empty() && !incr_create &&
+       (file.get_type() == FileInfo::BERKDB_FILE ||
+        file.get_type() == FileInfo::LOG_FILE)) {
+        serialise_chunks(file, fd, st, iomap);
+        return;
+    }
+
     // Write the header
     TarHeader head;
     head.set_filename(filename);
@@ -761,13 +960,16 @@ void serialise_database(
   bool incr_gen,
   bool copy_physical,
   bool add_latency,
-  const std::string& incr_path
+  const std::string& incr_path,
+  unsigned compress_threads
 )
 // Serialise a database into tape archive format and write it to stdout.
 // If support_only is true then only support files (lrl and schema) will
 // be serialised.  If disable_log_deletion and the database is running then
 // it will be advised to hold log file deletion until the backup is complete
 // (highly recommended!)
+// If compress_threads is not 0 then data and log files are serialised as
+// compressed chunks, using that many threads.
 {
     std::string dbname;
     std::string dbdir;
@@ -824,6 +1026,10 @@ void serialise_database(
         templrlpath = lrlpath;
     }
 
+    if (compress_threads) {
+        chunk_pool.reset(new WorkPool(compress_threads));
+    }
+
     // Create the directory for incremental backups if needed
     if (incr_create) {
         struct stat sb;
@@ -984,6 +1190,24 @@ void serialise_database(
         log_holder = std::unique_ptr<LogHolder>(new LogHolder(dbname));
     }
 
+    // An increment only needs to look at the pages the database wrote since
+    // the last one, if it is tracking them and the last snapshot it
+    // acknowledged came from this chain of increments.  Starting a chain of
+    // increments starts a new interval too.
+    std::string changed_pages_dir;
+    if((incr_create || incr_gen) && log_holder.get()) {
+        std::string chain;
+        if(incr_gen) {
+            chain = get_sha_fingerprint("fingerprint.sha", incr_path);
+        }
+        if(log_holder->snapshot_changed_pages(chain) && incr_gen) {
+            changed_pages_dir = dbdir + "/changed_pages";
+        } else if(incr_gen) {
+            std::clog << "Changed pages aren't from this chain of "
+                      << "increments, comparing every page" << std::endl;
+        }
+    }
+
 
     // Based on what we read from the lrl, it's time to create the definitive
     // set of files to back up.  For data files we record the file names and
@@ -1220,7 +1444,8 @@ void serialise_database(
             ssize_t data_size = 0;
 
             // Diff the page checksums for each file to find what has been changed
-            if(compare_checksum(*it, incr_path, pages_list, &data_size, incr_files)) {
+            if(compare_checksum(*it, incr_path, pages_list, &data_size, incr_files,
+                                changed_pages_dir)) {
                 // If pages list is empty but compare_checksum returned true, it's a new file
                 if(pages_list.empty()){
                     new_files.push_back(*it);
@@ -1485,8 +1710,9 @@ void serialise_database(
     }
 
     // Generate fingerprint SHA file
+    std::string sha;
     if(incr_create || incr_gen){
-        std::string sha = generate_fingerprint();
+        sha = generate_fingerprint();
 
         std::clog << "Calculated SHA fingerprint as: " << sha << std::endl;
 
@@ -1502,10 +1728,15 @@ void serialise_database(
 
     // Release the database for log file deletion.
     if(log_holder.get()) {
+        if(incr_create || incr_gen) {
+            log_holder->ack_changed_pages(sha);
+        }
         log_holder->close();
     }
 
 
+    chunk_pool.reset();
+
     // Complete the archive with two blank 512 byte blocks
     writepadding(2 * 512);
 
@@ -51,21 +51,7 @@ void TarHeader::set_attrs(const struct stat& st)
     snprintf(m_head.h.gid,   sizeof(m_head.h.gid),   "%07o",    st.st_gid);
     snprintf(m_head.h.mtime, sizeof(m_head.h.mtime), "%011llo",   (long long) st.st_mtime);
 
-    // If the size will fit within 11 octal digits then encode it that way
-    // (as per classic tar file format).  Otherwise we adopt the gnu extension
-    // for encoding larger +ve numbers.  First digit will be \200 (128) followed
-    // by base 256 encoded number.
-    if(st.st_size < MAX_OCTAL_SIZE) {
-        snprintf(m_head.h.size,  sizeof(m_head.h.size),  "%011llo", (long long) st.st_size);
-    } else {
-        unsigned long long sz = st.st_size;
-        m_head.h.size[0] = '\200';
-        for(int ii = sizeof(m_head.h.size) - 1; ii > 0; ii--) {
-            m_head.h.size[ii] = (char)(sz & 0xff);
-            sz >>= 8;
-        }
-        m_used_gnu = true;
-    }
+    set_size(st.st_size);
 
     struct passwd *pwd = getpwuid(st.st_uid);
     if(pwd == NULL) {
@@ -81,6 +67,26 @@ void TarHeader::set_attrs(const struct stat& st)
     }
 }
 
+void TarHeader::set_size(unsigned long long size)
+// Set the size field
+{
+    // If the size will fit within 11 octal digits then encode it that way
+    // (as per classic tar file format).  Otherwise we adopt the gnu extension
+    // for encoding larger +ve numbers.  First digit will be \200 (128) followed
+    // by base 256 encoded number.
+    if(size < (unsigned long long)MAX_OCTAL_SIZE) {
+        snprintf(m_head.h.size,  sizeof(m_head.h.size),  "%011llo", size);
+    } else {
+        unsigned long long sz = size;
+        m_head.h.size[0] = '\200';
+        for(int ii = sizeof(m_head.h.size) - 1; ii > 0; ii--) {
+            m_head.h.size[ii] = (char)(sz & 0xff);
+            sz >>= 8;
+        }
+        m_used_gnu = true;
+    }
+}
+
 void TarHeader::set_checksum()
 // Calculate and store checksum. The method is:
 //  Set the 8 checksum bytes to spaces
@@ -74,6 +74,9 @@ public:
     void set_attrs(const struct stat& st);
     // Set the attributes based on the information in the stat struct
 
+    void set_size(unsigned long long size);
+    // Set the size field only
+
     void set_checksum();
     // Calculate and store the checksum field
 
@@ -226,3 +226,29 @@ uint64_t logrecord_timestamp_matchable(char *data)
 
     return (uint64_t)-1;
 }
+
+uint32_t logrecord_generation(char *data)
+{
+    uint32_t rectype = 0;
+    if (data)
+        LOGCOPY_32(&rectype, data);
+    if (IS_UTXNID(rectype))
+        rectype -= 2000;
+
+    if (rectype == DB___txn_regop_gen || rectype == DB___txn_regop_gen_endianize)
+        return logrecord_generation_regop_gen(data);
+
+    if (rectype == DB___txn_dist_commit)
+        return logrecord_generation_dist_commit(data);
+
+    if (rectype == DB___txn_dist_abort)
+        return logrecord_generation_dist_abort(data);
+
+    if (rectype == DB___txn_regop_rowlocks || rectype == DB___txn_regop_rowlocks_endianize)
+        return logrecord_generation_regop_rowlocks(data);
+
+    if (rectype == DB___txn_ckp || rectype == DB___txn_ckp_recovery)
+        return logrecord_generation_ckp(data);
+
+    return 0;
+}
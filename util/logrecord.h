@@ -49,4 +49,10 @@ uint32_t logrecord_generation_ckp(char *data);
  */
 uint64_t logrecord_timestamp_matchable(char *data);
 
+/*
+ * Returns the generation of a commit/checkpoint record, 0 for any other
+ * record type.
+ */
+uint32_t logrecord_generation(char *data);
+
 #endif /* INCLUDED_LOGRECORD_H */
@@ -100,7 +100,7 @@ hash_t *hash_init_ptr(void)
 
 typedef void *hash_kfnd_t(hash_t *const h, const void *const restrict vkey);
 
-enum hash_scheme { HASH_BY_PRIMES, HASH_BY_POWER2 };
+enum hash_scheme { HASH_BY_PRIMES, HASH_BY_POWER2, HASH_OPEN };
 
 typedef struct hashent {
     struct hashent *next;
@@ -152,6 +152,12 @@ struct hash {
     hashmalloc_t *malloc_fn;
     hashfree_t *free_fn;
     enum hash_scheme scheme;
+    /* HASH_OPEN only */
+    unsigned char **slots;     /* objects */
+    unsigned int *hashes;      /* their hashes, for rehashing */
+    unsigned char *ctrl;       /* control bytes, after the hashes */
+    unsigned int ncap;         /* number of slots */
+    unsigned int growth_left;  /* adds before a rehash */
 };
 
 
@@ -1043,6 +1049,265 @@ static unsigned int hash_default_i4(const unsigned int *a,
     return a[0];
 }
 
+/*
+ * Open addressing (hash_set_open_addressing()).
+ *
+ * Objects are kept in one flat array of slots, in groups of OA_GROUP, with no
+ * allocation per object (their hashes are kept aside for rehashing).  Each slot has a control byte: OA_EMPTY, OA_DELETED
+ * or 7 bits of the object's hash.  A lookup picks a group with the other hash
+ * bits and compares the key only for slots of the group whose control byte
+ * matches, testing all bytes of the group at once (SSE2 when available).  It
+ * moves on to the next group of the probe sequence only if the group has no
+ * empty slot, which is why a deleted object leaves an OA_DELETED tombstone
+ * behind unless its group has an empty slot.  The table is doubled, or
+ * rehashed in place to drop tombstones, when 7/8 of its slots are used.
+ *
+ * Deletion never moves objects, so hash_for() callbacks may delete.
+ */
+#define OA_GROUP 16
+#define OA_EMPTY ((unsigned char)0x80)
+#define OA_DELETED ((unsigned char)0xfe)
+#define OA_ISFULL(c) (((c) & 0x80) == 0)
+#define OA_H2(hh) ((unsigned char)((hh) & 0x7f))
+#define OA_MAX_CAP (1U << 31)
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/* Point empty open addressing tables here. */
+static const unsigned char oa_empty_group[OA_GROUP] = {
+    OA_EMPTY, OA_EMPTY, OA_EMPTY, OA_EMPTY, OA_EMPTY, OA_EMPTY,
+    OA_EMPTY, OA_EMPTY, OA_EMPTY, OA_EMPTY, OA_EMPTY, OA_EMPTY,
+    OA_EMPTY, OA_EMPTY, OA_EMPTY, OA_EMPTY};
+
+/* The hash functions above are not meant to spread bits, eg. hash_init_i4()
+ * hashes an integer to itself.  Mix them so that both the group and the
+ * control byte are taken from well distributed bits. */
+static inline uint64_t oa_mix(unsigned int hh)
+{
+    uint64_t h = hh;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 32;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 29;
+    return h;
+}
+
+/* bit i set if control byte i of the group is `c' */
+static inline unsigned int oa_match(const unsigned char *ctrl, unsigned char c)
+{
+#if defined(__SSE2__)
+    const __m128i g = _mm_loadu_si128((const __m128i *)ctrl);
+    return (unsigned int)_mm_movemask_epi8(
+        _mm_cmpeq_epi8(g, _mm_set1_epi8((char)c)));
+#else
+    unsigned int m = 0;
+    for (int i = 0; i != OA_GROUP; ++i)
+        m |= (unsigned int)(ctrl[i] == c) << i;
+    return m;
+#endif
+}
+
+/* bit i set if slot i of the group is empty or deleted */
+static inline unsigned int oa_match_free(const unsigned char *ctrl)
+{
+#if defined(__SSE2__)
+    return (unsigned int)_mm_movemask_epi8(
+        _mm_loadu_si128((const __m128i *)ctrl));
+#else
+    unsigned int m = 0;
+    for (int i = 0; i != OA_GROUP; ++i)
+        m |= (unsigned int)(ctrl[i] >> 7) << i;
+    return m;
+#endif
+}
+
+/* Returns the slot of the first object matching `key', or -1.  `nsteps' is
+ * set to the number of groups probed past the first one. */
+static inline int oa_lookup(hash_t *const h, const void *const restrict key,
+                            unsigned int *nsteps)
+{
+    const uint64_t hh = oa_mix(HASH(h, key));
+    const unsigned int gmask = h->ncap / OA_GROUP - 1;
+    const int keyoff = h->keyoff;
+    unsigned int g = (unsigned int)(hh >> 7) & gmask, i = 0, m, s;
+    const unsigned char *ctrl;
+
+    for (;;) {
+        ctrl = h->ctrl + g * OA_GROUP;
+        for (m = oa_match(ctrl, OA_H2(hh)); m; m &= m - 1) {
+            s = g * OA_GROUP + __builtin_ctz(m);
+            if (CMP(h, key, &h->slots[s][keyoff]) == 0) {
+                *nsteps = i;
+                return (int)s;
+            }
+        }
+        if (oa_match(ctrl, OA_EMPTY)) {
+            *nsteps = i;
+            return -1;
+        }
+        g = (g + ++i) & gmask; /* triangular probing visits every group */
+    }
+}
+
+/* Must protect with mutex in threaded code (updates stats, like
+ * default_hash_kfnd_readonly()) */
+static void *oa_hash_kfnd(hash_t *const h, const void *const restrict vkey)
+{
+    unsigned int nsteps;
+    const int s = oa_lookup(h, vkey, &nsteps);
+
+    if (h->maxsteps < nsteps)
+        h->maxsteps = nsteps;
+    h->nsteps += nsteps;
+    if (s < 0) {
+        h->nmisses++;
+        return 0;
+    }
+    h->nhits++;
+    return h->slots[s];
+}
+
+/* thread-safe */
+static void *oa_hash_kfnd_nofrills(hash_t *const h,
+                                   const void *const restrict vkey)
+{
+    unsigned int nsteps;
+    const int s = oa_lookup(h, vkey, &nsteps);
+    return (s < 0) ? 0 : h->slots[s];
+}
+
+/* first empty or deleted slot of the probe sequence of `hh' */
+static unsigned int oa_place(hash_t *const h, const uint64_t hh)
+{
+    const unsigned int gmask = h->ncap / OA_GROUP - 1;
+    unsigned int g = (unsigned int)(hh >> 7) & gmask, i = 0, m;
+
+    while ((m = oa_match_free(h->ctrl + g * OA_GROUP)) == 0)
+        g = (g + ++i) & gmask;
+    return g * OA_GROUP + __builtin_ctz(m);
+}
+
+static int oa_rehash(hash_t *const h, const unsigned int ncap)
+{
+    unsigned char **const oslots = h->slots;
+    const unsigned int *const ohashes = h->hashes;
+    const unsigned char *const octrl = h->ctrl;
+    const unsigned int ocap = h->ncap;
+    unsigned char **slots;
+    unsigned int ii, s;
+    uint64_t hh;
+
+    slots = h->malloc_fn((size_t)ncap * (sizeof(unsigned char *) +
+                                         sizeof(unsigned int) + 1));
+    if (slots == 0)
+        return -1;
+    h->slots = slots;
+    h->hashes = (unsigned int *)(slots + ncap);
+    h->ctrl = (unsigned char *)(h->hashes + ncap);
+    h->ncap = ncap;
+    memset(h->ctrl, OA_EMPTY, ncap);
+    h->growth_left = ncap - ncap / 8 - h->nents;
+
+    if (oslots != 0) {
+        for (ii = 0; ii < ocap; ++ii) {
+            if (OA_ISFULL(octrl[ii])) {
+                hh = oa_mix(ohashes[ii]);
+                s = oa_place(h, hh);
+                h->ctrl[s] = OA_H2(hh);
+                h->slots[s] = oslots[ii];
+                h->hashes[s] = ohashes[ii];
+            }
+        }
+        h->free_fn(oslots);
+    }
+    h->ngrow++;
+    return 0;
+}
+
+static int oa_add(hash_t *const h, unsigned char *const obj)
+{
+    unsigned int ncap, s, hash;
+    uint64_t hh;
+
+    if (h->growth_left == 0) {
+        if (h->slots == 0)
+            ncap = OA_GROUP;
+        else if (h->nents >= (h->ncap - h->ncap / 8) / 2)
+            ncap = h->ncap << 1; /* else same size, drops tombstones */
+        else
+            ncap = h->ncap;
+        if (ncap > OA_MAX_CAP || oa_rehash(h, ncap) != 0)
+            return -1;
+    }
+
+    hash = HASH(h, &obj[h->keyoff]);
+    hh = oa_mix(hash);
+    s = oa_place(h, hh);
+    if (h->ctrl[s] == OA_EMPTY)
+        h->growth_left--;
+    h->ctrl[s] = OA_H2(hh);
+    h->slots[s] = obj;
+    h->hashes[s] = hash;
+    h->nadds++;
+    h->nents++;
+    return 0;
+}
+
+static int oa_delk(hash_t *const h, const void *const key)
+{
+    unsigned int nsteps;
+    const int s = oa_lookup(h, key, &nsteps);
+
+    if (nsteps > h->maxsteps)
+        h->maxsteps = nsteps;
+    h->nsteps += nsteps;
+    if (s < 0)
+        return -1;
+    /* No probe went past a group with an empty slot: free the slot for good.
+     * Otherwise, lookups for objects further down must keep probing. */
+    if (oa_match(h->ctrl + (s & ~(OA_GROUP - 1)), OA_EMPTY)) {
+        h->ctrl[s] = OA_EMPTY;
+        h->growth_left++;
+    } else {
+        h->ctrl[s] = OA_DELETED;
+    }
+    h->ndels++;
+    h->nents--;
+    return 0;
+}
+
+static unsigned int oa_next(hash_t *const h, unsigned int s)
+{
+    while (s < h->ncap && !OA_ISFULL(h->ctrl[s]))
+        ++s;
+    return s;
+}
+
+int hash_set_open_addressing(hash_t *const h)
+{
+    if (h->scheme == HASH_OPEN)
+        return 0;
+    if (h->nents != 0 || h->htab != STARTER_HTAB)
+        return -1;
+    h->scheme = HASH_OPEN;
+    h->ctrl = (unsigned char *)oa_empty_group; /* never written */
+    h->slots = 0;
+    h->ncap = OA_GROUP;
+    h->growth_left = 0; /* first hash_add() allocates */
+    if (h->hash_kfnd_fn == default_hash_kfnd_nofrills ||
+        h->hash_kfnd_fn == power2_hash_kfnd_nofrills ||
+        h->hash_kfnd_fn == i4_hash_kfnd_nofrills) {
+        h->hash_kfnd_fn = oa_hash_kfnd_nofrills;
+        h->hash_kfnd_fn_readonly = oa_hash_kfnd_nofrills;
+    } else {
+        h->hash_kfnd_fn = oa_hash_kfnd;
+        h->hash_kfnd_fn_readonly = oa_hash_kfnd;
+    }
+    return 0;
+}
+
 #define is_lockfree_query(h) 0
 
 /* enable stats for query steps and flipping found entry to head of chain.
@@ -1060,6 +1325,9 @@ void hash_config_query_stats(hash_t *const h, const int enable)
         } else if (h->hash_kfnd_fn == i4_hash_kfnd_nofrills) {
             h->hash_kfnd_fn = i4_hash_kfnd;
             h->hash_kfnd_fn_readonly = i4_hash_kfnd_readonly;
+        } else if (h->hash_kfnd_fn == oa_hash_kfnd_nofrills) {
+            h->hash_kfnd_fn = oa_hash_kfnd;
+            h->hash_kfnd_fn_readonly = oa_hash_kfnd;
         }
     } else {
         if (h->hash_kfnd_fn == default_hash_kfnd) {
@@ -1071,6 +1339,9 @@ void hash_config_query_stats(hash_t *const h, const int enable)
         } else if (h->hash_kfnd_fn == i4_hash_kfnd) {
             h->hash_kfnd_fn = i4_hash_kfnd_nofrills;
             h->hash_kfnd_fn_readonly = i4_hash_kfnd_nofrills;
+        } else if (h->hash_kfnd_fn == oa_hash_kfnd) {
+            h->hash_kfnd_fn = oa_hash_kfnd_nofrills;
+            h->hash_kfnd_fn_readonly = oa_hash_kfnd_nofrills;
         }
     }
 }
@@ -1198,6 +1469,15 @@ int hash_initsize(hash_t *h, unsigned int sz)
 {
     const size_t tsz = sizeof(hashtable) + sz * sizeof(hashent *);
 
+    if (h->scheme == HASH_OPEN) {
+        unsigned int ncap = OA_GROUP;
+        if (sz == 0 || h->slots != 0 || sz > OA_MAX_CAP / 8 * 7)
+            return -1;
+        while (ncap - ncap / 8 < sz)
+            ncap <<= 1;
+        return oa_rehash(h, ncap);
+    }
+
     if (sz == 0 || h->htab != STARTER_HTAB)
         return -1;
 
@@ -1441,6 +1721,8 @@ int hash_add(hash_t *h, void *vobj)
     hashtable *restrict htab = h->htab;
     hashent *restrict he;
     hashent **tbl;
+    if (h->scheme == HASH_OPEN)
+        return oa_add(h, obj);
     if (h->nents >= htab->ntbl >> 1) {
         if ((htab = hash_inctbl(h)) == STARTER_HTAB)
             return -1; /*(failed to resize starter_htab)*/
@@ -1461,6 +1743,9 @@ int hash_add(hash_t *h, void *vobj)
 int hash_delk(hash_t *const h, const void *const key)
 {
     /* must be protected by mutex in threaded application */
+    if (h->scheme == HASH_OPEN)
+        return oa_delk(h, key);
+
     hashtable *const restrict htab = h->htab;
     unsigned int nsteps = 0;
     const unsigned int hh = HASH(h, key);
@@ -1528,6 +1813,10 @@ void hash_clear(hash_t *const h)
 {
     hashfree_t *const h_free = h->free_fn;
     hashtable *nxtab, *restrict htab = h->htab;
+    if (h->scheme == HASH_OPEN && h->slots != 0) {
+        memset(h->ctrl, OA_EMPTY, h->ncap);
+        h->growth_left = h->ncap - h->ncap / 8;
+    }
     if (htab != STARTER_HTAB) {
         /* pool_clear() below will reclaim hashents) */
         memset(htab->tbl, 0, htab->ntbl * sizeof(hashent *));
@@ -1553,6 +1842,8 @@ void hash_free(hash_t *const h)
     }
     if (h->htab != STARTER_HTAB)
         h_free(h->htab);
+    if (h->slots != 0)
+        h_free(h->slots);
     pool_free(h->ents);
     memset(h, -1, sizeof(*h)); /* zap it */
     h_free(h);
@@ -1608,6 +1899,15 @@ void hash_dump_stats(hash_t *h, FILE *out, FILE *detail_out)
     int nused;
     char buf[160];
     hashent *he;
+    if (h->scheme == HASH_OPEN) {
+        logmsgf(LOGMSG_USER, out, "Key Size = %-10u      #Ents = %-10u\n", h->keysz, h->nents);
+        logmsgf(LOGMSG_USER, out, "#Slots   = %-10u      #Free = %-10u\n", h->ncap, h->growth_left);
+        logmsgf(LOGMSG_USER, out, "#Steps   = %-10u   MaxSteps = %-10u\n", h->nsteps, h->maxsteps);
+        logmsgf(LOGMSG_USER, out, "#Hits    = %-10u    #Misses = %-10u\n", h->nhits, h->nmisses);
+        logmsgf(LOGMSG_USER, out, "#Adds    = %-10u      #Dels = %-10u\n", h->nadds, h->ndels);
+        logmsgf(LOGMSG_USER, out, "#TBLgrow = %-10u\n", h->ngrow);
+        return;
+    }
     pool_info(h->ents, 0, &nused, 0);
     logmsgf(LOGMSG_USER, out, "Key Size = %-10u      #Ents = %-10u\n", h->keysz, h->nents);
     logmsgf(LOGMSG_USER, out, "#Table   = %-10u      #Used = %-10d\n", ntbl, nused);
@@ -1647,6 +1947,15 @@ int hash_for(hash_t *const h, hashforfunc_t *const func,
     hashent **const tbl = htab->tbl;
     const unsigned int ntbl = htab->ntbl;
 
+    if (h->scheme == HASH_OPEN) {
+        for (ii = oa_next(h, 0); ii < h->ncap; ii = oa_next(h, ii + 1)) {
+            rc = (*func)(h->slots[ii], arg);
+            if (rc != 0)
+                return rc; /*terminate walk*/
+        }
+        return 0;
+    }
+
     for (ii = 0; ii < ntbl; ii++) {
         for (he = tbl[ii]; he; he = nhe) {
             nhe = he->next;
@@ -1667,6 +1976,13 @@ void *hash_first(hash_t *const h, void **const ent,
     const unsigned int ntbl = htab->ntbl;
     unsigned int ii;
 
+    if (h->scheme == HASH_OPEN) {
+        /* the slot is the iterator, `ent' is unused */
+        *ent = 0;
+        *bkt = ii = oa_next(h, 0);
+        return (ii < h->ncap) ? h->slots[ii] : 0;
+    }
+
     for (ii = 0; ii < ntbl && !(he = tbl[ii]); ++ii)
         ;
     *bkt = ii;
@@ -1681,6 +1997,11 @@ void *hash_next(hash_t *const h, void **const ent,
                 unsigned int *const restrict bkt)
 {
     hashent *restrict he = (hashent *)(*ent);
+    if (h->scheme == HASH_OPEN) {
+        const unsigned int ii = oa_next(h, *bkt + 1);
+        *bkt = ii;
+        return (ii < h->ncap) ? h->slots[ii] : 0;
+    }
     if (!he) {
         hashtable *const htab = h->htab;
         hashent **const tbl = htab->tbl;
@@ -1707,7 +2028,7 @@ void hash_info2(hash_t *h, int *nhits, int *nmisses, int *nsteps, int *ntbl,
     if (nsteps)
         *nsteps = h->nsteps;
     if (ntbl)
-        *ntbl = h->htab->ntbl;
+        *ntbl = (h->scheme == HASH_OPEN) ? h->ncap : h->htab->ntbl;
     if (nents)
         *nents = h->nents;
     if (nadds)
@@ -1726,4 +2047,9 @@ void hash_info(hash_t *h, int *nhits, int *nmisses, int *nsteps, int *ntbl,
 
 int hash_get_num_entries(hash_t *h) { return h->nents; }
 
+#else /*COMDB2_BBCMAKE*/
+
+/* sysutil's hash tables are chained only */
+int hash_set_open_addressing(hash_t *h) { return -1; }
+
 #endif /*COMDB2_BBCMAKE*/